@@ -1,4 +1,4 @@
-QT += core gui printsupport sql svg webkit webkitwidgets
+QT += concurrent core gui printsupport sql svg webkit webkitwidgets
 TEMPLATE = app
 CONFIG += debug_and_release
 
@@ -36,3 +36,7 @@ MIN_COMPATIBLE_OPTIMUS_VERSION=\\\"'0.1'\\\"
 DEFINES += MIN_COMPATIBLE_OPTIMUS_VERSION=$${MIN_COMPATIBLE_OPTIMUS_VERSION}
 CURRENT_OPTIMUS_VERSION=\\\"'1.2.0'\\\"
 DEFINES += CURRENT_OPTIMUS_VERSION=$${CURRENT_OPTIMUS_VERSION}
+
+# images are encoded with zlib directly, Qt ships its own copy on Windows
+unix: LIBS += -lz
+win32: INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
@@ -1,48 +1,117 @@
 include (ov.pri)
 
-HEADERS += src/AppController.h \
+HEADERS += src/AnnotationIndex.h \
+           src/AppController.h \
            src/AppView.h \
+           src/ChartRenderer.h \
+           src/ChartWidget.h \
+           src/ClusteringController.h \
+           src/ClusteringDialog.h \
+           src/CorrelatedFeaturesView.h \
+           src/CsvWriter.h \
            src/CsvWritingUtils.h \
+           src/DifferentialStatistics.h \
+           src/FeatureCorrelationSearch.h \
            src/FeatureData.h \
+           src/FeatureDataLoader.h \
            src/FeatureDataSource.h \
+           src/FeatureGroupingDialog.h \
+           src/FeatureGroups.h \
+           src/FeatureMatrix.h \
+           src/FeatureMatrixFileReader.h \
+           src/FeatureMatrixFileWriter.h \
+           src/FeatureMatrixUtils.h \
            src/FeatureTableExporter.h \
            src/FeatureTableItemDelegate.h \
            src/FeatureTableModel.h \
            src/FeatureTableProxyModel.h \
            src/FeatureTableVisibilityDialog.h \
            src/FeatureTableWidget.h \
+           src/FilterExpression.h \
+           src/FilterExpressionDialog.h \
            src/Globals.h \
            src/GraphDataController.h \
            src/GraphDescriptors.h \
            src/GraphExporter.h \
            src/GraphPoint.h \
+           src/GraphSeries.h \
+           src/GroupComparisonDialog.h \
+           src/HeatmapTileCache.h \
+           src/HeatmapView.h \
+           src/HierarchicalClustering.h \
+           src/IntensityNormalization.h \
+           src/MassTraceIndex.h \
            src/Ms2ScanInfo.h \
+           src/Ms2ScanTable.h \
+           src/NativeGraphView.h \
+           src/NeighbourFeaturesDialog.h \
            src/ProgressIndicator.h \
-           src/SaveGraphDialog.h
+           src/RangeFilterDialog.h \
+           src/SamplePca.h \
+           src/SamplePcaView.h \
+           src/SampleStatisticsDialog.h \
+           src/SaveGraphDialog.h \
+           src/SparklineCache.h \
+           src/StripImageWriter.h \
+           src/VolcanoPlotView.h
 
 FORMS += src/ui/AppView.ui \
          src/ui/FeatureTableVisibilityDialog.ui \
          src/ui/ProgressIndicator.ui
 
-SOURCES += src/AppController.cpp \
+SOURCES += src/AnnotationIndex.cpp \
+           src/AppController.cpp \
            src/AppView.cpp \
+           src/ChartRenderer.cpp \
+           src/ChartWidget.cpp \
+           src/ClusteringController.cpp \
+           src/ClusteringDialog.cpp \
+           src/CorrelatedFeaturesView.cpp \
+           src/CsvWriter.cpp \
            src/CsvWritingUtils.cpp \
+           src/DifferentialStatistics.cpp \
+           src/FeatureCorrelationSearch.cpp \
            src/FeatureData.cpp \
+           src/FeatureDataLoader.cpp \
            src/FeatureDataSource.cpp \
+           src/FeatureGroupingDialog.cpp \
+           src/FeatureGroups.cpp \
+           src/FeatureMatrix.cpp \
+           src/FeatureMatrixFileWriter.cpp \
+           src/FeatureMatrixUtils.cpp \
            src/FeatureTableExporter.cpp \
            src/FeatureTableItemDelegate.cpp \
            src/FeatureTableModel.cpp \
            src/FeatureTableProxyModel.cpp \
            src/FeatureTableVisibilityDialog.cpp \
            src/FeatureTableWidget.cpp \
+           src/FilterExpression.cpp \
+           src/FilterExpressionDialog.cpp \
            src/Globals.cpp \
            src/GraphDataController.cpp \
            src/GraphDescriptors.cpp \
            src/GraphExporter.cpp \
            src/GraphPoint.cpp \
+           src/GraphSeries.cpp \
+           src/GroupComparisonDialog.cpp \
+           src/HeatmapTileCache.cpp \
+           src/HeatmapView.cpp \
+           src/HierarchicalClustering.cpp \
+           src/IntensityNormalization.cpp \
            src/Main.cpp \
+           src/MassTraceIndex.cpp \
            src/Ms2ScanInfo.cpp \
+           src/Ms2ScanTable.cpp \
+           src/NativeGraphView.cpp \
+           src/NeighbourFeaturesDialog.cpp \
            src/ProgressIndicator.cpp \
-           src/SaveGraphDialog.cpp
+           src/RangeFilterDialog.cpp \
+           src/SamplePca.cpp \
+           src/SamplePcaView.cpp \
+           src/SampleStatisticsDialog.cpp \
+           src/SaveGraphDialog.cpp \
+           src/SparklineCache.cpp \
+           src/StripImageWriter.cpp \
+           src/VolcanoPlotView.cpp
 
 RESOURCES += ov.qrc
@@ -0,0 +1,52 @@
+include (ov.pri)
+
+# the batch exporter renders charts with QPainter only and doesn't need the web view
+QT -= webkit webkitwidgets
+QT += widgets
+CONFIG += console
+CONFIG -= app_bundle
+
+CONFIG(debug, debug|release) {
+    TARGET = OptimusViewerBatchd
+    MOC_DIR = _tmp/batch/moc/debug
+    OBJECTS_DIR = _tmp/batch/obj/debug
+}
+
+CONFIG(release, debug|release) {
+    TARGET = OptimusViewerBatch
+    MOC_DIR = _tmp/batch/moc/release
+    OBJECTS_DIR = _tmp/batch/obj/release
+}
+
+HEADERS += src/AnnotationIndex.h \
+           src/BatchExporter.h \
+           src/ChartRenderer.h \
+           src/CsvWriter.h \
+           src/CsvWritingUtils.h \
+           src/FeatureData.h \
+           src/FeatureDataLoader.h \
+           src/FeatureDataSource.h \
+           src/FeatureMatrix.h \
+           src/Globals.h \
+           src/GraphPoint.h \
+           src/GraphSeries.h \
+           src/Ms2ScanInfo.h \
+           src/Ms2ScanTable.h \
+           src/SparklineCache.h
+
+SOURCES += src/AnnotationIndex.cpp \
+           src/BatchExporter.cpp \
+           src/BatchMain.cpp \
+           src/ChartRenderer.cpp \
+           src/CsvWriter.cpp \
+           src/CsvWritingUtils.cpp \
+           src/FeatureData.cpp \
+           src/FeatureDataLoader.cpp \
+           src/FeatureDataSource.cpp \
+           src/FeatureMatrix.cpp \
+           src/Globals.cpp \
+           src/GraphPoint.cpp \
+           src/GraphSeries.cpp \
+           src/Ms2ScanInfo.cpp \
+           src/Ms2ScanTable.cpp \
+           src/SparklineCache.cpp
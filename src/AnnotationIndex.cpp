@@ -0,0 +1,162 @@
+#include <algorithm>
+
+#include <QPair>
+#include <QSqlQuery>
+#include <QVariant>
+
+#include "FeatureMatrix.h"
+
+#include "AnnotationIndex.h"
+
+const int TRIGRAM_LENGTH = 3;
+
+namespace ov {
+
+AnnotationIndex::AnnotationIndex()
+{
+
+}
+
+void AnnotationIndex::clear()
+{
+    terms.clear();
+    foldedTerms.clear();
+    termRowOffsets.clear();
+    termRows.clear();
+    termsByTrigram.clear();
+}
+
+bool AnnotationIndex::isEmpty() const
+{
+    return terms.isEmpty();
+}
+
+void AnnotationIndex::build(const FeatureMatrix &matrix)
+{
+    clear();
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT FA.feature_id, A.compound_id, CWL.web_link FROM FeatureAnnotation AS FA "
+        "INNER JOIN Annotation AS A ON FA.annotation_id = A.id "
+        "LEFT OUTER JOIN AnnotationWebLink AS AWL ON AWL.annotation_id = A.id "
+        "LEFT OUTER JOIN CompoundWebLink AS CWL ON AWL.link_id = CWL.id")) {
+        return;
+    }
+
+    QHash<QString, QVector<int> > rowsByTerm;
+    while (query.next()) {
+        const int row = matrix.findRow(query.value(0).value<FeatureId>());
+        if (-1 == row) {
+            continue;
+        }
+        for (int column = 1; column <= 2; ++column) {
+            const QString term = query.value(column).toString();
+            if (!term.isEmpty()) {
+                rowsByTerm[term].append(row);
+            }
+        }
+    }
+
+    QVector<QPair<QString, QString> > sortedTerms; // lowercase and original versions
+    sortedTerms.reserve(rowsByTerm.size());
+    for (QHash<QString, QVector<int> >::const_iterator it = rowsByTerm.constBegin(); it != rowsByTerm.constEnd(); ++it) {
+        sortedTerms.append(qMakePair(it.key().toLower(), it.key()));
+    }
+    std::sort(sortedTerms.begin(), sortedTerms.end());
+
+    termRowOffsets.reserve(sortedTerms.size() + 1);
+    termRowOffsets.append(0);
+    for (int termIndex = 0; termIndex < sortedTerms.size(); ++termIndex) {
+        const QString &foldedTerm = sortedTerms[termIndex].first;
+        terms.append(sortedTerms[termIndex].second);
+        foldedTerms.append(foldedTerm);
+
+        // a feature may be annotated by the same compound several times, e.g. as different adducts
+        QVector<int> rows = rowsByTerm.value(sortedTerms[termIndex].second);
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        termRows += rows;
+        termRowOffsets.append(termRows.size());
+
+        for (int position = 0; position + TRIGRAM_LENGTH <= foldedTerm.size(); ++position) {
+            QVector<int> &trigramTerms = termsByTrigram[getTrigram(foldedTerm, position)];
+            if (trigramTerms.isEmpty() || trigramTerms.last() != termIndex) {
+                trigramTerms.append(termIndex);
+            }
+        }
+    }
+    termRows.squeeze();
+}
+
+AnnotationIndex::Trigram AnnotationIndex::getTrigram(const QString &foldedText, int position)
+{
+    return (Trigram(foldedText[position].unicode()) << 32) | (Trigram(foldedText[position + 1].unicode()) << 16)
+        | Trigram(foldedText[position + 2].unicode());
+}
+
+QVector<int> AnnotationIndex::findTermIndexes(const QString &foldedText, MatchMode mode) const
+{
+    QVector<int> termIndexes;
+    if (foldedText.isEmpty()) {
+        return termIndexes;
+    }
+
+    if (PREFIX_MATCH == mode) {
+        const int begin = std::lower_bound(foldedTerms.constBegin(), foldedTerms.constEnd(), foldedText) - foldedTerms.constBegin();
+        for (int termIndex = begin; termIndex < foldedTerms.size() && foldedTerms[termIndex].startsWith(foldedText); ++termIndex) {
+            termIndexes.append(termIndex);
+        }
+    } else if (foldedText.size() < TRIGRAM_LENGTH) {
+        // too short to have trigrams, there are far fewer terms than rows anyway
+        for (int termIndex = 0; termIndex < foldedTerms.size(); ++termIndex) {
+            if (foldedTerms[termIndex].contains(foldedText)) {
+                termIndexes.append(termIndex);
+            }
+        }
+    } else {
+        const QVector<int> *candidates = NULL;
+        for (int position = 0; position + TRIGRAM_LENGTH <= foldedText.size(); ++position) {
+            const QHash<Trigram, QVector<int> >::const_iterator it = termsByTrigram.constFind(getTrigram(foldedText, position));
+            if (it == termsByTrigram.constEnd()) {
+                return termIndexes; // no term has the trigram
+            }
+            if (NULL == candidates || it->size() < candidates->size()) {
+                candidates = &it.value();
+            }
+        }
+        foreach (int termIndex, *candidates) {
+            if (foldedTerms[termIndex].contains(foldedText)) {
+                termIndexes.append(termIndex);
+            }
+        }
+    }
+    return termIndexes;
+}
+
+QVector<int> AnnotationIndex::findRows(const QString &text, MatchMode mode) const
+{
+    QVector<int> rows;
+    foreach (int termIndex, findTermIndexes(text.toLower(), mode)) {
+        for (int i = termRowOffsets[termIndex]; i < termRowOffsets[termIndex + 1]; ++i) {
+            rows.append(termRows[i]);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+QStringList AnnotationIndex::findTerms(const QString &prefix, int maxCount) const
+{
+    QStringList result;
+    foreach (int termIndex, findTermIndexes(prefix.toLower(), PREFIX_MATCH)) {
+        if (result.size() == maxCount) {
+            break;
+        }
+        result.append(terms[termIndex]);
+    }
+    return result;
+}
+
+} // namespace ov
@@ -0,0 +1,50 @@
+#ifndef ANNOTATION_INDEX_H
+#define ANNOTATION_INDEX_H
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+namespace ov {
+
+class FeatureMatrix;
+
+// Compound IDs and web links of annotations of all features kept in memory for case insensitive search.
+// Distinct terms are sorted for prefix search, and every term is listed under each trigram (three consecutive
+// characters) it contains, so a substring search checks only terms having the rarest trigram of the query.
+class AnnotationIndex
+{
+public:
+    enum MatchMode {
+        PREFIX_MATCH,
+        SUBSTRING_MATCH
+    };
+
+    AnnotationIndex();
+
+    // rows of the matrix are looked up by feature ids
+    void build(const FeatureMatrix &matrix);
+    void clear();
+    bool isEmpty() const;
+
+    // rows of features having a matching compound ID or link, sorted, none for an empty text
+    QVector<int> findRows(const QString &text, MatchMode mode) const;
+    // compound IDs and links starting with the prefix, in alphabetical order
+    QStringList findTerms(const QString &prefix, int maxCount) const;
+
+private:
+    typedef quint64 Trigram;
+
+    QVector<int> findTermIndexes(const QString &foldedText, MatchMode mode) const;
+    static Trigram getTrigram(const QString &foldedText, int position);
+
+    QStringList terms; // sorted by their lowercase versions
+    QStringList foldedTerms; // lowercase
+    QVector<int> termRowOffsets; // rows of the term t are at [termRowOffsets[t], termRowOffsets[t + 1]) of termRows
+    QVector<int> termRows;
+    QHash<Trigram, QVector<int> > termsByTrigram; // indexes of terms, ascending
+};
+
+} // namespace ov
+
+#endif // ANNOTATION_INDEX_H
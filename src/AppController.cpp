@@ -10,12 +10,13 @@ namespace ov {
 bool AppController::staticInitializationDone = false;
 
 AppController::AppController()
-    : featureModel(NULL, &dataSource), graphDataController(&dataSource), featureTableExporter(view)
+    : featureModel(NULL, &dataSource), graphDataController(&dataSource), featureTableExporter(view, dataSource)
 {
     initStatic();
     connectSingals();
+    graphExporter.setGraphDataController(&graphDataController);
 
-    view.initViews(&featureModel);
+    view.initViews(&featureModel, &graphDataController);
     view.show();
 }
 
@@ -32,6 +33,12 @@ void AppController::registerMetatypes()
 {
     qRegisterMetaType<GraphId>("GraphId");
     qRegisterMetaType<FormatId>("FormatId");
+    qRegisterMetaType<DataSourceId>("DataSourceId");
+    qRegisterMetaType<SampleFeatureIds>("SampleFeatureIds");
+    qRegisterMetaType<FeatureDataList>("FeatureDataList");
+    qRegisterMetaType<SpectrumIdList>("SpectrumIdList");
+    qRegisterMetaType<Ms2SpectraById>("Ms2SpectraById");
+    qRegisterMetaType<SparklinesByFeature>("SparklinesByFeature");
 }
 
 void AppController::setWebSettings()
@@ -52,9 +59,12 @@ void AppController::connectSingals()
     connect(&view, &AppView::exit, &QCoreApplication::quit);
     connect(&view, &AppView::graphViewAboutToLoad, this, &AppController::graphViewAboutToLoad);
     connect(&view, &AppView::featureSelectionChanged, &graphDataController, &GraphDataController::featureSelectionChanged);
+    connect(&view, &AppView::featurePrefetchRequested, &dataSource, &FeatureDataSource::prefetchFeatures);
+    connect(&view, &AppView::webGraphViewVisibilityChanged, &graphDataController, &GraphDataController::setWebPlotEnabled);
 
     connect(&dataSource, &FeatureDataSource::samplesChanged, &view, &AppView::samplesChanged);
     connect(&dataSource, &FeatureDataSource::samplesChanged, &graphDataController, &GraphDataController::samplesChanged);
+    connect(&dataSource.getSparklineCache(), &SparklineCache::sparklinesReady, &view, &AppView::sparklinesReady);
 
     connect(&graphDataController, &GraphDataController::resetActiveFeatures, &view, &AppView::resetSelection);
 }
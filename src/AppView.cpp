@@ -1,25 +1,79 @@
+#include <algorithm>
+
+#include <QActionGroup>
+#include <QApplication>
+#include <QCompleter>
 #include <QFile>
+#include <QInputDialog>
+#include <QItemSelection>
 #include <QMessageBox>
+#include <QSplitter>
 #include <QSqlError>
+#include <QStringListModel>
 #include <QTextStream>
 #include <QWebFrame>
 #include <QWebPage>
 #include <QWebSecurityOrigin>
+#include <QtConcurrent>
 
 #include "ui_AppView.h"
 
+#include "AnnotationIndex.h"
+#include "ClusteringController.h"
+#include "ClusteringDialog.h"
+#include "CorrelatedFeaturesView.h"
+#include "FeatureGroupingDialog.h"
 #include "FeatureTableModel.h"
+#include "GroupComparisonDialog.h"
 #include "FeatureTableProxyModel.h"
 #include "FeatureTableWidget.h"
+#include "FilterExpressionDialog.h"
+#include "HeatmapView.h"
+#include "MassTraceIndex.h"
+#include "NativeGraphView.h"
+#include "NeighbourFeaturesDialog.h"
+#include "RangeFilterDialog.h"
+#include "SamplePcaView.h"
+#include "SampleStatisticsDialog.h"
+#include "VolcanoPlotView.h"
 
 #include "AppView.h"
 
+const int SELECTION_UPDATE_DELAY_MS = 50;
+const int HEATMAP_UPDATE_DELAY_MS = 200;
+const int MAX_NEIGHBOUR_COUNT = 100; // plots become unreadable with more graphs
+const int MIN_COMPLETION_PREFIX_LENGTH = 2;
+const int MAX_COMPLETION_COUNT = 50;
+const int DEFAULT_MOST_INTENSE_FEATURE_COUNT = 100;
+
 namespace ov {
 
 AppView::AppView(QWidget *parent)
-    : QMainWindow(parent), graphViewInited(false), ui(new Ui::AppViewUi)
+    : QMainWindow(parent), graphViewInited(false), normalizationActions(NULL), featureTableView(NULL), nativeGraphView(NULL),
+    heatmapView(NULL), volcanoPlotView(NULL), correlatedFeaturesView(NULL),
+    samplePcaView(NULL), clusteringController(new ClusteringController(this)), ui(new Ui::AppViewUi),
+    mostIntenseFeatureCount(DEFAULT_MOST_INTENSE_FEATURE_COUNT), mostIntenseSampleNumber(-1), cancelRequested(0),
+    traceIndexRequester(NULL)
 {
     ui->setupUi(this);
+
+    computationIndicator.setModal(true);
+    connect(this, &AppView::computationProgress, &computationIndicator, &ProgressIndicator::progress);
+    connect(&computationIndicator, &ProgressIndicator::canceled, this, &AppView::cancelComputation);
+    connect(&comparisonWatcher, &QFutureWatcher<DifferentialStatistics>::finished, this, &AppView::groupComparisonFinished);
+    connect(&traceIndexWatcher, &QFutureWatcher<MassTraceIndex>::finished, this, &AppView::massTraceIndexFinished);
+    connect(&groupingWatcher, &QFutureWatcher<FeatureGroups>::finished, this, &AppView::featureGroupingFinished);
+
+    // bursts of selection changes, e.g. while dragging the mouse, result in a single plot update
+    selectionUpdateTimer.setSingleShot(true);
+    selectionUpdateTimer.setInterval(SELECTION_UPDATE_DELAY_MS);
+    connect(&selectionUpdateTimer, &QTimer::timeout, this, &AppView::emitFeatureSelection);
+
+    // sorting and filtering change the order of rows many times in a row
+    heatmapUpdateTimer.setSingleShot(true);
+    heatmapUpdateTimer.setInterval(HEATMAP_UPDATE_DELAY_MS);
+    connect(&heatmapUpdateTimer, &QTimer::timeout, this, &AppView::updateHeatmapRows);
+
     initActions();
     connectGuiSignals();
     setShortcuts();
@@ -28,20 +82,52 @@ AppView::AppView(QWidget *parent)
     setDefaultSplitterSize();
 }
 
-void AppView::initViews(FeatureTableModel *model)
+void AppView::initViews(FeatureTableModel *model, GraphDataController *graphDataController)
 {
     initGraphView();
+    initNativeGraphView(graphDataController);
     initFeatureTable(model);
 }
 
 AppView::~AppView()
 {
+    cancelRequested.store(1);
+    comparisonWatcher.waitForFinished();
+    traceIndexWatcher.waitForFinished();
+    groupingWatcher.waitForFinished();
     delete ui;
 }
 
 void AppView::initActions()
 {
     ui->actionExportToCsv->setEnabled(false);
+    ui->actionSampleStatistics->setEnabled(false);
+    ui->actionSamplePca->setEnabled(false);
+    ui->menuNormalization->setEnabled(false);
+    ui->actionCompareGroups->setEnabled(false);
+    ui->actionClearGroupComparison->setEnabled(false);
+    ui->actionFindCorrelated->setEnabled(false);
+    ui->actionAddNeighbours->setEnabled(false);
+    ui->actionRangeFilter->setEnabled(false);
+    ui->actionClearRangeFilter->setEnabled(false);
+    ui->actionFilterExpression->setEnabled(false);
+    ui->actionClearFilterExpression->setEnabled(false);
+    ui->actionMostIntenseFeatures->setEnabled(false);
+    ui->actionClusterTable->setEnabled(false);
+    ui->actionRestoreTableOrder->setEnabled(false);
+    ui->actionGroupFeatures->setEnabled(false);
+    ui->actionShowMainFeatures->setEnabled(false);
+    ui->actionClearFeatureGroups->setEnabled(false);
+
+    normalizationActions = new QActionGroup(this);
+    ui->actionNoNormalization->setData(IntensityNormalization::NO_NORMALIZATION);
+    ui->actionTicNormalization->setData(IntensityNormalization::TIC_NORMALIZATION);
+    ui->actionMedianNormalization->setData(IntensityNormalization::MEDIAN_NORMALIZATION);
+    ui->actionQuantileNormalization->setData(IntensityNormalization::QUANTILE_NORMALIZATION);
+    ui->actionInternalStandardNormalization->setData(IntensityNormalization::INTERNAL_STANDARD_NORMALIZATION);
+    foreach (QAction *action, ui->menuNormalization->actions()) {
+        normalizationActions->addAction(action);
+    }
 
     filterTableAction = new QAction(tr("Filter feature table..."), this);
     connect(filterTableAction, &QAction::triggered, this, &AppView::filterTableTriggered);
@@ -83,36 +169,96 @@ void AppView::connectGuiSignals()
     connect(ui->actionExit, &QAction::triggered, this, &AppView::exit);
     connect(ui->actionOpen, &QAction::triggered, this, &AppView::open);
     connect(ui->actionExportToCsv, &QAction::triggered, this, &AppView::exportToCsvTriggered);
+    connect(ui->actionNativeCharts, &QAction::toggled, this, &AppView::nativeChartsToggled);
+    connect(ui->actionHeatmap, &QAction::toggled, this, &AppView::heatmapToggled);
+    connect(ui->actionSparklines, &QAction::toggled, this, &AppView::sparklinesToggled);
+    connect(ui->actionSampleStatistics, &QAction::triggered, this, &AppView::sampleStatisticsTriggered);
+    connect(ui->actionSamplePca, &QAction::triggered, this, &AppView::samplePcaTriggered);
+    connect(normalizationActions, &QActionGroup::triggered, this, &AppView::normalizationTriggered);
+    connect(ui->actionCompareGroups, &QAction::triggered, this, &AppView::compareGroupsTriggered);
+    connect(ui->actionClearGroupComparison, &QAction::triggered, this, &AppView::clearGroupComparisonTriggered);
+    connect(ui->actionFindCorrelated, &QAction::triggered, this, &AppView::findCorrelatedTriggered);
+    connect(ui->actionAddNeighbours, &QAction::triggered, this, &AppView::addNeighboursTriggered);
+    connect(ui->actionRangeFilter, &QAction::triggered, this, &AppView::rangeFilterTriggered);
+    connect(ui->actionClearRangeFilter, &QAction::triggered, this, &AppView::clearRangeFilterTriggered);
+    connect(ui->actionFilterExpression, &QAction::triggered, this, &AppView::filterExpressionTriggered);
+    connect(ui->actionClearFilterExpression, &QAction::triggered, this, &AppView::clearFilterExpressionTriggered);
+    connect(ui->actionMostIntenseFeatures, &QAction::toggled, this, &AppView::mostIntenseFeaturesToggled);
+    connect(ui->actionClusterTable, &QAction::triggered, this, &AppView::clusterTableTriggered);
+    connect(ui->actionRestoreTableOrder, &QAction::triggered, this, &AppView::restoreTableOrderTriggered);
+    connect(ui->actionGroupFeatures, &QAction::triggered, this, &AppView::groupFeaturesTriggered);
+    connect(ui->actionShowMainFeatures, &QAction::toggled, this, &AppView::mainFeaturesToggled);
+    connect(ui->actionClearFeatureGroups, &QAction::triggered, this, &AppView::clearFeatureGroupsTriggered);
+    connect(clusteringController, &ClusteringController::featureOrderReady, this, &AppView::featureOrderReady);
+    connect(clusteringController, &ClusteringController::sampleOrderReady, this, &AppView::sampleOrderReady);
 }
 
-void AppView::featureTableSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected)
+void AppView::featureTableSelectionChanged()
 {
-    Q_UNUSED(selected);
-    Q_UNUSED(deselected);
+    // bursts of changes, e.g. a drag across many cells, end up in a single update of the plots
+    selectionUpdateTimer.start();
+}
 
-    QMultiHash<SampleId, FeatureId> currentSelection;
-    QMap<FeatureId, qreal> featureMzs;
+void AppView::emitFeatureSelection()
+{
+    // the selection model keeps rectangular ranges, so they're compared with the emitted ones
+    // and cells are visited once per update rather than once per change
+    const QItemSelection selection = featureTableView->selectionModel()->selection();
+    if (selection == emittedSelection) {
+        return;
+    }
+    emittedSelection = selection;
 
     FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
     Q_ASSERT(NULL != proxyModel);
     FeatureTableModel *model = getFeatureTableModel();
     Q_ASSERT(NULL != model);
+    const int firstSampleColumn = model->countOfGeneralDataColumns();
+    const int lastSampleColumn = firstSampleColumn + model->countOfSampleColumns() - 1;
 
-    foreach (const QModelIndex &index, featureTableView->selectionModel()->selectedIndexes()) {
-        if (index.column() > 4) {
-            const QModelIndex sourceIndex = proxyModel->mapToSource(index);
-            const FeatureId featureId = model->data(model->index(sourceIndex.row(), 0)).value<FeatureId>(); // the 0th column contains feature id
-            const SampleId sampleId = model->getSampleIdByColumnNumber(sourceIndex.column());
-            if (!featureMzs.contains(featureId)) {
-                featureMzs[featureId] = model->data(model->index(sourceIndex.row(), 1)).toReal(); // the 1st column contains mz value
+    QMultiHash<SampleId, FeatureId> currentSelection;
+    QMap<FeatureId, qreal> featureMzs;
+    foreach (const QItemSelectionRange &range, selection) {
+        const int leftColumn = qMax(range.left(), firstSampleColumn);
+        const int rightColumn = qMin(range.right(), lastSampleColumn);
+        for (int row = range.top(); row <= range.bottom() && leftColumn <= rightColumn; ++row) {
+            // columns are only moved by the view, so a row of the proxy is a single row of the source
+            const int sourceRow = proxyModel->mapToSource(proxyModel->index(row, leftColumn)).row();
+            const FeatureId featureId = model->getFeatureIdByRowNumber(sourceRow);
+            featureMzs[featureId] = model->getFeatureMzByRowNumber(sourceRow);
+            for (int column = leftColumn; column <= rightColumn; ++column) {
+                currentSelection.insert(model->getSampleIdByColumnNumber(column), featureId);
             }
-            currentSelection.insert(sampleId, featureId);
         }
     }
 
     emit featureSelectionChanged(currentSelection, featureMzs);
 }
 
+void AppView::featureTableNeighbourhoodChanged(const QModelIndexList &indexes)
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    FeatureTableModel *model = getFeatureTableModel();
+    Q_ASSERT(NULL != model);
+
+    QMultiHash<SampleId, FeatureId> features;
+    foreach (const QModelIndex &index, indexes) {
+        const QModelIndex sourceIndex = proxyModel->mapToSource(index);
+        if (sourceIndex.column() >= model->countOfGeneralDataColumns() + model->countOfSampleColumns()) {
+            continue; // statistics of the groups
+        }
+        if (0.0 == model->data(sourceIndex).toDouble()) {
+            continue; // the feature is not detected in the sample
+        }
+        features.insert(model->getSampleIdByColumnNumber(sourceIndex.column()), model->getFeatureIdByRowNumber(sourceIndex.row()));
+    }
+
+    if (!features.isEmpty()) {
+        emit featurePrefetchRequested(features);
+    }
+}
+
 void AppView::setShortcuts()
 {
     ui->actionOpen->setShortcut(QKeySequence::Open);
@@ -149,6 +295,22 @@ void AppView::initGraphView()
     webPage->mainFrame()->setHtml(html);
 }
 
+void AppView::initNativeGraphView(GraphDataController *graphDataController)
+{
+    nativeGraphView = new NativeGraphView(graphDataController);
+    nativeGraphView->setObjectName("nativeGraphView");
+    nativeGraphView->hide();
+    ui->mainSplitter->insertWidget(ui->mainSplitter->indexOf(ui->graphView) + 1, nativeGraphView);
+}
+
+void AppView::nativeChartsToggled(bool enabled)
+{
+    Q_ASSERT(NULL != nativeGraphView);
+    ui->graphView->setVisible(!enabled);
+    nativeGraphView->setVisible(enabled);
+    emit webGraphViewVisibilityChanged(!enabled);
+}
+
 void AppView::initFeatureTable(FeatureTableModel *model)
 {
     connect(model, &FeatureTableModel::setIndexWidget, this, &AppView::setFeatureTableIndexWidget);
@@ -156,13 +318,664 @@ void AppView::initFeatureTable(FeatureTableModel *model)
     FeatureTableProxyModel *proxyModel = new FeatureTableProxyModel(model);
     proxyModel->setSourceModel(model);
     proxyModel->setDynamicSortFilter(true);
-    connect(ui->filterEdit, &QLineEdit::textChanged, proxyModel, &FeatureTableProxyModel::setFilterFixedString);
+    connect(ui->filterEdit, &QLineEdit::textChanged, this, &AppView::filterTextChanged);
+    connect(ui->filterEdit, &QLineEdit::textEdited, this, &AppView::filterTextEdited);
+
+    // compound IDs and links starting with the typed text are offered while typing
+    QCompleter *completer = new QCompleter(new QStringListModel(this), this);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    ui->filterEdit->setCompleter(completer);
 
-    featureTableView = new FeatureTableWidget(proxyModel, model->countOfGeneralDataColumns(), ui->layoutWidget);
+    QSplitter *tableSplitter = new QSplitter(Qt::Horizontal, ui->layoutWidget);
+    featureTableView = new FeatureTableWidget(proxyModel, model->countOfGeneralDataColumns(), tableSplitter);
     featureTableView->setObjectName("featureTableView");
-    ui->verticalLayout->addWidget(featureTableView);
+    heatmapView = new HeatmapView(tableSplitter);
+    heatmapView->setObjectName("heatmapView");
+    heatmapView->hide();
+    tableSplitter->addWidget(featureTableView);
+    tableSplitter->addWidget(heatmapView);
+    tableSplitter->setStretchFactor(0, 3);
+    tableSplitter->setStretchFactor(1, 1);
+    ui->verticalLayout->addWidget(tableSplitter);
 
     connect(featureTableView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &AppView::featureTableSelectionChanged);
+    connect(featureTableView, &FeatureTableWidget::neighbourhoodChanged, this, &AppView::featureTableNeighbourhoodChanged);
+    connect(featureTableView->selectionModel(), &QItemSelectionModel::currentColumnChanged, this, &AppView::currentColumnChanged);
+
+    connect(proxyModel, &QAbstractItemModel::layoutChanged, &heatmapUpdateTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(proxyModel, &QAbstractItemModel::rowsInserted, &heatmapUpdateTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(proxyModel, &QAbstractItemModel::rowsRemoved, &heatmapUpdateTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(heatmapView, &HeatmapView::blockClicked, this, &AppView::heatmapBlockClicked);
+
+    featureTableView->setContextMenuPolicy(Qt::ActionsContextMenu);
+    featureTableView->addAction(ui->actionFindCorrelated);
+    featureTableView->addAction(ui->actionAddNeighbours);
+    featureTableView->addAction(ui->actionMostIntenseFeatures);
+}
+
+QVector<int> AppView::getDisplayedSourceRows() const
+{
+    const QAbstractProxyModel *proxyModel = dynamic_cast<const QAbstractProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const int rowCount = proxyModel->rowCount();
+    QVector<int> rows;
+    rows.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        rows.append(proxyModel->mapToSource(proxyModel->index(row, 0)).row());
+    }
+    return rows;
+}
+
+void AppView::heatmapToggled(bool enabled)
+{
+    Q_ASSERT(NULL != heatmapView);
+    heatmapView->setVisible(enabled);
+    if (enabled) {
+        heatmapView->setMatrix(getFeatureTableModel()->getFeatureMatrix(), getDisplayedSourceRows());
+    } else {
+        heatmapView->setMatrix(FeatureMatrix(), QVector<int>()); // the tiles take a lot of memory
+    }
+}
+
+void AppView::updateHeatmapRows()
+{
+    if (heatmapView->isVisible()) {
+        heatmapView->setRows(getDisplayedSourceRows());
+    }
+}
+
+void AppView::heatmapBlockClicked(int displayedRow, int sampleNumber)
+{
+    const QModelIndex index = featureTableView->model()->index(displayedRow,
+        getFeatureTableModel()->countOfGeneralDataColumns() + sampleNumber);
+    featureTableView->scrollTo(index, QAbstractItemView::PositionAtTop);
+    featureTableView->selectionModel()->setCurrentIndex(index, QItemSelectionModel::NoUpdate);
+}
+
+void AppView::sparklinesToggled(bool enabled)
+{
+    featureTableView->setSparklinesVisible(enabled);
+}
+
+void AppView::sparklinesReady()
+{
+    if (ui->actionSparklines->isChecked()) {
+        featureTableView->viewport()->update();
+    }
+}
+
+QStringList AppView::getSampleNames() const
+{
+    const FeatureTableModel *model = getFeatureTableModel();
+    const int firstSampleColumn = model->countOfGeneralDataColumns();
+    QStringList sampleNames;
+    for (int column = firstSampleColumn; column < firstSampleColumn + model->countOfSampleColumns(); ++column) {
+        sampleNames.append(model->headerData(column, Qt::Horizontal).toString());
+    }
+    return sampleNames;
+}
+
+void AppView::sampleStatisticsTriggered()
+{
+    SampleStatisticsDialog dialog(getFeatureTableModel()->getFeatureMatrix(), getSampleNames(), this);
+    dialog.exec();
+}
+
+void AppView::samplePcaTriggered()
+{
+    if (NULL == samplePcaView) {
+        samplePcaView = new SamplePcaView(this);
+        samplePcaView->setWindowFlags(Qt::Tool);
+        samplePcaView->resize(550, 500);
+        connect(samplePcaView, &SamplePcaView::sampleClicked, this, &AppView::pcaSampleClicked);
+    }
+    updateSamplePca();
+    samplePcaView->show();
+    samplePcaView->raise();
+}
+
+void AppView::updateSamplePca()
+{
+    const FeatureTableModel *model = getFeatureTableModel();
+    samplePcaView->setData(model->getFeatureMatrix(), model->getNormalization(), getSampleNames(), model->getSampleTypes());
+}
+
+void AppView::pcaSampleClicked(int sampleNumber)
+{
+    // the current feature stays, the table scrolls to the sample
+    const QModelIndex currentIndex = featureTableView->currentIndex();
+    const QModelIndex index = featureTableView->model()->index(currentIndex.isValid() ? currentIndex.row() : 0,
+        getFeatureTableModel()->countOfGeneralDataColumns() + sampleNumber);
+    featureTableView->scrollTo(index);
+    featureTableView->selectionModel()->setCurrentIndex(index, QItemSelectionModel::NoUpdate);
+}
+
+void AppView::normalizationTriggered(QAction *action)
+{
+    FeatureTableModel *model = getFeatureTableModel();
+    const IntensityNormalization::Mode mode = static_cast<IntensityNormalization::Mode>(action->data().toInt());
+
+    int standardRow = -1;
+    if (IntensityNormalization::INTERNAL_STANDARD_NORMALIZATION == mode) {
+        const QAbstractProxyModel *proxyModel = dynamic_cast<const QAbstractProxyModel *>(featureTableView->model());
+        Q_ASSERT(NULL != proxyModel);
+        standardRow = proxyModel->mapToSource(featureTableView->currentIndex()).row();
+        if (-1 == standardRow) {
+            QMessageBox::warning(this, tr("Warning"), tr("Please, click a cell of the internal standard feature first."));
+            // the previous mode stays active
+            foreach (QAction *modeAction, normalizationActions->actions()) {
+                modeAction->setChecked(modeAction->data().toInt() == model->getNormalization().getMode());
+            }
+            return;
+        }
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    model->setNormalization(IntensityNormalization::create(model->getFeatureMatrix(), mode, standardRow));
+    updateCorrelatedFeaturesMatrix();
+    if (NULL != samplePcaView && samplePcaView->isVisible()) {
+        updateSamplePca();
+    }
+    if (filterExpression.dependsOnIntensities()) {
+        setFilterExpression(filterExpression);
+    }
+    QApplication::restoreOverrideCursor();
+
+    const DifferentialStatistics statistics = model->getDifferentialStatistics();
+    if (!statistics.isEmpty()) {
+        // groups are compared by normalized intensities, so the old comparison is dropped even if the new one is canceled
+        setDifferentialStatistics(DifferentialStatistics());
+        startGroupComparison(statistics.getFirstGroup(), statistics.getSecondGroup(), statistics.getFirstGroupName(),
+            statistics.getSecondGroupName());
+    }
+}
+
+void AppView::compareGroupsTriggered()
+{
+    FeatureTableModel *model = getFeatureTableModel();
+    const QStringList sampleTypes = model->getSampleTypes();
+    if (sampleTypes.count(QString()) == sampleTypes.size()) {
+        QMessageBox::information(this, tr("Compare Sample Groups"), tr("Types of samples aren't set in this database."));
+        return;
+    }
+    GroupComparisonDialog dialog(sampleTypes, this);
+    if (QDialog::Accepted != dialog.exec()) {
+        return;
+    }
+    startGroupComparison(dialog.getFirstGroup(), dialog.getSecondGroup(), dialog.getFirstGroupName(),
+        dialog.getSecondGroupName());
+}
+
+void AppView::startGroupComparison(const QVector<int> &firstGroup, const QVector<int> &secondGroup,
+    const QString &firstGroupName, const QString &secondGroupName)
+{
+    if (isComputing()) {
+        return;
+    }
+    const FeatureTableModel *model = getFeatureTableModel();
+    const FeatureMatrix matrix = model->getFeatureMatrix();
+    const IntensityNormalization normalization = model->getNormalization();
+    const FeatureMatrixUtils::ProgressCallback progress = getComputationProgressCallback();
+    startComputation(tr("Comparing sample groups..."));
+    comparisonWatcher.setFuture(QtConcurrent::run([=] () {
+        return DifferentialStatistics::compute(matrix, normalization, firstGroup, secondGroup, firstGroupName,
+            secondGroupName, progress);
+    }));
+}
+
+void AppView::groupComparisonFinished()
+{
+    computationIndicator.finished();
+    if (cancelRequested.load()) {
+        return;
+    }
+    setDifferentialStatistics(comparisonWatcher.result());
+    volcanoPlotView->show();
+    volcanoPlotView->raise();
+}
+
+void AppView::clearGroupComparisonTriggered()
+{
+    setDifferentialStatistics(DifferentialStatistics());
+}
+
+void AppView::setDifferentialStatistics(const DifferentialStatistics &statistics)
+{
+    getFeatureTableModel()->setDifferentialStatistics(statistics);
+    ui->actionClearGroupComparison->setEnabled(!statistics.isEmpty());
+
+    if (NULL == volcanoPlotView) {
+        volcanoPlotView = new VolcanoPlotView(this);
+        volcanoPlotView->setWindowFlags(Qt::Tool);
+        volcanoPlotView->resize(600, 450);
+        connect(volcanoPlotView, &VolcanoPlotView::featureClicked, this, &AppView::volcanoFeatureClicked);
+    }
+    volcanoPlotView->setStatistics(statistics);
+    if (statistics.isEmpty()) {
+        volcanoPlotView->hide();
+    }
+}
+
+void AppView::volcanoFeatureClicked(int row)
+{
+    FeatureTableModel *model = getFeatureTableModel();
+    showSourceIndex(row, model->countOfGeneralDataColumns() + model->countOfSampleColumns()
+        + DifferentialStatistics::LOG2_FOLD_CHANGE_COLUMN);
+}
+
+void AppView::showSourceIndex(int row, int column)
+{
+    const QAbstractProxyModel *proxyModel = dynamic_cast<const QAbstractProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const QModelIndex index = proxyModel->mapFromSource(getFeatureTableModel()->index(row, column));
+    if (!index.isValid()) {
+        return; // filtered out
+    }
+    featureTableView->scrollTo(index, QAbstractItemView::PositionAtCenter);
+    featureTableView->selectionModel()->setCurrentIndex(index, QItemSelectionModel::NoUpdate);
+}
+
+void AppView::findCorrelatedTriggered()
+{
+    const QAbstractProxyModel *proxyModel = dynamic_cast<const QAbstractProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const int row = proxyModel->mapToSource(featureTableView->currentIndex()).row();
+    if (-1 == row) {
+        QMessageBox::warning(this, tr("Warning"), tr("Please, click a cell of the feature first."));
+        return;
+    }
+
+    if (NULL == correlatedFeaturesView) {
+        correlatedFeaturesView = new CorrelatedFeaturesView(this);
+        correlatedFeaturesView->setWindowFlags(Qt::Tool);
+        correlatedFeaturesView->resize(500, 450);
+        connect(correlatedFeaturesView, &CorrelatedFeaturesView::featureClicked, this, &AppView::correlatedFeatureClicked);
+        updateCorrelatedFeaturesMatrix();
+    }
+    correlatedFeaturesView->search(row);
+    correlatedFeaturesView->show();
+    correlatedFeaturesView->raise();
+}
+
+void AppView::correlatedFeatureClicked(int row)
+{
+    showSourceIndex(row, 0);
+}
+
+void AppView::addNeighboursTriggered()
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    FeatureTableModel *model = getFeatureTableModel();
+    const QModelIndex currentIndex = proxyModel->mapToSource(featureTableView->currentIndex());
+    const int sampleNumber = currentIndex.column() - model->countOfGeneralDataColumns();
+    const FeatureMatrix &matrix = model->getFeatureMatrix();
+    const bool isSampleCell = currentIndex.isValid() && 0 <= sampleNumber && sampleNumber < model->countOfSampleColumns();
+    if (!isSampleCell || !matrix.hasIntensity(currentIndex.row(), sampleNumber)) {
+        QMessageBox::warning(this, tr("Warning"), tr("Please, click a non-zero intensity of the feature first."));
+        return;
+    }
+
+    if (!requireMassTraceIndex(ui->actionAddNeighbours)) {
+        return;
+    }
+    const MassTraceIndex &traceIndex = model->getMassTraceIndex();
+    if (traceIndex.isEmpty()) {
+        QMessageBox::information(this, tr("Information"), tr("No mass traces of features are stored in the database."));
+        return;
+    }
+    TraceBounds featureBounds;
+    if (!traceIndex.getFeatureBounds(currentIndex.row(), sampleNumber, featureBounds)) {
+        QMessageBox::information(this, tr("Information"), tr("No mass traces of the feature are stored in the database for this sample."));
+        return;
+    }
+    NeighbourFeaturesDialog dialog(this);
+    if (QDialog::Accepted != dialog.exec()) {
+        return;
+    }
+
+    QVector<int> neighbourRows;
+    foreach (int row, traceIndex.findRows(sampleNumber, dialog.getWindow(featureBounds))) {
+        if (currentIndex.row() != row) {
+            neighbourRows.append(row);
+        }
+    }
+    if (neighbourRows.isEmpty()) {
+        QMessageBox::information(this, tr("Information"), tr("No other features were found in the window."));
+        return;
+    }
+
+    // features eluting closest to the given one are plotted first
+    const qreal rt = matrix.getConsensusRt(currentIndex.row());
+    std::sort(neighbourRows.begin(), neighbourRows.end(), [&matrix, rt] (int left, int right) {
+        return qAbs(matrix.getConsensusRt(left) - rt) < qAbs(matrix.getConsensusRt(right) - rt);
+    });
+    neighbourRows.resize(qMin(neighbourRows.size(), MAX_NEIGHBOUR_COUNT));
+
+    // cells are selected as if the user clicked them, features hidden by the filter are skipped
+    QItemSelection selection;
+    foreach (int row, neighbourRows) {
+        const QModelIndex index = proxyModel->mapFromSource(model->index(row, currentIndex.column()));
+        if (index.isValid()) {
+            selection.select(index, index);
+        }
+    }
+    featureTableView->selectionModel()->select(selection, QItemSelectionModel::Select);
+}
+
+bool AppView::requireMassTraceIndex(QAction *requester)
+{
+    FeatureTableModel *model = getFeatureTableModel();
+    if (model->isMassTraceIndexBuilt()) {
+        return true;
+    }
+    if (!model->hasMassTraces()) {
+        model->setMassTraceIndex(MassTraceIndex()); // there's nothing to read
+        return true;
+    }
+    if (isComputing()) {
+        return false;
+    }
+
+    const DataSourceId dataSourceId = model->getDataSourceId();
+    const FeatureMatrix matrix = model->getFeatureMatrix();
+    const QVector<SampleId> sampleIds = model->getSampleIds();
+    const FeatureMatrixUtils::ProgressCallback progress = getComputationProgressCallback();
+    traceIndexRequester = requester;
+    startComputation(tr("Indexing mass traces..."));
+    traceIndexWatcher.setFuture(QtConcurrent::run([=] () {
+        return MassTraceIndex::build(dataSourceId, matrix, sampleIds, progress);
+    }));
+    return false;
+}
+
+void AppView::massTraceIndexFinished()
+{
+    computationIndicator.finished();
+    if (cancelRequested.load()) {
+        return;
+    }
+    FeatureTableModel *model = getFeatureTableModel();
+    model->setMassTraceIndex(traceIndexWatcher.result());
+    traceIndexRequester->trigger();
+    // the table may have no traces of known features, which is found out only by the build
+    ui->actionAddNeighbours->setEnabled(model->hasMassTraces());
+}
+
+void AppView::rangeFilterTriggered()
+{
+    RangeFilterDialog dialog(this);
+    if (QDialog::Accepted != dialog.exec()) {
+        return;
+    }
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const FeatureMatrix &matrix = getFeatureTableModel()->getFeatureMatrix();
+
+    // the window is looked up in sorted consensus values, so cells aren't read
+    QBitArray acceptedRows(matrix.getRowCount());
+    foreach (int row, matrix.findRows(dialog.getMzMin(), dialog.getMzMax(), dialog.getRtMin(), dialog.getRtMax())) {
+        acceptedRows.setBit(row);
+    }
+    proxyModel->setRowFilter(FeatureTableProxyModel::RANGE_FILTER, acceptedRows);
+    ui->actionClearRangeFilter->setEnabled(true);
+}
+
+void AppView::clearRangeFilterTriggered()
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    if (proxyModel->hasRowFilter(FeatureTableProxyModel::RANGE_FILTER)) {
+        proxyModel->setRowFilter(FeatureTableProxyModel::RANGE_FILTER, QBitArray());
+    }
+    ui->actionClearRangeFilter->setEnabled(false);
+}
+
+void AppView::filterExpressionTriggered()
+{
+    FilterExpressionDialog dialog(getSampleNames(), filterExpression.getText(), this);
+    if (QDialog::Accepted != dialog.exec()) {
+        return;
+    }
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    setFilterExpression(dialog.getExpression());
+    QApplication::restoreOverrideCursor();
+}
+
+void AppView::clearFilterExpressionTriggered()
+{
+    setFilterExpression(FilterExpression());
+}
+
+void AppView::setFilterExpression(const FilterExpression &expression)
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    filterExpression = expression;
+    if (!expression.isEmpty()) {
+        const FeatureTableModel *model = getFeatureTableModel();
+        proxyModel->setRowFilter(FeatureTableProxyModel::EXPRESSION_FILTER,
+            expression.evaluate(model->getFeatureMatrix(), model->getNormalization()));
+    } else if (proxyModel->hasRowFilter(FeatureTableProxyModel::EXPRESSION_FILTER)) {
+        proxyModel->setRowFilter(FeatureTableProxyModel::EXPRESSION_FILTER, QBitArray());
+    }
+    ui->actionClearFilterExpression->setEnabled(!expression.isEmpty());
+}
+
+void AppView::mostIntenseFeaturesToggled(bool enabled)
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const FeatureTableModel *model = getFeatureTableModel();
+    if (!enabled) {
+        // the order of clustering comes back unless the user has sorted the table in the meantime
+        const bool isSortedByMode = -1 != mostIntenseSampleNumber && Qt::DescendingOrder == proxyModel->sortOrder()
+            && model->countOfGeneralDataColumns() + mostIntenseSampleNumber == proxyModel->sortColumn();
+        mostIntenseSampleNumber = -1;
+        if (proxyModel->hasRowFilter(FeatureTableProxyModel::MOST_INTENSE_FILTER)) {
+            proxyModel->setRowFilter(FeatureTableProxyModel::MOST_INTENSE_FILTER, QBitArray());
+        }
+        if (isSortedByMode && !rowOrderBeforeMostIntense.isEmpty()) {
+            featureTableView->clearSortIndicator();
+            proxyModel->setRowOrder(rowOrderBeforeMostIntense);
+        }
+        rowOrderBeforeMostIntense.clear();
+        return;
+    }
+
+    const int sampleNumber = proxyModel->mapToSource(featureTableView->currentIndex()).column() - model->countOfGeneralDataColumns();
+    if (sampleNumber < 0 || sampleNumber >= model->countOfSampleColumns()) {
+        QMessageBox::warning(this, tr("Warning"), tr("Please, click a cell of the sample first."));
+        ui->actionMostIntenseFeatures->setChecked(false);
+        return;
+    }
+    bool ok = false;
+    const int count = QInputDialog::getInt(this, tr("Most Intense Features"), tr("Number of features:"),
+        mostIntenseFeatureCount, 1, qMax(1, model->rowCount()), 1, &ok);
+    if (!ok) {
+        ui->actionMostIntenseFeatures->setChecked(false);
+        return;
+    }
+    mostIntenseFeatureCount = count;
+    showMostIntenseFeatures(sampleNumber);
+}
+
+void AppView::currentColumnChanged(const QModelIndex &current)
+{
+    // the features follow the sample of the current cell
+    if (-1 == mostIntenseSampleNumber) {
+        return;
+    }
+    const QAbstractProxyModel *proxyModel = dynamic_cast<const QAbstractProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const FeatureTableModel *model = getFeatureTableModel();
+    const int sampleNumber = proxyModel->mapToSource(current).column() - model->countOfGeneralDataColumns();
+    if (0 <= sampleNumber && sampleNumber < model->countOfSampleColumns() && sampleNumber != mostIntenseSampleNumber) {
+        showMostIntenseFeatures(sampleNumber);
+    }
+}
+
+void AppView::showMostIntenseFeatures(int sampleNumber)
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const FeatureTableModel *model = getFeatureTableModel();
+    mostIntenseSampleNumber = sampleNumber;
+
+    // rows are selected from the sample without sorting the table, only the displayed ones are sorted then
+    QBitArray mostIntenseRows(model->rowCount());
+    foreach (int row, model->getFeatureMatrix().findMostIntenseRows(sampleNumber, mostIntenseFeatureCount)) {
+        mostIntenseRows.setBit(row);
+    }
+    proxyModel->setRowFilter(FeatureTableProxyModel::MOST_INTENSE_FILTER, mostIntenseRows);
+    if (proxyModel->hasRowOrder()) {
+        rowOrderBeforeMostIntense = proxyModel->getRowOrder(); // sorting drops it
+    }
+    featureTableView->sortByColumn(model->countOfGeneralDataColumns() + sampleNumber, Qt::DescendingOrder);
+}
+
+void AppView::updateCorrelatedFeaturesMatrix()
+{
+    if (NULL != correlatedFeaturesView) {
+        const FeatureTableModel *model = getFeatureTableModel();
+        correlatedFeaturesView->setMatrix(model->getFeatureMatrix(), model->getNormalization());
+    }
+}
+
+void AppView::clusterTableTriggered()
+{
+    ClusteringDialog dialog(this);
+    if (QDialog::Accepted != dialog.exec()) {
+        return;
+    }
+    const FeatureTableModel *model = getFeatureTableModel();
+    clusteringController->cluster(model->getFeatureMatrix(), model->getNormalization(), dialog.isFeatureClustering(),
+        dialog.isSampleClustering(), dialog.getDistance(), dialog.getLinkage());
+}
+
+void AppView::featureOrderReady(const QVector<int> &rows)
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    featureTableView->clearSortIndicator();
+    proxyModel->setRowOrder(rows);
+    rowOrderBeforeMostIntense.clear();
+    ui->actionRestoreTableOrder->setEnabled(true);
+}
+
+void AppView::sampleOrderReady(const QVector<int> &sampleNumbers)
+{
+    const int firstSampleColumn = getFeatureTableModel()->countOfGeneralDataColumns();
+    QVector<int> columns;
+    foreach (int sampleNumber, sampleNumbers) {
+        columns.append(firstSampleColumn + sampleNumber);
+    }
+    featureTableView->placeColumns(columns, firstSampleColumn);
+    ui->actionRestoreTableOrder->setEnabled(true);
+}
+
+void AppView::restoreTableOrderTriggered()
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    if (proxyModel->hasRowOrder()) {
+        proxyModel->setRowOrder(QVector<int>());
+    }
+    rowOrderBeforeMostIntense.clear();
+    featureTableView->resetColumnOrder();
+    ui->actionRestoreTableOrder->setEnabled(false);
+}
+
+void AppView::groupFeaturesTriggered()
+{
+    // bounds of traces are compared if the database has them
+    if (!requireMassTraceIndex(ui->actionGroupFeatures)) {
+        return;
+    }
+    FeatureGroupingDialog dialog(this);
+    if (QDialog::Accepted != dialog.exec() || isComputing()) {
+        return;
+    }
+    const FeatureTableModel *model = getFeatureTableModel();
+    const FeatureMatrix matrix = model->getFeatureMatrix();
+    const MassTraceIndex traceIndex = model->getMassTraceIndex();
+    const FeatureGroups::Polarity polarity = dialog.getPolarity();
+    const qreal mzTolerancePpm = dialog.getMzTolerancePpm();
+    const qreal rtTolerance = dialog.getRtTolerance();
+    const qreal minCorrelation = dialog.getMinCorrelation();
+    const FeatureMatrixUtils::ProgressCallback progress = getComputationProgressCallback();
+    startComputation(tr("Grouping isotopes and adducts..."));
+    groupingWatcher.setFuture(QtConcurrent::run([=] () {
+        return FeatureGroups::compute(matrix, traceIndex, polarity, mzTolerancePpm, rtTolerance, minCorrelation, progress);
+    }));
+}
+
+void AppView::featureGroupingFinished()
+{
+    computationIndicator.finished();
+    if (cancelRequested.load()) {
+        return;
+    }
+    setFeatureGroups(groupingWatcher.result());
+}
+
+void AppView::setFeatureGroups(const FeatureGroups &groups)
+{
+    getFeatureTableModel()->setFeatureGroups(groups);
+    ui->actionShowMainFeatures->setEnabled(!groups.isEmpty());
+    ui->actionClearFeatureGroups->setEnabled(!groups.isEmpty());
+    if (groups.isEmpty()) {
+        ui->actionShowMainFeatures->setChecked(false);
+    } else if (ui->actionShowMainFeatures->isChecked()) {
+        mainFeaturesToggled(true); // main features of the new groups
+    }
+}
+
+void AppView::mainFeaturesToggled(bool enabled)
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const FeatureGroups &groups = getFeatureTableModel()->getFeatureGroups();
+    QBitArray mainRows;
+    if (enabled && !groups.isEmpty()) {
+        const int rowCount = getFeatureTableModel()->rowCount();
+        mainRows.resize(rowCount);
+        for (int row = 0; row < rowCount; ++row) {
+            mainRows.setBit(row, groups.isMainFeature(row));
+        }
+    }
+    proxyModel->setRowFilter(FeatureTableProxyModel::FEATURE_GROUP_FILTER, mainRows);
+}
+
+void AppView::clearFeatureGroupsTriggered()
+{
+    setFeatureGroups(FeatureGroups());
+}
+
+bool AppView::isComputing() const
+{
+    return comparisonWatcher.isRunning() || traceIndexWatcher.isRunning() || groupingWatcher.isRunning();
+}
+
+void AppView::startComputation(const QString &title)
+{
+    cancelRequested.store(0);
+    computationIndicator.setWindowTitle(title);
+    computationIndicator.started();
+}
+
+FeatureMatrixUtils::ProgressCallback AppView::getComputationProgressCallback()
+{
+    // the window waits for running computations when it's destroyed
+    return [this] (int percents) {
+        emit computationProgress(percents);
+        return !cancelRequested.load();
+    };
+}
+
+void AppView::cancelComputation()
+{
+    cancelRequested.store(1);
 }
 
 FeatureTableModel * AppView::getFeatureTableModel() const
@@ -176,13 +989,59 @@ FeatureTableModel * AppView::getFeatureTableModel() const
 
 void AppView::samplesChanged()
 {
+    // the selection model is cleared silently on model reset
+    selectionUpdateTimer.stop();
+    emittedSelection.clear();
+
+    // the matrix is already replaced, so the proxy drops its row orders and filters itself when the model is reset;
+    // actions are updated only then, so that the old rows aren't filtered or sorted against the new matrix
     FeatureTableModel *model = getFeatureTableModel();
     model->reset();
+
+    // orders, filters and results of computations of the previous database don't fit the new one
+    cancelComputation();
+    clusteringController->clear();
+    restoreTableOrderTriggered();
+    ui->actionShowMainFeatures->setChecked(false);
+    clearRangeFilterTriggered();
+    clearFilterExpressionTriggered(); // samples may be named differently
+    ui->actionMostIntenseFeatures->setChecked(false);
     if (QSqlError::NoError != model->lastError().type()) {
         QMessageBox::critical(this, tr("Error"), model->lastError().text());
     } else {
         featureTableView->resetColumnHiddenState();
+        if (!ui->filterEdit->text().isEmpty()) {
+            filterTextChanged(ui->filterEdit->text()); // annotations of the new features
+        }
         ui->actionExportToCsv->setEnabled(true);
+        ui->actionSampleStatistics->setEnabled(true);
+        ui->actionSamplePca->setEnabled(true);
+        ui->menuNormalization->setEnabled(true);
+        ui->actionNoNormalization->setChecked(true); // the model drops normalization and comparison on reset
+        ui->actionCompareGroups->setEnabled(true);
+        ui->actionClearGroupComparison->setEnabled(false);
+        ui->actionFindCorrelated->setEnabled(true);
+        ui->actionAddNeighbours->setEnabled(model->hasMassTraces());
+        ui->actionRangeFilter->setEnabled(true);
+        ui->actionFilterExpression->setEnabled(true);
+        ui->actionMostIntenseFeatures->setEnabled(true);
+        ui->actionClusterTable->setEnabled(true);
+        ui->actionGroupFeatures->setEnabled(true);
+        ui->actionShowMainFeatures->setEnabled(false); // the model drops groups on reset
+        ui->actionClearFeatureGroups->setEnabled(false);
+        if (NULL != volcanoPlotView) {
+            volcanoPlotView->hide();
+        }
+        if (NULL != correlatedFeaturesView) {
+            correlatedFeaturesView->hide();
+        }
+        if (NULL != samplePcaView) {
+            samplePcaView->hide();
+        }
+        updateCorrelatedFeaturesMatrix();
+        if (heatmapView->isVisible()) {
+            heatmapView->setMatrix(model->getFeatureMatrix(), getDisplayedSourceRows());
+        }
     }
 }
 
@@ -191,6 +1050,41 @@ void AppView::filterTableTriggered()
     ui->filterEdit->setFocus(Qt::MouseFocusReason);
 }
 
+void AppView::filterTextChanged(const QString &text)
+{
+    FeatureTableProxyModel *proxyModel = dynamic_cast<FeatureTableProxyModel *>(featureTableView->model());
+    Q_ASSERT(NULL != proxyModel);
+    const FeatureTableModel *model = getFeatureTableModel();
+
+    // annotations are looked up in the index, so that cells with links aren't created for every row
+    QBitArray annotationMatches;
+    if (!text.isEmpty()) {
+        const FeatureMatrix &matrix = model->getFeatureMatrix();
+        annotationMatches.resize(matrix.getRowCount());
+        foreach (int row, model->getAnnotationIndex().findRows(text, AnnotationIndex::SUBSTRING_MATCH)) {
+            annotationMatches.setBit(row);
+        }
+        if (FeatureTableModel::tr("N/A").contains(text, Qt::CaseInsensitive)) {
+            for (int row = 0; row < matrix.getRowCount(); ++row) {
+                if (matrix.getCompoundIds(row).isEmpty()) {
+                    annotationMatches.setBit(row);
+                }
+            }
+        }
+    }
+    proxyModel->setAnnotationMatches(model->getAnnotationColumn(), annotationMatches);
+    proxyModel->setFilterFixedString(text);
+}
+
+void AppView::filterTextEdited(const QString &text)
+{
+    // the line edit updates the completion popup right after this signal
+    QStringListModel *completionModel = qobject_cast<QStringListModel *>(ui->filterEdit->completer()->model());
+    Q_ASSERT(NULL != completionModel);
+    completionModel->setStringList(text.size() < MIN_COMPLETION_PREFIX_LENGTH
+        ? QStringList() : getFeatureTableModel()->getAnnotationIndex().findTerms(text, MAX_COMPLETION_COUNT));
+}
+
 void AppView::graphViewLoaded(bool ok)
 {
     disconnect(ui->graphView, &QWebView::loadFinished, this, &AppView::graphViewLoaded);
@@ -1,13 +1,23 @@
 #ifndef APPVIEW_H
 #define APPVIEW_H
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QItemSelection>
 #include <QMainWindow>
 #include <QMap>
+#include <QTimer>
 
+#include "DifferentialStatistics.h"
+#include "FeatureGroups.h"
+#include "FilterExpression.h"
 #include "Globals.h"
+#include "MassTraceIndex.h"
+#include "ProgressIndicator.h"
 
 class QAbstractItemModel;
 class QAction;
+class QActionGroup;
 class QItemSelection;
 class QWebView;
 
@@ -19,8 +29,15 @@ class AppViewUi;
 
 namespace ov {
 
+class ClusteringController;
+class CorrelatedFeaturesView;
 class FeatureTableModel;
 class FeatureTableWidget;
+class GraphDataController;
+class HeatmapView;
+class NativeGraphView;
+class SamplePcaView;
+class VolcanoPlotView;
 
 class AppView : public QMainWindow
 {
@@ -30,7 +47,7 @@ public:
     explicit AppView(QWidget *parent = NULL);
     ~AppView();
 
-    void initViews(FeatureTableModel *model);
+    void initViews(FeatureTableModel *model, GraphDataController *graphDataController);
     const QAbstractItemModel * getTableModel() const;
 
 signals:
@@ -39,34 +56,113 @@ signals:
     void exportToCsv(const QVector<int> &visibleColumns);
 
     void graphViewAboutToLoad(QWebView *view);
+    void webGraphViewVisibilityChanged(bool visible);
     void featureSelectionChanged(const QMultiHash<SampleId, FeatureId> &newSelection, const QMap<FeatureId, qreal> &featureMzs);
+    void featurePrefetchRequested(const QMultiHash<SampleId, FeatureId> &features);
+    void computationProgress(int percents);
 
 public slots:
     void samplesChanged();
     void resetSelection();
     void setFeatureTableIndexWidget(const QModelIndex &index, QWidget *w);
+    void sparklinesReady();
 
 private slots:
     void graphViewLoaded(bool ok);
-    void featureTableSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected);
+    void featureTableSelectionChanged();
+    void emitFeatureSelection();
+    void featureTableNeighbourhoodChanged(const QModelIndexList &indexes);
     void exportToCsvTriggered();
     void aboutTriggered();
     void filterTableTriggered();
+    void filterTextChanged(const QString &text);
+    void filterTextEdited(const QString &text);
+    void nativeChartsToggled(bool enabled);
+    void heatmapToggled(bool enabled);
+    void updateHeatmapRows();
+    void heatmapBlockClicked(int displayedRow, int sampleNumber);
+    void sparklinesToggled(bool enabled);
+    void sampleStatisticsTriggered();
+    void samplePcaTriggered();
+    void pcaSampleClicked(int sampleNumber);
+    void normalizationTriggered(QAction *action);
+    void compareGroupsTriggered();
+    void groupComparisonFinished();
+    void clearGroupComparisonTriggered();
+    void volcanoFeatureClicked(int row);
+    void findCorrelatedTriggered();
+    void correlatedFeatureClicked(int row);
+    void addNeighboursTriggered();
+    void massTraceIndexFinished();
+    void rangeFilterTriggered();
+    void clearRangeFilterTriggered();
+    void filterExpressionTriggered();
+    void clearFilterExpressionTriggered();
+    void mostIntenseFeaturesToggled(bool enabled);
+    void currentColumnChanged(const QModelIndex &current);
+    void clusterTableTriggered();
+    void restoreTableOrderTriggered();
+    void featureOrderReady(const QVector<int> &rows);
+    void sampleOrderReady(const QVector<int> &sampleNumbers);
+    void groupFeaturesTriggered();
+    void featureGroupingFinished();
+    void mainFeaturesToggled(bool enabled);
+    void clearFeatureGroupsTriggered();
+    void cancelComputation();
 
 private:
     void setDefaultSplitterSize();
     void initGraphView();
+    void initNativeGraphView(GraphDataController *graphDataController);
     void initFeatureTable(FeatureTableModel *model);
     void initActions();
     void connectGuiSignals();
     void setShortcuts();
     FeatureTableModel * getFeatureTableModel() const;
+    QVector<int> getDisplayedSourceRows() const;
+    bool isComputing() const;
+    void startComputation(const QString &title);
+    FeatureMatrixUtils::ProgressCallback getComputationProgressCallback();
+    void startGroupComparison(const QVector<int> &firstGroup, const QVector<int> &secondGroup, const QString &firstGroupName,
+        const QString &secondGroupName);
+    void setDifferentialStatistics(const DifferentialStatistics &statistics);
+    bool requireMassTraceIndex(QAction *requester); // false while it is being built, @requester is triggered again then
+    void setFeatureGroups(const FeatureGroups &groups);
+    void showSourceIndex(int row, int column);
+    void updateCorrelatedFeaturesMatrix();
+    QStringList getSampleNames() const;
+    void updateSamplePca();
+    void setFilterExpression(const FilterExpression &expression);
+    void showMostIntenseFeatures(int sampleNumber);
 
     bool graphViewInited;
     QAction *filterTableAction;
+    QActionGroup *normalizationActions;
 
     FeatureTableWidget *featureTableView;
+    NativeGraphView *nativeGraphView;
+    HeatmapView *heatmapView;
+    VolcanoPlotView *volcanoPlotView;
+    CorrelatedFeaturesView *correlatedFeaturesView;
+    SamplePcaView *samplePcaView;
+    ClusteringController *clusteringController;
     Ui::AppViewUi *ui;
+
+    QItemSelection emittedSelection; // ranges of the proxy model the plots were last updated with
+    QTimer selectionUpdateTimer;
+    QTimer heatmapUpdateTimer;
+    FilterExpression filterExpression;
+    int mostIntenseFeatureCount;
+    int mostIntenseSampleNumber; // -1 unless only the most intense features are shown
+    QVector<int> rowOrderBeforeMostIntense; // of clustering, restored when all features are shown again
+
+    // computations over the whole table run one at a time on worker threads behind a modal progress dialog
+    ProgressIndicator computationIndicator;
+    QAtomicInt cancelRequested; // also set when another database is opened, results of the old one are dropped
+    QFutureWatcher<DifferentialStatistics> comparisonWatcher;
+    QFutureWatcher<MassTraceIndex> traceIndexWatcher;
+    QFutureWatcher<FeatureGroups> groupingWatcher;
+    QAction *traceIndexRequester; // triggered again once the index is built
 };
 
 } // namespace ov
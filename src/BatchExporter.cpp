@@ -0,0 +1,320 @@
+#include <limits>
+
+#include <QDir>
+#include <QImage>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSvgGenerator>
+
+#include "ChartRenderer.h"
+#include "FeatureMatrix.h"
+
+#include "BatchExporter.h"
+
+const int FEATURES_PER_CHUNK = 100; // features of a chunk are read from the database by the same queries
+const qreal XIC_PEAK_ZOOM_OFFSET = 7.5;
+const int PDF_RESOLUTION = 96; // dpi, image size is given in pixels
+
+namespace ov {
+
+BatchExportSettings::BatchExportSettings()
+    : dataEnabled(true), layout(CsvWritingUtils::LONG_GRAPH_TABLE), imagesEnabled(true), imageFormat("PNG"),
+    imageSize(1200, 600), shardNumber(0), shardCount(1)
+{
+
+}
+
+BatchExporter::BatchExporter(const BatchExportSettings &settings)
+    : settings(settings)
+{
+
+}
+
+QStringList BatchExporter::getSupportedImageFormats()
+{
+    return QStringList() << "PNG" << "JPG" << "BMP" << "SVG" << "PDF";
+}
+
+bool BatchExporter::run(QString &errorMessage)
+{
+    if (!dataSource.openDataSource(settings.dataSourceId, errorMessage)) {
+        return false;
+    }
+    if (!QDir().mkpath(settings.outputDir)) {
+        errorMessage = tr("Unable to create directory: %1").arg(settings.outputDir);
+        return false;
+    }
+
+    SamplesByFeature samplesByFeature;
+    const bool collected = settings.query.isEmpty() ? collectFeatures(samplesByFeature, errorMessage)
+        : collectFeaturesByQuery(samplesByFeature, errorMessage);
+    return collected && exportFeatures(samplesByFeature, errorMessage);
+}
+
+bool BatchExporter::collectFeatures(SamplesByFeature &samplesByFeature, QString &errorMessage)
+{
+    const FeatureMatrix &matrix = dataSource.getFeatureMatrix();
+
+    QList<int> sampleNumbers;
+    for (int i = 0; i < dataSource.getSampleCount(); ++i) {
+        if (settings.sampleIds.isEmpty() || settings.sampleIds.contains(dataSource.getSampleIdByNumber(i))) {
+            sampleNumbers.append(i);
+        }
+    }
+    if (sampleNumbers.size() < settings.sampleIds.size()) {
+        errorMessage = tr("Some of the requested samples aren't present in the database.");
+        return false;
+    }
+
+    QList<int> rows;
+    if (settings.featureIds.isEmpty()) {
+        for (int row = 0; row < matrix.getRowCount(); ++row) {
+            rows.append(row);
+        }
+    } else {
+        foreach (const FeatureId &featureId, settings.featureIds) {
+            const int row = matrix.findRow(featureId);
+            if (-1 == row) {
+                errorMessage = tr("Feature %1 isn't present in the database.").arg(featureId);
+                return false;
+            }
+            rows.append(row);
+        }
+    }
+
+    foreach (int row, rows) {
+        QList<SampleId> featureSamples;
+        foreach (int sampleNumber, sampleNumbers) {
+            if (matrix.hasIntensity(row, sampleNumber)) {
+                featureSamples.append(dataSource.getSampleIdByNumber(sampleNumber));
+            }
+        }
+        if (!featureSamples.isEmpty()) {
+            samplesByFeature[matrix.getFeatureId(row)] = featureSamples;
+        }
+    }
+    return true;
+}
+
+bool BatchExporter::collectFeaturesByQuery(SamplesByFeature &samplesByFeature, QString &errorMessage)
+{
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    if (!query.exec(settings.query)) {
+        errorMessage = tr("Unable to execute the query: %1").arg(query.lastError().text());
+        return false;
+    }
+    while (query.next()) {
+        const SampleId sampleId = query.value(0).value<SampleId>();
+        const FeatureId featureId = query.value(1).value<FeatureId>();
+        if (!samplesByFeature[featureId].contains(sampleId)) {
+            samplesByFeature[featureId].append(sampleId);
+        }
+    }
+    return true;
+}
+
+bool BatchExporter::exportFeatures(const SamplesByFeature &samplesByFeature, QString &errorMessage)
+{
+    const FeatureMatrix &matrix = dataSource.getFeatureMatrix();
+
+    QList<FeatureId> featureIds;
+    int featureNumber = 0;
+    foreach (const FeatureId &featureId, samplesByFeature.keys()) {
+        if (featureNumber++ % settings.shardCount == settings.shardNumber) {
+            featureIds.append(featureId);
+        }
+    }
+
+    for (int chunkStart = 0; chunkStart < featureIds.size(); chunkStart += FEATURES_PER_CHUNK) {
+        const QList<FeatureId> chunk = featureIds.mid(chunkStart, FEATURES_PER_CHUNK);
+        SampleFeatureIds chunkFeatures;
+        foreach (const FeatureId &featureId, chunk) {
+            foreach (const SampleId &sampleId, samplesByFeature[featureId]) {
+                chunkFeatures.insert(sampleId, featureId);
+            }
+        }
+
+        QHash<QPair<SampleId, FeatureId>, FeatureData> featureData;
+        foreach (const FeatureData &feature, dataSource.getFeatures(chunkFeatures)) {
+            featureData[qMakePair(feature.sampleId, feature.featureId)] = feature;
+        }
+
+        foreach (const FeatureId &featureId, chunk) {
+            const int row = matrix.findRow(featureId);
+            const qreal consensusMz = -1 != row ? matrix.getConsensusMz(row) : 0.0;
+            const QString compoundIds = -1 != row ? matrix.getCompoundIds(row) : QString();
+
+            GraphSeriesList xicSeries;
+            GraphSeriesList massSeries;
+            foreach (const SampleId &sampleId, samplesByFeature[featureId]) {
+                const QPair<SampleId, FeatureId> key(sampleId, featureId);
+                if (!featureData.contains(key)) {
+                    continue; // the feature isn't detected in the sample
+                }
+                GraphSeries xic(sampleId, featureId, dataSource.getSampleNameById(sampleId), consensusMz,
+                    compoundIds.split("; ", QString::SkipEmptyParts));
+                GraphSeries massPeaks = xic;
+                xic.setXic(featureData[key], dataSource.getMs2ScanTable());
+                massPeaks.setMassPeaks(featureData[key]);
+                xicSeries.append(xic);
+                massSeries.append(massPeaks);
+            }
+
+            if (!xicSeries.isEmpty() && !exportFeature(featureId, xicSeries, massSeries, errorMessage)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool BatchExporter::exportFeature(const FeatureId &featureId, const GraphSeriesList &xicSeries,
+    const GraphSeriesList &massSeries, QString &errorMessage)
+{
+    QStringList featureTitles;
+    QVector<QColor> featureColors;
+    QList<FragmentationSpectrumId> spectrumIds;
+    for (int i = 0; i < xicSeries.size(); ++i) {
+        featureTitles.append(xicSeries[i].getFeatureTitle().replace('\n', "; "));
+        featureColors.append(ChartRenderer::getDefaultColor(i));
+        foreach (const Ms2ScanInfo &scan, xicSeries[i].ms2Scans) {
+            spectrumIds.append(scan.spectrumId);
+        }
+    }
+
+    const Ms2SpectraById spectra = dataSource.getMs2SpectraData(spectrumIds);
+    GraphSeriesList spectrumSeries;
+    QStringList spectrumTitles;
+    QVector<QColor> spectrumColors;
+    foreach (const GraphSeries &xic, xicSeries) {
+        foreach (const Ms2ScanInfo &scan, xic.ms2Scans) {
+            if (!spectra.contains(scan.spectrumId)) {
+                continue;
+            }
+            GraphSeries series(xic.sampleId, xic.featureId, xic.sampleName, xic.consensusMz, xic.compoundIds);
+            series.points = spectra[scan.spectrumId].toVector();
+            GraphSeries::sortPoints(series.points);
+            spectrumColors.append(ChartRenderer::getDefaultColor(spectrumSeries.size()));
+            spectrumSeries.append(series);
+            spectrumTitles.append(series.getSpectrumTitle(scan).replace('\n', "; "));
+        }
+    }
+
+    if (settings.dataEnabled) {
+        if (!saveSeries(xicSeries, featureTitles, "RT", getOutputPath(featureId, "xic", "csv"), errorMessage)
+            || !saveSeries(massSeries, featureTitles, "m/z", getOutputPath(featureId, "ms1", "csv"), errorMessage)
+            || (!spectrumSeries.isEmpty()
+                && !saveSeries(spectrumSeries, spectrumTitles, "m/z", getOutputPath(featureId, "ms2", "csv"), errorMessage)))
+        {
+            return false;
+        }
+    }
+
+    if (settings.imagesEnabled) {
+        const QString extension = settings.imageFormat.toLower();
+
+        ChartRenderer xicRenderer;
+        xicRenderer.setTitle(tr("Extracted Ion Chromatogram of Feature %1").arg(featureId));
+        xicRenderer.setAxisTitles(tr("Retention time [s]"), tr("Ion count"));
+        xicRenderer.setSeries(xicSeries, featureColors);
+        xicRenderer.setSeriesTitles(featureTitles);
+        qreal minRt = std::numeric_limits<qreal>::max();
+        qreal maxRt = -std::numeric_limits<qreal>::max();
+        foreach (const GraphSeries &series, xicSeries) {
+            if (series.hasElutionRange()) {
+                minRt = qMin(minRt, series.rtStart);
+                maxRt = qMax(maxRt, series.rtEnd);
+            }
+        }
+        if (minRt <= maxRt) {
+            xicRenderer.setXRange(qMax(minRt - XIC_PEAK_ZOOM_OFFSET, 0.0), maxRt + XIC_PEAK_ZOOM_OFFSET);
+        }
+
+        ChartRenderer massRenderer;
+        massRenderer.setTitle(tr("Mass Peaks of Feature %1").arg(featureId));
+        massRenderer.setAxisTitles(tr("m/z"), tr("Ion count"));
+        massRenderer.setPlotStyle(ChartRenderer::STICK_PLOT);
+        massRenderer.setSeries(massSeries, featureColors);
+        massRenderer.setSeriesTitles(featureTitles);
+
+        if (!saveChart(xicRenderer, getOutputPath(featureId, "xic", extension), errorMessage)
+            || !saveChart(massRenderer, getOutputPath(featureId, "ms1", extension), errorMessage))
+        {
+            return false;
+        }
+
+        if (!spectrumSeries.isEmpty()) {
+            ChartRenderer spectrumRenderer;
+            spectrumRenderer.setTitle(tr("Fragmentation Spectra of Feature %1").arg(featureId));
+            spectrumRenderer.setAxisTitles(tr("m/z"), tr("Ion count"));
+            spectrumRenderer.setPlotStyle(ChartRenderer::STICK_PLOT);
+            spectrumRenderer.setSeries(spectrumSeries, spectrumColors);
+            spectrumRenderer.setSeriesTitles(spectrumTitles);
+            if (!saveChart(spectrumRenderer, getOutputPath(featureId, "ms2", extension), errorMessage)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool BatchExporter::saveSeries(const GraphSeriesList &series, const QStringList &titles, const QString &xTitle,
+    const QString &path, QString &errorMessage) const
+{
+    if (!CsvWritingUtils::saveGraphSeriesToFile(series, titles, xTitle, tr("Intensity"), settings.layout, path)) {
+        errorMessage = tr("Unable to save file: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool BatchExporter::saveChart(ChartRenderer &renderer, const QString &path, QString &errorMessage) const
+{
+    const QRect chartRect(QPoint(0, 0), settings.imageSize);
+    bool saved = false;
+    if ("SVG" == settings.imageFormat) {
+        QSvgGenerator generator;
+        generator.setFileName(path);
+        generator.setSize(settings.imageSize);
+        generator.setViewBox(chartRect);
+        QPainter painter;
+        saved = painter.begin(&generator);
+        if (saved) {
+            renderer.render(&painter, chartRect);
+            saved = painter.end();
+        }
+    } else if ("PDF" == settings.imageFormat) {
+        QPdfWriter writer(path);
+        writer.setResolution(PDF_RESOLUTION);
+        writer.setPageSizeMM(QSizeF(settings.imageSize) * 25.4 / PDF_RESOLUTION);
+        writer.setPageMargins(QMarginsF());
+        QPainter painter;
+        saved = painter.begin(&writer);
+        if (saved) {
+            renderer.render(&painter, QRect(0, 0, writer.width(), writer.height()));
+            saved = painter.end();
+        }
+    } else {
+        QImage image(settings.imageSize, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        renderer.render(&painter, chartRect);
+        painter.end();
+        saved = image.save(path, settings.imageFormat.toLatin1().constData());
+    }
+
+    if (!saved) {
+        errorMessage = tr("Unable to save file: %1").arg(path);
+    }
+    return saved;
+}
+
+QString BatchExporter::getOutputPath(const FeatureId &featureId, const QString &chartName, const QString &extension) const
+{
+    return QDir(settings.outputDir).filePath(QString("feature_%1_%2.%3").arg(featureId).arg(chartName, extension));
+}
+
+} // namespace ov
@@ -0,0 +1,70 @@
+#ifndef BATCH_EXPORTER_H
+#define BATCH_EXPORTER_H
+
+#include <QCoreApplication>
+#include <QMap>
+#include <QSize>
+#include <QStringList>
+
+#include "CsvWritingUtils.h"
+#include "FeatureDataSource.h"
+#include "GraphSeries.h"
+
+namespace ov {
+
+class ChartRenderer;
+
+struct BatchExportSettings
+{
+    BatchExportSettings();
+
+    DataSourceId dataSourceId;
+    QString outputDir;
+    QList<FeatureId> featureIds; // all features if empty
+    QList<SampleId> sampleIds; // all samples where a feature is detected if empty
+    QString query; // returns (sample_id, feature_id) pairs, overrides the lists above
+
+    bool dataEnabled;
+    CsvWritingUtils::GraphTableLayout layout;
+    bool imagesEnabled;
+    FormatId imageFormat;
+    QSize imageSize;
+
+    // features are distributed among processes working in parallel, each process exports every shardCount-th feature
+    int shardNumber;
+    int shardCount;
+};
+
+// Writes XIC, mass peak and fragmentation spectrum series of features and their charts to files without any GUI.
+// Graphs of a feature are overlaid for all its samples, files are named "feature_<id>_<chart>.<format>".
+class BatchExporter
+{
+    Q_DECLARE_TR_FUNCTIONS(BatchExporter)
+
+public:
+    explicit BatchExporter(const BatchExportSettings &settings);
+
+    bool run(QString &errorMessage);
+
+    static QStringList getSupportedImageFormats();
+
+private:
+    typedef QMap<FeatureId, QList<SampleId> > SamplesByFeature;
+
+    bool collectFeatures(SamplesByFeature &samplesByFeature, QString &errorMessage);
+    bool collectFeaturesByQuery(SamplesByFeature &samplesByFeature, QString &errorMessage);
+    bool exportFeatures(const SamplesByFeature &samplesByFeature, QString &errorMessage);
+    bool exportFeature(const FeatureId &featureId, const GraphSeriesList &xicSeries, const GraphSeriesList &massSeries,
+        QString &errorMessage);
+    bool saveSeries(const GraphSeriesList &series, const QStringList &titles, const QString &xTitle, const QString &path,
+        QString &errorMessage) const;
+    bool saveChart(ChartRenderer &renderer, const QString &path, QString &errorMessage) const;
+    QString getOutputPath(const FeatureId &featureId, const QString &chartName, const QString &extension) const;
+
+    const BatchExportSettings settings;
+    FeatureDataSource dataSource;
+};
+
+} // namespace ov
+
+#endif // BATCH_EXPORTER_H
@@ -0,0 +1,194 @@
+#include <QCommandLineParser>
+#include <QFile>
+#include <QGuiApplication>
+#include <QProcess>
+#include <QRegExp>
+#include <QTextStream>
+#include <QThread>
+
+#include "BatchExporter.h"
+
+namespace {
+
+template<typename T>
+bool parseIdList(const QString &str, QList<T> &ids)
+{
+    foreach (const QString &idStr, str.split(QRegExp("[,;\\s]+"), QString::SkipEmptyParts)) {
+        bool ok = false;
+        ids.append(idStr.toLongLong(&ok));
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readIdFile(const QString &path, QList<ov::FeatureId> &ids)
+{
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+        return false;
+    }
+    return parseIdList(QTextStream(&file).readAll(), ids);
+}
+
+int fail(const QString &message)
+{
+    QTextStream(stderr) << message << endl;
+    return 1;
+}
+
+// Runs the same command in several child processes, each of them exports its own share of features.
+// Processes are used instead of threads because every exporter needs its own database connection and font rendering
+// outside of the main thread isn't supported by all Qt platform plugins, in particular by "offscreen".
+int runShards(int shardCount)
+{
+    const QStringList arguments = QCoreApplication::arguments().mid(1);
+    QList<QProcess *> processes;
+    for (int i = 0; i < shardCount; ++i) {
+        QProcess *process = new QProcess(qApp);
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(QCoreApplication::applicationFilePath(), QStringList() << arguments
+            << "--jobs" << "1" << "--shard" << QString("%1/%2").arg(i).arg(shardCount));
+        processes.append(process);
+    }
+
+    int result = 0;
+    foreach (QProcess *process, processes) {
+        if (!process->waitForFinished(-1) || QProcess::NormalExit != process->exitStatus() || 0 != process->exitCode()) {
+            result = 1;
+        }
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (sizeof(double) != 8 || sizeof(float) != 4) {
+        printf("This platform is incompatible with Optimus database format.");
+        return -1;
+    }
+
+    // charts are only rendered to files, so no display is needed
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication a(argc, argv);
+    QCoreApplication::setApplicationName("OptimusViewerBatch");
+    QCoreApplication::setApplicationVersion(CURRENT_OPTIMUS_VERSION);
+
+    qRegisterMetaType<ov::DataSourceId>("DataSourceId");
+    qRegisterMetaType<ov::SampleFeatureIds>("SampleFeatureIds");
+    qRegisterMetaType<ov::FeatureDataList>("FeatureDataList");
+    qRegisterMetaType<ov::SpectrumIdList>("SpectrumIdList");
+    qRegisterMetaType<ov::Ms2SpectraById>("Ms2SpectraById");
+    qRegisterMetaType<ov::SparklinesByFeature>("SparklinesByFeature");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "Exports XIC, mass peak and MS/MS spectrum plots "
+        "and their data for features of an Optimus database."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("database", QCoreApplication::translate("main", "Optimus database (*.db)."));
+    parser.addPositionalArgument("output", QCoreApplication::translate("main", "Output directory."));
+
+    const QCommandLineOption featuresOption(QStringList() << "f" << "features",
+        QCoreApplication::translate("main", "Comma-separated feature IDs. All features are exported by default."), "ids");
+    const QCommandLineOption featureFileOption("feature-file",
+        QCoreApplication::translate("main", "File with feature IDs separated by commas or line breaks."), "path");
+    const QCommandLineOption samplesOption(QStringList() << "s" << "samples",
+        QCoreApplication::translate("main", "Comma-separated sample IDs. All samples where a feature is detected are used by default."), "ids");
+    const QCommandLineOption queryOption(QStringList() << "q" << "query",
+        QCoreApplication::translate("main", "SQL query returning (sample_id, feature_id) pairs to export instead of the lists of IDs."), "sql");
+    const QCommandLineOption formatOption("image-format",
+        QCoreApplication::translate("main", "Image format: %1. Default is PNG.").arg(ov::BatchExporter::getSupportedImageFormats().join(", ")),
+        "format", "PNG");
+    const QCommandLineOption sizeOption("image-size", QCoreApplication::translate("main", "Image size in pixels. Default is 1200x600."),
+        "WxH", "1200x600");
+    const QCommandLineOption layoutOption("layout",
+        QCoreApplication::translate("main", "Plot data layout: \"long\" (a row per point, default) or \"wide\" (a column per graph)."),
+        "layout", "long");
+    const QCommandLineOption noImagesOption("no-images", QCoreApplication::translate("main", "Don't render plots."));
+    const QCommandLineOption noDataOption("no-data", QCoreApplication::translate("main", "Don't write plot data."));
+    const QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+        QCoreApplication::translate("main", "Number of processes working in parallel. Default is the number of CPU cores."), "n",
+        QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption shardOption("shard", QCoreApplication::translate("main",
+        "Export only the k-th of n shares of features. Used by child processes started for parallel export."), "k/n");
+
+    parser.addOption(featuresOption);
+    parser.addOption(featureFileOption);
+    parser.addOption(samplesOption);
+    parser.addOption(queryOption);
+    parser.addOption(formatOption);
+    parser.addOption(sizeOption);
+    parser.addOption(layoutOption);
+    parser.addOption(noImagesOption);
+    parser.addOption(noDataOption);
+    parser.addOption(jobsOption);
+    parser.addOption(shardOption);
+    parser.process(a);
+
+    const QStringList positionalArguments = parser.positionalArguments();
+    if (positionalArguments.size() != 2) {
+        parser.showHelp(1);
+    }
+
+    ov::BatchExportSettings settings;
+    settings.dataSourceId = positionalArguments[0];
+    settings.outputDir = positionalArguments[1];
+    settings.query = parser.value(queryOption);
+    settings.dataEnabled = !parser.isSet(noDataOption);
+    settings.imagesEnabled = !parser.isSet(noImagesOption);
+
+    if (!parseIdList(parser.value(featuresOption), settings.featureIds)) {
+        return fail(QCoreApplication::translate("main", "Invalid feature IDs."));
+    }
+    if (parser.isSet(featureFileOption) && !readIdFile(parser.value(featureFileOption), settings.featureIds)) {
+        return fail(QCoreApplication::translate("main", "Unable to read feature IDs from %1.").arg(parser.value(featureFileOption)));
+    }
+    if (!parseIdList(parser.value(samplesOption), settings.sampleIds)) {
+        return fail(QCoreApplication::translate("main", "Invalid sample IDs."));
+    }
+
+    settings.imageFormat = parser.value(formatOption).toUpper();
+    if (!ov::BatchExporter::getSupportedImageFormats().contains(settings.imageFormat)) {
+        return fail(QCoreApplication::translate("main", "Unsupported image format: %1.").arg(parser.value(formatOption)));
+    }
+
+    const QStringList sizeParts = parser.value(sizeOption).split('x');
+    settings.imageSize = sizeParts.size() == 2 ? QSize(sizeParts[0].toInt(), sizeParts[1].toInt()) : QSize();
+    if (settings.imageSize.width() <= 0 || settings.imageSize.height() <= 0) {
+        return fail(QCoreApplication::translate("main", "Invalid image size: %1.").arg(parser.value(sizeOption)));
+    }
+
+    const QString layout = parser.value(layoutOption);
+    if ("long" == layout) {
+        settings.layout = ov::CsvWritingUtils::LONG_GRAPH_TABLE;
+    } else if ("wide" == layout) {
+        settings.layout = ov::CsvWritingUtils::WIDE_GRAPH_TABLE;
+    } else {
+        return fail(QCoreApplication::translate("main", "Invalid layout: %1.").arg(layout));
+    }
+
+    if (parser.isSet(shardOption)) {
+        const QStringList shardParts = parser.value(shardOption).split('/');
+        settings.shardNumber = shardParts.value(0).toInt();
+        settings.shardCount = qMax(1, shardParts.value(1).toInt());
+    } else {
+        const int jobCount = parser.value(jobsOption).toInt();
+        if (jobCount > 1) {
+            return runShards(jobCount);
+        }
+    }
+
+    ov::BatchExporter exporter(settings);
+    QString errorMessage;
+    if (!exporter.run(errorMessage)) {
+        return fail(errorMessage);
+    }
+    return 0;
+}
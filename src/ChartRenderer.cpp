@@ -0,0 +1,622 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QPainter>
+#include <QPolygonF>
+
+#include "ChartRenderer.h"
+
+const int CHART_MARGIN = 10;
+const int LEGEND_MARKER_SIZE = 12;
+const int LEGEND_ITEM_SPACING = 16;
+const int MAX_LEGEND_ITEM_WIDTH = 320;
+const int MAX_LEGEND_HEIGHT_FRACTION = 4; // legend never takes more than a quarter of the chart height
+const int MIN_X_TICK_DISTANCE = 80;
+const int MIN_Y_TICK_DISTANCE = 40;
+const qreal SCAN_MARKER_RADIUS = 5.0;
+const qreal SCAN_MARKER_CLICK_RADIUS = 7.0;
+const qreal Y_RANGE_MARGIN = 1.05;
+const qreal AREA_FILL_ALPHA = 0.7;
+const qreal GUIDE_FILL_ALPHA = 0.1;
+const qreal DIMMED_ALPHA = 0.3;
+const QColor SCAN_MARKER_BORDER_COLOR("#B22222");
+const QColor GRID_COLOR("#E0E0E0");
+const QColor HIDDEN_SERIES_COLOR("#AAAAAA");
+
+namespace ov {
+
+ChartRenderer::ChartRenderer()
+    : plotStyle(AREA_PLOT), legendVisible(true), seriesDimmed(false), zoomed(false), zoomXMin(0.0), zoomXMax(1.0),
+    viewXMin(0.0), viewXMax(1.0), viewYMax(1.0), legendOverflowCount(0)
+{
+
+}
+
+void ChartRenderer::setTitle(const QString &title)
+{
+    this->title = title;
+}
+
+void ChartRenderer::setAxisTitles(const QString &xTitle, const QString &yTitle)
+{
+    this->xTitle = xTitle;
+    this->yTitle = yTitle;
+}
+
+void ChartRenderer::setPlotStyle(PlotStyle style)
+{
+    plotStyle = style;
+}
+
+ChartRenderer::PlotStyle ChartRenderer::getPlotStyle() const
+{
+    return plotStyle;
+}
+
+void ChartRenderer::setLegendVisible(bool visible)
+{
+    legendVisible = visible;
+}
+
+void ChartRenderer::setSeries(const GraphSeriesList &series, const QVector<QColor> &colors)
+{
+    Q_ASSERT(series.size() == colors.size());
+    this->series = series;
+    this->colors = colors;
+    seriesVisibility = QVector<bool>(series.size(), true);
+    seriesTitles.clear();
+    foreach (const GraphSeries &s, series) {
+        seriesTitles.append(s.getFeatureTitle());
+    }
+    highlightedScans.clear();
+    seriesDimmed = false;
+    zoomed = false;
+}
+
+const GraphSeriesList & ChartRenderer::getSeries() const
+{
+    return series;
+}
+
+void ChartRenderer::setSeriesTitles(const QStringList &titles)
+{
+    Q_ASSERT(titles.size() == series.size());
+    seriesTitles = titles;
+}
+
+void ChartRenderer::setSeriesVisible(int index, bool visible)
+{
+    Q_ASSERT(index >= 0 && index < seriesVisibility.size());
+    seriesVisibility[index] = visible;
+}
+
+bool ChartRenderer::isSeriesVisible(int index) const
+{
+    Q_ASSERT(index >= 0 && index < seriesVisibility.size());
+    return seriesVisibility[index];
+}
+
+int ChartRenderer::getVisibleSeriesCount() const
+{
+    return seriesVisibility.count(true);
+}
+
+void ChartRenderer::setSeriesDimmed(bool dimmed)
+{
+    seriesDimmed = dimmed;
+}
+
+void ChartRenderer::setHighlightedScans(const QHash<FragmentationSpectrumId, QColor> &scanColors)
+{
+    highlightedScans = scanColors;
+}
+
+void ChartRenderer::setXRange(qreal xMin, qreal xMax)
+{
+    if (xMin < xMax) {
+        zoomXMin = xMin;
+        zoomXMax = xMax;
+        zoomed = true;
+    }
+}
+
+void ChartRenderer::resetXRange()
+{
+    zoomed = false;
+}
+
+bool ChartRenderer::isZoomed() const
+{
+    return zoomed;
+}
+
+bool ChartRenderer::getDataXRange(qreal &xMin, qreal &xMax) const
+{
+    xMin = std::numeric_limits<qreal>::max();
+    xMax = -std::numeric_limits<qreal>::max();
+    for (int i = 0; i < series.size(); ++i) {
+        if (!seriesVisibility[i]) {
+            continue;
+        }
+        const GraphSeries &s = series[i];
+        if (!s.points.isEmpty()) {
+            xMin = qMin(xMin, s.points.first().x());
+            xMax = qMax(xMax, s.points.last().x());
+        }
+        if (!s.ms2Scans.isEmpty()) {
+            xMin = qMin(xMin, s.ms2Scans.first().scanTime);
+            xMax = qMax(xMax, s.ms2Scans.last().scanTime);
+        }
+    }
+    return xMin <= xMax;
+}
+
+void ChartRenderer::getVisiblePointRange(const QVector<QPointF> &points, int &first, int &last) const
+{
+    // one point beyond each side of the view keeps lines continuous at the edges
+    const auto xLessThan = [] (const QPointF &p, qreal x) { return p.x() < x; };
+    const auto xGreaterThan = [] (qreal x, const QPointF &p) { return x < p.x(); };
+    first = std::lower_bound(points.constBegin(), points.constEnd(), viewXMin, xLessThan) - points.constBegin();
+    last = std::upper_bound(points.constBegin(), points.constEnd(), viewXMax, xGreaterThan) - points.constBegin();
+    first = qMax(0, first - 1);
+    last = qMin(points.size() - 1, last);
+}
+
+void ChartRenderer::updateViewRange()
+{
+    if (zoomed) {
+        viewXMin = zoomXMin;
+        viewXMax = zoomXMax;
+    } else if (!getDataXRange(viewXMin, viewXMax)) {
+        viewXMin = 0.0;
+        viewXMax = 1.0;
+    }
+    if (viewXMin == viewXMax) {
+        viewXMin -= 1.0;
+        viewXMax += 1.0;
+    }
+
+    viewYMax = 0.0;
+    for (int i = 0; i < series.size(); ++i) {
+        if (!seriesVisibility[i]) {
+            continue;
+        }
+        const GraphSeries &s = series[i];
+        int first = 0;
+        int last = 0;
+        getVisiblePointRange(s.points, first, last);
+        for (int j = first; j <= last; ++j) {
+            const QPointF &p = s.points[j];
+            if (p.x() >= viewXMin && p.x() <= viewXMax) {
+                viewYMax = qMax(viewYMax, p.y());
+            }
+        }
+        foreach (const Ms2ScanInfo &scan, s.ms2Scans) {
+            if (scan.scanTime >= viewXMin && scan.scanTime <= viewXMax) {
+                viewYMax = qMax(viewYMax, scan.precursorIntensity);
+            }
+        }
+    }
+    viewYMax = viewYMax > 0.0 ? viewYMax * Y_RANGE_MARGIN : 1.0;
+}
+
+qreal ChartRenderer::mapX(qreal x) const
+{
+    return plotArea.left() + (x - viewXMin) / (viewXMax - viewXMin) * plotArea.width();
+}
+
+qreal ChartRenderer::mapY(qreal y) const
+{
+    return plotArea.bottom() - y / viewYMax * plotArea.height();
+}
+
+QColor ChartRenderer::getDrawingColor(int seriesIndex) const
+{
+    QColor color = colors[seriesIndex];
+    if (seriesDimmed) {
+        color.setAlphaF(DIMMED_ALPHA);
+    }
+    return color;
+}
+
+namespace {
+
+qreal getTickStep(qreal range, int maxTickCount)
+{
+    const qreal rawStep = range / qMax(1, maxTickCount);
+    const qreal magnitude = std::pow(10.0, std::floor(std::log10(rawStep)));
+    const qreal residual = rawStep / magnitude;
+    if (residual > 5.0) {
+        return 10.0 * magnitude;
+    } else if (residual > 2.0) {
+        return 5.0 * magnitude;
+    } else if (residual > 1.0) {
+        return 2.0 * magnitude;
+    } else {
+        return magnitude;
+    }
+}
+
+int getPixelColumn(qreal x)
+{
+    // points far beyond the view must not overflow int
+    return static_cast<int>(std::floor(qBound(-1e9, x, 1e9)));
+}
+
+QString formatXValue(qreal value)
+{
+    return QString::number(value, 'g', 6);
+}
+
+QString formatYValue(qreal value)
+{
+    return QString::number(value, 'e', 3);
+}
+
+}
+
+void ChartRenderer::layoutLegend(const QFontMetrics &fm, const QRect &rect)
+{
+    legendItems.clear();
+    legendOverflowCount = 0;
+    legendOverflowRect = QRect();
+    if (!legendVisible || series.isEmpty()) {
+        return;
+    }
+
+    const int rowHeight = fm.height() + 4;
+    const int maxRowCount = qMax(1, rect.height() / MAX_LEGEND_HEIGHT_FRACTION / rowHeight);
+    const QString overflowTemplate = tr("... and %1 more");
+    const int overflowWidth = fm.width(overflowTemplate.arg(series.size()));
+
+    int x = 0;
+    int row = 0;
+    for (int i = 0; i < series.size(); ++i) {
+        const QString text = fm.elidedText(QString(seriesTitles[i]).replace('\n', "; "), Qt::ElideRight, MAX_LEGEND_ITEM_WIDTH);
+        const int itemWidth = LEGEND_MARKER_SIZE + 4 + fm.width(text);
+        int nextX = x;
+        int nextRow = row;
+        if (nextX > 0 && nextX + itemWidth > rect.width()) {
+            nextX = 0;
+            ++nextRow;
+        }
+        // the last row keeps space for the overflow note
+        const bool moreItems = i < series.size() - 1;
+        const int requiredWidth = itemWidth + (moreItems ? LEGEND_ITEM_SPACING + overflowWidth : 0);
+        if (nextRow >= maxRowCount || (nextRow == maxRowCount - 1 && nextX > 0 && nextX + requiredWidth > rect.width())) {
+            legendOverflowCount = series.size() - i;
+            legendOverflowRect = QRect(rect.left() + x, rect.top() + row * rowHeight, overflowWidth, rowHeight);
+            break;
+        }
+        legendItems.append(qMakePair(QRect(rect.left() + nextX, rect.top() + nextRow * rowHeight, itemWidth, rowHeight), i));
+        x = nextX + itemWidth + LEGEND_ITEM_SPACING;
+        row = nextRow;
+    }
+}
+
+void ChartRenderer::render(QPainter *painter, const QRect &rect)
+{
+    painter->save();
+    painter->fillRect(rect, Qt::white);
+
+    const QFontMetrics fm = painter->fontMetrics();
+    const int lineHeight = fm.height();
+
+    QRect chartRect = rect.adjusted(CHART_MARGIN, CHART_MARGIN, -CHART_MARGIN, -CHART_MARGIN);
+    QRect titleRect;
+    if (!title.isEmpty()) {
+        titleRect = QRect(chartRect.left(), chartRect.top(), chartRect.width(), lineHeight * 3 / 2);
+        chartRect.setTop(titleRect.bottom() + 1);
+    }
+
+    layoutLegend(fm, chartRect);
+    if (!legendItems.isEmpty()) {
+        int legendHeight = 0;
+        for (int i = 0; i < legendItems.size(); ++i) {
+            legendHeight = qMax(legendHeight, legendItems[i].first.bottom() - chartRect.top() + 1);
+        }
+        legendHeight = qMax(legendHeight, legendOverflowRect.bottom() - chartRect.top() + 1);
+        const int legendOffset = chartRect.bottom() - legendHeight - chartRect.top() + 1;
+        for (int i = 0; i < legendItems.size(); ++i) {
+            legendItems[i].first.translate(0, legendOffset);
+        }
+        legendOverflowRect.translate(0, legendOffset);
+        chartRect.setBottom(chartRect.bottom() - legendHeight - CHART_MARGIN);
+    }
+
+    const int yLabelWidth = fm.width(formatYValue(-8.888e88));
+    plotArea = QRectF(chartRect.left() + lineHeight + yLabelWidth + CHART_MARGIN, chartRect.top() + CHART_MARGIN,
+        0.0, 0.0);
+    plotArea.setRight(chartRect.right() - 2 * CHART_MARGIN);
+    plotArea.setBottom(chartRect.bottom() - 2 * lineHeight - CHART_MARGIN);
+    if (plotArea.width() < 1.0 || plotArea.height() < 1.0) {
+        scanMarkers.clear();
+        painter->restore();
+        return;
+    }
+
+    updateViewRange();
+
+    if (!titleRect.isEmpty()) {
+        QFont titleFont = painter->font();
+        titleFont.setBold(true);
+        painter->save();
+        painter->setFont(titleFont);
+        painter->drawText(titleRect, Qt::AlignCenter, title);
+        painter->restore();
+    }
+    drawAxes(painter);
+
+    painter->save();
+    painter->setClipRect(plotArea);
+    drawGuides(painter);
+    for (int i = 0; i < series.size(); ++i) {
+        if (seriesVisibility[i]) {
+            drawSeries(painter, series[i], getDrawingColor(i));
+        }
+    }
+    scanMarkers.clear();
+    for (int i = 0; i < series.size(); ++i) {
+        if (seriesVisibility[i]) {
+            drawScans(painter, i, colors[i]);
+        }
+    }
+    painter->restore();
+
+    drawLegend(painter);
+    painter->restore();
+}
+
+void ChartRenderer::drawAxes(QPainter *painter) const
+{
+    const QFontMetrics fm = painter->fontMetrics();
+    const QPen gridPen(GRID_COLOR, 1.0, Qt::DotLine);
+    const QPen axisPen(Qt::gray);
+
+    const qreal xStep = getTickStep(viewXMax - viewXMin, static_cast<int>(plotArea.width()) / MIN_X_TICK_DISTANCE);
+    for (qreal x = std::ceil(viewXMin / xStep) * xStep; x <= viewXMax; x += xStep) {
+        const qreal px = mapX(x);
+        painter->setPen(gridPen);
+        painter->drawLine(QPointF(px, plotArea.top()), QPointF(px, plotArea.bottom()));
+        painter->setPen(Qt::black);
+        const QString label = formatXValue(std::fabs(x) < xStep * 1e-9 ? 0.0 : x);
+        painter->drawText(QRectF(px - MIN_X_TICK_DISTANCE / 2, plotArea.bottom() + 2, MIN_X_TICK_DISTANCE, fm.height()),
+            Qt::AlignHCenter | Qt::AlignTop, label);
+    }
+
+    const qreal yStep = getTickStep(viewYMax, static_cast<int>(plotArea.height()) / MIN_Y_TICK_DISTANCE);
+    for (qreal y = 0.0; y <= viewYMax; y += yStep) {
+        const qreal py = mapY(y);
+        painter->setPen(gridPen);
+        painter->drawLine(QPointF(plotArea.left(), py), QPointF(plotArea.right(), py));
+        painter->setPen(Qt::black);
+        painter->drawText(QRectF(plotArea.left() - CHART_MARGIN - 200, py - fm.height() / 2, 200, fm.height()),
+            Qt::AlignRight | Qt::AlignVCenter, formatYValue(y));
+    }
+
+    painter->setPen(axisPen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(plotArea);
+
+    painter->setPen(Qt::black);
+    painter->drawText(QRectF(plotArea.left(), plotArea.bottom() + fm.height() + 4, plotArea.width(), fm.height()),
+        Qt::AlignCenter, xTitle);
+
+    painter->save();
+    painter->translate(plotArea.left() - CHART_MARGIN - fm.width(formatYValue(-8.888e88)) - fm.height(), plotArea.center().y());
+    painter->rotate(-90);
+    painter->drawText(QRectF(-plotArea.height() / 2, 0, plotArea.height(), fm.height()), Qt::AlignCenter, yTitle);
+    painter->restore();
+}
+
+void ChartRenderer::drawGuides(QPainter *painter) const
+{
+    for (int i = 0; i < series.size(); ++i) {
+        const GraphSeries &s = series[i];
+        if (!seriesVisibility[i] || !s.hasElutionRange()) {
+            continue;
+        }
+        QColor fillColor = colors[i];
+        fillColor.setAlphaF(GUIDE_FILL_ALPHA);
+        const qreal left = mapX(s.rtStart);
+        const qreal right = mapX(s.rtEnd);
+        painter->fillRect(QRectF(left, plotArea.top(), right - left, plotArea.height()), fillColor);
+
+        painter->setPen(QPen(colors[i], 1.0, Qt::DashLine));
+        painter->drawLine(QPointF(left, plotArea.top()), QPointF(left, plotArea.bottom()));
+        painter->drawLine(QPointF(right, plotArea.top()), QPointF(right, plotArea.bottom()));
+    }
+}
+
+void ChartRenderer::appendDecimatedPoints(const QVector<QPointF> &points, QPolygonF &polyline) const
+{
+    // Keeps the first, the lowest, the highest and the last point of each pixel column,
+    // which is indistinguishable from drawing all of them
+    if (points.isEmpty()) {
+        return;
+    }
+    int first = 0;
+    int last = 0;
+    getVisiblePointRange(points, first, last);
+
+    int column = std::numeric_limits<int>::min();
+    QPointF columnFirst;
+    QPointF columnLast;
+    qreal columnMin = 0.0;
+    qreal columnMax = 0.0;
+    int columnPointCount = 0;
+    for (int i = first; i <= last + 1; ++i) {
+        QPointF mapped;
+        int pointColumn = std::numeric_limits<int>::max();
+        if (i <= last) {
+            mapped = QPointF(mapX(points[i].x()), mapY(points[i].y()));
+            pointColumn = getPixelColumn(mapped.x());
+        }
+        if (pointColumn != column) {
+            if (1 == columnPointCount) {
+                polyline.append(columnFirst);
+            } else if (columnPointCount > 1) {
+                const bool maxFirst = columnFirst.y() > columnLast.y();
+                polyline.append(columnFirst);
+                polyline.append(QPointF(column + 0.5, maxFirst ? columnMax : columnMin));
+                polyline.append(QPointF(column + 0.5, maxFirst ? columnMin : columnMax));
+                polyline.append(columnLast);
+            }
+            column = pointColumn;
+            columnFirst = mapped;
+            columnMin = columnMax = mapped.y();
+            columnPointCount = 0;
+        }
+        columnLast = mapped;
+        columnMin = qMin(columnMin, mapped.y());
+        columnMax = qMax(columnMax, mapped.y());
+        ++columnPointCount;
+    }
+}
+
+void ChartRenderer::drawSeries(QPainter *painter, const GraphSeries &s, const QColor &color) const
+{
+    if (s.points.isEmpty()) {
+        return;
+    }
+
+    const qreal baseline = mapY(0.0);
+    if (AREA_PLOT == plotStyle) {
+        QPolygonF polyline;
+        appendDecimatedPoints(s.points, polyline);
+        if (polyline.isEmpty()) {
+            return;
+        }
+        QPolygonF area = polyline;
+        area.prepend(QPointF(polyline.first().x(), baseline));
+        area.append(QPointF(polyline.last().x(), baseline));
+
+        QColor fillColor = color;
+        fillColor.setAlphaF(color.alphaF() * AREA_FILL_ALPHA);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(fillColor);
+        painter->drawPolygon(area);
+        painter->setPen(QPen(color, 1.0));
+        painter->setBrush(Qt::NoBrush);
+        painter->drawPolyline(polyline);
+    } else {
+        // the highest peak of each pixel column is drawn
+        int first = 0;
+        int last = 0;
+        getVisiblePointRange(s.points, first, last);
+        QVector<QLineF> sticks;
+        int column = std::numeric_limits<int>::min();
+        for (int i = first; i <= last; ++i) {
+            const qreal px = mapX(s.points[i].x());
+            const qreal py = mapY(s.points[i].y());
+            const int pointColumn = getPixelColumn(px);
+            if (pointColumn != column) {
+                sticks.append(QLineF(px, baseline, px, py));
+                column = pointColumn;
+            } else if (py < sticks.last().y2()) {
+                sticks.last().setP2(QPointF(sticks.last().x2(), py));
+            }
+        }
+        painter->setPen(QPen(color, 1.5));
+        painter->drawLines(sticks);
+    }
+}
+
+void ChartRenderer::drawScans(QPainter *painter, int seriesIndex, const QColor &color)
+{
+    const QVector<Ms2ScanInfo> &scans = series[seriesIndex].ms2Scans;
+    painter->setPen(QPen(SCAN_MARKER_BORDER_COLOR, 1.0));
+    for (int i = 0; i < scans.size(); ++i) {
+        const Ms2ScanInfo &scan = scans[i];
+        if (scan.scanTime < viewXMin || scan.scanTime > viewXMax) {
+            continue;
+        }
+        const QPointF center(mapX(scan.scanTime), mapY(scan.precursorIntensity));
+        painter->setBrush(highlightedScans.value(scan.spectrumId, color));
+        painter->drawEllipse(center, SCAN_MARKER_RADIUS, SCAN_MARKER_RADIUS);
+
+        ScanMarker marker;
+        marker.center = center;
+        marker.seriesIndex = seriesIndex;
+        marker.scanIndex = i;
+        scanMarkers.append(marker);
+    }
+}
+
+void ChartRenderer::drawLegend(QPainter *painter) const
+{
+    const QFontMetrics fm = painter->fontMetrics();
+    for (int i = 0; i < legendItems.size(); ++i) {
+        const QRect &itemRect = legendItems[i].first;
+        const int seriesIndex = legendItems[i].second;
+        const QColor color = seriesVisibility[seriesIndex] ? colors[seriesIndex] : HIDDEN_SERIES_COLOR;
+
+        const QRect markerRect(itemRect.left(), itemRect.center().y() - LEGEND_MARKER_SIZE / 2, LEGEND_MARKER_SIZE, LEGEND_MARKER_SIZE);
+        painter->fillRect(markerRect, color);
+
+        const QRect textRect = itemRect.adjusted(LEGEND_MARKER_SIZE + 4, 0, 0, 0);
+        painter->setPen(seriesVisibility[seriesIndex] ? Qt::black : HIDDEN_SERIES_COLOR);
+        painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter,
+            fm.elidedText(QString(seriesTitles[seriesIndex]).replace('\n', "; "), Qt::ElideRight, textRect.width()));
+    }
+    if (legendOverflowCount > 0) {
+        painter->setPen(Qt::black);
+        painter->drawText(legendOverflowRect, Qt::AlignLeft | Qt::AlignVCenter, tr("... and %1 more").arg(legendOverflowCount));
+    }
+}
+
+QRect ChartRenderer::getPlotArea() const
+{
+    return plotArea.toRect();
+}
+
+qreal ChartRenderer::xValueAt(int x) const
+{
+    return viewXMin + (x - plotArea.left()) / plotArea.width() * (viewXMax - viewXMin);
+}
+
+int ChartRenderer::legendItemAt(const QPoint &pos) const
+{
+    for (int i = 0; i < legendItems.size(); ++i) {
+        if (legendItems[i].first.contains(pos)) {
+            return legendItems[i].second;
+        }
+    }
+    return -1;
+}
+
+bool ChartRenderer::scanAt(const QPoint &pos, int &seriesIndex, Ms2ScanInfo &scan) const
+{
+    qreal closestDistance = SCAN_MARKER_CLICK_RADIUS;
+    int closestMarker = -1;
+    for (int i = 0; i < scanMarkers.size(); ++i) {
+        const QPointF diff = scanMarkers[i].center - pos;
+        const qreal distance = std::sqrt(QPointF::dotProduct(diff, diff));
+        if (distance <= closestDistance) {
+            closestDistance = distance;
+            closestMarker = i;
+        }
+    }
+    if (-1 == closestMarker) {
+        return false;
+    }
+    seriesIndex = scanMarkers[closestMarker].seriesIndex;
+    scan = series[seriesIndex].ms2Scans[scanMarkers[closestMarker].scanIndex];
+    return true;
+}
+
+QColor ChartRenderer::getDefaultColor(int index)
+{
+    // default amCharts colors are used first to look the same as the web view
+    static const char *defaultColors[] = { "#FF6600", "#FCD202", "#B0DE09", "#0D8ECF", "#2A0CD0", "#CD0D74", "#CC0000",
+        "#00CC00", "#0000CC", "#DDDDDD", "#999999", "#333333", "#990000" };
+    const int defaultColorCount = sizeof(defaultColors) / sizeof(defaultColors[0]);
+    if (index < defaultColorCount) {
+        return QColor(defaultColors[index]);
+    }
+    // golden angle steps of hue give distinct colors for any number of graphs
+    return QColor::fromHsv((index * 137) % 360, 200, 210);
+}
+
+} // namespace ov
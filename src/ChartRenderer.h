@@ -0,0 +1,113 @@
+#ifndef CHART_RENDERER_H
+#define CHART_RENDERER_H
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QHash>
+#include <QRect>
+#include <QVector>
+
+#include "GraphSeries.h"
+
+class QFontMetrics;
+class QPainter;
+class QPolygonF;
+
+namespace ov {
+
+// Draws XIC, mass peak and fragmentation spectrum charts with QPainter only, so it works with any paint device
+// including QImage, QSvgGenerator and QPrinter. Series are reduced to at most a few points per pixel column,
+// so the cost of rendering depends on the size of the chart rather than on the number of points.
+class ChartRenderer
+{
+    Q_DECLARE_TR_FUNCTIONS(ChartRenderer)
+
+public:
+    enum PlotStyle {
+        AREA_PLOT,
+        STICK_PLOT
+    };
+
+    ChartRenderer();
+
+    void setTitle(const QString &title);
+    void setAxisTitles(const QString &xTitle, const QString &yTitle);
+    void setPlotStyle(PlotStyle style);
+    PlotStyle getPlotStyle() const;
+    void setLegendVisible(bool visible);
+
+    void setSeries(const GraphSeriesList &series, const QVector<QColor> &colors);
+    const GraphSeriesList & getSeries() const;
+    void setSeriesTitles(const QStringList &titles);
+    void setSeriesVisible(int index, bool visible);
+    bool isSeriesVisible(int index) const;
+    int getVisibleSeriesCount() const;
+    void setSeriesDimmed(bool dimmed);
+    void setHighlightedScans(const QHash<FragmentationSpectrumId, QColor> &scanColors);
+
+    void setXRange(qreal xMin, qreal xMax);
+    void resetXRange();
+    bool isZoomed() const;
+    bool getDataXRange(qreal &xMin, qreal &xMax) const;
+
+    void render(QPainter *painter, const QRect &rect);
+
+    // hit tests use the layout of the last rendering
+    QRect getPlotArea() const;
+    qreal xValueAt(int x) const;
+    int legendItemAt(const QPoint &pos) const;
+    bool scanAt(const QPoint &pos, int &seriesIndex, Ms2ScanInfo &scan) const;
+
+    static QColor getDefaultColor(int index);
+
+private:
+    struct ScanMarker {
+        QPointF center;
+        int seriesIndex;
+        int scanIndex;
+    };
+
+    void updateViewRange();
+    void layoutLegend(const QFontMetrics &fm, const QRect &rect);
+    void drawAxes(QPainter *painter) const;
+    void drawGuides(QPainter *painter) const;
+    void drawSeries(QPainter *painter, const GraphSeries &series, const QColor &color) const;
+    void drawScans(QPainter *painter, int seriesIndex, const QColor &color);
+    void drawLegend(QPainter *painter) const;
+    void appendDecimatedPoints(const QVector<QPointF> &points, QPolygonF &polyline) const;
+    void getVisiblePointRange(const QVector<QPointF> &points, int &first, int &last) const;
+    qreal mapX(qreal x) const;
+    qreal mapY(qreal y) const;
+    QColor getDrawingColor(int seriesIndex) const;
+
+    QString title;
+    QString xTitle;
+    QString yTitle;
+    PlotStyle plotStyle;
+    bool legendVisible;
+
+    GraphSeriesList series;
+    QStringList seriesTitles;
+    QVector<QColor> colors;
+    QVector<bool> seriesVisibility;
+    bool seriesDimmed;
+    QHash<FragmentationSpectrumId, QColor> highlightedScans;
+
+    bool zoomed;
+    qreal zoomXMin;
+    qreal zoomXMax;
+
+    // current view
+    qreal viewXMin;
+    qreal viewXMax;
+    qreal viewYMax;
+    QRectF plotArea;
+    QVector<QPair<QRect, int> > legendItems; // (item rectangle, series index)
+    QRect legendOverflowRect;
+    int legendOverflowCount;
+    QVector<ScanMarker> scanMarkers;
+};
+
+} // namespace ov
+
+#endif // CHART_RENDERER_H
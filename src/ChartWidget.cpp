@@ -0,0 +1,150 @@
+#include <QContextMenuEvent>
+#include <QHelpEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QRubberBand>
+#include <QToolTip>
+#include <QWheelEvent>
+
+#include "ChartWidget.h"
+
+const int MIN_ZOOM_DRAG_DISTANCE = 4;
+const qreal WHEEL_ZOOM_FACTOR = 0.8;
+
+namespace ov {
+
+ChartWidget::ChartWidget(QWidget *parent)
+    : QWidget(parent), rubberBand(new QRubberBand(QRubberBand::Rectangle, this))
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMouseTracking(false);
+    setMinimumSize(200, 150);
+}
+
+ChartRenderer & ChartWidget::getRenderer()
+{
+    return renderer;
+}
+
+void ChartWidget::zoomOut()
+{
+    renderer.resetXRange();
+    update();
+}
+
+void ChartWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    renderer.render(&painter, rect());
+}
+
+void ChartWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (Qt::LeftButton != event->button()) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+
+    const int legendItem = renderer.legendItemAt(event->pos());
+    if (-1 != legendItem) {
+        const bool visible = !renderer.isSeriesVisible(legendItem);
+        if (visible || renderer.getVisibleSeriesCount() > 1) { // at least one graph stays visible
+            renderer.setSeriesVisible(legendItem, visible);
+            update();
+            emit seriesVisibilityChanged(legendItem, visible);
+        }
+        return;
+    }
+
+    int seriesIndex = -1;
+    Ms2ScanInfo scan;
+    if (renderer.scanAt(event->pos(), seriesIndex, scan)) {
+        emit scanClicked(seriesIndex, scan, event->modifiers() & Qt::ControlModifier);
+        return;
+    }
+
+    if (renderer.getPlotArea().contains(event->pos())) {
+        dragOrigin = event->pos();
+        rubberBand->setGeometry(QRect(dragOrigin, QSize()));
+        rubberBand->show();
+    }
+}
+
+void ChartWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (rubberBand->isVisible()) {
+        const QRect plotArea = renderer.getPlotArea();
+        const int x = qBound(plotArea.left(), event->pos().x(), plotArea.right());
+        rubberBand->setGeometry(QRect(QPoint(qMin(dragOrigin.x(), x), plotArea.top()),
+            QPoint(qMax(dragOrigin.x(), x), plotArea.bottom())));
+    }
+}
+
+void ChartWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (!rubberBand->isVisible()) {
+        return;
+    }
+    rubberBand->hide();
+
+    const QRect zoomRect = rubberBand->geometry();
+    if (zoomRect.width() >= MIN_ZOOM_DRAG_DISTANCE) {
+        renderer.setXRange(renderer.xValueAt(zoomRect.left()), renderer.xValueAt(zoomRect.right()));
+        update();
+    } else if (Qt::LeftButton == event->button()) {
+        emit backgroundClicked();
+    }
+}
+
+void ChartWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (renderer.getPlotArea().contains(event->pos())) {
+        zoomOut();
+    }
+}
+
+void ChartWidget::wheelEvent(QWheelEvent *event)
+{
+    const QRect plotArea = renderer.getPlotArea();
+    if (!plotArea.contains(event->pos()) || 0 == event->angleDelta().y()) {
+        event->ignore();
+        return;
+    }
+    const qreal factor = event->angleDelta().y() > 0 ? WHEEL_ZOOM_FACTOR : 1.0 / WHEEL_ZOOM_FACTOR;
+    const qreal center = renderer.xValueAt(event->pos().x());
+    const qreal left = renderer.xValueAt(plotArea.left());
+    const qreal right = renderer.xValueAt(plotArea.right());
+    renderer.setXRange(center - (center - left) * factor, center + (right - center) * factor);
+    update();
+}
+
+void ChartWidget::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *zoomOutAction = menu.addAction(tr("Show all"), this, SLOT(zoomOut()));
+    zoomOutAction->setEnabled(renderer.isZoomed());
+    emit contextMenuRequested(&menu);
+    menu.exec(event->globalPos());
+}
+
+bool ChartWidget::event(QEvent *event)
+{
+    if (QEvent::ToolTip == event->type()) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        int seriesIndex = -1;
+        Ms2ScanInfo scan;
+        if (renderer.scanAt(helpEvent->pos(), seriesIndex, scan)) {
+            QToolTip::showText(helpEvent->globalPos(), tr("Scan start time: %1 s\n(Click to see fragmentation spectrum)\nPrecursor m/z: %2")
+                .arg(QString::number(scan.scanTime, 'f', 2), QString::number(scan.precursorMz, 'f', 4)), this);
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+} // namespace ov
@@ -0,0 +1,51 @@
+#ifndef CHART_WIDGET_H
+#define CHART_WIDGET_H
+
+#include <QWidget>
+
+#include "ChartRenderer.h"
+
+class QMenu;
+class QRubberBand;
+
+namespace ov {
+
+// Interactive chart painted by ChartRenderer: legend items toggle graphs, MS2 markers are clickable,
+// dragging over the plot zooms in, double click or the context menu zooms out.
+class ChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ChartWidget(QWidget *parent = NULL);
+
+    ChartRenderer & getRenderer();
+
+signals:
+    void seriesVisibilityChanged(int seriesIndex, bool visible);
+    void scanClicked(int seriesIndex, const Ms2ScanInfo &scan, bool addToSelection);
+    void backgroundClicked();
+    void contextMenuRequested(QMenu *menu);
+
+public slots:
+    void zoomOut();
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void mouseReleaseEvent(QMouseEvent *event);
+    void mouseDoubleClickEvent(QMouseEvent *event);
+    void wheelEvent(QWheelEvent *event);
+    void contextMenuEvent(QContextMenuEvent *event);
+    bool event(QEvent *event);
+
+private:
+    ChartRenderer renderer;
+    QRubberBand *rubberBand;
+    QPoint dragOrigin;
+};
+
+} // namespace ov
+
+#endif // CHART_WIDGET_H
@@ -0,0 +1,144 @@
+#include <QtConcurrent>
+
+#include "ClusteringController.h"
+
+namespace ov {
+
+ClusteringController::ClusteringController(QObject *parent)
+    : QObject(parent), cancelRequested(0), hasWaitingRequest(false)
+{
+    progressIndicator.setWindowTitle(tr("Clustering..."));
+    progressIndicator.setModal(true);
+
+    connect(this, &ClusteringController::clusteringProgress, &progressIndicator, &ProgressIndicator::progress);
+    connect(&progressIndicator, &ProgressIndicator::canceled, this, &ClusteringController::cancelClustering);
+    connect(&clusteringWatcher, &QFutureWatcher<QVector<QVector<int> > >::finished, this, &ClusteringController::clusteringFinished);
+}
+
+ClusteringController::~ClusteringController()
+{
+    cancelRequested.store(1);
+    clusteringWatcher.waitForFinished();
+}
+
+void ClusteringController::cluster(const FeatureMatrix &matrix, const IntensityNormalization &normalization, bool features,
+    bool samples, HierarchicalClustering::Distance distance, HierarchicalClustering::Linkage linkage)
+{
+    ClusteringRequest request;
+    request.matrix = matrix;
+    request.normalization = normalization;
+    request.features = features;
+    request.samples = samples;
+    request.distance = distance;
+    request.linkage = linkage;
+    if (clusteringWatcher.isRunning()) {
+        // the running task stops at its next progress report, clusteringFinished() starts the request then
+        cancelRequested.store(1);
+        waitingRequest = request;
+        hasWaitingRequest = true;
+        return;
+    }
+    start(request);
+}
+
+void ClusteringController::start(const ClusteringRequest &request)
+{
+    ClusteringTask task;
+    task.matrix = request.matrix;
+    task.normalization = request.normalization;
+    task.distance = request.distance;
+    task.linkage = request.linkage;
+    pendingKeys.clear();
+    pendingTargets.clear();
+    QVector<HierarchicalClustering::Target> targets;
+    if (request.features) {
+        targets.append(HierarchicalClustering::FEATURE_CLUSTERING);
+    }
+    if (request.samples) {
+        targets.append(HierarchicalClustering::SAMPLE_CLUSTERING);
+    }
+    foreach (HierarchicalClustering::Target target, targets) {
+        const QString key = getCacheKey(target, request.normalization, request.distance, request.linkage);
+        if (cachedOrders.contains(key)) {
+            emitOrder(target, cachedOrders[key]);
+        } else {
+            task.targets.append(target);
+            pendingKeys.append(key);
+            pendingTargets.append(target);
+        }
+    }
+    if (task.targets.isEmpty()) {
+        return;
+    }
+
+    cancelRequested.store(0);
+    progressIndicator.started();
+    clusteringWatcher.setFuture(QtConcurrent::run(this, &ClusteringController::computeOrders, task));
+}
+
+QVector<QVector<int> > ClusteringController::computeOrders(const ClusteringTask &task)
+{
+    QVector<QVector<int> > orders;
+    const int targetCount = task.targets.size();
+    for (int i = 0; i < targetCount; ++i) {
+        // every target gets an equal share of the progress bar
+        const QVector<int> order = HierarchicalClustering::computeOrder(task.matrix, task.normalization, task.targets[i],
+            task.distance, task.linkage, [this, i, targetCount](int percents) {
+                emit clusteringProgress((100 * i + percents) / targetCount);
+                return !cancelRequested.load();
+            });
+        if (cancelRequested.load()) {
+            return QVector<QVector<int> >();
+        }
+        orders.append(order);
+    }
+    return orders;
+}
+
+void ClusteringController::cancelClustering()
+{
+    cancelRequested.store(1);
+    hasWaitingRequest = false;
+}
+
+void ClusteringController::clusteringFinished()
+{
+    progressIndicator.finished();
+    if (!cancelRequested.load()) {
+        const QVector<QVector<int> > orders = clusteringWatcher.result();
+        for (int i = 0; i < orders.size(); ++i) {
+            cachedOrders[pendingKeys[i]] = orders[i];
+            emitOrder(pendingTargets[i], orders[i]);
+        }
+    }
+    if (hasWaitingRequest) {
+        hasWaitingRequest = false;
+        start(waitingRequest);
+    }
+}
+
+void ClusteringController::clear()
+{
+    cancelRequested.store(1);
+    hasWaitingRequest = false;
+    waitingRequest = ClusteringRequest();
+    cachedOrders.clear();
+}
+
+void ClusteringController::emitOrder(HierarchicalClustering::Target target, const QVector<int> &order)
+{
+    if (HierarchicalClustering::FEATURE_CLUSTERING == target) {
+        emit featureOrderReady(order);
+    } else {
+        emit sampleOrderReady(order);
+    }
+}
+
+QString ClusteringController::getCacheKey(HierarchicalClustering::Target target, const IntensityNormalization &normalization,
+    HierarchicalClustering::Distance distance, HierarchicalClustering::Linkage linkage)
+{
+    return QString("%1 %2 %3 %4 %5").arg(target).arg(normalization.getMode()).arg(normalization.getStandardRow())
+        .arg(distance).arg(linkage);
+}
+
+} // namespace ov
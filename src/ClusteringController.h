@@ -0,0 +1,81 @@
+#ifndef CLUSTERING_CONTROLLER_H
+#define CLUSTERING_CONTROLLER_H
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+#include "FeatureMatrix.h"
+#include "HierarchicalClustering.h"
+#include "IntensityNormalization.h"
+#include "ProgressIndicator.h"
+
+namespace ov {
+
+// Runs clustering of features and samples on a worker thread with a cancelable progress dialog.
+// Orders are cached for the open database by their settings, so switching between them is instant.
+// A request made while clustering is running supersedes it: the running task is canceled and the latest
+// request starts once it has stopped.
+class ClusteringController : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ClusteringController(QObject *parent = NULL);
+    ~ClusteringController();
+
+    void cluster(const FeatureMatrix &matrix, const IntensityNormalization &normalization, bool features, bool samples,
+        HierarchicalClustering::Distance distance, HierarchicalClustering::Linkage linkage);
+    void clear(); // called when another database is opened, also drops the running and the waiting requests
+
+signals:
+    void featureOrderReady(const QVector<int> &rows);
+    void sampleOrderReady(const QVector<int> &sampleNumbers);
+    void clusteringProgress(int percents);
+
+private slots:
+    void clusteringFinished();
+    void cancelClustering();
+
+private:
+    struct ClusteringRequest
+    {
+        FeatureMatrix matrix;
+        IntensityNormalization normalization;
+        bool features;
+        bool samples;
+        HierarchicalClustering::Distance distance;
+        HierarchicalClustering::Linkage linkage;
+    };
+
+    // everything the worker thread needs, copied from the GUI thread before clustering starts
+    struct ClusteringTask
+    {
+        FeatureMatrix matrix;
+        IntensityNormalization normalization;
+        QVector<HierarchicalClustering::Target> targets;
+        HierarchicalClustering::Distance distance;
+        HierarchicalClustering::Linkage linkage;
+    };
+
+    void start(const ClusteringRequest &request);
+    QVector<QVector<int> > computeOrders(const ClusteringTask &task); // one per target, empty if canceled
+    static QString getCacheKey(HierarchicalClustering::Target target, const IntensityNormalization &normalization,
+        HierarchicalClustering::Distance distance, HierarchicalClustering::Linkage linkage);
+    void emitOrder(HierarchicalClustering::Target target, const QVector<int> &order);
+
+    ProgressIndicator progressIndicator;
+    QFutureWatcher<QVector<QVector<int> > > clusteringWatcher;
+    QAtomicInt cancelRequested; // also when the running task is superseded, its orders are dropped then
+    bool hasWaitingRequest;
+    ClusteringRequest waitingRequest; // the latest one made while a task was running
+    QVector<QString> pendingKeys; // of targets of the running task
+    QVector<HierarchicalClustering::Target> pendingTargets;
+    QHash<QString, QVector<int> > cachedOrders;
+};
+
+} // namespace ov
+
+#endif // CLUSTERING_CONTROLLER_H
@@ -0,0 +1,70 @@
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+
+#include "ClusteringDialog.h"
+
+namespace ov {
+
+namespace {
+
+enum TargetChoice {
+    FEATURES_AND_SAMPLES,
+    FEATURES_ONLY,
+    SAMPLES_ONLY
+};
+
+}
+
+ClusteringDialog::ClusteringDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Cluster Table"));
+
+    targetComboBox = new QComboBox(this);
+    targetComboBox->addItem(tr("Features and samples"), FEATURES_AND_SAMPLES);
+    targetComboBox->addItem(tr("Features (rows)"), FEATURES_ONLY);
+    targetComboBox->addItem(tr("Samples (columns)"), SAMPLES_ONLY);
+
+    distanceComboBox = new QComboBox(this);
+    distanceComboBox->addItem(tr("Correlation (1 - Pearson r)"), HierarchicalClustering::CORRELATION_DISTANCE);
+    distanceComboBox->addItem(tr("Euclidean"), HierarchicalClustering::EUCLIDEAN_DISTANCE);
+
+    linkageComboBox = new QComboBox(this);
+    linkageComboBox->addItem(tr("Average"), HierarchicalClustering::AVERAGE_LINKAGE);
+    linkageComboBox->addItem(tr("Complete"), HierarchicalClustering::COMPLETE_LINKAGE);
+    linkageComboBox->addItem(tr("Single"), HierarchicalClustering::SINGLE_LINKAGE);
+    linkageComboBox->addItem(tr("Ward"), HierarchicalClustering::WARD_LINKAGE);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QFormLayout *layout = new QFormLayout(this);
+    layout->addRow(tr("Reorder:"), targetComboBox);
+    layout->addRow(tr("Distance of log intensities:"), distanceComboBox);
+    layout->addRow(tr("Linkage:"), linkageComboBox);
+    layout->addRow(buttonBox);
+}
+
+bool ClusteringDialog::isFeatureClustering() const
+{
+    return SAMPLES_ONLY != targetComboBox->currentData().toInt();
+}
+
+bool ClusteringDialog::isSampleClustering() const
+{
+    return FEATURES_ONLY != targetComboBox->currentData().toInt();
+}
+
+HierarchicalClustering::Distance ClusteringDialog::getDistance() const
+{
+    return static_cast<HierarchicalClustering::Distance>(distanceComboBox->currentData().toInt());
+}
+
+HierarchicalClustering::Linkage ClusteringDialog::getLinkage() const
+{
+    return static_cast<HierarchicalClustering::Linkage>(linkageComboBox->currentData().toInt());
+}
+
+} // namespace ov
@@ -0,0 +1,33 @@
+#ifndef CLUSTERING_DIALOG_H
+#define CLUSTERING_DIALOG_H
+
+#include <QDialog>
+
+#include "HierarchicalClustering.h"
+
+class QComboBox;
+
+namespace ov {
+
+// Lets the user choose what to reorder in the feature table and how items are compared
+class ClusteringDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ClusteringDialog(QWidget *parent);
+
+    bool isFeatureClustering() const;
+    bool isSampleClustering() const;
+    HierarchicalClustering::Distance getDistance() const;
+    HierarchicalClustering::Linkage getLinkage() const;
+
+private:
+    QComboBox *targetComboBox;
+    QComboBox *distanceComboBox;
+    QComboBox *linkageComboBox;
+};
+
+} // namespace ov
+
+#endif // CLUSTERING_DIALOG_H
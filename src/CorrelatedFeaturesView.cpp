@@ -0,0 +1,103 @@
+#include <QApplication>
+#include <QComboBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QStandardItemModel>
+#include <QTableView>
+#include <QVBoxLayout>
+
+#include "CorrelatedFeaturesView.h"
+
+const int MATCH_COUNT = 100;
+
+namespace ov {
+
+namespace {
+
+QStandardItem * createNumberItem(const QVariant &value)
+{
+    QStandardItem *item = new QStandardItem;
+    item->setData(value, Qt::DisplayRole);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+}
+
+CorrelatedFeaturesView::CorrelatedFeaturesView(QWidget *parent)
+    : QWidget(parent), queryRow(-1)
+{
+    methodComboBox = new QComboBox(this);
+    methodComboBox->addItem(tr("Pearson (log intensities)"), FeatureCorrelationSearch::PEARSON_CORRELATION);
+    methodComboBox->addItem(tr("Spearman (ranks)"), FeatureCorrelationSearch::SPEARMAN_CORRELATION);
+    connect(methodComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+        this, &CorrelatedFeaturesView::methodChanged);
+
+    matchesModel = new QStandardItemModel(0, 4, this);
+    matchesModel->setHorizontalHeaderLabels(QStringList() << tr("Feature ID") << tr("m/z") << tr("RT") << tr("Correlation"));
+
+    QTableView *tableView = new QTableView(this);
+    tableView->setModel(matchesModel);
+    tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tableView->setSortingEnabled(true);
+    tableView->sortByColumn(3, Qt::DescendingOrder); // the order of the search
+    tableView->verticalHeader()->hide();
+    tableView->horizontalHeader()->setStretchLastSection(true);
+    connect(tableView, &QTableView::doubleClicked, this, &CorrelatedFeaturesView::itemDoubleClicked);
+
+    QFormLayout *methodLayout = new QFormLayout;
+    methodLayout->addRow(tr("Correlation:"), methodComboBox);
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(methodLayout);
+    layout->addWidget(tableView);
+}
+
+void CorrelatedFeaturesView::setMatrix(const FeatureMatrix &matrix, const IntensityNormalization &normalization)
+{
+    this->matrix = matrix;
+    correlationSearch.setMatrix(matrix, normalization);
+    if (!isVisible()) {
+        queryRow = -1; // the next search starts over
+    }
+    updateMatches();
+}
+
+void CorrelatedFeaturesView::search(int row)
+{
+    queryRow = row;
+    setWindowTitle(tr("Features Correlated with %1").arg(matrix.getFeatureId(row)));
+    updateMatches();
+}
+
+void CorrelatedFeaturesView::methodChanged()
+{
+    updateMatches();
+}
+
+void CorrelatedFeaturesView::updateMatches()
+{
+    matchesModel->removeRows(0, matchesModel->rowCount());
+    if (-1 == queryRow) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const FeatureCorrelationSearch::Method method
+        = static_cast<FeatureCorrelationSearch::Method>(methodComboBox->currentData().toInt());
+    const QVector<FeatureCorrelationSearch::Match> matches = correlationSearch.findCorrelated(queryRow, method, MATCH_COUNT);
+    foreach (const FeatureCorrelationSearch::Match &match, matches) {
+        QStandardItem *idItem = createNumberItem(matrix.getFeatureId(match.row));
+        idItem->setData(match.row, Qt::UserRole);
+        matchesModel->appendRow(QList<QStandardItem *>() << idItem << createNumberItem(matrix.getConsensusMz(match.row))
+            << createNumberItem(matrix.getConsensusRt(match.row)) << createNumberItem(match.correlation));
+    }
+    QApplication::restoreOverrideCursor();
+}
+
+void CorrelatedFeaturesView::itemDoubleClicked(const QModelIndex &index)
+{
+    emit featureClicked(matchesModel->index(index.row(), 0).data(Qt::UserRole).toInt());
+}
+
+} // namespace ov
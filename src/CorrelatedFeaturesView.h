@@ -0,0 +1,47 @@
+#ifndef CORRELATED_FEATURES_VIEW_H
+#define CORRELATED_FEATURES_VIEW_H
+
+#include <QWidget>
+
+#include "FeatureCorrelationSearch.h"
+
+class QComboBox;
+class QModelIndex;
+class QStandardItemModel;
+
+namespace ov {
+
+// Table of features whose profiles correlate best with the profile of a given one.
+// Profiles are prepared for the current matrix on the first search and reused by the following ones.
+// A double click on a feature reports its matrix row.
+class CorrelatedFeaturesView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CorrelatedFeaturesView(QWidget *parent = NULL);
+
+    void setMatrix(const FeatureMatrix &matrix, const IntensityNormalization &normalization);
+    void search(int row);
+
+signals:
+    void featureClicked(int row);
+
+private slots:
+    void methodChanged();
+    void itemDoubleClicked(const QModelIndex &index);
+
+private:
+    void updateMatches();
+
+    FeatureMatrix matrix;
+    FeatureCorrelationSearch correlationSearch;
+    int queryRow; // -1 if nothing was searched in the current matrix
+
+    QComboBox *methodComboBox;
+    QStandardItemModel *matchesModel;
+};
+
+} // namespace ov
+
+#endif // CORRELATED_FEATURES_VIEW_H
@@ -0,0 +1,202 @@
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <QIODevice>
+#include <QStringList>
+
+#include "CsvWriter.h"
+
+namespace ov {
+
+namespace {
+
+const int MAX_NUMBER_LENGTH = 32;
+const int MIN_DOUBLE_PRECISION = 15; // enough for the most of values, checked by reading the value back
+const int MAX_DOUBLE_PRECISION = 17; // always restores the value
+
+bool needsQuoting(const QString &value)
+{
+    const QChar *data = value.constData();
+    const QChar *end = data + value.size();
+    for (; data != end; ++data) {
+        const ushort c = data->unicode();
+        if (',' == c || '"' == c || '\n' == c || '\r' == c) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void appendUtf8(QByteArray &buffer, const QString &value)
+{
+    const int size = value.size();
+    const QChar *data = value.constData();
+    for (int i = 0; i < size; ++i) {
+        if (data[i].unicode() >= 0x80) {
+            buffer.append(value.midRef(i).toUtf8());
+            return;
+        }
+        buffer.append(static_cast<char>(data[i].unicode()));
+    }
+}
+
+int formatDouble(double value, char *output)
+{
+    if (std::isnan(value)) {
+        return std::sprintf(output, "NaN");
+    } else if (std::isinf(value)) {
+        return std::sprintf(output, value > 0 ? "Inf" : "-Inf");
+    }
+
+    // printf writes into the stack buffer without a temporary QString, but it respects LC_NUMERIC which Qt sets
+    // from the environment, so the value is read back with the same locale and the decimal separator is replaced afterwards
+    int length = std::snprintf(output, MAX_NUMBER_LENGTH, "%.*g", MIN_DOUBLE_PRECISION, value);
+    for (int precision = MIN_DOUBLE_PRECISION + 1; precision <= MAX_DOUBLE_PRECISION && std::strtod(output, NULL) != value; ++precision) {
+        length = std::snprintf(output, MAX_NUMBER_LENGTH, "%.*g", precision, value);
+    }
+    const char decimalPoint = *std::localeconv()->decimal_point;
+    if ('.' != decimalPoint) {
+        for (int i = 0; i < length; ++i) {
+            if (decimalPoint == output[i]) {
+                output[i] = '.';
+                break;
+            }
+        }
+    }
+    return length;
+}
+
+int formatInteger(qint64 value, char *output)
+{
+    char digits[MAX_NUMBER_LENGTH];
+    int digitCount = 0;
+    quint64 absValue = value < 0 ? 0 - static_cast<quint64>(value) : static_cast<quint64>(value);
+    do {
+        digits[digitCount++] = static_cast<char>('0' + absValue % 10);
+        absValue /= 10;
+    } while (0 != absValue);
+
+    int length = 0;
+    if (value < 0) {
+        output[length++] = '-';
+    }
+    while (digitCount > 0) {
+        output[length++] = digits[--digitCount];
+    }
+    return length;
+}
+
+}
+
+CsvWriter::CsvWriter(QIODevice *device, int bufferSize)
+    : device(device), bufferSize(bufferSize), rowStarted(false), error(false)
+{
+    Q_ASSERT(NULL != device);
+    buffer.reserve(bufferSize + MAX_NUMBER_LENGTH);
+}
+
+CsvWriter::~CsvWriter()
+{
+    flush();
+}
+
+void CsvWriter::startField()
+{
+    if (rowStarted) {
+        buffer.append(',');
+    }
+    rowStarted = true;
+}
+
+void CsvWriter::appendEscaped(const QString &value)
+{
+    if (!needsQuoting(value)) {
+        appendUtf8(buffer, value);
+        return;
+    }
+    buffer.append('"');
+    const int size = value.size();
+    int chunkStart = 0;
+    for (int i = 0; i < size; ++i) {
+        if ('"' == value[i].unicode()) {
+            appendUtf8(buffer, value.mid(chunkStart, i - chunkStart + 1));
+            buffer.append('"'); // an embedded quote is doubled
+            chunkStart = i + 1;
+        }
+    }
+    appendUtf8(buffer, value.mid(chunkStart));
+    buffer.append('"');
+}
+
+void CsvWriter::writeField(const QString &value)
+{
+    startField();
+    appendEscaped(value);
+    flushIfFull();
+}
+
+void CsvWriter::writeField(double value)
+{
+    startField();
+    char number[MAX_NUMBER_LENGTH];
+    buffer.append(number, formatDouble(value, number));
+    flushIfFull();
+}
+
+void CsvWriter::writeField(qint64 value)
+{
+    startField();
+    char number[MAX_NUMBER_LENGTH];
+    buffer.append(number, formatInteger(value, number));
+    flushIfFull();
+}
+
+void CsvWriter::writeField(int value)
+{
+    writeField(static_cast<qint64>(value));
+}
+
+void CsvWriter::writeEmptyField()
+{
+    startField();
+}
+
+void CsvWriter::writeRow(const QStringList &row)
+{
+    foreach (const QString &value, row) {
+        writeField(value);
+    }
+    endRow();
+}
+
+void CsvWriter::endRow()
+{
+    buffer.append("\r\n", 2);
+    rowStarted = false;
+    flushIfFull();
+}
+
+void CsvWriter::flushIfFull()
+{
+    if (buffer.size() >= bufferSize) {
+        flush();
+    }
+}
+
+bool CsvWriter::flush()
+{
+    if (!buffer.isEmpty()) {
+        error = error || device->write(buffer) != buffer.size();
+        buffer.resize(0); // keeps the allocated memory
+    }
+    return !error;
+}
+
+bool CsvWriter::hasError() const
+{
+    return error;
+}
+
+} // namespace ov
@@ -0,0 +1,49 @@
+#ifndef CSV_WRITER_H
+#define CSV_WRITER_H
+
+#include <QByteArray>
+
+class QIODevice;
+class QString;
+class QStringList;
+
+namespace ov {
+
+// Writes UTF-8 CSV to a device through a large output buffer.
+// Fields containing separators, quotes or line breaks are quoted and rows end with CRLF as described in RFC 4180.
+// Floating point numbers are written in the shortest form that is read back to the same value,
+// with a dot as decimal separator regardless of the current locale.
+class CsvWriter
+{
+public:
+    explicit CsvWriter(QIODevice *device, int bufferSize = DEFAULT_BUFFER_SIZE);
+    ~CsvWriter();
+
+    void writeField(const QString &value);
+    void writeField(double value);
+    void writeField(qint64 value);
+    void writeField(int value);
+    void writeEmptyField();
+    void writeRow(const QStringList &row);
+    void endRow();
+
+    bool flush();
+    bool hasError() const;
+
+    static const int DEFAULT_BUFFER_SIZE = 1 << 20; // bytes
+
+private:
+    void startField();
+    void appendEscaped(const QString &value);
+    void flushIfFull();
+
+    QIODevice *device;
+    QByteArray buffer;
+    int bufferSize;
+    bool rowStarted;
+    bool error;
+};
+
+} // namespace ov
+
+#endif // CSV_WRITER_H
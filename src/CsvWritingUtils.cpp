@@ -1,5 +1,12 @@
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
+
 #include <QFile>
-#include <QTextStream>
+#include <QObject>
+
+#include "CsvWriter.h"
 
 #include "CsvWritingUtils.h"
 
@@ -26,23 +33,98 @@ QList<QStringList> createEmptyTable(int nRows, int nColumns)
 bool saveTableToFile(const QList<QStringList> &table, const QString &path)
 {
     QFile file(path);
-    if (file.open(QFile::WriteOnly | QFile::Truncate)) {
-        QStringList csvRows;
-        foreach (QStringList row, table) {
-            for (int i = 0; i < row.length(); ++i) {
-                if (row[i].contains(",")) {
-                    row[i] = QString("\"%1\"").arg(row[i]);
-                }
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    CsvWriter writer(&file);
+    foreach (const QStringList &row, table) {
+        writer.writeRow(row);
+    }
+    return writer.flush();
+}
+
+namespace {
+
+typedef std::pair<qreal, int> MergeCursor; // (x of the next point, series number)
+typedef std::priority_queue<MergeCursor, std::vector<MergeCursor>, std::greater<MergeCursor> > MergeQueue;
+
+}
+
+bool saveGraphSeriesToFile(const GraphSeriesList &series, const QStringList &titles, const QString &xTitle,
+    const QString &yTitle, GraphTableLayout layout, const QString &path)
+{
+    Q_ASSERT(series.size() == titles.size());
+
+    QFile file(path);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    CsvWriter writer(&file);
+
+    const int seriesCount = series.size();
+    if (WIDE_GRAPH_TABLE == layout) {
+        writer.writeRow(QStringList() << xTitle << titles);
+    } else {
+        writer.writeRow(QStringList() << xTitle << QObject::tr("Graph") << yTitle);
+    }
+
+    // k-way merge of the sorted series, a heap holds the next point of every series
+    std::vector<int> nextPointNumbers(seriesCount, 0);
+    std::vector<MergeCursor> cursors;
+    cursors.reserve(seriesCount);
+    for (int i = 0; i < seriesCount; ++i) {
+        if (!series[i].points.isEmpty()) {
+            cursors.push_back(MergeCursor(series[i].points.first().x(), i));
+        }
+    }
+    MergeQueue queue(std::greater<MergeCursor>(), cursors);
+
+    std::vector<const QPointF *> rowPoints(seriesCount, NULL); // points of the current x in the wide layout
+    std::vector<int> rowSeriesNumbers;
+    while (!queue.empty()) {
+        const qreal x = queue.top().first;
+        rowSeriesNumbers.clear();
+        while (!queue.empty() && queue.top().first == x) {
+            const int seriesNumber = queue.top().second;
+            queue.pop();
+            const QVector<QPointF> &points = series[seriesNumber].points;
+            int &pointNumber = nextPointNumbers[seriesNumber];
+            // several points of a series with the same x are merged into the last one as it was plotted on top
+            while (pointNumber + 1 < points.size() && points[pointNumber + 1].x() == x) {
+                ++pointNumber;
+            }
+            rowPoints[seriesNumber] = &points[pointNumber];
+            rowSeriesNumbers.push_back(seriesNumber);
+            if (++pointNumber < points.size()) {
+                queue.push(MergeCursor(points[pointNumber].x(), seriesNumber));
             }
-            csvRows.append(row.join(","));
         }
 
-        QTextStream output(&file);
-        output << csvRows.join("\n");
-        return true;
-    } else {
-        return false;
+        if (WIDE_GRAPH_TABLE == layout) {
+            writer.writeField(x);
+            for (int i = 0; i < seriesCount; ++i) {
+                if (NULL != rowPoints[i]) {
+                    writer.writeField(rowPoints[i]->y());
+                } else {
+                    writer.writeEmptyField();
+                }
+            }
+            writer.endRow();
+        } else {
+            std::sort(rowSeriesNumbers.begin(), rowSeriesNumbers.end());
+            foreach (int seriesNumber, rowSeriesNumbers) {
+                writer.writeField(x);
+                writer.writeField(titles[seriesNumber]);
+                writer.writeField(rowPoints[seriesNumber]->y());
+                writer.endRow();
+            }
+        }
+        foreach (int seriesNumber, rowSeriesNumbers) {
+            rowPoints[seriesNumber] = NULL;
+        }
     }
+
+    return writer.flush();
 }
 
 } // namespace CsvWritingUtils
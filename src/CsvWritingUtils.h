@@ -3,6 +3,8 @@
 
 #include <QStringList>
 
+#include "GraphSeries.h"
+
 namespace ov {
 
 namespace CsvWritingUtils {
@@ -11,6 +13,16 @@ QList<QStringList> createEmptyTable(int nRows, int nColumns);
 
 bool saveTableToFile(const QList<QStringList> &table, const QString &path);
 
+enum GraphTableLayout
+{
+    WIDE_GRAPH_TABLE, // a row per x value, a column per graph
+    LONG_GRAPH_TABLE // a row per point: x, graph title, y
+};
+
+// Points of all series are merged by x on the fly, the series must have their points sorted by x
+bool saveGraphSeriesToFile(const GraphSeriesList &series, const QStringList &titles, const QString &xTitle,
+    const QString &yTitle, GraphTableLayout layout, const QString &path);
+
 } // namespace CsvWritingUtils
 
 } // namespace ov
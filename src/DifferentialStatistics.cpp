@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "FeatureMatrix.h"
+#include "FeatureMatrixUtils.h"
+#include "IntensityNormalization.h"
+
+#include "DifferentialStatistics.h"
+
+const int MAX_CONTINUED_FRACTION_ITERATIONS = 300;
+const double CONTINUED_FRACTION_EPSILON = 3e-16;
+const double NOT_APPLICABLE = std::numeric_limits<double>::quiet_NaN();
+
+namespace ov {
+
+namespace {
+
+// continued fraction of the regularized incomplete beta function, converges quickly for x < (a + 1) / (a + b + 2)
+double incompleteBetaFraction(double a, double b, double x)
+{
+    const double tiny = std::numeric_limits<double>::min() / CONTINUED_FRACTION_EPSILON;
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+    double result = d;
+    for (int m = 1; m <= MAX_CONTINUED_FRACTION_ITERATIONS; ++m) {
+        const int m2 = 2 * m;
+        double coefficient = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + coefficient * d;
+        d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+        c = 1.0 + coefficient / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        result *= d * c;
+
+        coefficient = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + coefficient * d;
+        d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+        c = 1.0 + coefficient / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        const double delta = d * c;
+        result *= delta;
+        if (std::fabs(delta - 1.0) < CONTINUED_FRACTION_EPSILON) {
+            break;
+        }
+    }
+    return result;
+}
+
+double regularizedIncompleteBeta(double a, double b, double x)
+{
+    if (x <= 0.0) {
+        return 0.0;
+    } else if (x >= 1.0) {
+        return 1.0;
+    }
+    const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+    return x < (a + 1.0) / (a + b + 2.0)
+        ? front * incompleteBetaFraction(a, b, x) / a
+        : 1.0 - front * incompleteBetaFraction(b, a, 1.0 - x) / b;
+}
+
+double studentTwoSidedPValue(double t, double degreesOfFreedom)
+{
+    return regularizedIncompleteBeta(degreesOfFreedom / 2.0, 0.5, degreesOfFreedom / (degreesOfFreedom + t * t));
+}
+
+double welchTTestPValue(const QVector<double> &first, const QVector<double> &second)
+{
+    const int n1 = first.size();
+    const int n2 = second.size();
+    if (n1 < 2 || n2 < 2) {
+        return NOT_APPLICABLE;
+    }
+    const double mean1 = std::accumulate(first.constBegin(), first.constEnd(), 0.0) / n1;
+    const double mean2 = std::accumulate(second.constBegin(), second.constEnd(), 0.0) / n2;
+    double sumOfSquares1 = 0.0;
+    foreach (double value, first) {
+        sumOfSquares1 += (value - mean1) * (value - mean1);
+    }
+    double sumOfSquares2 = 0.0;
+    foreach (double value, second) {
+        sumOfSquares2 += (value - mean2) * (value - mean2);
+    }
+    const double variance1 = sumOfSquares1 / (n1 - 1) / n1;
+    const double variance2 = sumOfSquares2 / (n2 - 1) / n2;
+    const double standardError = variance1 + variance2;
+    if (standardError <= 0.0) {
+        return NOT_APPLICABLE;
+    }
+    const double t = (mean2 - mean1) / std::sqrt(standardError);
+    const double degreesOfFreedom = standardError * standardError
+        / (variance1 * variance1 / (n1 - 1) + variance2 * variance2 / (n2 - 1));
+    return studentTwoSidedPValue(t, degreesOfFreedom);
+}
+
+// @values: both groups, the first one goes first; they are reordered
+double mannWhitneyPValue(QVector<double> &values, int firstCount)
+{
+    const int n = values.size();
+    const int n1 = firstCount;
+    const int n2 = n - firstCount;
+    if (0 == n1 || 0 == n2) {
+        return NOT_APPLICABLE;
+    }
+    QVector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&values] (int i, int j) { return values[i] < values[j]; });
+
+    double firstRankSum = 0.0;
+    double tieSum = 0.0;
+    for (int i = 0; i < n; ) {
+        int tieEnd = i + 1;
+        while (tieEnd < n && values[order[tieEnd]] == values[order[i]]) {
+            ++tieEnd;
+        }
+        const double rank = (i + 1 + tieEnd) / 2.0; // ranks start with 1, tied values get the mean of theirs
+        for (int j = i; j < tieEnd; ++j) {
+            if (order[j] < n1) {
+                firstRankSum += rank;
+            }
+        }
+        const double tieCount = tieEnd - i;
+        tieSum += tieCount * tieCount * tieCount - tieCount;
+        i = tieEnd;
+    }
+
+    const double u = firstRankSum - n1 * (n1 + 1) / 2.0;
+    const double meanU = n1 * double(n2) / 2.0;
+    const double varianceU = n1 * double(n2) / 12.0 * ((n + 1) - tieSum / (double(n) * (n - 1)));
+    if (varianceU <= 0.0) {
+        return NOT_APPLICABLE;
+    }
+    const double difference = std::fabs(u - meanU);
+    const double z = qMax(0.0, difference - 0.5) / std::sqrt(varianceU); // with the continuity correction
+    return qMin(1.0, std::erfc(z / std::sqrt(2.0)));
+}
+
+// Benjamini-Hochberg adjustment of the p-values in @column, NaNs aren't counted as tests
+void adjustPValues(QVector<double> &values, int column, int qValueColumn)
+{
+    const int rowCount = values.size() / DifferentialStatistics::COLUMN_COUNT;
+    QVector<int> rows;
+    rows.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        if (!std::isnan(values[row * DifferentialStatistics::COLUMN_COUNT + column])) {
+            rows.append(row);
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [&values, column] (int i, int j) {
+        return values[i * DifferentialStatistics::COLUMN_COUNT + column] < values[j * DifferentialStatistics::COLUMN_COUNT + column];
+    });
+    const int testCount = rows.size();
+    double minQValue = 1.0;
+    for (int rank = testCount; rank >= 1; --rank) {
+        const int row = rows[rank - 1];
+        const double pValue = values[row * DifferentialStatistics::COLUMN_COUNT + column];
+        minQValue = qMin(minQValue, pValue * testCount / rank);
+        values[row * DifferentialStatistics::COLUMN_COUNT + qValueColumn] = minQValue;
+    }
+}
+
+// computes the statistics of a range of rows, ranges of different tasks don't overlap
+class RowRangeComparer
+{
+public:
+    RowRangeComparer(const FeatureMatrix &matrix, const IntensityNormalization &normalization, const QVector<int> &groupBySample,
+        double *values)
+        : matrix(matrix), normalization(normalization), groupBySample(groupBySample), values(values)
+    {
+
+    }
+
+    void operator ()(int beginRow, int endRow) const
+    {
+        QVector<double> first;
+        QVector<double> second;
+        QVector<double> both;
+        for (int row = beginRow; row < endRow; ++row) {
+            first.clear();
+            second.clear();
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            for (int i = 0; i < count; ++i) {
+                const int group = groupBySample[sampleNumbers[i]];
+                const double intensity = normalization.normalize(sampleNumbers[i], intensities[i]);
+                if (intensity > 0.0 && 0 != group) {
+                    (1 == group ? first : second).append(intensity);
+                }
+            }
+
+            double *rowValues = values + row * DifferentialStatistics::COLUMN_COUNT;
+            const double firstMean = first.isEmpty() ? 0.0 : std::accumulate(first.constBegin(), first.constEnd(), 0.0) / first.size();
+            const double secondMean = second.isEmpty() ? 0.0 : std::accumulate(second.constBegin(), second.constEnd(), 0.0) / second.size();
+            rowValues[DifferentialStatistics::LOG2_FOLD_CHANGE_COLUMN] = firstMean > 0.0 && secondMean > 0.0
+                ? std::log2(secondMean / firstMean) : NOT_APPLICABLE;
+
+            both = first + second; // ranks are the same for log intensities
+            rowValues[DifferentialStatistics::MANN_WHITNEY_P_VALUE_COLUMN] = mannWhitneyPValue(both, first.size());
+
+            for (double &intensity : first) {
+                intensity = std::log2(intensity);
+            }
+            for (double &intensity : second) {
+                intensity = std::log2(intensity);
+            }
+            rowValues[DifferentialStatistics::T_TEST_P_VALUE_COLUMN] = welchTTestPValue(first, second);
+        }
+    }
+
+private:
+    const FeatureMatrix &matrix;
+    const IntensityNormalization &normalization;
+    const QVector<int> &groupBySample; // 0 if the sample isn't compared, 1 or 2 otherwise
+    double *values;
+};
+
+}
+
+DifferentialStatistics::DifferentialStatistics()
+{
+
+}
+
+DifferentialStatistics DifferentialStatistics::compute(const FeatureMatrix &matrix, const IntensityNormalization &normalization,
+    const QVector<int> &firstGroup, const QVector<int> &secondGroup, const QString &firstGroupName, const QString &secondGroupName,
+    const FeatureMatrixUtils::ProgressCallback &progress)
+{
+    DifferentialStatistics statistics;
+    statistics.firstGroup = firstGroup;
+    statistics.secondGroup = secondGroup;
+    statistics.firstGroupName = firstGroupName;
+    statistics.secondGroupName = secondGroupName;
+
+    QVector<int> groupBySample(matrix.getSampleCount(), 0);
+    foreach (int sampleNumber, firstGroup) {
+        groupBySample[sampleNumber] = 1;
+    }
+    foreach (int sampleNumber, secondGroup) {
+        groupBySample[sampleNumber] = 2;
+    }
+
+    const int rowCount = matrix.getRowCount();
+    statistics.values.fill(NOT_APPLICABLE, rowCount * COLUMN_COUNT);
+    if (!FeatureMatrixUtils::runInBlocks(rowCount, FeatureMatrixUtils::ROWS_PER_TASK,
+        RowRangeComparer(matrix, normalization, groupBySample, statistics.values.data()), progress))
+    {
+        return DifferentialStatistics();
+    }
+
+    adjustPValues(statistics.values, T_TEST_P_VALUE_COLUMN, T_TEST_Q_VALUE_COLUMN);
+    adjustPValues(statistics.values, MANN_WHITNEY_P_VALUE_COLUMN, MANN_WHITNEY_Q_VALUE_COLUMN);
+    return statistics;
+}
+
+bool DifferentialStatistics::isEmpty() const
+{
+    return values.isEmpty();
+}
+
+const QVector<int> & DifferentialStatistics::getFirstGroup() const
+{
+    return firstGroup;
+}
+
+const QVector<int> & DifferentialStatistics::getSecondGroup() const
+{
+    return secondGroup;
+}
+
+QString DifferentialStatistics::getFirstGroupName() const
+{
+    return firstGroupName;
+}
+
+QString DifferentialStatistics::getSecondGroupName() const
+{
+    return secondGroupName;
+}
+
+int DifferentialStatistics::getRowCount() const
+{
+    return values.size() / COLUMN_COUNT;
+}
+
+qreal DifferentialStatistics::getValue(int row, Column column) const
+{
+    return values[row * COLUMN_COUNT + column];
+}
+
+QString DifferentialStatistics::getColumnName(Column column) const
+{
+    switch (column) {
+        case LOG2_FOLD_CHANGE_COLUMN:
+            return tr("log2 fold change");
+        case T_TEST_P_VALUE_COLUMN:
+            return tr("t-test p-value");
+        case T_TEST_Q_VALUE_COLUMN:
+            return tr("t-test q-value");
+        case MANN_WHITNEY_P_VALUE_COLUMN:
+            return tr("Mann-Whitney p-value");
+        case MANN_WHITNEY_Q_VALUE_COLUMN:
+            return tr("Mann-Whitney q-value");
+        default:
+            Q_ASSERT(false);
+            return QString();
+    }
+}
+
+QString DifferentialStatistics::getColumnDescription(Column column) const
+{
+    const QString comparison = tr("%1 (%2 samples) vs. %3 (%4 samples)").arg(secondGroupName).arg(secondGroup.size())
+        .arg(firstGroupName).arg(firstGroup.size());
+    switch (column) {
+        case LOG2_FOLD_CHANGE_COLUMN:
+            return tr("log2 of the ratio of mean detected intensities, %1").arg(comparison);
+        case T_TEST_P_VALUE_COLUMN:
+            return tr("Welch's t-test of log2 detected intensities, %1").arg(comparison);
+        case T_TEST_Q_VALUE_COLUMN:
+            return tr("Benjamini-Hochberg adjusted t-test p-value, %1").arg(comparison);
+        case MANN_WHITNEY_P_VALUE_COLUMN:
+            return tr("Mann-Whitney U test of detected intensities, %1").arg(comparison);
+        case MANN_WHITNEY_Q_VALUE_COLUMN:
+            return tr("Benjamini-Hochberg adjusted Mann-Whitney p-value, %1").arg(comparison);
+        default:
+            Q_ASSERT(false);
+            return QString();
+    }
+}
+
+} // namespace ov
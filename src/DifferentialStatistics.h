@@ -0,0 +1,59 @@
+#ifndef DIFFERENTIAL_STATISTICS_H
+#define DIFFERENTIAL_STATISTICS_H
+
+#include <QCoreApplication>
+#include <QVector>
+
+#include "FeatureMatrixUtils.h"
+
+namespace ov {
+
+class FeatureMatrix;
+class IntensityNormalization;
+
+// Per-feature comparison of two groups of samples. Only detected intensities take part in the tests,
+// undetected features are missing values rather than zeros. Results are implicitly shared, so copies are cheap.
+class DifferentialStatistics
+{
+    Q_DECLARE_TR_FUNCTIONS(DifferentialStatistics)
+
+public:
+    enum Column {
+        LOG2_FOLD_CHANGE_COLUMN, // of mean intensities, the second group to the first one
+        T_TEST_P_VALUE_COLUMN, // Welch's t-test of log2 intensities
+        T_TEST_Q_VALUE_COLUMN, // Benjamini-Hochberg
+        MANN_WHITNEY_P_VALUE_COLUMN, // normal approximation with the tie correction
+        MANN_WHITNEY_Q_VALUE_COLUMN,
+        COLUMN_COUNT
+    };
+
+    DifferentialStatistics(); // no comparison
+
+    // slow for large tables, meant to be run on a worker thread; features are processed in parallel,
+    // normalized intensities are compared; a computation canceled by @progress returns no comparison
+    static DifferentialStatistics compute(const FeatureMatrix &matrix, const IntensityNormalization &normalization,
+        const QVector<int> &firstGroup, const QVector<int> &secondGroup, const QString &firstGroupName,
+        const QString &secondGroupName, const FeatureMatrixUtils::ProgressCallback &progress);
+
+    bool isEmpty() const;
+    const QVector<int> & getFirstGroup() const; // sample numbers
+    const QVector<int> & getSecondGroup() const;
+    QString getFirstGroupName() const;
+    QString getSecondGroupName() const;
+
+    int getRowCount() const;
+    qreal getValue(int row, Column column) const; // NaN if the test isn't applicable to the feature
+    QString getColumnName(Column column) const;
+    QString getColumnDescription(Column column) const;
+
+private:
+    QVector<int> firstGroup;
+    QVector<int> secondGroup;
+    QString firstGroupName;
+    QString secondGroupName;
+    QVector<double> values; // COLUMN_COUNT values per matrix row
+};
+
+} // namespace ov
+
+#endif // DIFFERENTIAL_STATISTICS_H
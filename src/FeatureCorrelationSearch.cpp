@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+#include "FeatureMatrixUtils.h"
+
+#include "FeatureCorrelationSearch.h"
+
+namespace ov {
+
+namespace {
+
+typedef FeatureCorrelationSearch::Match Match;
+
+bool isBetterMatch(const Match &left, const Match &right)
+{
+    return left.correlation > right.correlation || (left.correlation == right.correlation && left.row < right.row);
+}
+
+// turns rows of a block into profiles, blocks of different tasks don't overlap
+class ProfileBuilder
+{
+public:
+    ProfileBuilder(const FeatureMatrix &matrix, const IntensityNormalization &normalization, bool ranks,
+        double *deviations, double *scales)
+        : matrix(matrix), normalization(normalization), ranks(ranks), deviations(deviations), scales(scales)
+    {
+
+    }
+
+    void operator ()(int beginRow, int endRow) const
+    {
+        const int sampleCount = matrix.getSampleCount();
+        QVector<int> order;
+        for (int row = beginRow; row < endRow; ++row) {
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            double *rowDeviations = deviations + matrix.getRowOffset(row);
+            for (int i = 0; i < count; ++i) {
+                rowDeviations[i] = normalization.normalize(sampleNumbers[i], intensities[i]);
+            }
+
+            if (ranks) {
+                // undetected samples share the lowest ranks, so detected ones are ranked after them
+                order.resize(count);
+                std::iota(order.begin(), order.end(), 0);
+                std::sort(order.begin(), order.end(), [rowDeviations] (int i, int j) { return rowDeviations[i] < rowDeviations[j]; });
+                const double undetectedRank = (sampleCount - count + 1) / 2.0;
+                QVector<double> rowRanks(count);
+                for (int i = 0; i < count; ) {
+                    int tieEnd = i + 1;
+                    while (tieEnd < count && rowDeviations[order[tieEnd]] == rowDeviations[order[i]]) {
+                        ++tieEnd;
+                    }
+                    const double rank = sampleCount - count + (i + 1 + tieEnd) / 2.0;
+                    for (int j = i; j < tieEnd; ++j) {
+                        rowRanks[order[j]] = rank - undetectedRank;
+                    }
+                    i = tieEnd;
+                }
+                std::copy(rowRanks.constBegin(), rowRanks.constEnd(), rowDeviations);
+            } else {
+                for (int i = 0; i < count; ++i) {
+                    rowDeviations[i] = FeatureMatrixUtils::getLogIntensity(rowDeviations[i]);
+                }
+            }
+
+            double sum = 0.0;
+            double sumOfSquares = 0.0;
+            for (int i = 0; i < count; ++i) {
+                sum += rowDeviations[i];
+                sumOfSquares += rowDeviations[i] * rowDeviations[i];
+            }
+            const double centeredSumOfSquares = sumOfSquares - sum * sum / sampleCount;
+            scales[row] = centeredSumOfSquares > 1e-12 * qMax(1.0, sumOfSquares) ? 1.0 / std::sqrt(centeredSumOfSquares) : 0.0;
+        }
+    }
+
+private:
+    const FeatureMatrix &matrix;
+    const IntensityNormalization &normalization;
+    bool ranks;
+    double *deviations;
+    double *scales;
+};
+
+// keeps the best matches of a block of rows in a bounded heap
+class MatchCollector
+{
+public:
+    MatchCollector(const FeatureMatrix &matrix, const double *deviations, const double *scales, const double *query,
+        int queryRow, int count)
+        : matrix(matrix), deviations(deviations), scales(scales), query(query), queryRow(queryRow), count(count)
+    {
+
+    }
+
+    QVector<Match> operator ()(int beginRow, int endRow) const
+    {
+        // the top of the heap is the worst match kept so far
+        std::priority_queue<Match, std::vector<Match>, std::function<bool (const Match &, const Match &)> > heap(isBetterMatch);
+        for (int row = beginRow; row < endRow; ++row) {
+            if (row == queryRow || 0.0 == scales[row]) {
+                continue;
+            }
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int rowCount = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            const double *rowDeviations = deviations + matrix.getRowOffset(row);
+            double product = 0.0;
+            for (int i = 0; i < rowCount; ++i) {
+                product += rowDeviations[i] * query[sampleNumbers[i]];
+            }
+            const Match match = { row, product * scales[row] };
+            if (heap.size() < size_t(count)) {
+                heap.push(match);
+            } else if (isBetterMatch(match, heap.top())) {
+                heap.pop();
+                heap.push(match);
+            }
+        }
+        QVector<Match> matches;
+        matches.reserve(int(heap.size()));
+        while (!heap.empty()) {
+            matches.append(heap.top());
+            heap.pop();
+        }
+        return matches;
+    }
+
+private:
+    const FeatureMatrix &matrix;
+    const double *deviations;
+    const double *scales;
+    const double *query;
+    int queryRow;
+    int count;
+};
+
+}
+
+FeatureCorrelationSearch::FeatureCorrelationSearch()
+{
+    std::fill(prepared, prepared + METHOD_COUNT, false);
+}
+
+void FeatureCorrelationSearch::setMatrix(const FeatureMatrix &matrix, const IntensityNormalization &normalization)
+{
+    this->matrix = matrix;
+    this->normalization = normalization;
+    for (int method = 0; method < METHOD_COUNT; ++method) {
+        profiles[method] = Profiles();
+        prepared[method] = false;
+    }
+}
+
+void FeatureCorrelationSearch::prepareProfiles(Method method, Profiles &profiles) const
+{
+    const int rowCount = matrix.getRowCount();
+    profiles.deviations.resize(matrix.getIntensityCount());
+    profiles.scales.resize(rowCount);
+
+    FeatureMatrixUtils::runInBlocks(rowCount, FeatureMatrixUtils::ROWS_PER_TASK, ProfileBuilder(matrix, normalization,
+        SPEARMAN_CORRELATION == method, profiles.deviations.data(), profiles.scales.data()));
+}
+
+const FeatureCorrelationSearch::Profiles & FeatureCorrelationSearch::getProfiles(Method method)
+{
+    if (!prepared[method]) {
+        prepareProfiles(method, profiles[method]);
+        prepared[method] = true;
+    }
+    return profiles[method];
+}
+
+QVector<FeatureCorrelationSearch::Match> FeatureCorrelationSearch::findCorrelated(int row, Method method, int count)
+{
+    Q_ASSERT(0 <= row && row < matrix.getRowCount());
+    const Profiles &methodProfiles = getProfiles(method);
+    if (0.0 == methodProfiles.scales[row]) {
+        return QVector<Match>(); // a constant profile doesn't correlate with anything
+    }
+
+    // the standardized query is dense, so that every other row is multiplied by it without lookups
+    const int sampleCount = matrix.getSampleCount();
+    const int *sampleNumbers = NULL;
+    const double *intensities = NULL;
+    const int rowIntensityCount = matrix.getRowIntensities(row, sampleNumbers, intensities);
+    const double *rowDeviations = methodProfiles.deviations.constData() + matrix.getRowOffset(row);
+    const double mean = std::accumulate(rowDeviations, rowDeviations + rowIntensityCount, 0.0) / sampleCount;
+    QVector<double> query(sampleCount, -mean * methodProfiles.scales[row]);
+    for (int i = 0; i < rowIntensityCount; ++i) {
+        query[sampleNumbers[i]] = (rowDeviations[i] - mean) * methodProfiles.scales[row];
+    }
+
+    const QVector<QVector<Match> > taskMatches = FeatureMatrixUtils::mapBlocks<QVector<Match> >(matrix.getRowCount(),
+        FeatureMatrixUtils::ROWS_PER_TASK, MatchCollector(matrix, methodProfiles.deviations.constData(),
+        methodProfiles.scales.constData(), query.constData(), row, count));
+
+    QVector<Match> matches;
+    foreach (const QVector<Match> &blockMatches, taskMatches) {
+        matches += blockMatches;
+    }
+    const int resultCount = qMin(count, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + resultCount, matches.end(), isBetterMatch);
+    matches.resize(resultCount);
+    for (int i = 0; i < matches.size(); ++i) {
+        matches[i].correlation = qBound(-1.0, matches[i].correlation, 1.0); // rounding errors
+    }
+    return matches;
+}
+
+} // namespace ov
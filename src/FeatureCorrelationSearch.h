@@ -0,0 +1,56 @@
+#ifndef FEATURE_CORRELATION_SEARCH_H
+#define FEATURE_CORRELATION_SEARCH_H
+
+#include <QVector>
+
+#include "FeatureMatrix.h"
+#include "IntensityNormalization.h"
+
+namespace ov {
+
+// Finds features whose intensity profiles across all samples correlate best with the profile of a given one.
+// A profile is a sparse row where every undetected sample has the same base value (0 for log intensities,
+// the mean of tied ranks for Spearman), so standardized profiles are kept as deviations from the base at
+// detected samples only and a correlation costs as many multiplications as the row has detected samples.
+class FeatureCorrelationSearch
+{
+public:
+    enum Method {
+        PEARSON_CORRELATION, // of log2(1 + intensity)
+        SPEARMAN_CORRELATION,
+        METHOD_COUNT
+    };
+
+    struct Match
+    {
+        int row;
+        qreal correlation;
+    };
+
+    FeatureCorrelationSearch();
+
+    // profiles are prepared again on the next search
+    void setMatrix(const FeatureMatrix &matrix, const IntensityNormalization &normalization);
+
+    // @count best matches sorted by decreasing correlation, the feature itself isn't included
+    QVector<Match> findCorrelated(int row, Method method, int count);
+
+private:
+    struct Profiles
+    {
+        QVector<double> deviations; // value minus the base value of the row, parallel to intensities of the matrix
+        QVector<double> scales; // 1 / norm of the centered row, 0 for constant rows
+    };
+
+    const Profiles & getProfiles(Method method);
+    void prepareProfiles(Method method, Profiles &profiles) const;
+
+    FeatureMatrix matrix;
+    IntensityNormalization normalization;
+    Profiles profiles[METHOD_COUNT];
+    bool prepared[METHOD_COUNT];
+};
+
+} // namespace ov
+
+#endif // FEATURE_CORRELATION_SEARCH_H
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <functional>
 
+#include <QVector>
+
 #include "FeatureData.h"
 
 
@@ -50,6 +53,35 @@ QList<QPointF> FeatureData::getXic() const
     return projectMassTraces2D(massTraces, [] (const QVector3D &p) { return QPointF(p.y(), p.z()); });
 }
 
+QByteArray FeatureData::getXicSparkline(int pointCount) const
+{
+    Q_ASSERT(pointCount > 0);
+    QVector<qreal> bins(pointCount, 0.0);
+    const QList<QPointF> xic = getXic();
+    if (!xic.isEmpty()) {
+        qreal rtStart = xic.first().x();
+        qreal rtEnd = rtStart;
+        foreach (const QPointF &point, xic) {
+            rtStart = qMin(rtStart, point.x());
+            rtEnd = qMax(rtEnd, point.x());
+        }
+        const qreal rtRange = rtEnd - rtStart;
+        foreach (const QPointF &point, xic) {
+            const int bin = rtRange > 0.0 ? qMin(int((point.x() - rtStart) / rtRange * pointCount), pointCount - 1) : 0;
+            bins[bin] = qMax(bins[bin], point.y());
+        }
+    }
+
+    const qreal maxIntensity = *std::max_element(bins.constBegin(), bins.constEnd());
+    QByteArray result(pointCount, 0);
+    if (maxIntensity > 0.0) {
+        for (int i = 0; i < pointCount; ++i) {
+            result[i] = char(qRound(bins[i] / maxIntensity * 255));
+        }
+    }
+    return result;
+}
+
 QList<QPointF> FeatureData::getMassPeaks() const
 {
     QList<QList<QVector3D> > reducedMassTraces;
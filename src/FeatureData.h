@@ -14,6 +14,8 @@ struct FeatureData {
 
     QList<QPointF> getXic() const; // Point: (RT, intensity)
     QList<QPointF> getMassPeaks() const; // Point: (mz, intensity)
+    // maximum XIC intensity in each of @pointCount equal RT bins, scaled to 0-255 relative to the highest one
+    QByteArray getXicSparkline(int pointCount) const;
 
     SampleId sampleId;
     FeatureId featureId;
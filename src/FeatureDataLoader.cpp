@@ -0,0 +1,237 @@
+#include <QDataStream>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+
+#include "FeatureDataLoader.h"
+
+namespace ov {
+
+const int FeatureDataLoader::QUERY_PARAMS_LIMIT = 999;
+const int FeatureDataLoader::SPARKLINE_POINT_COUNT = 32;
+
+const int SPARKLINE_CHUNK_SIZE = 100; // features per query, results are emitted after each chunk
+
+FeatureDataLoader::FeatureDataLoader()
+    : lastFeaturePrefetchId(0), lastMs2SpectraPrefetchId(0), connectionName(QString("ov_loader_%1").arg(reinterpret_cast<quintptr>(this)))
+{
+
+}
+
+FeatureDataLoader::~FeatureDataLoader()
+{
+    if (QSqlDatabase::contains(connectionName)) {
+        QSqlDatabase::database(connectionName, false).close();
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+}
+
+int FeatureDataLoader::startFeaturePrefetch()
+{
+    return lastFeaturePrefetchId.fetchAndAddOrdered(1) + 1;
+}
+
+int FeatureDataLoader::startMs2SpectraPrefetch()
+{
+    return lastMs2SpectraPrefetchId.fetchAndAddOrdered(1) + 1;
+}
+
+namespace {
+
+QList<QVector3D> decodeMassTrace(QByteArray massTraceData)
+{
+    QDataStream binaryStream(&massTraceData, QIODevice::ReadOnly);
+    binaryStream.setByteOrder(QDataStream::LittleEndian);
+    QList<QVector3D> massTrace;
+    while (!binaryStream.atEnd()) {
+        double mz = 0.0;
+        float rt = 0.0;
+        float intensity = 0.0;
+        int bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&mz), sizeof(mz));
+        Q_ASSERT(bytesRead == sizeof(mz));
+        bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&rt), sizeof(rt));
+        Q_ASSERT(bytesRead == sizeof(rt));
+        bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&intensity), sizeof(intensity));
+        Q_ASSERT(bytesRead == sizeof(intensity));
+        massTrace.append(QVector3D(mz, rt, intensity));
+    }
+    return massTrace;
+}
+
+QList<QPointF> decodeSpectrum(QByteArray spectrumData)
+{
+    QDataStream binaryStream(&spectrumData, QIODevice::ReadOnly);
+    binaryStream.setByteOrder(QDataStream::LittleEndian);
+    QList<QPointF> spectrum;
+    while (!binaryStream.atEnd()) {
+        double mz = 0.0;
+        float intensity = 0.0;
+        int bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&mz), sizeof(mz));
+        Q_ASSERT(bytesRead == sizeof(mz));
+        bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&intensity), sizeof(intensity));
+        Q_ASSERT(bytesRead == sizeof(intensity));
+        spectrum.append(QPointF(mz, intensity));
+    }
+    return spectrum;
+}
+
+}
+
+void FeatureDataLoader::fetchFeatures(const QSqlDatabase &db, const SampleFeatureIds &featureIdsToExtract,
+    QHash<SampleId, QHash<FeatureId, FeatureData> > &features)
+{
+    QList<QPair<SampleId, FeatureId> > pairsToExtract;
+    foreach (const SampleId &sampleId, featureIdsToExtract.uniqueKeys()) {
+        foreach (const FeatureId &featureId, featureIdsToExtract.values(sampleId)) {
+            pairsToExtract.append(QPair<SampleId, FeatureId>(sampleId, featureId));
+        }
+    }
+
+    // Limit on number of SQLite query parameters: two parameters per feature
+    const int pairsPerQuery = QUERY_PARAMS_LIMIT / 2;
+    for (int chunkStart = 0; chunkStart < pairsToExtract.size(); chunkStart += pairsPerQuery) {
+        const int chunkEnd = qMin(chunkStart + pairsPerQuery, pairsToExtract.size());
+
+        QString queryStr = "SELECT sample_id, feature_id, data, rt_start, rt_end FROM FeatureMassTrace WHERE ";
+        const QString queryConjunction = " OR ";
+        for (int i = chunkStart; i < chunkEnd; ++i) {
+            queryStr.append("(sample_id = ? AND feature_id = ?)");
+            queryStr.append(queryConjunction);
+        }
+        queryStr.chop(queryConjunction.length());
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare(queryStr);
+        for (int i = chunkStart; i < chunkEnd; ++i) {
+            query.addBindValue(pairsToExtract[i].first);
+            query.addBindValue(pairsToExtract[i].second);
+        }
+        const bool ok = query.exec();
+        Q_ASSERT(ok);
+
+        while (query.next()) {
+            const SampleId sampleId = query.value(0).value<SampleId>();
+            const SampleId featureId = query.value(1).value<FeatureId>();
+            const QList<QVector3D> massTrace = decodeMassTrace(query.value(2).toByteArray());
+            const qreal massTraceStart = query.value(3).toReal();
+            const qreal massTraceEnd = query.value(4).toReal();
+
+            if (!features.contains(sampleId) || !features[sampleId].contains(featureId)) {
+                features[sampleId][featureId] = FeatureData(sampleId, featureId, QList<QList<QVector3D> >() << massTrace, massTraceStart, massTraceEnd);
+            } else {
+                FeatureData &feature = features[sampleId][featureId];
+                feature.massTraces.append(massTrace);
+                feature.featureStart = qMin(feature.featureStart, massTraceStart);
+                feature.featureEnd = qMax(feature.featureEnd, massTraceEnd);
+            }
+        }
+    }
+}
+
+Ms2SpectraById FeatureDataLoader::fetchMs2Spectra(const QSqlDatabase &db, const SpectrumIdList &spectrumIds)
+{
+    Ms2SpectraById result;
+
+    for (int chunkStart = 0; chunkStart < spectrumIds.size(); chunkStart += QUERY_PARAMS_LIMIT) {
+        const SpectrumIdList chunk = spectrumIds.mid(chunkStart, QUERY_PARAMS_LIMIT);
+        const QString queryStr = QString("SELECT FS.id, FS.data FROM FragmentationSpectrum AS FS WHERE FS.id IN (%1)").arg(QStringList(QVector<QString>(chunk.size(), "?").toList()).join(","));
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare(queryStr);
+        foreach (const FragmentationSpectrumId &value, chunk) {
+            query.addBindValue(value);
+        }
+        const bool ok = query.exec();
+        Q_ASSERT(ok);
+
+        while (query.next()) {
+            result[query.value(0).value<FragmentationSpectrumId>()] = decodeSpectrum(query.value(1).toByteArray());
+        }
+    }
+    return result;
+}
+
+void FeatureDataLoader::setDataSource(const DataSourceId &dataSourceId)
+{
+    QSqlDatabase db = QSqlDatabase::contains(connectionName) ? QSqlDatabase::database(connectionName, false)
+        : QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    if (db.isOpen()) {
+        db.close();
+    }
+    db.setDatabaseName(dataSourceId);
+    db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    db.open();
+}
+
+void FeatureDataLoader::prefetchFeatures(int prefetchId, const SampleFeatureIds &featuresBySample)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    if (!db.isOpen() || prefetchId != lastFeaturePrefetchId.load()) {
+        return;
+    }
+
+    // fetch feature by feature so that an outdated request can be abandoned quickly
+    FeatureDataList result;
+    SampleFeatureIds::const_iterator it = featuresBySample.constBegin();
+    for (; it != featuresBySample.constEnd() && prefetchId == lastFeaturePrefetchId.load(); ++it) {
+        SampleFeatureIds single;
+        single.insert(it.key(), it.value());
+        QHash<SampleId, QHash<FeatureId, FeatureData> > features;
+        fetchFeatures(db, single, features);
+        if (features.contains(it.key()) && features[it.key()].contains(it.value())) {
+            result.append(features[it.key()][it.value()]);
+        }
+    }
+    if (!result.isEmpty()) {
+        emit featuresPrefetched(db.databaseName(), result);
+    }
+}
+
+void FeatureDataLoader::prefetchMs2Spectra(int prefetchId, const SpectrumIdList &spectrumIds)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    if (!db.isOpen() || prefetchId != lastMs2SpectraPrefetchId.load() || spectrumIds.isEmpty()) {
+        return;
+    }
+    emit ms2SpectraPrefetched(db.databaseName(), fetchMs2Spectra(db, spectrumIds));
+}
+
+void FeatureDataLoader::loadMs2Spectra(int requestId, const SpectrumIdList &spectrumIds)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    emit ms2SpectraLoaded(db.databaseName(), requestId, db.isOpen() ? fetchMs2Spectra(db, spectrumIds) : Ms2SpectraById());
+}
+
+void FeatureDataLoader::loadSparklines(const SampleFeatureIds &featuresBySample)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    if (!db.isOpen()) {
+        return;
+    }
+
+    SampleFeatureIds chunk;
+    SampleFeatureIds::const_iterator it = featuresBySample.constBegin();
+    while (it != featuresBySample.constEnd()) {
+        chunk.insert(it.key(), it.value());
+        ++it;
+        if (chunk.size() < SPARKLINE_CHUNK_SIZE && it != featuresBySample.constEnd()) {
+            continue;
+        }
+
+        QHash<SampleId, QHash<FeatureId, FeatureData> > features;
+        fetchFeatures(db, chunk, features);
+        SparklinesByFeature sparklines;
+        SampleFeatureIds::const_iterator chunkIt = chunk.constBegin();
+        for (; chunkIt != chunk.constEnd(); ++chunkIt) {
+            // features without mass traces get a flat profile, so that they aren't requested again
+            const FeatureData feature = features.value(chunkIt.key()).value(chunkIt.value());
+            sparklines.insert(SampleFeatureKey(chunkIt.key(), chunkIt.value()), feature.getXicSparkline(SPARKLINE_POINT_COUNT));
+        }
+        emit sparklinesLoaded(db.databaseName(), sparklines);
+        chunk.clear();
+    }
+}
+
+} // namespace ov
@@ -0,0 +1,67 @@
+#ifndef FEATURE_DATA_LOADER_H
+#define FEATURE_DATA_LOADER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMultiHash>
+#include <QObject>
+#include <QPointF>
+#include <QSqlDatabase>
+
+#include "FeatureData.h"
+
+namespace ov {
+
+typedef QMultiHash<SampleId, FeatureId> SampleFeatureIds;
+typedef QList<FeatureData> FeatureDataList;
+typedef QList<FragmentationSpectrumId> SpectrumIdList;
+typedef QHash<FragmentationSpectrumId, QList<QPointF> > Ms2SpectraById; // Point: (mz, intensity)
+typedef QPair<SampleId, FeatureId> SampleFeatureKey;
+typedef QHash<SampleFeatureKey, QByteArray> SparklinesByFeature;
+
+// Reads and decodes mass traces and fragmentation spectra. Static methods work on any connection,
+// slots are meant to be called via queued connections when the loader lives in a background thread
+// and use a connection of its own.
+class FeatureDataLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    FeatureDataLoader();
+    ~FeatureDataLoader();
+
+    int startFeaturePrefetch();
+    int startMs2SpectraPrefetch();
+
+    static void fetchFeatures(const QSqlDatabase &db, const SampleFeatureIds &featureIdsToExtract,
+        QHash<SampleId, QHash<FeatureId, FeatureData> > &features);
+    static Ms2SpectraById fetchMs2Spectra(const QSqlDatabase &db, const SpectrumIdList &spectrumIds);
+
+    static const int QUERY_PARAMS_LIMIT;
+    static const int SPARKLINE_POINT_COUNT;
+
+signals:
+    void featuresPrefetched(const DataSourceId &dataSourceId, const FeatureDataList &features);
+    void ms2SpectraPrefetched(const DataSourceId &dataSourceId, const Ms2SpectraById &spectra);
+    void ms2SpectraLoaded(const DataSourceId &dataSourceId, int requestId, const Ms2SpectraById &spectra);
+    void sparklinesLoaded(const DataSourceId &dataSourceId, const SparklinesByFeature &sparklines);
+
+public slots:
+    void setDataSource(const DataSourceId &dataSourceId);
+    void prefetchFeatures(int prefetchId, const SampleFeatureIds &featuresBySample);
+    void prefetchMs2Spectra(int prefetchId, const SpectrumIdList &spectrumIds);
+    void loadMs2Spectra(int requestId, const SpectrumIdList &spectrumIds);
+    void loadSparklines(const SampleFeatureIds &featuresBySample);
+
+private:
+    QAtomicInt lastFeaturePrefetchId;
+    QAtomicInt lastMs2SpectraPrefetchId;
+    QString connectionName;
+};
+
+} // namespace ov
+
+Q_DECLARE_METATYPE(ov::FeatureData)
+Q_DECLARE_METATYPE(ov::SampleFeatureIds) // QList and QHash of meta types are registered by Qt automatically
+
+#endif // FEATURE_DATA_LOADER_H
@@ -1,7 +1,6 @@
 #include <math.h>
 
 #include <QApplication>
-#include <QDataStream>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QSqlQuery>
@@ -9,13 +8,67 @@
 
 #include "FeatureDataSource.h"
 
-const int QUERY_PARAMS_LIMIT = 999;
+const int FEATURE_CACHE_SIZE = 2000;
+const int MS2_SPECTRA_CACHE_SIZE = 1000;
 
 namespace ov {
 
 FeatureDataSource::FeatureDataSource()
+    : featureCache(FEATURE_CACHE_SIZE), ms2SpectraCache(MS2_SPECTRA_CACHE_SIZE), lastMs2SpectraRequestId(0),
+    prefetchLoader(NULL), requestLoader(NULL)
 {
     db = QSqlDatabase::addDatabase("QSQLITE");
+    initLoaders();
+}
+
+FeatureDataSource::~FeatureDataSource()
+{
+    prefetchThread.quit();
+    requestThread.quit();
+    prefetchThread.wait();
+    requestThread.wait();
+}
+
+void FeatureDataSource::initLoaders()
+{
+    // speculative reads go to a low priority thread so that they never delay explicit requests
+    prefetchLoader = new FeatureDataLoader;
+    prefetchLoader->moveToThread(&prefetchThread);
+    connect(&prefetchThread, &QThread::finished, prefetchLoader, &QObject::deleteLater);
+
+    connect(this, &FeatureDataSource::loaderDataSourceChanged, prefetchLoader, &FeatureDataLoader::setDataSource);
+    connect(this, &FeatureDataSource::featurePrefetchRequested, prefetchLoader, &FeatureDataLoader::prefetchFeatures);
+    connect(this, &FeatureDataSource::ms2SpectraPrefetchRequested, prefetchLoader, &FeatureDataLoader::prefetchMs2Spectra);
+    connect(prefetchLoader, &FeatureDataLoader::featuresPrefetched, this, &FeatureDataSource::featuresPrefetched);
+    connect(prefetchLoader, &FeatureDataLoader::ms2SpectraPrefetched, this, &FeatureDataSource::ms2SpectraPrefetched);
+
+    requestLoader = new FeatureDataLoader;
+    requestLoader->moveToThread(&requestThread);
+    connect(&requestThread, &QThread::finished, requestLoader, &QObject::deleteLater);
+
+    connect(this, &FeatureDataSource::loaderDataSourceChanged, requestLoader, &FeatureDataLoader::setDataSource);
+    connect(this, &FeatureDataSource::ms2SpectraLoadRequested, requestLoader, &FeatureDataLoader::loadMs2Spectra);
+    connect(requestLoader, &FeatureDataLoader::ms2SpectraLoaded, this, &FeatureDataSource::ms2SpectraLoaded);
+
+    prefetchThread.start(QThread::LowPriority);
+    requestThread.start();
+}
+
+void FeatureDataSource::clearCaches()
+{
+    currentFeatures.clear();
+    featureCache.clear();
+    ms2SpectraCache.clear();
+    pendingMs2SpectraRequests.clear();
+}
+
+void FeatureDataSource::cacheMs2Spectra(const Ms2SpectraById &spectra)
+{
+    foreach (const FragmentationSpectrumId &spectrumId, spectra.keys()) {
+        if (!ms2SpectraCache.contains(spectrumId)) {
+            ms2SpectraCache.insert(spectrumId, new QList<QPointF>(spectra[spectrumId]));
+        }
+    }
 }
 
 bool FeatureDataSource::isValid() const
@@ -24,14 +77,14 @@ bool FeatureDataSource::isValid() const
 }
 
 QMultiHash<SampleId, FeatureId> FeatureDataSource::getFeaturesToExtract(const QMultiHash<SampleId, FeatureId> &featuresBySample,
-    QHash<SampleId, QHash<FeatureId, FeatureData> > &presentFeatures, QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > &presentMs2Scans)
+    QHash<SampleId, QHash<FeatureId, FeatureData> > &presentFeatures)
 {
     QMultiHash<SampleId, FeatureId> featuresToExtract;
     foreach(const SampleId &sampleId, featuresBySample.uniqueKeys()) {
         foreach(const FeatureId &featureId, featuresBySample.values(sampleId)) {
-            if (currentFeatures.contains(sampleId) && currentFeatures[sampleId].contains(featureId)) {
-                presentFeatures[sampleId].insert(featureId, currentFeatures[sampleId][featureId]);
-                presentMs2Scans[sampleId].insert(featureId, currentMs2Scans[sampleId][featureId]);
+            const FeatureData *cachedFeature = featureCache.object(FeatureKey(sampleId, featureId));
+            if (NULL != cachedFeature) {
+                presentFeatures[sampleId].insert(featureId, *cachedFeature);
             } else {
                 featuresToExtract.insert(sampleId, featureId);
             }
@@ -40,132 +93,64 @@ QMultiHash<SampleId, FeatureId> FeatureDataSource::getFeaturesToExtract(const QM
     return featuresToExtract;
 }
 
-void FeatureDataSource::fetchFeatures(const QMultiHash<SampleId, FeatureId> &featureIdsToExtract, QHash<SampleId, QHash<FeatureId, FeatureData> > &features)
-{
-    if (featureIdsToExtract.isEmpty()) {
-        return;
-    }
-
-    QString queryStr = "SELECT sample_id, feature_id, data, rt_start, rt_end FROM FeatureMassTrace WHERE ";
-    QVariantList bindParameters;
-    const QString queryConjunction = " OR ";
-    foreach(const SampleId &sampleId, featureIdsToExtract.uniqueKeys()) {
-        foreach(const FeatureId &featureId, featureIdsToExtract.values(sampleId)) {
-            queryStr.append("(sample_id = ? AND feature_id = ?)");
-            bindParameters.append(sampleId);
-            bindParameters.append(featureId);
-            queryStr.append(queryConjunction);
-        }
-    }
-    queryStr.chop(queryConjunction.length());
-
-    QSqlQuery query;
-    query.prepare(queryStr);
-    foreach(const QVariant &value, bindParameters) {
-        query.addBindValue(value);
-    }
-    const bool ok = query.exec();
-    Q_ASSERT(ok);
-
-    while (query.next()) {
-        const SampleId sampleId = query.value(0).value<SampleId>();
-        const SampleId featureId = query.value(1).value<FeatureId>();
-        QByteArray massTraceData = query.value(2).toByteArray();
-        QDataStream binaryStream(&massTraceData, QIODevice::ReadOnly);
-        binaryStream.setByteOrder(QDataStream::LittleEndian);
-        QList<QVector3D> massTrace;
-        while (!binaryStream.atEnd()) {
-            double mz = 0.0;
-            float rt = 0.0;
-            float intensity = 0.0;
-            int bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&mz), sizeof(mz));
-            Q_ASSERT(bytesRead == sizeof(mz));
-            bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&rt), sizeof(rt));
-            Q_ASSERT(bytesRead == sizeof(rt));
-            bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&intensity), sizeof(intensity));
-            Q_ASSERT(bytesRead == sizeof(intensity));
-            massTrace.append(QVector3D(mz, rt, intensity));
-        }
-        const qreal massTraceStart = query.value(3).toReal();
-        const qreal massTraceEnd = query.value(4).toReal();
-
-        if (!features.contains(sampleId) || !features[sampleId].contains(featureId)) {
-            features[sampleId][featureId] = FeatureData(sampleId, featureId, QList<QList<QVector3D> >() << massTrace, massTraceStart, massTraceEnd);
-        } else {
-            FeatureData &feature = features[sampleId][featureId];
-            feature.massTraces.append(massTrace);
-            feature.featureStart = qMin(feature.featureStart, massTraceStart);
-            feature.featureEnd = qMax(feature.featureEnd, massTraceEnd);
-        }
-    }
-}
-
-void FeatureDataSource::fetchMs2Scans(const QMultiHash<SampleId, FeatureId> &featuresToExtract, QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > &ms2Scans)
+void FeatureDataSource::cacheFeatures(const QHash<SampleId, QHash<FeatureId, FeatureData> > &features)
 {
-    if (featuresToExtract.isEmpty()) {
-        return;
-    }
-
-    QString queryStr = "SELECT FMT.sample_id, FMT.feature_id, FS.scan_time, FS.precursor_mz, FS.precursor_intensity, FS.id "
-        "FROM FeatureMassTrace AS FMT, MassTraceFragmentationSpectrum AS MSFS, FragmentationSpectrum AS FS "
-        "WHERE FMT.id = MSFS.mt_id AND MSFS.spectrum_id = FS.id AND (";
-    QVariantList bindParameters;
-    const QString queryConjunction = " OR ";
-    foreach(const SampleId &sampleId, featuresToExtract.uniqueKeys()) {
-        foreach(const FeatureId &featureId, featuresToExtract.values(sampleId)) {
-            queryStr.append("(FMT.sample_id = ? AND FMT.feature_id = ?)");
-            bindParameters.append(sampleId);
-            bindParameters.append(featureId);
-            queryStr.append(queryConjunction);
+    foreach (const SampleId &sampleId, features.keys()) {
+        const QHash<FeatureId, FeatureData> &sampleFeatures = features[sampleId];
+        foreach (const FeatureId &featureId, sampleFeatures.keys()) {
+            featureCache.insert(FeatureKey(sampleId, featureId), new FeatureData(sampleFeatures[featureId]));
         }
     }
-    queryStr.chop(queryConjunction.length());
-    queryStr.append(") ORDER BY FS.scan_time");
-
-    QSqlQuery query;
-    query.prepare(queryStr);
-    foreach(const QVariant &value, bindParameters) {
-        query.addBindValue(value);
-    }
-    const bool ok = query.exec();
-    Q_ASSERT(ok);
-
-    while (query.next()) {
-        const SampleId sampleId = query.value(0).value<SampleId>();
-        const SampleId featureId = query.value(1).value<FeatureId>();
-        ms2Scans[sampleId][featureId].append(Ms2ScanInfo(query.value(2).toReal(), query.value(3).toReal(),
-            query.value(4).toReal(), query.value(5).value<FragmentationSpectrumId>()));
-    }
 }
 
 bool FeatureDataSource::setActiveFeatures(const QMultiHash<SampleId, FeatureId> &featuresBySample)
 {
     currentFeatures.clear();
-    currentMs2Scans.clear();
 
     if (featuresBySample.isEmpty()) {
         return true;
     }
 
-    // Limit on number of SQLite query parameters
-    // TODO: consider splitting the query into multiple ones.
-    if (featuresBySample.values().size() * 2 > QUERY_PARAMS_LIMIT) {
+    // Queries are split by the loader, but charts become unresponsive with too many graphs
+    if (featuresBySample.values().size() * 2 > FeatureDataLoader::QUERY_PARAMS_LIMIT) {
         return false;
     }
 
     QHash<SampleId, QHash<FeatureId, FeatureData> > newFeatures;
-    QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > newMs2Scans;
-    const QMultiHash<SampleId, FeatureId> featuresToExtract = getFeaturesToExtract(featuresBySample, newFeatures, newMs2Scans);
+    const QMultiHash<SampleId, FeatureId> featuresToExtract = getFeaturesToExtract(featuresBySample, newFeatures);
 
-    fetchFeatures(featuresToExtract, newFeatures);
+    QHash<SampleId, QHash<FeatureId, FeatureData> > fetchedFeatures;
+    FeatureDataLoader::fetchFeatures(db, featuresToExtract, fetchedFeatures);
+    cacheFeatures(fetchedFeatures);
+    foreach (const SampleId &sampleId, fetchedFeatures.keys()) {
+        newFeatures[sampleId].unite(fetchedFeatures[sampleId]);
+    }
     currentFeatures = newFeatures;
 
-    fetchMs2Scans(featuresToExtract, newMs2Scans);
-    currentMs2Scans = newMs2Scans;
-
     return true;
 }
 
+FeatureDataList FeatureDataSource::getFeatures(const QMultiHash<SampleId, FeatureId> &featuresBySample)
+{
+    Q_ASSERT(isValid());
+    QHash<SampleId, QHash<FeatureId, FeatureData> > features;
+    const QMultiHash<SampleId, FeatureId> featuresToExtract = getFeaturesToExtract(featuresBySample, features);
+
+    // unlike setActiveFeatures() the number of features isn't limited, the loader splits queries by itself
+    QHash<SampleId, QHash<FeatureId, FeatureData> > fetchedFeatures;
+    FeatureDataLoader::fetchFeatures(db, featuresToExtract, fetchedFeatures);
+    cacheFeatures(fetchedFeatures);
+
+    FeatureDataList result;
+    foreach (const SampleId &sampleId, features.keys()) {
+        result.append(features[sampleId].values());
+    }
+    foreach (const SampleId &sampleId, fetchedFeatures.keys()) {
+        result.append(fetchedFeatures[sampleId].values());
+    }
+    return result;
+}
+
 QList<FeatureData> FeatureDataSource::getMs1Data() const
 {
     QList<FeatureData> result;
@@ -175,49 +160,132 @@ QList<FeatureData> FeatureDataSource::getMs1Data() const
     return result;
 }
 
-QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > FeatureDataSource::getMs2ScanData() const
+const Ms2ScanTable & FeatureDataSource::getMs2ScanTable() const
+{
+    Q_ASSERT(isValid());
+    return ms2ScanTable;
+}
+
+const AnnotationIndex & FeatureDataSource::getAnnotationIndex() const
 {
     Q_ASSERT(isValid());
-    return currentMs2Scans;
+    return annotationIndex;
 }
 
-QHash<FragmentationSpectrumId, QList<QPointF> > FeatureDataSource::getMs2SpectraData(const QList<FragmentationSpectrumId> &spectrumIds) const
+Ms2SpectraById FeatureDataSource::getMs2SpectraData(const QList<FragmentationSpectrumId> &spectrumIds)
 {
     Q_ASSERT(isValid());
-    QHash<FragmentationSpectrumId, QList<QPointF> > result;
+    Ms2SpectraById result;
 
-    if (spectrumIds.size() > QUERY_PARAMS_LIMIT) {
-        return result;
+    SpectrumIdList spectraToExtract;
+    foreach (const FragmentationSpectrumId &spectrumId, spectrumIds) {
+        const QList<QPointF> *cachedSpectrum = ms2SpectraCache.object(spectrumId);
+        if (NULL != cachedSpectrum) {
+            result[spectrumId] = *cachedSpectrum;
+        } else {
+            spectraToExtract.append(spectrumId);
+        }
     }
 
-    const QString queryStr = QString("SELECT FS.id, FS.data FROM FragmentationSpectrum AS FS WHERE FS.id IN (%1)").arg(QStringList(QVector<QString>(spectrumIds.size(), "?").toList()).join(","));
+    const Ms2SpectraById fetchedSpectra = FeatureDataLoader::fetchMs2Spectra(db, spectraToExtract);
+    cacheMs2Spectra(fetchedSpectra);
+    result.unite(fetchedSpectra);
+    return result;
+}
 
-    QSqlQuery query;
-    query.prepare(queryStr);
-    foreach(const FragmentationSpectrumId &value, spectrumIds) {
-        query.addBindValue(value);
+int FeatureDataSource::requestMs2SpectraData(const QList<FragmentationSpectrumId> &spectrumIds)
+{
+    const int requestId = ++lastMs2SpectraRequestId;
+
+    Ms2SpectraById cachedSpectra;
+    SpectrumIdList spectraToExtract;
+    foreach (const FragmentationSpectrumId &spectrumId, spectrumIds) {
+        const QList<QPointF> *cachedSpectrum = ms2SpectraCache.object(spectrumId);
+        if (NULL != cachedSpectrum) {
+            cachedSpectra[spectrumId] = *cachedSpectrum;
+        } else {
+            spectraToExtract.append(spectrumId);
+        }
     }
-    const bool ok = query.exec();
-    Q_ASSERT(ok);
+    pendingMs2SpectraRequests[requestId] = cachedSpectra;
+
+    if (spectraToExtract.isEmpty() || !isValid()) {
+        // the result is delivered asynchronously anyway, so that the caller knows the request id in advance
+        QMetaObject::invokeMethod(this, "finishMs2SpectraRequest", Qt::QueuedConnection, Q_ARG(int, requestId));
+    } else {
+        emit ms2SpectraLoadRequested(requestId, spectraToExtract);
+    }
+    return requestId;
+}
+
+void FeatureDataSource::ms2SpectraLoaded(const DataSourceId &dataSourceId, int requestId, const Ms2SpectraById &spectra)
+{
+    if (dataSourceId != currentDataSourceId() || !pendingMs2SpectraRequests.contains(requestId)) {
+        return;
+    }
+    cacheMs2Spectra(spectra);
+    pendingMs2SpectraRequests[requestId].unite(spectra);
+    finishMs2SpectraRequest(requestId);
+}
 
-    while (query.next()) {
-        const FragmentationSpectrumId spectrumId = query.value(0).value<FragmentationSpectrumId>();
-        QByteArray spectrumData = query.value(1).toByteArray();
-        QDataStream binaryStream(&spectrumData, QIODevice::ReadOnly);
-        binaryStream.setByteOrder(QDataStream::LittleEndian);
-        QList<QPointF> spectrum;
-        while (!binaryStream.atEnd()) {
-            double mz = 0.0;
-            float intensity = 0.0;
-            int bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&mz), sizeof(mz));
-            Q_ASSERT(bytesRead == sizeof(mz));
-            bytesRead = binaryStream.readRawData(reinterpret_cast<char *>(&intensity), sizeof(intensity));
-            Q_ASSERT(bytesRead == sizeof(intensity));
-            spectrum.append(QPointF(mz, intensity));
+void FeatureDataSource::finishMs2SpectraRequest(int requestId)
+{
+    if (pendingMs2SpectraRequests.contains(requestId)) {
+        emit ms2SpectraDataReady(requestId, pendingMs2SpectraRequests.take(requestId));
+    }
+}
+
+void FeatureDataSource::prefetchFeatures(const QMultiHash<SampleId, FeatureId> &featuresBySample)
+{
+    if (!isValid()) {
+        return;
+    }
+
+    SampleFeatureIds featuresToPrefetch;
+    QMultiHash<SampleId, FeatureId>::const_iterator it = featuresBySample.constBegin();
+    for (; it != featuresBySample.constEnd(); ++it) {
+        if (!featureCache.contains(FeatureKey(it.key(), it.value()))) {
+            featuresToPrefetch.insert(it.key(), it.value());
         }
-        result[spectrumId] = spectrum;
     }
-    return result;
+    // a new request always supersedes the previous one even if there is nothing to prefetch
+    emit featurePrefetchRequested(prefetchLoader->startFeaturePrefetch(), featuresToPrefetch);
+}
+
+void FeatureDataSource::prefetchMs2Spectra(const QList<FragmentationSpectrumId> &spectrumIds)
+{
+    if (!isValid()) {
+        return;
+    }
+
+    SpectrumIdList spectraToPrefetch;
+    foreach (const FragmentationSpectrumId &spectrumId, spectrumIds) {
+        if (!ms2SpectraCache.contains(spectrumId)) {
+            spectraToPrefetch.append(spectrumId);
+        }
+    }
+    emit ms2SpectraPrefetchRequested(prefetchLoader->startMs2SpectraPrefetch(), spectraToPrefetch);
+}
+
+void FeatureDataSource::featuresPrefetched(const DataSourceId &dataSourceId, const FeatureDataList &features)
+{
+    if (dataSourceId != currentDataSourceId()) {
+        return; // the data source was changed while the request was processed
+    }
+    foreach (const FeatureData &feature, features) {
+        const FeatureKey key(feature.sampleId, feature.featureId);
+        if (!featureCache.contains(key)) {
+            featureCache.insert(key, new FeatureData(feature));
+        }
+    }
+}
+
+void FeatureDataSource::ms2SpectraPrefetched(const DataSourceId &dataSourceId, const Ms2SpectraById &spectra)
+{
+    if (dataSourceId != currentDataSourceId()) {
+        return;
+    }
+    cacheMs2Spectra(spectra);
 }
 
 void FeatureDataSource::selectDataSource()
@@ -225,14 +293,30 @@ void FeatureDataSource::selectDataSource()
     DataSourceId dataSourceId = QFileDialog::getOpenFileName(QApplication::activeWindow(), QObject::tr("Open File"), QString(), getInputFileFilter());
     if (dataSourceId.isEmpty()) {
         return;
-    } else if (setDataSource(dataSourceId)) {
-        updateSamplesInfo();
-        updateFeaturesInfo();
-        currentFeatures.clear();
-        emit samplesChanged();
+    }
+    QString errorMessage;
+    if (!openDataSource(dataSourceId, errorMessage)) {
+        QMessageBox::critical(QApplication::activeWindow(), tr("Error"), errorMessage);
     }
 }
 
+bool FeatureDataSource::openDataSource(const DataSourceId &dataSourceId, QString &errorMessage)
+{
+    if (!setDataSource(dataSourceId, errorMessage)) {
+        return false;
+    }
+    updateSamplesInfo();
+    updateFeaturesInfo();
+    featureMatrix.build(sampleIds);
+    ms2ScanTable.build();
+    annotationIndex.build(featureMatrix);
+    clearCaches();
+    emit loaderDataSourceChanged(dataSourceId);
+    sparklineCache.setDataSource(dataSourceId);
+    emit samplesChanged();
+    return true;
+}
+
 SampleId FeatureDataSource::getSampleIdByNumber(int number) const
 {
     if (0 <= number && number < sampleIds.size()) {
@@ -253,6 +337,11 @@ QString FeatureDataSource::getSampleNameById(const SampleId &id) const
     }
 }
 
+QString FeatureDataSource::getSampleTypeById(const SampleId &id) const
+{
+    return sampleTypeById.value(id);
+}
+
 qint64 FeatureDataSource::getSampleCount() const
 {
     return sampleIds.size();
@@ -268,11 +357,16 @@ FeatureId FeatureDataSource::getFeatureIdByNumber(int number) const
     }
 }
 
+const FeatureMatrix & FeatureDataSource::getFeatureMatrix() const
+{
+    return featureMatrix;
+}
+
 QHash<FeatureId, QStringList> FeatureDataSource::getFeatureCompoundIds(const QSet<FeatureId> &ids) const
 {
     // Limit on number of SQLite query parameters
     // TODO: consider splitting the query into multiple ones.
-    if (ids.isEmpty() || ids.size() > QUERY_PARAMS_LIMIT) {
+    if (ids.isEmpty() || ids.size() > FeatureDataLoader::QUERY_PARAMS_LIMIT) {
         return QHash<FeatureId, QStringList>();
     }
 
@@ -301,6 +395,11 @@ qint64 FeatureDataSource::getFeatureCount() const
     return featureIds.size();
 }
 
+SparklineCache & FeatureDataSource::getSparklineCache()
+{
+    return sparklineCache;
+}
+
 void FeatureDataSource::updateSamplesInfo()
 {
     sampleIds.clear();
@@ -311,6 +410,15 @@ void FeatureDataSource::updateSamplesInfo()
         sampleNameById[id] = samplesQuery.value(1).toString();
         sampleIds.append(id);
     }
+
+    // types are queried separately, so that databases without them can still be opened
+    sampleTypeById.clear();
+    QSqlQuery typesQuery;
+    if (typesQuery.exec("SELECT id, type FROM Sample")) {
+        while (typesQuery.next()) {
+            sampleTypeById[typesQuery.value(0).value<SampleId>()] = typesQuery.value(1).toString();
+        }
+    }
 }
 
 void FeatureDataSource::updateFeaturesInfo()
@@ -354,7 +462,7 @@ QString getMetaInfoValue(const QString &key)
 
 }
 
-bool FeatureDataSource::isDataSourceVersionSupported()
+bool FeatureDataSource::isDataSourceVersionSupported(QString &errorMessage)
 {
     const QString minOptimusVersionStr = getMetaInfoValue("min_compatible_optimus_version");
     const int dataSourceMinOptimusVersion = versionToInt(minOptimusVersionStr);
@@ -364,26 +472,24 @@ bool FeatureDataSource::isDataSourceVersionSupported()
 
     const int curSupportedVersion = versionToInt(CURRENT_OPTIMUS_VERSION);
     if (dataSourceMinOptimusVersion > curSupportedVersion) {
-        QMessageBox::critical(QApplication::activeWindow(), tr("Error"),
-            tr("This Optimus database was created by Optimus version %1 "
-               "which is not compatible with the current version of OptimusViewer. "
-               "Use newer versions of OptimusViewer to open this file.").arg(curOptimusVersionStr));
+        errorMessage = tr("This Optimus database was created by Optimus version %1 "
+           "which is not compatible with the current version of OptimusViewer. "
+           "Use newer versions of OptimusViewer to open this file.").arg(curOptimusVersionStr);
         return false;
     }
 
     const int minSupportedVersion = versionToInt(MIN_COMPATIBLE_OPTIMUS_VERSION);
     if (dataSourceCurOptimusVersion < minSupportedVersion) {
-        QMessageBox::critical(QApplication::activeWindow(), tr("Error"),
-            tr("This Optimus database was created by Optimus version %1 "
+        errorMessage = tr("This Optimus database was created by Optimus version %1 "
             "which is not compatible with the current version of OptimusViewer. "
-            "Use previous versions of OptimusViewer to open this file.").arg(curOptimusVersionStr));
+            "Use previous versions of OptimusViewer to open this file.").arg(curOptimusVersionStr);
         return false;
     }
 
     return true;
 }
 
-bool FeatureDataSource::setDataSource(const DataSourceId &dataSourceId)
+bool FeatureDataSource::setDataSource(const DataSourceId &dataSourceId, QString &errorMessage)
 {
     Q_ASSERT(!dataSourceId.isEmpty());
 
@@ -403,12 +509,12 @@ bool FeatureDataSource::setDataSource(const DataSourceId &dataSourceId)
             "PRAGMA cache_size = 50000;"
             "PRAGMA foreign_keys = ON;"
         );
-        if (!isDataSourceVersionSupported()) {
+        if (!isDataSourceVersionSupported(errorMessage)) {
             db.close();
             storageAvailable = false;
         }
     } else {
-        QMessageBox::critical(QApplication::activeWindow(), tr("Error"), tr("Unable to read the Optimus database."));
+        errorMessage = tr("Unable to read the Optimus database.");
     }
 
     return storageAvailable;
@@ -1,15 +1,21 @@
 #ifndef FEATUREDATASOURCE_H
 #define FEATUREDATASOURCE_H
 
+#include <QCache>
 #include <QObject>
 #include <QSet>
 #include <QSqlDatabase>
+#include <QThread>
 #include <QVector>
 
+#include "AnnotationIndex.h"
 #include "Globals.h"
 #include "GraphPoint.h"
 #include "FeatureData.h"
-#include "Ms2ScanInfo.h"
+#include "FeatureDataLoader.h"
+#include "FeatureMatrix.h"
+#include "Ms2ScanTable.h"
+#include "SparklineCache.h"
 
 namespace ov {
 
@@ -19,47 +25,88 @@ class FeatureDataSource: public QObject
 
 public:
     FeatureDataSource();
+    ~FeatureDataSource();
 
     bool isValid() const;
+    bool openDataSource(const DataSourceId &dataSourceId, QString &errorMessage);
 
     bool setActiveFeatures(const QMultiHash<SampleId, FeatureId> &featuresBySample);
 
     QList<FeatureData> getMs1Data() const;
-    QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > getMs2ScanData() const;
-    QHash<FragmentationSpectrumId, QList<QPointF> > getMs2SpectraData(const QList<FragmentationSpectrumId> &spectrumIds) const; // Point: (mz, intensity)
+    FeatureDataList getFeatures(const QMultiHash<SampleId, FeatureId> &featuresBySample);
+    const Ms2ScanTable & getMs2ScanTable() const;
+    const AnnotationIndex & getAnnotationIndex() const;
+    Ms2SpectraById getMs2SpectraData(const QList<FragmentationSpectrumId> &spectrumIds);
+    int requestMs2SpectraData(const QList<FragmentationSpectrumId> &spectrumIds);
 
     SampleId getSampleIdByNumber(int number) const;
     QString getSampleNameById(const SampleId &id) const;
+    QString getSampleTypeById(const SampleId &id) const; // empty if the database doesn't set types
     qint64 getSampleCount() const;
 
     FeatureId getFeatureIdByNumber(int number) const;
+    const FeatureMatrix & getFeatureMatrix() const;
     QHash<FeatureId, QStringList> getFeatureCompoundIds(const QSet<FeatureId> &ids) const;
     qint64 getFeatureCount() const;
 
+    SparklineCache & getSparklineCache();
+
 signals:
     void samplesChanged();
+    void ms2SpectraDataReady(int requestId, const Ms2SpectraById &spectra);
+
+    void loaderDataSourceChanged(const DataSourceId &dataSourceId);
+    void featurePrefetchRequested(int prefetchId, const SampleFeatureIds &featuresBySample);
+    void ms2SpectraPrefetchRequested(int prefetchId, const SpectrumIdList &spectrumIds);
+    void ms2SpectraLoadRequested(int requestId, const SpectrumIdList &spectrumIds);
 
 public slots:
     void selectDataSource();
+    void prefetchFeatures(const QMultiHash<SampleId, FeatureId> &featuresBySample);
+    void prefetchMs2Spectra(const QList<FragmentationSpectrumId> &spectrumIds);
+
+private slots:
+    void featuresPrefetched(const DataSourceId &dataSourceId, const FeatureDataList &features);
+    void ms2SpectraPrefetched(const DataSourceId &dataSourceId, const Ms2SpectraById &spectra);
+    void ms2SpectraLoaded(const DataSourceId &dataSourceId, int requestId, const Ms2SpectraById &spectra);
+    void finishMs2SpectraRequest(int requestId);
 
 private:
-    bool setDataSource(const DataSourceId &dataSourceId);
-    bool isDataSourceVersionSupported();
+    typedef QPair<SampleId, FeatureId> FeatureKey;
+
+    void initLoaders();
+    void clearCaches();
+    void cacheMs2Spectra(const Ms2SpectraById &spectra);
+    bool setDataSource(const DataSourceId &dataSourceId, QString &errorMessage);
+    bool isDataSourceVersionSupported(QString &errorMessage);
     DataSourceId currentDataSourceId() const;
     void updateSamplesInfo();
     void updateFeaturesInfo();
     QMultiHash<SampleId, FeatureId> getFeaturesToExtract(const QMultiHash<SampleId, FeatureId> &featuresBySample,
-        QHash<SampleId, QHash<FeatureId, FeatureData> > &presentFeatures, QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > &presentMs2Scans);
-    void fetchFeatures(const QMultiHash<SampleId, FeatureId> &featureIdsToExtract, QHash<SampleId, QHash<FeatureId, FeatureData> > &features);
-    void fetchMs2Scans(const QMultiHash<SampleId, FeatureId> &featuresToExtract, QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > &ms2Scans);
+        QHash<SampleId, QHash<FeatureId, FeatureData> > &presentFeatures);
+    void cacheFeatures(const QHash<SampleId, QHash<FeatureId, FeatureData> > &features);
 
     static QString getInputFileFilter();
 
     QMap<SampleId, QString> sampleNameById;
+    QMap<SampleId, QString> sampleTypeById;
     QVector<SampleId> sampleIds;
     QVector<FeatureId> featureIds;
     QHash<SampleId, QHash<FeatureId, FeatureData> > currentFeatures;
-    QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > currentMs2Scans;
+    Ms2ScanTable ms2ScanTable;
+    AnnotationIndex annotationIndex;
+    FeatureMatrix featureMatrix;
+
+    QCache<FeatureKey, FeatureData> featureCache;
+    QCache<FragmentationSpectrumId, QList<QPointF> > ms2SpectraCache;
+    QHash<int, Ms2SpectraById> pendingMs2SpectraRequests; // value: spectra available so far
+    int lastMs2SpectraRequestId;
+    SparklineCache sparklineCache;
+
+    QThread prefetchThread;
+    FeatureDataLoader *prefetchLoader;
+    QThread requestThread;
+    FeatureDataLoader *requestLoader;
 
     QSqlDatabase db;
 };
@@ -0,0 +1,73 @@
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+
+#include "FeatureGroupingDialog.h"
+
+const double DEFAULT_MZ_TOLERANCE_PPM = 5.0;
+const double DEFAULT_RT_TOLERANCE = 2.0;
+const double DEFAULT_MIN_CORRELATION = 0.7;
+
+namespace ov {
+
+FeatureGroupingDialog::FeatureGroupingDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Group Isotopes and Adducts"));
+
+    polarityComboBox = new QComboBox(this);
+    polarityComboBox->addItem(tr("Positive"), FeatureGroups::POSITIVE_MODE);
+    polarityComboBox->addItem(tr("Negative"), FeatureGroups::NEGATIVE_MODE);
+
+    mzToleranceSpinBox = new QDoubleSpinBox(this);
+    mzToleranceSpinBox->setRange(0.1, 100.0);
+    mzToleranceSpinBox->setDecimals(1);
+    mzToleranceSpinBox->setSuffix(tr(" ppm"));
+    mzToleranceSpinBox->setValue(DEFAULT_MZ_TOLERANCE_PPM);
+
+    rtToleranceSpinBox = new QDoubleSpinBox(this);
+    rtToleranceSpinBox->setRange(0.0, 600.0);
+    rtToleranceSpinBox->setDecimals(1);
+    rtToleranceSpinBox->setSuffix(tr(" s"));
+    rtToleranceSpinBox->setValue(DEFAULT_RT_TOLERANCE);
+
+    correlationSpinBox = new QDoubleSpinBox(this);
+    correlationSpinBox->setRange(-1.0, 1.0);
+    correlationSpinBox->setDecimals(2);
+    correlationSpinBox->setSingleStep(0.05);
+    correlationSpinBox->setValue(DEFAULT_MIN_CORRELATION);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QFormLayout *layout = new QFormLayout(this);
+    layout->addRow(tr("Ionization mode:"), polarityComboBox);
+    layout->addRow(tr("m/z tolerance:"), mzToleranceSpinBox);
+    layout->addRow(tr("Gap between elution periods:"), rtToleranceSpinBox);
+    layout->addRow(tr("Min correlation of log intensities:"), correlationSpinBox);
+    layout->addRow(buttonBox);
+}
+
+FeatureGroups::Polarity FeatureGroupingDialog::getPolarity() const
+{
+    return static_cast<FeatureGroups::Polarity>(polarityComboBox->currentData().toInt());
+}
+
+qreal FeatureGroupingDialog::getMzTolerancePpm() const
+{
+    return mzToleranceSpinBox->value();
+}
+
+qreal FeatureGroupingDialog::getRtTolerance() const
+{
+    return rtToleranceSpinBox->value();
+}
+
+qreal FeatureGroupingDialog::getMinCorrelation() const
+{
+    return correlationSpinBox->value();
+}
+
+} // namespace ov
@@ -0,0 +1,35 @@
+#ifndef FEATURE_GROUPING_DIALOG_H
+#define FEATURE_GROUPING_DIALOG_H
+
+#include <QDialog>
+
+#include "FeatureGroups.h"
+
+class QComboBox;
+class QDoubleSpinBox;
+
+namespace ov {
+
+// Lets the user choose the ionization mode and how closely features of one compound must match
+class FeatureGroupingDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit FeatureGroupingDialog(QWidget *parent);
+
+    FeatureGroups::Polarity getPolarity() const;
+    qreal getMzTolerancePpm() const;
+    qreal getRtTolerance() const;
+    qreal getMinCorrelation() const;
+
+private:
+    QComboBox *polarityComboBox;
+    QDoubleSpinBox *mzToleranceSpinBox;
+    QDoubleSpinBox *rtToleranceSpinBox;
+    QDoubleSpinBox *correlationSpinBox;
+};
+
+} // namespace ov
+
+#endif // FEATURE_GROUPING_DIALOG_H
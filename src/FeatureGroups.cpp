@@ -0,0 +1,475 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "FeatureMatrix.h"
+#include "FeatureMatrixUtils.h"
+#include "MassTraceIndex.h"
+
+#include "FeatureGroups.h"
+
+const int MAX_ISOTOPE_CHARGE = 4;
+const int MIN_CORRELATION_SAMPLE_COUNT = 3; // correlation isn't required with fewer samples
+const double ISOTOPE_MASS_DIFFERENCE = 1.0033548; // 13C - 12C
+const int PROFILE_PROGRESS = 20; // percents of the progress taken by log profiles, the rest by the search of links
+
+namespace ov {
+
+namespace {
+
+struct Adduct
+{
+    const char *name;
+    double mzShift; // m/z of the singly charged ion minus the neutral mass
+};
+
+// sorted by the shift
+const Adduct POSITIVE_ADDUCTS[] = {
+    { "[M+H-H2O]+", -17.003289 },
+    { "[M+H]+", 1.007276 },
+    { "[M+NH4]+", 18.033823 },
+    { "[M+Na]+", 22.989218 },
+    { "[M+K]+", 38.963158 }
+};
+
+const Adduct NEGATIVE_ADDUCTS[] = {
+    { "[M-H2O-H]-", -19.018390 },
+    { "[M-H]-", -1.007276 },
+    { "[M+Cl]-", 34.969402 },
+    { "[M+FA-H]-", 44.998201 }
+};
+
+const Adduct * getAdducts(FeatureGroups::Polarity polarity, int &count)
+{
+    if (FeatureGroups::POSITIVE_MODE == polarity) {
+        count = sizeof(POSITIVE_ADDUCTS) / sizeof(Adduct);
+        return POSITIVE_ADDUCTS;
+    }
+    count = sizeof(NEGATIVE_ADDUCTS) / sizeof(Adduct);
+    return NEGATIVE_ADDUCTS;
+}
+
+// difference of m/z from a lighter ion of a compound to a heavier one
+struct MassOffset
+{
+    double mzDifference;
+    int charge;
+    int lighterAdduct; // -1 for isotopes
+    int heavierAdduct;
+};
+
+struct Link
+{
+    int lighterRow;
+    int heavierRow;
+    int lighterAdduct; // -1 for isotopes
+    int heavierAdduct;
+    double correlation;
+};
+
+bool isStrongerLink(const Link &left, const Link &right)
+{
+    if (left.correlation != right.correlation) {
+        return left.correlation > right.correlation;
+    }
+    return left.lighterRow < right.lighterRow || (left.lighterRow == right.lighterRow && left.heavierRow < right.heavierRow);
+}
+
+class DisjointSets
+{
+public:
+    explicit DisjointSets(int count)
+        : parents(count)
+    {
+        std::iota(parents.begin(), parents.end(), 0);
+    }
+
+    int find(int item)
+    {
+        while (parents[item] != item) {
+            parents[item] = parents[parents[item]];
+            item = parents[item];
+        }
+        return item;
+    }
+
+    void unite(int first, int second)
+    {
+        parents[find(first)] = find(second);
+    }
+
+private:
+    QVector<int> parents;
+};
+
+// log intensities of the rows of a block, parallel to intensities of the matrix, and their sums by row
+class ProfileBuilder
+{
+public:
+    ProfileBuilder(const FeatureMatrix &matrix, double *logIntensities, double *sums, double *sumsOfSquares)
+        : matrix(matrix), logIntensities(logIntensities), sums(sums), sumsOfSquares(sumsOfSquares)
+    {
+
+    }
+
+    void operator ()(int beginRow, int endRow) const
+    {
+        for (int row = beginRow; row < endRow; ++row) {
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            double *rowLogs = logIntensities + matrix.getRowOffset(row);
+            sums[row] = 0.0;
+            sumsOfSquares[row] = 0.0;
+            for (int i = 0; i < count; ++i) {
+                rowLogs[i] = FeatureMatrixUtils::getLogIntensity(intensities[i]);
+                sums[row] += rowLogs[i];
+                sumsOfSquares[row] += rowLogs[i] * rowLogs[i];
+            }
+        }
+    }
+
+private:
+    const FeatureMatrix &matrix;
+    double *logIntensities;
+    double *sums;
+    double *sumsOfSquares;
+};
+
+// finds links from features of a block of the m/z order to heavier ones
+class LinkFinder
+{
+public:
+    LinkFinder(const FeatureMatrix &matrix, const QVector<int> &rowsByMz, const QVector<double> &sortedMzs,
+        const QVector<TraceBounds> &elutionPeriods, const QVector<MassOffset> &offsets, const QVector<double> &logIntensities,
+        const QVector<double> &sums, const QVector<double> &sumsOfSquares, qreal mzTolerancePpm, qreal rtTolerance,
+        qreal minCorrelation)
+        : matrix(matrix), rowsByMz(rowsByMz), sortedMzs(sortedMzs), elutionPeriods(elutionPeriods), offsets(offsets),
+        logIntensities(logIntensities), sums(sums), sumsOfSquares(sumsOfSquares), mzTolerancePpm(mzTolerancePpm),
+        rtTolerance(rtTolerance), minCorrelation(minCorrelation)
+    {
+
+    }
+
+    QVector<Link> operator ()(int beginPosition, int endPosition) const
+    {
+        QVector<Link> links;
+        for (int position = beginPosition; position < endPosition; ++position) {
+            const int row = rowsByMz[position];
+            const int charge = getCharge(row);
+            foreach (const MassOffset &offset, offsets) {
+                if (offset.charge != charge) {
+                    continue;
+                }
+                const double targetMz = sortedMzs[position] + offset.mzDifference;
+                const double tolerance = targetMz * mzTolerancePpm * 1e-6;
+                QVector<double>::const_iterator candidate = std::lower_bound(sortedMzs.constBegin(), sortedMzs.constEnd(),
+                    targetMz - tolerance);
+                for (; candidate != sortedMzs.constEnd() && *candidate <= targetMz + tolerance; ++candidate) {
+                    const int otherRow = rowsByMz[candidate - sortedMzs.constBegin()];
+                    if (otherRow == row || getCharge(otherRow) != charge || !areCoeluting(row, otherRow)) {
+                        continue;
+                    }
+                    const double correlation = getCorrelation(row, otherRow);
+                    if (correlation >= minCorrelation) {
+                        const Link link = { row, otherRow, offset.lighterAdduct, offset.heavierAdduct, correlation };
+                        links.append(link);
+                    }
+                }
+            }
+        }
+        return links;
+    }
+
+private:
+    int getCharge(int row) const
+    {
+        return qMax(1, matrix.getConsensusCharge(row)); // unknown charges are taken for 1
+    }
+
+    bool areCoeluting(int row, int otherRow) const
+    {
+        const TraceBounds &period = elutionPeriods[row];
+        const TraceBounds &otherPeriod = elutionPeriods[otherRow];
+        return period.rtStart - rtTolerance <= otherPeriod.rtEnd && otherPeriod.rtStart - rtTolerance <= period.rtEnd;
+    }
+
+    // Pearson correlation of log intensities over all samples, undetected features count as zeros
+    double getCorrelation(int row, int otherRow) const
+    {
+        const int sampleCount = matrix.getSampleCount();
+        if (sampleCount < MIN_CORRELATION_SAMPLE_COUNT) {
+            return 1.0;
+        }
+        const int *sampleNumbers = NULL;
+        const int *otherSampleNumbers = NULL;
+        const double *intensities = NULL;
+        const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+        const int otherCount = matrix.getRowIntensities(otherRow, otherSampleNumbers, intensities);
+        const double *logs = logIntensities.constData() + matrix.getRowOffset(row);
+        const double *otherLogs = logIntensities.constData() + matrix.getRowOffset(otherRow);
+
+        double sumOfProducts = 0.0;
+        for (int i = 0, j = 0; i < count && j < otherCount; ) {
+            if (sampleNumbers[i] < otherSampleNumbers[j]) {
+                ++i;
+            } else if (sampleNumbers[i] > otherSampleNumbers[j]) {
+                ++j;
+            } else {
+                sumOfProducts += logs[i++] * otherLogs[j++];
+            }
+        }
+        const double variance = sampleCount * sumsOfSquares[row] - sums[row] * sums[row];
+        const double otherVariance = sampleCount * sumsOfSquares[otherRow] - sums[otherRow] * sums[otherRow];
+        if (variance <= 0.0 || otherVariance <= 0.0) {
+            return 0.0;
+        }
+        return (sampleCount * sumOfProducts - sums[row] * sums[otherRow]) / std::sqrt(variance * otherVariance);
+    }
+
+    const FeatureMatrix &matrix;
+    const QVector<int> &rowsByMz;
+    const QVector<double> &sortedMzs;
+    const QVector<TraceBounds> &elutionPeriods;
+    const QVector<MassOffset> &offsets;
+    const QVector<double> &logIntensities;
+    const QVector<double> &sums;
+    const QVector<double> &sumsOfSquares;
+    qreal mzTolerancePpm;
+    qreal rtTolerance;
+    qreal minCorrelation;
+};
+
+QVector<MassOffset> getMassOffsets(FeatureGroups::Polarity polarity)
+{
+    QVector<MassOffset> offsets;
+    for (int charge = 1; charge <= MAX_ISOTOPE_CHARGE; ++charge) {
+        const MassOffset offset = { ISOTOPE_MASS_DIFFERENCE / charge, charge, -1, -1 };
+        offsets.append(offset);
+    }
+    int adductCount = 0;
+    const Adduct *adducts = getAdducts(polarity, adductCount);
+    for (int lighter = 0; lighter < adductCount; ++lighter) {
+        for (int heavier = lighter + 1; heavier < adductCount; ++heavier) {
+            const MassOffset offset = { adducts[heavier].mzShift - adducts[lighter].mzShift, 1, lighter, heavier };
+            offsets.append(offset);
+        }
+    }
+    return offsets;
+}
+
+}
+
+FeatureGroups::FeatureGroups()
+    : polarity(POSITIVE_MODE), groupCount(0)
+{
+
+}
+
+FeatureGroups FeatureGroups::compute(const FeatureMatrix &matrix, const MassTraceIndex &traceIndex, Polarity polarity,
+    qreal mzTolerancePpm, qreal rtTolerance, qreal minCorrelation, const FeatureMatrixUtils::ProgressCallback &progress)
+{
+    const int rowCount = matrix.getRowCount();
+    FeatureGroups groups;
+    groups.polarity = polarity;
+
+    QVector<int> rowsByMz(rowCount);
+    std::iota(rowsByMz.begin(), rowsByMz.end(), 0);
+    std::sort(rowsByMz.begin(), rowsByMz.end(), [&matrix] (int left, int right) {
+        return matrix.getConsensusMz(left) < matrix.getConsensusMz(right);
+    });
+    QVector<double> sortedMzs(rowCount);
+    for (int position = 0; position < rowCount; ++position) {
+        sortedMzs[position] = matrix.getConsensusMz(rowsByMz[position]);
+    }
+    QVector<TraceBounds> elutionPeriods(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        if (!traceIndex.getConsensusBounds(row, elutionPeriods[row])) {
+            elutionPeriods[row].rtStart = elutionPeriods[row].rtEnd = matrix.getConsensusRt(row);
+        }
+    }
+
+    QVector<double> logIntensities(matrix.getIntensityCount());
+    QVector<double> sums(rowCount);
+    QVector<double> sumsOfSquares(rowCount);
+    if (!FeatureMatrixUtils::runInBlocks(rowCount, FeatureMatrixUtils::ROWS_PER_TASK,
+        ProfileBuilder(matrix, logIntensities.data(), sums.data(), sumsOfSquares.data()), [&progress] (int percents) {
+            return progress(percents * PROFILE_PROGRESS / 100);
+        }))
+    {
+        return FeatureGroups();
+    }
+
+    // positions in the m/z order are split in the same way as rows
+    const QVector<MassOffset> offsets = getMassOffsets(polarity);
+    const QVector<QVector<Link> > taskLinks = FeatureMatrixUtils::mapBlocks<QVector<Link> >(rowCount,
+        FeatureMatrixUtils::ROWS_PER_TASK, LinkFinder(matrix, rowsByMz, sortedMzs, elutionPeriods, offsets, logIntensities,
+        sums, sumsOfSquares, mzTolerancePpm, rtTolerance, minCorrelation), [&progress] (int percents) {
+            return progress(PROFILE_PROGRESS + percents * (100 - PROFILE_PROGRESS) / 100);
+        });
+    if (!progress(100)) {
+        return FeatureGroups(); // links of skipped ranges are missing
+    }
+    QVector<Link> links;
+    foreach (const QVector<Link> &blockLinks, taskLinks) {
+        links += blockLinks;
+    }
+    std::sort(links.begin(), links.end(), isStrongerLink);
+
+    DisjointSets isotopeClusters(rowCount);
+    DisjointSets families(rowCount);
+    foreach (const Link &link, links) {
+        if (-1 == link.lighterAdduct) {
+            isotopeClusters.unite(link.lighterRow, link.heavierRow);
+            families.unite(link.lighterRow, link.heavierRow);
+        }
+    }
+
+    // the lightest feature of a cluster is taken for the monoisotopic one
+    QVector<int> clusterSizes(rowCount, 0);
+    QVector<int> monoisotopicRows(rowCount, -1);
+    for (int row = 0; row < rowCount; ++row) {
+        const int cluster = isotopeClusters.find(row);
+        ++clusterSizes[cluster];
+        if (-1 == monoisotopicRows[cluster] || matrix.getConsensusMz(row) < matrix.getConsensusMz(monoisotopicRows[cluster])) {
+            monoisotopicRows[cluster] = row;
+        }
+    }
+
+    // stronger links assign adducts first, a link contradicting assigned adducts doesn't join clusters
+    QVector<int> adductsByCluster(rowCount, -1);
+    foreach (const Link &link, links) {
+        if (-1 == link.lighterAdduct) {
+            continue;
+        }
+        const int lighterCluster = isotopeClusters.find(link.lighterRow);
+        const int heavierCluster = isotopeClusters.find(link.heavierRow);
+        const int lighterAdduct = adductsByCluster[lighterCluster];
+        const int heavierAdduct = adductsByCluster[heavierCluster];
+        if (lighterCluster == heavierCluster || (-1 != lighterAdduct && link.lighterAdduct != lighterAdduct)
+            || (-1 != heavierAdduct && link.heavierAdduct != heavierAdduct))
+        {
+            continue;
+        }
+        adductsByCluster[lighterCluster] = link.lighterAdduct;
+        adductsByCluster[heavierCluster] = link.heavierAdduct;
+        families.unite(link.lighterRow, link.heavierRow);
+    }
+
+    QVector<int> familySizes(rowCount, 0);
+    QVector<int> mainRows(rowCount, -1);
+    QVector<double> totalIntensities(rowCount, 0.0);
+    for (int row = 0; row < rowCount; ++row) {
+        const int *sampleNumbers = NULL;
+        const double *intensities = NULL;
+        const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+        totalIntensities[row] = std::accumulate(intensities, intensities + count, 0.0);
+
+        const int family = families.find(row);
+        ++familySizes[family];
+        if (-1 == mainRows[family] || totalIntensities[row] > totalIntensities[mainRows[family]]) {
+            mainRows[family] = row;
+        }
+    }
+
+    groups.groupNumbers.fill(0, rowCount);
+    groups.isotopeNumbers.fill(-1, rowCount);
+    groups.adductIndexes.fill(-1, rowCount);
+    groups.mainFeatures.fill(true, rowCount);
+    QVector<int> numbersByFamily(rowCount, 0);
+    for (int row = 0; row < rowCount; ++row) {
+        const int family = families.find(row);
+        if (familySizes[family] < 2) {
+            continue;
+        }
+        if (0 == numbersByFamily[family]) {
+            numbersByFamily[family] = ++groups.groupCount; // in the order of rows
+        }
+        groups.groupNumbers[row] = numbersByFamily[family];
+        groups.mainFeatures[row] = mainRows[family] == row;
+
+        const int cluster = isotopeClusters.find(row);
+        groups.adductIndexes[row] = adductsByCluster[cluster];
+        if (clusterSizes[cluster] > 1) {
+            const double mzDifference = matrix.getConsensusMz(row) - matrix.getConsensusMz(monoisotopicRows[cluster]);
+            groups.isotopeNumbers[row] = qRound(mzDifference * qMax(1, matrix.getConsensusCharge(row)) / ISOTOPE_MASS_DIFFERENCE);
+        }
+    }
+    return groups;
+}
+
+bool FeatureGroups::isEmpty() const
+{
+    return groupNumbers.isEmpty();
+}
+
+int FeatureGroups::getGroupCount() const
+{
+    return groupCount;
+}
+
+int FeatureGroups::getGroupNumber(int row) const
+{
+    return groupNumbers[row];
+}
+
+QString FeatureGroups::getIonLabel(int row) const
+{
+    QStringList parts;
+    if (-1 != adductIndexes[row]) {
+        int adductCount = 0;
+        parts.append(getAdducts(polarity, adductCount)[adductIndexes[row]].name);
+    }
+    if (0 == isotopeNumbers[row]) {
+        parts.append("M");
+    } else if (isotopeNumbers[row] > 0) {
+        parts.append(QString("M+%1").arg(isotopeNumbers[row]));
+    }
+    return parts.join(" ");
+}
+
+bool FeatureGroups::isMainFeature(int row) const
+{
+    return mainFeatures[row];
+}
+
+QVariant FeatureGroups::getValue(int row, Column column) const
+{
+    switch (column) {
+        case GROUP_COLUMN:
+            return 0 == groupNumbers[row] ? QVariant() : QVariant(groupNumbers[row]);
+        case ION_COLUMN:
+            return getIonLabel(row);
+        default:
+            Q_ASSERT(false);
+            return QVariant();
+    }
+}
+
+QString FeatureGroups::getColumnName(Column column) const
+{
+    switch (column) {
+        case GROUP_COLUMN:
+            return tr("Feature group");
+        case ION_COLUMN:
+            return tr("Ion");
+        default:
+            Q_ASSERT(false);
+            return QString();
+    }
+}
+
+QString FeatureGroups::getColumnDescription(Column column) const
+{
+    switch (column) {
+        case GROUP_COLUMN:
+            return tr("Features that are likely to be isotopes and adducts of the same compound, %1 groups").arg(groupCount);
+        case ION_COLUMN:
+            return tr("Adduct and isotope of the feature within its group, M is the lightest isotope found");
+        default:
+            Q_ASSERT(false);
+            return QString();
+    }
+}
+
+} // namespace ov
@@ -0,0 +1,63 @@
+#ifndef FEATURE_GROUPS_H
+#define FEATURE_GROUPS_H
+
+#include <QCoreApplication>
+#include <QVariant>
+#include <QVector>
+
+#include "FeatureMatrixUtils.h"
+
+namespace ov {
+
+class FeatureMatrix;
+class MassTraceIndex;
+
+// Isotope clusters and adduct families of features, i.e. features that are likely to be ions of the same compound.
+// Features are linked if their consensus m/z differ by an isotope or adduct mass difference within a tolerance,
+// their elution periods overlap and their log intensities correlate across samples. Isotope links join features
+// into clusters, adduct links join clusters into groups. Results are implicitly shared, so copies are cheap.
+class FeatureGroups
+{
+    Q_DECLARE_TR_FUNCTIONS(FeatureGroups)
+
+public:
+    enum Column {
+        GROUP_COLUMN, // number of the group, empty if the feature isn't grouped with others
+        ION_COLUMN, // adduct and isotope of the feature, e.g. "[M+Na]+ M+1"
+        COLUMN_COUNT
+    };
+
+    enum Polarity {
+        POSITIVE_MODE,
+        NEGATIVE_MODE
+    };
+
+    FeatureGroups(); // no grouping
+
+    // slow for large tables, meant to be run on a worker thread; links are searched in parallel;
+    // without trace bounds in @traceIndex consensus RTs are compared; a grouping canceled by @progress returns no groups
+    static FeatureGroups compute(const FeatureMatrix &matrix, const MassTraceIndex &traceIndex, Polarity polarity,
+        qreal mzTolerancePpm, qreal rtTolerance, qreal minCorrelation, const FeatureMatrixUtils::ProgressCallback &progress);
+
+    bool isEmpty() const;
+    int getGroupCount() const;
+    int getGroupNumber(int row) const; // starting with 1, 0 if the feature isn't grouped
+    QString getIonLabel(int row) const;
+    bool isMainFeature(int row) const; // the most intense feature of its group, also true for ungrouped ones
+
+    QVariant getValue(int row, Column column) const;
+    QString getColumnName(Column column) const;
+    QString getColumnDescription(Column column) const;
+
+private:
+    Polarity polarity;
+    int groupCount;
+    QVector<int> groupNumbers;
+    QVector<int> isotopeNumbers; // -1 if the feature isn't in an isotope cluster
+    QVector<int> adductIndexes; // -1 if the adduct is unknown
+    QVector<bool> mainFeatures;
+};
+
+} // namespace ov
+
+#endif // FEATURE_GROUPS_H
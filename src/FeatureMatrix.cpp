@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <numeric>
+
+#include <QHash>
+#include <QPair>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+#include <QtConcurrent>
+
+#include "FeatureMatrix.h"
+
+namespace ov {
+
+namespace {
+
+// reduces intensities of a sample gathered into a contiguous range, ranges of different samples don't overlap
+class SampleReducer
+{
+public:
+    typedef SampleStatistics result_type;
+
+    SampleReducer(const int *columnOffsets, double *columnIntensities)
+        : columnOffsets(columnOffsets), columnIntensities(columnIntensities)
+    {
+
+    }
+
+    SampleStatistics operator ()(int sampleNumber) const
+    {
+        double *begin = columnIntensities + columnOffsets[sampleNumber];
+        double *end = columnIntensities + columnOffsets[sampleNumber + 1];
+        SampleStatistics statistics;
+        statistics.featureCount = end - begin;
+        if (begin == end) {
+            return statistics;
+        }
+        for (const double *intensity = begin; intensity != end; ++intensity) {
+            statistics.totalIntensity += *intensity;
+            statistics.maxIntensity = qMax(statistics.maxIntensity, *intensity);
+        }
+        double *middle = begin + statistics.featureCount / 2;
+        std::nth_element(begin, middle, end);
+        statistics.medianIntensity = 0 == statistics.featureCount % 2 ? (*std::max_element(begin, middle) + *middle) / 2 : *middle;
+        return statistics;
+    }
+
+private:
+    const int *columnOffsets;
+    double *columnIntensities;
+};
+
+typedef QPair<const int *, const int *> RowRange;
+
+// rows of @sortedRows whose values are within [min, max]
+RowRange findRowRange(const QVector<int> &sortedRows, const QVector<double> &values, qreal min, qreal max)
+{
+    const int *begin = std::lower_bound(sortedRows.constBegin(), sortedRows.constEnd(), min,
+        [&values] (int row, qreal value) { return values[row] < value; });
+    const int *end = std::upper_bound(begin, sortedRows.constEnd(), max,
+        [&values] (qreal value, int row) { return value < values[row]; });
+    return RowRange(begin, qMax(begin, end));
+}
+
+}
+
+SampleStatistics::SampleStatistics()
+    : featureCount(0), totalIntensity(0.0), medianIntensity(0.0), maxIntensity(0.0)
+{
+
+}
+
+FeatureMatrix::FeatureMatrix()
+    : sampleCount(0)
+{
+    rowOffsets.append(0);
+}
+
+void FeatureMatrix::clear()
+{
+    sampleCount = 0;
+    featureIds.clear();
+    consensusMzs.clear();
+    consensusRts.clear();
+    consensusCharges.clear();
+    compoundIds.clear();
+    mzSortedRows.clear();
+    rtSortedRows.clear();
+    rowOffsets.clear();
+    rowOffsets.append(0);
+    sampleNumbers.clear();
+    intensities.clear();
+    sampleStatistics.clear();
+}
+
+void FeatureMatrix::build(const QVector<SampleId> &sampleIds)
+{
+    clear();
+    sampleCount = sampleIds.size();
+
+    QSqlQuery featureQuery;
+    featureQuery.setForwardOnly(true);
+    bool ok = featureQuery.exec("SELECT id, consensus_mz, consensus_rt, consensus_charge FROM Feature ORDER BY id");
+    Q_ASSERT(ok);
+    while (featureQuery.next()) {
+        featureIds.append(featureQuery.value(0).value<FeatureId>());
+        consensusMzs.append(featureQuery.value(1).toDouble());
+        consensusRts.append(featureQuery.value(2).toDouble());
+        consensusCharges.append(featureQuery.value(3).toInt());
+    }
+    const int rowCount = featureIds.size();
+    compoundIds.resize(rowCount);
+    mzSortedRows = getSortedRows(consensusMzs);
+    rtSortedRows = getSortedRows(consensusRts);
+
+    QHash<SampleId, int> sampleNumberById;
+    for (int i = 0; i < sampleIds.size(); ++i) {
+        sampleNumberById[sampleIds[i]] = i;
+    }
+
+    // both queries are sorted by feature id, so rows are matched by a single pass
+    QSqlQuery intensityQuery;
+    intensityQuery.setForwardOnly(true);
+    ok = intensityQuery.exec("SELECT feature_id, sample_id, intensity FROM SampleFeature ORDER BY feature_id, sample_id");
+    Q_ASSERT(ok);
+    rowOffsets.resize(rowCount + 1);
+    int row = 0;
+    while (intensityQuery.next()) {
+        const FeatureId featureId = intensityQuery.value(0).value<FeatureId>();
+        while (row < rowCount && featureIds[row] < featureId) {
+            rowOffsets[++row] = sampleNumbers.size();
+        }
+        const QHash<SampleId, int>::const_iterator sampleNumber = sampleNumberById.constFind(intensityQuery.value(1).value<SampleId>());
+        if (row == rowCount || featureIds[row] != featureId || sampleNumber == sampleNumberById.constEnd()) {
+            continue;
+        }
+        sampleNumbers.append(sampleNumber.value());
+        intensities.append(intensityQuery.value(2).toDouble());
+    }
+    while (row < rowCount) {
+        rowOffsets[++row] = sampleNumbers.size();
+    }
+    sampleNumbers.squeeze();
+    intensities.squeeze();
+    updateSampleStatistics();
+
+    QSqlQuery annotationQuery;
+    annotationQuery.setForwardOnly(true);
+    ok = annotationQuery.exec("SELECT FA.feature_id, A.compound_id FROM FeatureAnnotation AS FA, Annotation AS A "
+        "WHERE FA.annotation_id = A.id ORDER BY FA.feature_id");
+    Q_ASSERT(ok);
+    row = 0;
+    while (annotationQuery.next()) {
+        const FeatureId featureId = annotationQuery.value(0).value<FeatureId>();
+        while (row < rowCount && featureIds[row] < featureId) {
+            ++row;
+        }
+        if (row == rowCount || featureIds[row] != featureId) {
+            continue;
+        }
+        QString &rowCompoundIds = compoundIds[row];
+        if (!rowCompoundIds.isEmpty()) {
+            rowCompoundIds.append("; ");
+        }
+        rowCompoundIds.append(annotationQuery.value(1).toString());
+    }
+}
+
+void FeatureMatrix::getColumns(QVector<int> &columnOffsets, QVector<double> &columnIntensities) const
+{
+    // counting sort by sample number
+    columnOffsets.fill(0, sampleCount + 1);
+    foreach (int sampleNumber, sampleNumbers) {
+        ++columnOffsets[sampleNumber + 1];
+    }
+    std::partial_sum(columnOffsets.constBegin(), columnOffsets.constEnd(), columnOffsets.begin());
+
+    columnIntensities.resize(intensities.size());
+    QVector<int> columnPositions = columnOffsets;
+    for (int i = 0; i < intensities.size(); ++i) {
+        columnIntensities[columnPositions[sampleNumbers[i]]++] = intensities[i];
+    }
+}
+
+void FeatureMatrix::updateSampleStatistics()
+{
+    // every sample is reduced by a task of its own
+    QVector<int> columnOffsets;
+    QVector<double> columnIntensities;
+    getColumns(columnOffsets, columnIntensities);
+
+    QVector<int> sampleNumberRange(sampleCount);
+    std::iota(sampleNumberRange.begin(), sampleNumberRange.end(), 0);
+    sampleStatistics = QtConcurrent::blockingMapped<QVector<SampleStatistics> >(sampleNumberRange,
+        SampleReducer(columnOffsets.constData(), columnIntensities.data()));
+}
+
+QVector<int> FeatureMatrix::getSortedRows(const QVector<double> &values)
+{
+    QVector<int> rows(values.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    std::stable_sort(rows.begin(), rows.end(), [&values] (int left, int right) {
+        return values[left] < values[right];
+    });
+    return rows;
+}
+
+int FeatureMatrix::getRowCount() const
+{
+    return featureIds.size();
+}
+
+int FeatureMatrix::getSampleCount() const
+{
+    return sampleCount;
+}
+
+int FeatureMatrix::findRow(const FeatureId &featureId) const
+{
+    // rows are sorted by feature id
+    const QVector<FeatureId>::const_iterator found = std::lower_bound(featureIds.constBegin(), featureIds.constEnd(), featureId);
+    return found != featureIds.constEnd() && *found == featureId ? found - featureIds.constBegin() : -1;
+}
+
+FeatureId FeatureMatrix::getFeatureId(int row) const
+{
+    return featureIds[row];
+}
+
+qreal FeatureMatrix::getConsensusMz(int row) const
+{
+    return consensusMzs[row];
+}
+
+qreal FeatureMatrix::getConsensusRt(int row) const
+{
+    return consensusRts[row];
+}
+
+int FeatureMatrix::getConsensusCharge(int row) const
+{
+    return consensusCharges[row];
+}
+
+QString FeatureMatrix::getCompoundIds(int row) const
+{
+    return compoundIds[row];
+}
+
+QVector<int> FeatureMatrix::findRows(qreal mzMin, qreal mzMax, qreal rtMin, qreal rtMax) const
+{
+    // both bounds are looked up by binary search, rows of the narrower range are checked against the other one
+    const RowRange mzRange = findRowRange(mzSortedRows, consensusMzs, mzMin, mzMax);
+    const RowRange rtRange = findRowRange(rtSortedRows, consensusRts, rtMin, rtMax);
+    const bool mzNarrower = mzRange.second - mzRange.first <= rtRange.second - rtRange.first;
+    const RowRange &candidates = mzNarrower ? mzRange : rtRange;
+    const QVector<double> &otherValues = mzNarrower ? consensusRts : consensusMzs;
+    const qreal otherMin = mzNarrower ? rtMin : mzMin;
+    const qreal otherMax = mzNarrower ? rtMax : mzMax;
+
+    QVector<int> rows;
+    for (const int *row = candidates.first; row != candidates.second; ++row) {
+        if (otherMin <= otherValues[*row] && otherValues[*row] <= otherMax) {
+            rows.append(*row);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+int FeatureMatrix::findIntensity(int row, int sampleNumber) const
+{
+    const int *rowBegin = sampleNumbers.constData() + rowOffsets[row];
+    const int *rowEnd = sampleNumbers.constData() + rowOffsets[row + 1];
+    const int *found = std::lower_bound(rowBegin, rowEnd, sampleNumber);
+    return found != rowEnd && *found == sampleNumber ? found - sampleNumbers.constData() : -1;
+}
+
+bool FeatureMatrix::hasIntensity(int row, int sampleNumber) const
+{
+    return -1 != findIntensity(row, sampleNumber);
+}
+
+qreal FeatureMatrix::getIntensity(int row, int sampleNumber) const
+{
+    const int index = findIntensity(row, sampleNumber);
+    return -1 != index ? intensities[index] : 0.0;
+}
+
+int FeatureMatrix::getRowIntensities(int row, const int *&sampleNumbers, const double *&intensities) const
+{
+    const int offset = rowOffsets[row];
+    sampleNumbers = this->sampleNumbers.constData() + offset;
+    intensities = this->intensities.constData() + offset;
+    return rowOffsets[row + 1] - offset;
+}
+
+QVector<int> FeatureMatrix::findMostIntenseRows(int sampleNumber, int count) const
+{
+    QVector<QPair<double, int> > detected;
+    const int rowCount = getRowCount();
+    for (int row = 0; row < rowCount; ++row) {
+        const int index = findIntensity(row, sampleNumber);
+        if (-1 != index) {
+            detected.append(qMakePair(intensities[index], row));
+        }
+    }
+
+    // only the selected rows are sorted, equal intensities are ordered by row
+    const auto moreIntense = [] (const QPair<double, int> &left, const QPair<double, int> &right) {
+        return left.first > right.first || (left.first == right.first && left.second < right.second);
+    };
+    const int resultCount = qBound(0, count, detected.size());
+    std::nth_element(detected.begin(), detected.begin() + resultCount, detected.end(), moreIntense);
+    std::sort(detected.begin(), detected.begin() + resultCount, moreIntense);
+
+    QVector<int> rows(resultCount);
+    for (int i = 0; i < resultCount; ++i) {
+        rows[i] = detected[i].second;
+    }
+    return rows;
+}
+
+int FeatureMatrix::getRowOffset(int row) const
+{
+    return rowOffsets[row];
+}
+
+int FeatureMatrix::getIntensityCount() const
+{
+    return intensities.size();
+}
+
+const SampleStatistics & FeatureMatrix::getSampleStatistics(int sampleNumber) const
+{
+    return sampleStatistics[sampleNumber];
+}
+
+} // namespace ov
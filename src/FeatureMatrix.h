@@ -0,0 +1,83 @@
+#ifndef FEATURE_MATRIX_H
+#define FEATURE_MATRIX_H
+
+#include <QVector>
+
+#include "Globals.h"
+
+namespace ov {
+
+// Summary of the intensities detected in a sample, undetected features aren't counted as zeros
+struct SampleStatistics
+{
+    SampleStatistics();
+
+    int featureCount;
+    qreal totalIntensity;
+    qreal medianIntensity;
+    qreal maxIntensity;
+};
+
+// Consensus properties and sample intensities of all features kept in memory column by column.
+// Intensities are sparse, they're stored in compressed rows: intensities of the feature in row r
+// are at [rowOffsets[r], rowOffsets[r + 1]) of sampleNumbers and intensities, sorted by sample number.
+// The data is implicitly shared, so copies are cheap and may be read from other threads.
+class FeatureMatrix
+{
+public:
+    FeatureMatrix();
+
+    void build(const QVector<SampleId> &sampleIds);
+    void clear();
+
+    int getRowCount() const;
+    int getSampleCount() const;
+    int findRow(const FeatureId &featureId) const; // -1 if there is no such feature
+
+    FeatureId getFeatureId(int row) const;
+    qreal getConsensusMz(int row) const;
+    qreal getConsensusRt(int row) const;
+    int getConsensusCharge(int row) const;
+    QString getCompoundIds(int row) const; // "; "-separated, empty if the feature isn't annotated
+    // rows whose consensus m/z and RT are within the inclusive bounds, sorted
+    QVector<int> findRows(qreal mzMin, qreal mzMax, qreal rtMin, qreal rtMax) const;
+
+    bool hasIntensity(int row, int sampleNumber) const;
+    qreal getIntensity(int row, int sampleNumber) const; // 0 if the feature isn't detected in the sample
+    int getRowIntensities(int row, const int *&sampleNumbers, const double *&intensities) const; // returns count
+    // rows of the features most intense in the sample, the most intense first, undetected features aren't included;
+    // all normalization modes keep the order of intensities within a sample, so raw ones are compared
+    QVector<int> findMostIntenseRows(int sampleNumber, int count) const;
+    int getRowOffset(int row) const; // of the first intensity of the row among intensities of all rows
+    int getIntensityCount() const;
+    int findIntensity(int row, int sampleNumber) const; // position among intensities of all rows, -1 if not detected
+    // intensities transposed into columns: those of sample s are at [columnOffsets[s], columnOffsets[s + 1])
+    // of columnIntensities in the order of rows
+    void getColumns(QVector<int> &columnOffsets, QVector<double> &columnIntensities) const;
+
+    // computed once when the matrix is built
+    const SampleStatistics & getSampleStatistics(int sampleNumber) const;
+
+private:
+    void updateSampleStatistics();
+    static QVector<int> getSortedRows(const QVector<double> &values);
+
+    int sampleCount;
+    QVector<FeatureId> featureIds;
+    QVector<double> consensusMzs;
+    QVector<double> consensusRts;
+    QVector<int> consensusCharges;
+    QVector<QString> compoundIds;
+    QVector<int> mzSortedRows; // rows in ascending order of consensus m/z
+    QVector<int> rtSortedRows;
+
+    QVector<int> rowOffsets;
+    QVector<int> sampleNumbers;
+    QVector<double> intensities;
+
+    QVector<SampleStatistics> sampleStatistics;
+};
+
+} // namespace ov
+
+#endif // FEATURE_MATRIX_H
@@ -0,0 +1,383 @@
+#ifndef FEATURE_MATRIX_FILE_READER_H
+#define FEATURE_MATRIX_FILE_READER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Binary feature matrix (*.ovm) exported by OptimusViewer.
+//
+// The file is meant to be mapped into memory and used in place, so every array is stored exactly as a C++ program
+// on a little-endian machine keeps it. All numbers are little-endian, all sections start at offsets divisible by 8.
+//
+// Header, 48 bytes:
+//   char[8]  magic          "OVMATRIX"
+//   uint32   version        1
+//   uint32   section count  12 in version 1, readers ignore sections they don't know
+//   uint64   row count      number of features
+//   uint64   sample count
+//   uint64   intensity count, number of non-zero intensities
+//   uint64   string count
+// The header is followed by a section table: an entry {uint64 offset, uint64 size in bytes} for each section.
+// Offsets are counted from the beginning of the file. Sections in version 1:
+//   FEATURE_IDS        int64[row count]
+//   CONSENSUS_MZS      double[row count]
+//   CONSENSUS_RTS      double[row count]
+//   CONSENSUS_CHARGES  int32[row count]
+//   COMPOUND_IDS       uint32[row count], string indices of "; "-separated compound IDs, NO_STRING if not annotated
+//   ROW_OFFSETS        uint64[row count + 1], intensities of row r are at [ROW_OFFSETS[r], ROW_OFFSETS[r + 1])
+//                      of SAMPLE_NUMBERS and INTENSITIES
+//   SAMPLE_NUMBERS     uint32[intensity count], ascending within a row
+//   INTENSITIES        double[intensity count]
+//   SAMPLE_IDS         int64[sample count], database IDs of samples by their numbers
+//   SAMPLE_NAMES       uint32[sample count], string indices
+//   STRING_OFFSETS     uint64[string count + 1], string i is at [STRING_OFFSETS[i], STRING_OFFSETS[i + 1]) of STRING_DATA
+//   STRING_DATA        char[], UTF-8 strings, each of them followed by '\0' which is counted in its length
+//
+// This header has no dependencies besides the standard library, so it can be copied into other projects.
+
+namespace ov {
+
+namespace FeatureMatrixFileFormat {
+
+const char MAGIC[8] = { 'O', 'V', 'M', 'A', 'T', 'R', 'I', 'X' };
+const uint32_t VERSION = 1;
+const uint32_t NO_STRING = 0xFFFFFFFF;
+const uint64_t SECTION_ALIGNMENT = 8;
+
+enum Section {
+    FEATURE_IDS,
+    CONSENSUS_MZS,
+    CONSENSUS_RTS,
+    CONSENSUS_CHARGES,
+    COMPOUND_IDS,
+    ROW_OFFSETS,
+    SAMPLE_NUMBERS,
+    INTENSITIES,
+    SAMPLE_IDS,
+    SAMPLE_NAMES,
+    STRING_OFFSETS,
+    STRING_DATA,
+    SECTION_COUNT
+};
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t rowCount;
+    uint64_t sampleCount;
+    uint64_t intensityCount;
+    uint64_t stringCount;
+};
+
+struct SectionEntry
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(Header) == 48 && sizeof(SectionEntry) == 16, "Unexpected padding in feature matrix file structures");
+
+// size in bytes of a section with the given counts, the size of STRING_DATA isn't known in advance
+inline uint64_t getSectionSize(Section section, const Header &header)
+{
+    switch (section) {
+        case FEATURE_IDS:
+        case CONSENSUS_MZS:
+        case CONSENSUS_RTS:
+            return header.rowCount * 8;
+        case CONSENSUS_CHARGES:
+        case COMPOUND_IDS:
+            return header.rowCount * 4;
+        case ROW_OFFSETS:
+            return (header.rowCount + 1) * 8;
+        case SAMPLE_NUMBERS:
+            return header.intensityCount * 4;
+        case INTENSITIES:
+            return header.intensityCount * 8;
+        case SAMPLE_IDS:
+            return header.sampleCount * 8;
+        case SAMPLE_NAMES:
+            return header.sampleCount * 4;
+        case STRING_OFFSETS:
+            return (header.stringCount + 1) * 8;
+        default:
+            return 0;
+    }
+}
+
+inline uint64_t alignSectionOffset(uint64_t offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+} // namespace FeatureMatrixFileFormat
+
+// Maps a binary feature matrix file into memory. The header, the section table, offset arrays, sample numbers
+// and string terminators are checked on opening, everything else is read straight from the mapped file on access.
+class FeatureMatrixFileReader
+{
+public:
+    FeatureMatrixFileReader()
+        : data(NULL), dataSize(0), header(NULL), sections(NULL), mapped(false)
+#ifdef _WIN32
+        , fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL)
+#endif
+    {
+
+    }
+
+    ~FeatureMatrixFileReader()
+    {
+        close();
+    }
+
+    bool open(const std::string &path)
+    {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        LARGE_INTEGER fileSize;
+        if (INVALID_HANDLE_VALUE == fileHandle || !GetFileSizeEx(fileHandle, &fileSize) || 0 == fileSize.QuadPart) {
+            return fail("Unable to open " + path);
+        }
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void *view = NULL != mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (NULL == view) {
+            return fail("Unable to map " + path);
+        }
+        mapped = true;
+        return setData(view, fileSize.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat fileInfo;
+        if (-1 == fd || 0 != fstat(fd, &fileInfo) || 0 == fileInfo.st_size) {
+            if (-1 != fd) {
+                ::close(fd);
+            }
+            return fail("Unable to open " + path);
+        }
+        void *view = mmap(NULL, fileInfo.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // the mapping keeps the file open
+        if (MAP_FAILED == view) {
+            return fail("Unable to map " + path);
+        }
+        mapped = true;
+        return setData(view, fileInfo.st_size);
+#endif
+    }
+
+    // uses a file already loaded into memory, which must be 8-byte aligned and outlive the reader
+    bool open(const void *buffer, uint64_t size)
+    {
+        close();
+        return setData(buffer, size);
+    }
+
+    void close()
+    {
+        if (mapped) {
+#ifdef _WIN32
+            UnmapViewOfFile(data);
+#else
+            munmap(const_cast<char *>(data), dataSize);
+#endif
+        }
+#ifdef _WIN32
+        if (NULL != mappingHandle) {
+            CloseHandle(mappingHandle);
+            mappingHandle = NULL;
+        }
+        if (INVALID_HANDLE_VALUE != fileHandle) {
+            CloseHandle(fileHandle);
+            fileHandle = INVALID_HANDLE_VALUE;
+        }
+#endif
+        data = NULL;
+        dataSize = 0;
+        header = NULL;
+        sections = NULL;
+        mapped = false;
+        error.clear();
+    }
+
+    bool isOpen() const { return NULL != header; }
+    const std::string & getError() const { return error; }
+
+    uint64_t getRowCount() const { return header->rowCount; }
+    uint64_t getSampleCount() const { return header->sampleCount; }
+    uint64_t getIntensityCount() const { return header->intensityCount; }
+
+    const int64_t * getFeatureIds() const { return section<int64_t>(FeatureMatrixFileFormat::FEATURE_IDS); }
+    const double * getConsensusMzs() const { return section<double>(FeatureMatrixFileFormat::CONSENSUS_MZS); }
+    const double * getConsensusRts() const { return section<double>(FeatureMatrixFileFormat::CONSENSUS_RTS); }
+    const int32_t * getConsensusCharges() const { return section<int32_t>(FeatureMatrixFileFormat::CONSENSUS_CHARGES); }
+    const int64_t * getSampleIds() const { return section<int64_t>(FeatureMatrixFileFormat::SAMPLE_IDS); }
+
+    // CSR arrays for processing the whole matrix at once
+    const uint64_t * getRowOffsets() const { return section<uint64_t>(FeatureMatrixFileFormat::ROW_OFFSETS); }
+    const uint32_t * getSampleNumbers() const { return section<uint32_t>(FeatureMatrixFileFormat::SAMPLE_NUMBERS); }
+    const double * getIntensities() const { return section<double>(FeatureMatrixFileFormat::INTENSITIES); }
+
+    const char * getCompoundIds(uint64_t row) const // empty if the feature isn't annotated
+    {
+        return getString(section<uint32_t>(FeatureMatrixFileFormat::COMPOUND_IDS)[row]);
+    }
+
+    const char * getSampleName(uint64_t sampleNumber) const
+    {
+        return getString(section<uint32_t>(FeatureMatrixFileFormat::SAMPLE_NAMES)[sampleNumber]);
+    }
+
+    uint64_t getRowIntensities(uint64_t row, const uint32_t *&sampleNumbers, const double *&intensities) const // returns count
+    {
+        const uint64_t *rowOffsets = getRowOffsets();
+        sampleNumbers = getSampleNumbers() + rowOffsets[row];
+        intensities = getIntensities() + rowOffsets[row];
+        return rowOffsets[row + 1] - rowOffsets[row];
+    }
+
+    double getIntensity(uint64_t row, uint32_t sampleNumber) const // 0 if the feature isn't detected in the sample
+    {
+        const uint32_t *sampleNumbers = NULL;
+        const double *intensities = NULL;
+        const uint64_t count = getRowIntensities(row, sampleNumbers, intensities);
+        const uint32_t *found = std::lower_bound(sampleNumbers, sampleNumbers + count, sampleNumber);
+        return found != sampleNumbers + count && *found == sampleNumber ? intensities[found - sampleNumbers] : 0.0;
+    }
+
+private:
+    FeatureMatrixFileReader(const FeatureMatrixFileReader &);
+    FeatureMatrixFileReader & operator =(const FeatureMatrixFileReader &);
+
+    template<typename T>
+    const T * section(FeatureMatrixFileFormat::Section index) const
+    {
+        return reinterpret_cast<const T *>(data + sections[index].offset);
+    }
+
+    const char * getString(uint32_t index) const
+    {
+        if (index >= header->stringCount) {
+            return "";
+        }
+        return section<char>(FeatureMatrixFileFormat::STRING_DATA) + section<uint64_t>(FeatureMatrixFileFormat::STRING_OFFSETS)[index];
+    }
+
+    bool fail(const std::string &message)
+    {
+        close();
+        error = message;
+        return false;
+    }
+
+    bool setData(const void *buffer, uint64_t size)
+    {
+        using namespace FeatureMatrixFileFormat;
+
+        data = static_cast<const char *>(buffer);
+        dataSize = size;
+        const uint16_t byteOrderProbe = 1;
+        if (1 != *reinterpret_cast<const uint8_t *>(&byteOrderProbe)) {
+            return fail("Feature matrix files can be read only on little-endian machines");
+        }
+        if (0 != reinterpret_cast<uintptr_t>(data) % SECTION_ALIGNMENT) {
+            return fail("Feature matrix data isn't aligned");
+        }
+        if (size < sizeof(Header) || 0 != std::memcmp(data, MAGIC, sizeof(MAGIC))) {
+            return fail("Not a feature matrix file");
+        }
+        const Header *fileHeader = reinterpret_cast<const Header *>(data);
+        if (VERSION != fileHeader->version) {
+            return fail("Unsupported feature matrix file version");
+        }
+        if (fileHeader->sectionCount < SECTION_COUNT
+            || size < sizeof(Header) + uint64_t(fileHeader->sectionCount) * sizeof(SectionEntry))
+        {
+            return fail("Feature matrix file is truncated");
+        }
+        // every count sizes a section of 8-byte elements, larger counts would wrap section sizes around
+        const uint64_t maxCount = size / 8;
+        if (fileHeader->rowCount >= maxCount || fileHeader->sampleCount > maxCount || fileHeader->intensityCount > maxCount
+            || fileHeader->stringCount >= maxCount)
+        {
+            return fail("Feature matrix file is corrupted");
+        }
+        sections = reinterpret_cast<const SectionEntry *>(data + sizeof(Header));
+        for (int i = 0; i < SECTION_COUNT; ++i) {
+            const Section index = static_cast<Section>(i);
+            if (0 != sections[i].offset % SECTION_ALIGNMENT || sections[i].offset > size || sections[i].size > size - sections[i].offset
+                || (STRING_DATA != index && getSectionSize(index, *fileHeader) != sections[i].size))
+            {
+                return fail("Feature matrix file is corrupted");
+            }
+        }
+        header = fileHeader;
+
+        // offsets are checked once here, so that accessors can't go out of the file
+        if (!isAscending(getRowOffsets(), header->rowCount, header->intensityCount)
+            || !isAscending(section<uint64_t>(STRING_OFFSETS), header->stringCount, sections[STRING_DATA].size))
+        {
+            return fail("Feature matrix file is corrupted");
+        }
+        // getIntensity and callers of getSampleName index samples by these numbers
+        const uint32_t *sampleNumbers = getSampleNumbers();
+        for (uint64_t i = 0; i < header->intensityCount; ++i) {
+            if (sampleNumbers[i] >= header->sampleCount) {
+                return fail("Feature matrix file is corrupted");
+            }
+        }
+        // getString returns pointers into the file, so every string has to end within its own range
+        const uint64_t *stringOffsets = section<uint64_t>(STRING_OFFSETS);
+        const char *stringData = section<char>(STRING_DATA);
+        for (uint64_t i = 0; i < header->stringCount; ++i) {
+            if (stringOffsets[i + 1] == stringOffsets[i] || '\0' != stringData[stringOffsets[i + 1] - 1]) {
+                return fail("Feature matrix file is corrupted");
+            }
+        }
+        return true;
+    }
+
+    static bool isAscending(const uint64_t *offsets, uint64_t count, uint64_t end)
+    {
+        if (0 != offsets[0] || end != offsets[count]) {
+            return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            if (offsets[i] > offsets[i + 1]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char *data;
+    uint64_t dataSize;
+    const FeatureMatrixFileFormat::Header *header;
+    const FeatureMatrixFileFormat::SectionEntry *sections;
+    bool mapped;
+    std::string error;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+};
+
+} // namespace ov
+
+#endif // FEATURE_MATRIX_FILE_READER_H
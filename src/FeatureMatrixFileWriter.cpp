@@ -0,0 +1,194 @@
+#include <cstring>
+
+#include <QHash>
+#include <QIODevice>
+#include <QtEndian>
+
+#include "FeatureMatrixFileWriter.h"
+
+const int WRITE_BUFFER_SIZE = 1 << 20; // bytes
+
+namespace ov {
+
+using namespace FeatureMatrixFileFormat;
+
+namespace {
+
+class StringTable
+{
+public:
+    quint32 add(const QString &str)
+    {
+        const QHash<QString, quint32>::const_iterator found = indices.constFind(str);
+        if (found != indices.constEnd()) {
+            return found.value();
+        }
+        const quint32 index = offsets.size();
+        offsets.append(data.size());
+        data.append(str.toUtf8());
+        data.append('\0');
+        indices.insert(str, index);
+        return index;
+    }
+
+    QVector<quint64> offsets;
+    QByteArray data;
+
+private:
+    QHash<QString, quint32> indices;
+};
+
+}
+
+FeatureMatrixFileWriter::FeatureMatrixFileWriter(QIODevice *device)
+    : device(device), writtenSize(0)
+{
+    Q_ASSERT(NULL != device);
+    buffer.reserve(WRITE_BUFFER_SIZE);
+}
+
+template<typename T>
+void FeatureMatrixFileWriter::append(T value)
+{
+    const T littleEndianValue = qToLittleEndian(value);
+    buffer.append(reinterpret_cast<const char *>(&littleEndianValue), sizeof(T));
+}
+
+void FeatureMatrixFileWriter::append(double value)
+{
+    quint64 bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    append(bits);
+}
+
+bool FeatureMatrixFileWriter::flush()
+{
+    const bool ok = device->write(buffer) == buffer.size();
+    writtenSize += buffer.size();
+    buffer.clear();
+    return ok;
+}
+
+bool FeatureMatrixFileWriter::beginSection(Section section, const ProgressCallback &progress)
+{
+    while ((writtenSize + buffer.size()) % SECTION_ALIGNMENT != 0) {
+        buffer.append('\0');
+    }
+    Q_ASSERT(quint64(writtenSize + buffer.size()) == sections[section].offset);
+    return progress(100 * section / SECTION_COUNT) && (buffer.size() < WRITE_BUFFER_SIZE || flush());
+}
+
+template<typename ValueGetter>
+bool FeatureMatrixFileWriter::writeSection(Section section, int count, ValueGetter valueAt, const ProgressCallback &progress)
+{
+    if (!beginSection(section, progress)) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        append(valueAt(i));
+        if (buffer.size() >= WRITE_BUFFER_SIZE && !flush()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FeatureMatrixFileWriter::write(const FeatureMatrix &matrix, const QVector<int> &rows, const QVector<SampleId> &sampleIds,
+    const QStringList &sampleNames, const ProgressCallback &progress)
+{
+    Q_ASSERT(sampleIds.size() == matrix.getSampleCount() && sampleNames.size() == matrix.getSampleCount());
+
+    // strings go to the end of the file, but their indices are needed earlier
+    StringTable strings;
+    QVector<quint32> compoundIdStrings;
+    compoundIdStrings.reserve(rows.size());
+    QVector<quint64> rowOffsets;
+    rowOffsets.reserve(rows.size() + 1);
+    rowOffsets.append(0);
+    foreach (int row, rows) {
+        const QString compoundIds = matrix.getCompoundIds(row);
+        compoundIdStrings.append(compoundIds.isEmpty() ? NO_STRING : strings.add(compoundIds));
+        const int *rowSampleNumbers = NULL;
+        const double *rowIntensities = NULL;
+        rowOffsets.append(rowOffsets.last() + matrix.getRowIntensities(row, rowSampleNumbers, rowIntensities));
+    }
+    QVector<quint32> sampleNameStrings;
+    foreach (const QString &name, sampleNames) {
+        sampleNameStrings.append(strings.add(name));
+    }
+    strings.offsets.append(strings.data.size());
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sectionCount = SECTION_COUNT;
+    header.rowCount = rows.size();
+    header.sampleCount = sampleIds.size();
+    header.intensityCount = rowOffsets.last();
+    header.stringCount = strings.offsets.size() - 1;
+
+    quint64 offset = sizeof(Header) + sizeof(SectionEntry) * SECTION_COUNT;
+    for (int i = 0; i < SECTION_COUNT; ++i) {
+        const Section section = static_cast<Section>(i);
+        sections[i].offset = alignSectionOffset(offset);
+        sections[i].size = STRING_DATA == section ? strings.data.size() : getSectionSize(section, header);
+        offset = sections[i].offset + sections[i].size;
+    }
+
+    buffer.append(header.magic, sizeof(header.magic));
+    append(header.version);
+    append(header.sectionCount);
+    append(header.rowCount);
+    append(header.sampleCount);
+    append(header.intensityCount);
+    append(header.stringCount);
+    for (int i = 0; i < SECTION_COUNT; ++i) {
+        append(sections[i].offset);
+        append(sections[i].size);
+    }
+
+    const bool ok = writeSection(FEATURE_IDS, rows.size(), [&](int i) { return qint64(matrix.getFeatureId(rows[i])); }, progress)
+        && writeSection(CONSENSUS_MZS, rows.size(), [&](int i) { return double(matrix.getConsensusMz(rows[i])); }, progress)
+        && writeSection(CONSENSUS_RTS, rows.size(), [&](int i) { return double(matrix.getConsensusRt(rows[i])); }, progress)
+        && writeSection(CONSENSUS_CHARGES, rows.size(), [&](int i) { return qint32(matrix.getConsensusCharge(rows[i])); }, progress)
+        && writeSection(COMPOUND_IDS, rows.size(), [&](int i) { return compoundIdStrings[i]; }, progress)
+        && writeSection(ROW_OFFSETS, rowOffsets.size(), [&](int i) { return rowOffsets[i]; }, progress)
+        && writeIntensities(matrix, rows, progress)
+        && writeSection(SAMPLE_IDS, sampleIds.size(), [&](int i) { return qint64(sampleIds[i]); }, progress)
+        && writeSection(SAMPLE_NAMES, sampleNameStrings.size(), [&](int i) { return sampleNameStrings[i]; }, progress)
+        && writeSection(STRING_OFFSETS, strings.offsets.size(), [&](int i) { return strings.offsets[i]; }, progress)
+        && beginSection(STRING_DATA, progress);
+    if (!ok) {
+        return false;
+    }
+    buffer.append(strings.data);
+    return flush();
+}
+
+bool FeatureMatrixFileWriter::writeIntensities(const FeatureMatrix &matrix, const QVector<int> &rows, const ProgressCallback &progress)
+{
+    // both arrays are written row by row, so rows are walked twice instead of materializing a reordered copy
+    for (int section = SAMPLE_NUMBERS; section <= INTENSITIES; ++section) {
+        if (!beginSection(static_cast<Section>(section), progress)) {
+            return false;
+        }
+        foreach (int row, rows) {
+            const int *rowSampleNumbers = NULL;
+            const double *rowIntensities = NULL;
+            const int count = matrix.getRowIntensities(row, rowSampleNumbers, rowIntensities);
+            for (int i = 0; i < count; ++i) {
+                if (SAMPLE_NUMBERS == section) {
+                    append(quint32(rowSampleNumbers[i]));
+                } else {
+                    append(rowIntensities[i]);
+                }
+            }
+            if (buffer.size() >= WRITE_BUFFER_SIZE && !flush()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace ov
@@ -0,0 +1,50 @@
+#ifndef FEATURE_MATRIX_FILE_WRITER_H
+#define FEATURE_MATRIX_FILE_WRITER_H
+
+#include <functional>
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+#include "FeatureMatrix.h"
+#include "FeatureMatrixFileReader.h"
+
+class QIODevice;
+
+namespace ov {
+
+// Writes a feature matrix in the binary format described in FeatureMatrixFileReader.h.
+// Sections are written one after another through a fixed-size buffer, so the device may be sequential.
+class FeatureMatrixFileWriter
+{
+public:
+    // receives the share of written sections in percents, returns false to stop writing
+    typedef std::function<bool (int)> ProgressCallback;
+
+    explicit FeatureMatrixFileWriter(QIODevice *device);
+
+    // @rows: matrix rows in the order they should be written
+    // @sampleIds, @sampleNames: indexed by sample numbers of the matrix
+    bool write(const FeatureMatrix &matrix, const QVector<int> &rows, const QVector<SampleId> &sampleIds,
+        const QStringList &sampleNames, const ProgressCallback &progress);
+
+private:
+    template<typename T>
+    void append(T value);
+    void append(double value);
+    bool beginSection(FeatureMatrixFileFormat::Section section, const ProgressCallback &progress);
+    template<typename ValueGetter>
+    bool writeSection(FeatureMatrixFileFormat::Section section, int count, ValueGetter valueAt, const ProgressCallback &progress);
+    bool writeIntensities(const FeatureMatrix &matrix, const QVector<int> &rows, const ProgressCallback &progress);
+    bool flush();
+
+    QIODevice *device;
+    QByteArray buffer;
+    FeatureMatrixFileFormat::SectionEntry sections[FeatureMatrixFileFormat::SECTION_COUNT];
+    qint64 writtenSize;
+};
+
+} // namespace ov
+
+#endif // FEATURE_MATRIX_FILE_WRITER_H
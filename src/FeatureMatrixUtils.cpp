@@ -0,0 +1,79 @@
+#include <cmath>
+
+#include <QAtomicInt>
+#include <QtConcurrent>
+
+#include "IntensityNormalization.h"
+
+#include "FeatureMatrixUtils.h"
+
+namespace ov {
+
+namespace FeatureMatrixUtils {
+
+namespace {
+
+class BlockRunner
+{
+public:
+    BlockRunner(const std::function<void (int, int)> &function, const ProgressCallback &progress, int itemCount,
+        int itemsPerTask, QAtomicInt &finishedBlocks, QAtomicInt &stopped)
+        : function(function), progress(progress), itemCount(itemCount), itemsPerTask(itemsPerTask),
+        blockCount((itemCount + itemsPerTask - 1) / itemsPerTask), finishedBlocks(finishedBlocks), stopped(stopped)
+    {
+
+    }
+
+    void operator ()(int firstItem) const
+    {
+        if (stopped.load()) {
+            return;
+        }
+        function(firstItem, qMin(firstItem + itemsPerTask, itemCount));
+        if (progress) {
+            const int finished = finishedBlocks.fetchAndAddOrdered(1) + 1;
+            if (!progress(100 * finished / blockCount)) {
+                stopped.store(1);
+            }
+        }
+    }
+
+private:
+    const std::function<void (int, int)> &function;
+    const ProgressCallback &progress;
+    int itemCount;
+    int itemsPerTask;
+    int blockCount;
+    QAtomicInt &finishedBlocks;
+    QAtomicInt &stopped;
+};
+
+}
+
+double getLogIntensity(double intensity)
+{
+    return std::log2(1.0 + qMax(0.0, intensity));
+}
+
+double getLogIntensity(const IntensityNormalization &normalization, int sampleNumber, double intensity)
+{
+    return getLogIntensity(normalization.normalize(sampleNumber, intensity));
+}
+
+bool runInBlocks(int itemCount, int itemsPerTask, const std::function<void (int, int)> &function,
+    const ProgressCallback &progress)
+{
+    Q_ASSERT(itemsPerTask > 0);
+    QVector<int> firstItems;
+    for (int item = 0; item < itemCount; item += itemsPerTask) {
+        firstItems.append(item);
+    }
+    QAtomicInt finishedBlocks(0);
+    QAtomicInt stopped(0);
+    QtConcurrent::blockingMap(firstItems, BlockRunner(function, progress, itemCount, itemsPerTask, finishedBlocks, stopped));
+    return !stopped.load();
+}
+
+} // namespace FeatureMatrixUtils
+
+} // namespace ov
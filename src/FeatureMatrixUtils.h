@@ -0,0 +1,49 @@
+#ifndef FEATURE_MATRIX_UTILS_H
+#define FEATURE_MATRIX_UTILS_H
+
+#include <functional>
+
+#include <QVector>
+
+namespace ov {
+
+class IntensityNormalization;
+
+// Building blocks of computations over all features of a FeatureMatrix
+namespace FeatureMatrixUtils {
+
+const int ROWS_PER_TASK = 4096; // enough work per task to hide the scheduling overhead
+
+// receives percents of the work done and returns false once its result isn't needed anymore;
+// called from worker threads, possibly from several of them at once
+typedef std::function<bool (int)> ProgressCallback;
+
+// log2(1 + intensity), the scale on which profiles of features and samples are compared;
+// undetected features and negative normalized intensities give 0
+double getLogIntensity(double intensity);
+double getLogIntensity(const IntensityNormalization &normalization, int sampleNumber, double intensity);
+
+// calls @function for ranges [begin, end) of at most @itemsPerTask items in parallel and waits for all of them;
+// @progress is told about every finished range, once it returns false the ranges that haven't started yet
+// are skipped and false is returned
+bool runInBlocks(int itemCount, int itemsPerTask, const std::function<void (int, int)> &function,
+    const ProgressCallback &progress = ProgressCallback());
+
+// same, results of the ranges are returned in their order, skipped ranges get default values
+template<typename Result>
+QVector<Result> mapBlocks(int itemCount, int itemsPerTask, const std::function<Result (int, int)> &function,
+    const ProgressCallback &progress = ProgressCallback())
+{
+    QVector<Result> results((itemCount + itemsPerTask - 1) / itemsPerTask);
+    Result *blockResults = results.data(); // detached before tasks write their own elements
+    runInBlocks(itemCount, itemsPerTask, [blockResults, itemsPerTask, &function] (int begin, int end) {
+        blockResults[begin / itemsPerTask] = function(begin, end);
+    }, progress);
+    return results;
+}
+
+} // namespace FeatureMatrixUtils
+
+} // namespace ov
+
+#endif // FEATURE_MATRIX_UTILS_H
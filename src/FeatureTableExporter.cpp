@@ -1,47 +1,165 @@
-#include <QAbstractItemModel>
 #include <QApplication>
+#include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QSortFilterProxyModel>
+#include <QtConcurrent>
 
 #include "AppView.h"
-#include "CsvWritingUtils.h"
+#include "CsvWriter.h"
+#include "FeatureDataSource.h"
+#include "FeatureMatrixFileWriter.h"
+#include "FeatureTableModel.h"
 
 #include "FeatureTableExporter.h"
 
+const int PROGRESS_REPORT_ROW_STEP = 1000;
+
 namespace ov {
 
-FeatureTableExporter::FeatureTableExporter(const AppView &appView)
-    : appView(appView)
+namespace {
+
+void writeValue(CsvWriter &writer, const QVariant &value)
+{
+    switch (value.type()) {
+        case QVariant::Double:
+            writer.writeField(value.toDouble());
+            break;
+        case QVariant::Int:
+        case QVariant::LongLong:
+            writer.writeField(value.toLongLong());
+            break;
+        default:
+            writer.writeField(value.toString());
+    }
+}
+
+}
+
+FeatureTableExporter::FeatureTableExporter(const AppView &appView, const FeatureDataSource &dataSource)
+    : appView(appView), dataSource(dataSource), cancelRequested(0)
 {
+    progressIndicator.setWindowTitle(tr("Exporting feature table..."));
+    progressIndicator.setModal(true);
 
+    connect(this, &FeatureTableExporter::exportProgress, &progressIndicator, &ProgressIndicator::progress);
+    connect(&progressIndicator, &ProgressIndicator::canceled, this, &FeatureTableExporter::cancelExport);
+    connect(&exportWatcher, &QFutureWatcher<bool>::finished, this, &FeatureTableExporter::exportFinished);
+}
+
+FeatureTableExporter::~FeatureTableExporter()
+{
+    cancelRequested.store(1);
+    exportWatcher.waitForFinished();
 }
 
 void FeatureTableExporter::exportFeatures(const QVector<int> &visibleColumns)
 {
-    const QString path = QFileDialog::getSaveFileName(QApplication::activeWindow(), tr("Export Feature Table"), QString(), tr("CSV File (*.csv)"));
+    if (exportWatcher.isRunning()) {
+        return;
+    }
+
+    const QString csvFilter = tr("CSV File (*.csv)");
+    const QString binaryFilter = tr("Binary Feature Matrix (*.ovm)");
+    QString selectedFilter;
+    const QString path = QFileDialog::getSaveFileName(QApplication::activeWindow(), tr("Export Feature Table"), QString(),
+        csvFilter + ";;" + binaryFilter, &selectedFilter);
 
     if (path.isEmpty()) {
         return;
     }
 
-    const int columnCount = visibleColumns.size();
-    const QAbstractItemModel *featureTableModel = appView.getTableModel();
-    Q_ASSERT(NULL != featureTableModel);
-    const int rowCount = featureTableModel->rowCount() + 1; // +1 header row
-    QList<QStringList> table = CsvWritingUtils::createEmptyTable(rowCount, columnCount);
+    const QSortFilterProxyModel *proxyModel = dynamic_cast<const QSortFilterProxyModel *>(appView.getTableModel());
+    Q_ASSERT(NULL != proxyModel);
+
+    ExportTask task;
+    task.path = path;
+    task.binary = binaryFilter == selectedFilter || path.endsWith(".ovm", Qt::CaseInsensitive);
+    task.columns = visibleColumns;
+    foreach (int column, visibleColumns) {
+        task.header.append(proxyModel->headerData(column, Qt::Horizontal).toString());
+    }
+    // the model is only touched here, the worker reads rows straight from the shared feature matrix
+    const int rowCount = proxyModel->rowCount();
+    task.rows.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        task.rows.append(proxyModel->mapToSource(proxyModel->index(row, 0)).row());
+    }
+    task.matrix = dataSource.getFeatureMatrix();
+    const FeatureTableModel *model = dynamic_cast<const FeatureTableModel *>(proxyModel->sourceModel());
+    task.normalization = model->getNormalization();
+    task.statistics = model->getDifferentialStatistics();
+    task.groups = model->getFeatureGroups();
+    for (int i = 0; i < task.matrix.getSampleCount(); ++i) {
+        task.sampleIds.append(dataSource.getSampleIdByNumber(i));
+        task.sampleNames.append(dataSource.getSampleNameById(task.sampleIds.last()));
+    }
+
+    exportPath = path;
+    cancelRequested.store(0);
+    progressIndicator.started();
+    exportWatcher.setFuture(QtConcurrent::run(this, &FeatureTableExporter::writeFeatures, task));
+}
 
-    for (int column = 0; column < columnCount; ++column) {
-        table[0][column] = featureTableModel->headerData(visibleColumns[column], Qt::Horizontal).toString();
+bool FeatureTableExporter::writeFeatures(const ExportTask &task)
+{
+    QFile file(task.path);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
     }
+    return task.binary ? writeBinaryFeatures(task, file) : writeCsvFeatures(task, file);
+}
+
+bool FeatureTableExporter::writeBinaryFeatures(const ExportTask &task, QFile &file)
+{
+    FeatureMatrixFileWriter writer(&file);
+    return writer.write(task.matrix, task.rows, task.sampleIds, task.sampleNames, [this](int percents) {
+        emit exportProgress(percents);
+        return !cancelRequested.load();
+    });
+}
+
+bool FeatureTableExporter::writeCsvFeatures(const ExportTask &task, QFile &file)
+{
+    CsvWriter writer(&file);
+    writer.writeRow(task.header);
+
+    const int rowCount = task.rows.size();
+    const int columnCount = task.columns.size();
+    for (int i = 0; i < rowCount; ++i) {
+        if (cancelRequested.load()) {
+            return false;
+        }
 
-    for (int row = 1; row < rowCount; ++row) {
+        const int row = task.rows[i];
         for (int column = 0; column < columnCount; ++column) {
-            table[row][column] = featureTableModel->data(featureTableModel->index(row - 1, visibleColumns[column])).toString();
+            writeValue(writer, FeatureTableModel::getMatrixCellValue(task.matrix, task.normalization, task.statistics, task.groups,
+                row, task.columns[column]));
+        }
+        writer.endRow();
+
+        if (0 == i % PROGRESS_REPORT_ROW_STEP) {
+            emit exportProgress(100 * i / rowCount);
         }
     }
 
-    if (!CsvWritingUtils::saveTableToFile(table, path)) {
-        QMessageBox::critical(QApplication::activeWindow(), tr("Error"), tr("Unable to save file: %1").arg(path));
+    return writer.flush();
+}
+
+void FeatureTableExporter::cancelExport()
+{
+    cancelRequested.store(1);
+}
+
+void FeatureTableExporter::exportFinished()
+{
+    progressIndicator.finished();
+
+    if (cancelRequested.load()) {
+        QFile::remove(exportPath);
+    } else if (!exportWatcher.result()) {
+        QFile::remove(exportPath);
+        QMessageBox::critical(QApplication::activeWindow(), tr("Error"), tr("Unable to save file: %1").arg(exportPath));
     }
 }
 
@@ -1,23 +1,69 @@
 #ifndef FEATURE_TABLE_EXPORTER_H
 #define FEATURE_TABLE_EXPORTER_H
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
 #include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "DifferentialStatistics.h"
+#include "FeatureGroups.h"
+#include "FeatureMatrix.h"
+#include "IntensityNormalization.h"
+#include "ProgressIndicator.h"
+
+class QFile;
 
 namespace ov {
 
 class AppView;
+class FeatureDataSource;
 
 class FeatureTableExporter: public QObject
 {
     Q_OBJECT
 public:
-    FeatureTableExporter(const AppView &appView);
+    FeatureTableExporter(const AppView &appView, const FeatureDataSource &dataSource);
+    ~FeatureTableExporter();
+
+signals:
+    void exportProgress(int percents);
 
 public slots:
     void exportFeatures(const QVector<int> &visibleColumns);
 
+private slots:
+    void exportFinished();
+    void cancelExport();
+
 private:
+    // everything the worker thread needs, copied from the GUI thread before the export starts
+    struct ExportTask
+    {
+        QString path;
+        bool binary; // the whole matrix in the format of FeatureMatrixFileReader.h instead of visible columns in CSV
+        QStringList header;
+        QVector<int> columns; // source model columns
+        QVector<int> rows; // source model rows in the order they're displayed
+        FeatureMatrix matrix;
+        IntensityNormalization normalization; // the binary format always has raw intensities
+        DifferentialStatistics statistics;
+        FeatureGroups groups;
+        QVector<SampleId> sampleIds;
+        QStringList sampleNames;
+    };
+
+    bool writeFeatures(const ExportTask &task);
+    bool writeCsvFeatures(const ExportTask &task, QFile &file);
+    bool writeBinaryFeatures(const ExportTask &task, QFile &file);
+
     const AppView &appView;
+    const FeatureDataSource &dataSource;
+    ProgressIndicator progressIndicator;
+    QFutureWatcher<bool> exportWatcher;
+    QAtomicInt cancelRequested;
+    QString exportPath;
 };
 
 } // namespace ov
@@ -1,30 +1,74 @@
 #include <QAbstractItemView>
+#include <QPainter>
+
+#include "FeatureTableModel.h"
 
 #include "FeatureTableItemDelegate.h"
 
+const qreal SPARKLINE_HEIGHT_RATIO = 0.6; // of the cell height, the upper part is left for the text
+const int SPARKLINE_ALPHA = 70;
+
 namespace ov {
 
 FeatureTableItemDelegate::FeatureTableItemDelegate(QAbstractItemView *view)
-    : QStyledItemDelegate(view), view(view)
+    : QStyledItemDelegate(view), view(view), sparklinesVisible(false)
+{
+
+}
+
+void FeatureTableItemDelegate::setSparklinesVisible(bool visible)
 {
+    sparklinesVisible = visible;
+}
 
+bool FeatureTableItemDelegate::areSparklinesVisible() const
+{
+    return sparklinesVisible;
 }
 
 void FeatureTableItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
     if (NULL == view->indexWidget(index)) {
-        const int row = index.row();
-        bool intersectsSelection = false;
-        foreach (const QModelIndex &selectedIndex, view->selectionModel()->selectedIndexes()) {
-            if (selectedIndex.row() == row) {
-                intersectsSelection = true;
-                break;
-            }
-        }
         QStyleOptionViewItem customOption = option;
-        customOption.font.setBold(intersectsSelection);
+        customOption.font.setBold(view->selectionModel()->rowIntersectsSelection(index.row(), index.parent()));
         QStyledItemDelegate::paint(painter, customOption, index);
+
+        if (sparklinesVisible) {
+            // the model never waits for a profile, missing ones are requested and the view is updated when they arrive
+            const QVariant sparkline = index.data(FeatureTableModel::SPARKLINE_ROLE);
+            if (sparkline.isValid()) {
+                paintSparkline(painter, option.rect, sparkline.toByteArray());
+            }
+        }
+    }
+}
+
+void FeatureTableItemDelegate::paintSparkline(QPainter *painter, const QRect &rect, const QByteArray &sparkline) const
+{
+    if (sparkline.size() < 2) {
+        return;
     }
+    const QRectF area = QRectF(rect).adjusted(1, 1, -1, -1);
+    const qreal height = area.height() * SPARKLINE_HEIGHT_RATIO;
+    const qreal step = area.width() / (sparkline.size() - 1);
+
+    QPolygonF polygon;
+    polygon.reserve(sparkline.size() + 2);
+    polygon.append(area.bottomLeft());
+    for (int i = 0; i < sparkline.size(); ++i) {
+        const quint8 value = sparkline[i];
+        polygon.append(QPointF(area.left() + i * step, area.bottom() - value * height / 255));
+    }
+    polygon.append(area.bottomRight());
+
+    QColor color = view->palette().color(QPalette::Highlight);
+    color.setAlpha(SPARKLINE_ALPHA);
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(color);
+    painter->drawPolygon(polygon);
+    painter->restore();
 }
 
 } // namespace ov
@@ -12,8 +12,15 @@ public:
 
     void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
 
+    // elution profiles are drawn under intensities of the cells they are already loaded for
+    void setSparklinesVisible(bool visible);
+    bool areSparklinesVisible() const;
+
 private:
+    void paintSparkline(QPainter *painter, const QRect &rect, const QByteArray &sparkline) const;
+
     QAbstractItemView *view;
+    bool sparklinesVisible;
 };
 
 } // namespace ov
@@ -1,6 +1,9 @@
+#include <cmath>
+
 #include <QLabel>
 
 #include "FeatureDataSource.h"
+#include "FeatureMatrix.h"
 
 #include "FeatureTableModel.h"
 
@@ -13,7 +16,7 @@ namespace ov {
 
 FeatureTableModel::FeatureTableModel(QObject *parent, FeatureDataSource *dataSource)
     : QAbstractTableModel(parent), rowNumber(DEFAULT_TABLE_SIZE), columnNumber(DEFAULT_TABLE_SIZE), dataSource(dataSource),
-    totalFeatureObservationCount(0)
+    massTraceIndexBuilt(false)
 {
 
 }
@@ -25,7 +28,9 @@ void FeatureTableModel::updateRowNumber()
 
 void FeatureTableModel::updateColumnNumber()
 {
-    columnNumber = SAMPLE_COLUMNS_OFFSET + dataSource->getSampleCount();
+    columnNumber = SAMPLE_COLUMNS_OFFSET + dataSource->getSampleCount()
+        + (differentialStatistics.isEmpty() ? 0 : DifferentialStatistics::COLUMN_COUNT)
+        + (featureGroups.isEmpty() ? 0 : FeatureGroups::COLUMN_COUNT);
 }
 
 int FeatureTableModel::countOfGeneralDataColumns() const
@@ -33,18 +38,9 @@ int FeatureTableModel::countOfGeneralDataColumns() const
     return SAMPLE_COLUMNS_OFFSET;
 }
 
-void FeatureTableModel::updateFeatureCount()
+int FeatureTableModel::countOfSampleColumns() const
 {
-    featureObservationCount.clear();
-    totalFeatureObservationCount = 0;
-
-    QSqlQuery sampleFeatureCountQuery("SELECT feature_id, COUNT(*) FROM SampleFeature WHERE feature_id IN "
-        "(SELECT DISTINCT feature_id FROM SampleFeature) GROUP BY feature_id");
-    while (sampleFeatureCountQuery.next()) {
-        const qint64 featureCount = sampleFeatureCountQuery.value(1).toLongLong();
-        featureObservationCount[sampleFeatureCountQuery.value(0).value<FeatureId>()] = featureCount;
-        totalFeatureObservationCount += featureCount;
-    }
+    return dataSource->getSampleCount();
 }
 
 void FeatureTableModel::updateFeatureAnnotationRows()
@@ -73,24 +69,19 @@ void FeatureTableModel::updateFeatureAnnotationRows()
     annotationFetcher.seek(0);
 }
 
-void FeatureTableModel::invalidateCache()
-{
-    cachedCells = QVector<QVariant>(rowNumber * columnNumber);
-}
-
 void FeatureTableModel::reset()
 {
     beginResetModel();
 
+    differentialStatistics = DifferentialStatistics();
+    featureGroups = FeatureGroups();
+    massTraceIndex.clear();
+    massTraceIndexBuilt = false;
     updateRowNumber();
     updateColumnNumber();
-    updateFeatureCount();
-    invalidateCache();
-
-    consensusFeatureFetcher = QSqlQuery("SELECT id, consensus_mz, consensus_rt, consensus_charge FROM Feature ORDER BY id");
-    intensityFetcher = QSqlQuery("SELECT feature_id, sample_id, intensity FROM SampleFeature ORDER BY feature_id, sample_id");
-
+    cachedCompoundIds = QVector<QVariant>(rowNumber);
     updateFeatureAnnotationRows();
+    normalization = IntensityNormalization();
 
     endResetModel();
 }
@@ -113,15 +104,20 @@ int FeatureTableModel::rowCount(const QModelIndex &parent) const
 Qt::ItemFlags FeatureTableModel::flags(const QModelIndex &index) const
 {
     Qt::ItemFlags result = QAbstractTableModel::flags(index);
-    if (index.column() < SAMPLE_COLUMNS_OFFSET) {
+    if (index.column() < SAMPLE_COLUMNS_OFFSET || index.column() >= SAMPLE_COLUMNS_OFFSET + countOfSampleColumns()) {
         result &= ~Qt::ItemIsEnabled;
     }
     return result;
 }
 
+DataSourceId FeatureTableModel::getDataSourceId() const
+{
+    return dataSource->currentDataSourceId();
+}
+
 SampleId FeatureTableModel::getSampleIdByColumnNumber(int column) const
 {
-    if (column >= SAMPLE_COLUMNS_OFFSET && column < columnNumber) {
+    if (column >= SAMPLE_COLUMNS_OFFSET && column < SAMPLE_COLUMNS_OFFSET + countOfSampleColumns()) {
         return dataSource->getSampleIdByNumber(column - SAMPLE_COLUMNS_OFFSET);
     } else {
         Q_ASSERT(false);
@@ -129,42 +125,149 @@ SampleId FeatureTableModel::getSampleIdByColumnNumber(int column) const
     }
 }
 
-qint64 FeatureTableModel::findFirstQueryRecordIndex(QSqlQuery &query, qint64 startIndex, qint64 endIndex, int fieldNumber, qint64 value)
+QVector<SampleId> FeatureTableModel::getSampleIds() const
 {
-    qint64 left = startIndex;
-    qint64 right = endIndex;
+    QVector<SampleId> sampleIds;
+    for (int sampleNumber = 0; sampleNumber < countOfSampleColumns(); ++sampleNumber) {
+        sampleIds.append(dataSource->getSampleIdByNumber(sampleNumber));
+    }
+    return sampleIds;
+}
 
-    while (right - left > 1) {
-        qint64 middle = left + (right - left) / 2;
-        query.seek(middle);
-        if (query.value(fieldNumber).toLongLong() < value) {
-            left = middle;
-        } else {
-            right = middle;
+FeatureId FeatureTableModel::getFeatureIdByRowNumber(int row) const
+{
+    Q_ASSERT(row >= 0 && row < rowNumber);
+    return dataSource->getFeatureIdByNumber(row);
+}
+
+qreal FeatureTableModel::getFeatureMzByRowNumber(int row) const
+{
+    return dataSource->getFeatureMatrix().getConsensusMz(row);
+}
+
+const FeatureMatrix & FeatureTableModel::getFeatureMatrix() const
+{
+    return dataSource->getFeatureMatrix();
+}
+
+const MassTraceIndex & FeatureTableModel::getMassTraceIndex() const
+{
+    return massTraceIndex;
+}
+
+void FeatureTableModel::setMassTraceIndex(const MassTraceIndex &index)
+{
+    massTraceIndex = index;
+    massTraceIndexBuilt = true;
+}
+
+bool FeatureTableModel::isMassTraceIndexBuilt() const
+{
+    return massTraceIndexBuilt;
+}
+
+bool FeatureTableModel::hasMassTraces() const
+{
+    return massTraceIndexBuilt ? !massTraceIndex.isEmpty() : MassTraceIndex::isStoredInDatabase();
+}
+
+const AnnotationIndex & FeatureTableModel::getAnnotationIndex() const
+{
+    return dataSource->getAnnotationIndex();
+}
+
+int FeatureTableModel::getAnnotationColumn() const
+{
+    return ANNOTATION_COLUMN_OFFSET;
+}
+
+void FeatureTableModel::setNormalization(const IntensityNormalization &normalization)
+{
+    this->normalization = normalization;
+    if (rowNumber > 0 && columnNumber > SAMPLE_COLUMNS_OFFSET) {
+        // the proxy model sorts and filters rows again on this signal
+        emit dataChanged(index(0, SAMPLE_COLUMNS_OFFSET), index(rowNumber - 1, columnNumber - 1), QVector<int>() << Qt::DisplayRole);
+    }
+}
+
+const IntensityNormalization & FeatureTableModel::getNormalization() const
+{
+    return normalization;
+}
+
+void FeatureTableModel::setDifferentialStatistics(const DifferentialStatistics &statistics)
+{
+    const int firstStatisticsColumn = SAMPLE_COLUMNS_OFFSET + countOfSampleColumns();
+    const int lastStatisticsColumn = firstStatisticsColumn + DifferentialStatistics::COLUMN_COUNT - 1;
+    if (differentialStatistics.isEmpty() && !statistics.isEmpty()) {
+        beginInsertColumns(QModelIndex(), firstStatisticsColumn, lastStatisticsColumn);
+        differentialStatistics = statistics;
+        updateColumnNumber();
+        endInsertColumns();
+    } else if (!differentialStatistics.isEmpty() && statistics.isEmpty()) {
+        beginRemoveColumns(QModelIndex(), firstStatisticsColumn, lastStatisticsColumn);
+        differentialStatistics = statistics;
+        updateColumnNumber();
+        endRemoveColumns();
+    } else if (!statistics.isEmpty()) {
+        differentialStatistics = statistics;
+        emit headerDataChanged(Qt::Horizontal, firstStatisticsColumn, lastStatisticsColumn);
+        if (rowNumber > 0) {
+            emit dataChanged(index(0, firstStatisticsColumn), index(rowNumber - 1, lastStatisticsColumn), QVector<int>() << Qt::DisplayRole);
         }
     }
-    query.seek(left);
-    if (query.value(fieldNumber).toLongLong() == value) {
-        return left;
-    } else {
-        query.seek(right);
-        return right;
+}
+
+const DifferentialStatistics & FeatureTableModel::getDifferentialStatistics() const
+{
+    return differentialStatistics;
+}
+
+int FeatureTableModel::getFirstGroupColumn() const
+{
+    return columnNumber - (featureGroups.isEmpty() ? 0 : FeatureGroups::COLUMN_COUNT);
+}
+
+void FeatureTableModel::setFeatureGroups(const FeatureGroups &groups)
+{
+    const int firstGroupColumn = getFirstGroupColumn();
+    const int lastGroupColumn = firstGroupColumn + FeatureGroups::COLUMN_COUNT - 1;
+    if (featureGroups.isEmpty() && !groups.isEmpty()) {
+        beginInsertColumns(QModelIndex(), firstGroupColumn, lastGroupColumn);
+        featureGroups = groups;
+        updateColumnNumber();
+        endInsertColumns();
+    } else if (!featureGroups.isEmpty() && groups.isEmpty()) {
+        beginRemoveColumns(QModelIndex(), firstGroupColumn, lastGroupColumn);
+        featureGroups = groups;
+        updateColumnNumber();
+        endRemoveColumns();
+    } else if (!groups.isEmpty()) {
+        featureGroups = groups;
+        emit headerDataChanged(Qt::Horizontal, firstGroupColumn, lastGroupColumn);
+        if (rowNumber > 0) {
+            emit dataChanged(index(0, firstGroupColumn), index(rowNumber - 1, lastGroupColumn), QVector<int>() << Qt::DisplayRole);
+        }
     }
 }
 
-QVariant FeatureTableModel::data(const QModelIndex &index, int role) const
+const FeatureGroups & FeatureTableModel::getFeatureGroups() const
 {
-    return const_cast<FeatureTableModel *>(this)->dataInternal(index, role);
+    return featureGroups;
 }
 
-void FeatureTableModel::cacheValue(int row, int column, const QVariant &val)
+QStringList FeatureTableModel::getSampleTypes() const
 {
-    cachedCells[row * columnNumber + column] = val;
+    QStringList types;
+    for (int sampleNumber = 0; sampleNumber < countOfSampleColumns(); ++sampleNumber) {
+        types.append(dataSource->getSampleTypeById(dataSource->getSampleIdByNumber(sampleNumber)));
+    }
+    return types;
 }
 
-QVariant FeatureTableModel::getCachedValue(int row, int column) const
+QVariant FeatureTableModel::data(const QModelIndex &index, int role) const
 {
-    return cachedCells[row * columnNumber + column];
+    return const_cast<FeatureTableModel *>(this)->dataInternal(index, role);
 }
 
 typedef QPair<QString, QString> QStringPair;
@@ -208,42 +311,73 @@ QVariant FeatureTableModel::compoundIdColumnData(const QModelIndex &index)
     return result;
 }
 
+QVariant FeatureTableModel::getMatrixCellValue(const FeatureMatrix &matrix, const IntensityNormalization &normalization,
+    const DifferentialStatistics &statistics, const FeatureGroups &groups, int row, int column)
+{
+    switch (column) {
+        case 0:
+            return matrix.getFeatureId(row);
+        case 1:
+            return matrix.getConsensusMz(row);
+        case 2:
+            return matrix.getConsensusRt(row);
+        case 3:
+            return matrix.getConsensusCharge(row);
+        case ANNOTATION_COLUMN_OFFSET: {
+            const QString compoundIds = matrix.getCompoundIds(row);
+            return compoundIds.isEmpty() ? tr("N/A") : compoundIds;
+        }
+        default: {
+            const int sampleNumber = column - SAMPLE_COLUMNS_OFFSET;
+            const int statisticsColumn = sampleNumber - matrix.getSampleCount();
+            const int statisticsColumnCount = statistics.isEmpty() ? 0 : DifferentialStatistics::COLUMN_COUNT;
+            if (statisticsColumn >= statisticsColumnCount) {
+                return groups.getValue(row, FeatureGroups::Column(statisticsColumn - statisticsColumnCount));
+            } else if (statisticsColumn >= 0) {
+                // tests that aren't applicable to the feature give empty cells, which are sorted first
+                const qreal value = statistics.getValue(row, DifferentialStatistics::Column(statisticsColumn));
+                return std::isnan(value) ? QVariant() : QVariant(value);
+            }
+            return matrix.hasIntensity(row, sampleNumber)
+                ? QVariant(normalization.normalize(sampleNumber, matrix.getIntensity(row, sampleNumber))) : TABLE_DEFAULT_VALUE;
+        }
+    }
+}
+
+QVariant FeatureTableModel::sparklineData(int row, int column)
+{
+    const int sampleNumber = column - SAMPLE_COLUMNS_OFFSET;
+    const FeatureMatrix &matrix = dataSource->getFeatureMatrix();
+    if (sampleNumber < 0 || sampleNumber >= matrix.getSampleCount() || !matrix.hasIntensity(row, sampleNumber)) {
+        return QVariant();
+    }
+    QByteArray sparkline;
+    if (!dataSource->getSparklineCache().getSparkline(dataSource->getSampleIdByNumber(sampleNumber), matrix.getFeatureId(row), sparkline)) {
+        return QVariant();
+    }
+    return sparkline;
+}
+
 QVariant FeatureTableModel::dataInternal(const QModelIndex &index, int role)
 {
-    QVariant result;
     const int row = index.row();
     const int column = index.column();
 
-    if (!index.isValid() || (role & ~Qt::DisplayRole) || row >= rowNumber || column >= columnNumber) {
-        return result;
+    if (index.isValid() && SPARKLINE_ROLE == role && row < rowNumber && column < columnNumber) {
+        return sparklineData(row, column);
     }
-
-    const QVariant cachedVal = getCachedValue(row, column);
-    if (cachedVal.isValid()) {
-        return cachedVal;
+    if (!index.isValid() || (role & ~Qt::DisplayRole) || row >= rowNumber || column >= columnNumber) {
+        return QVariant();
     }
 
-    if (column < ANNOTATION_COLUMN_OFFSET) {
-        consensusFeatureFetcher.seek(row);
-        result = consensusFeatureFetcher.value(column);
-    } else if (column == ANNOTATION_COLUMN_OFFSET) {
-        result = compoundIdColumnData(index);
-    } else {
-        const FeatureId rowId = dataSource->getFeatureIdByNumber(row);
-        const SampleId columnId = dataSource->getSampleIdByNumber(column - SAMPLE_COLUMNS_OFFSET);
-
-        const qint64 firstFeatureRecord = findFirstQueryRecordIndex(intensityFetcher, 0, totalFeatureObservationCount - 1, 0, rowId);
-        if (intensityFetcher.value(0).value<FeatureId>() != rowId) {
-            result = TABLE_DEFAULT_VALUE;
-        } else {
-            const qint64 endRecordIndex = firstFeatureRecord + featureObservationCount[rowId] - 1;
-            findFirstQueryRecordIndex(intensityFetcher, firstFeatureRecord, endRecordIndex, 1, columnId);
-
-            result = intensityFetcher.value(1).value<SampleId>() == columnId ? intensityFetcher.value(2) : TABLE_DEFAULT_VALUE;
+    if (column == ANNOTATION_COLUMN_OFFSET) {
+        if (!cachedCompoundIds[row].isValid()) {
+            cachedCompoundIds[row] = compoundIdColumnData(index);
         }
+        return cachedCompoundIds[row];
+    } else {
+        return getMatrixCellValue(dataSource->getFeatureMatrix(), normalization, differentialStatistics, featureGroups, row, column);
     }
-    cacheValue(row, column, result);
-    return result;
 }
 
 QVariant FeatureTableModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -261,8 +395,26 @@ QVariant FeatureTableModel::headerData(int section, Qt::Orientation orientation,
             case 4:
                 return tr("Compound ID");
             default:
+                if (section >= getFirstGroupColumn()) {
+                    return featureGroups.getColumnName(FeatureGroups::Column(section - getFirstGroupColumn()));
+                } else if (section >= SAMPLE_COLUMNS_OFFSET + countOfSampleColumns()) {
+                    return differentialStatistics.getColumnName(
+                        DifferentialStatistics::Column(section - SAMPLE_COLUMNS_OFFSET - countOfSampleColumns()));
+                }
                 return QVariant(dataSource->getSampleNameById(dataSource->getSampleIdByNumber(section - SAMPLE_COLUMNS_OFFSET)));
         }
+    } else if (orientation == Qt::Horizontal && role == Qt::ToolTipRole && section >= getFirstGroupColumn() && section < columnNumber) {
+        return featureGroups.getColumnDescription(FeatureGroups::Column(section - getFirstGroupColumn()));
+    } else if (orientation == Qt::Horizontal && role == Qt::ToolTipRole && section >= SAMPLE_COLUMNS_OFFSET + countOfSampleColumns()
+        && section < columnNumber)
+    {
+        return differentialStatistics.getColumnDescription(
+            DifferentialStatistics::Column(section - SAMPLE_COLUMNS_OFFSET - countOfSampleColumns()));
+    } else if (orientation == Qt::Horizontal && role == Qt::ToolTipRole && section >= SAMPLE_COLUMNS_OFFSET && section < columnNumber) {
+        const SampleStatistics &statistics = dataSource->getFeatureMatrix().getSampleStatistics(section - SAMPLE_COLUMNS_OFFSET);
+        return tr("Detected features: %1\nTotal intensity: %2\nMedian intensity: %3\nMax intensity: %4")
+            .arg(statistics.featureCount).arg(statistics.totalIntensity, 0, 'g', 6)
+            .arg(statistics.medianIntensity, 0, 'g', 6).arg(statistics.maxIntensity, 0, 'g', 6);
     } else {
         return QAbstractItemModel::headerData(section, orientation, role);
     }
@@ -5,17 +5,27 @@
 #include <QSqlError>
 #include <QSqlQuery>
 
+#include "DifferentialStatistics.h"
+#include "FeatureGroups.h"
 #include "Globals.h"
+#include "IntensityNormalization.h"
+#include "MassTraceIndex.h"
 
 namespace ov {
 
+class AnnotationIndex;
 class FeatureDataSource;
+class FeatureMatrix;
 
 class FeatureTableModel : public QAbstractTableModel
 {
     Q_OBJECT
 
 public:
+    enum {
+        SPARKLINE_ROLE = Qt::UserRole + 1 // QByteArray of the downsampled XIC, invalid while it's being loaded
+    };
+
     FeatureTableModel(QObject *parent, FeatureDataSource *dataSource);
 
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -29,9 +39,40 @@ public:
     void reset();
     QSqlError lastError() const;
 
+    DataSourceId getDataSourceId() const;
     SampleId getSampleIdByColumnNumber(int column) const;
+    QVector<SampleId> getSampleIds() const; // by sample number
+    FeatureId getFeatureIdByRowNumber(int row) const;
+    qreal getFeatureMzByRowNumber(int row) const;
+    const FeatureMatrix & getFeatureMatrix() const; // rows of the model are rows of the matrix
+    // built on request after a reset, it takes a while on large databases and isn't needed by most views;
+    // the index is built on a worker thread by MassTraceIndex::build() and handed over with setMassTraceIndex()
+    const MassTraceIndex & getMassTraceIndex() const;
+    void setMassTraceIndex(const MassTraceIndex &index);
+    bool isMassTraceIndexBuilt() const;
+    bool hasMassTraces() const; // without building the index
+    const AnnotationIndex & getAnnotationIndex() const;
+    int getAnnotationColumn() const;
+
+    // intensities of sample columns are displayed, sorted, filtered and exported normalized
+    void setNormalization(const IntensityNormalization &normalization);
+    const IntensityNormalization & getNormalization() const;
+
+    // columns of the comparison follow sample columns, an empty one removes them
+    void setDifferentialStatistics(const DifferentialStatistics &statistics);
+    const DifferentialStatistics & getDifferentialStatistics() const;
+
+    // columns of the groups follow columns of the comparison, empty groups remove them
+    void setFeatureGroups(const FeatureGroups &groups);
+    const FeatureGroups & getFeatureGroups() const;
+    QStringList getSampleTypes() const; // by sample number
 
     int countOfGeneralDataColumns() const;
+    int countOfSampleColumns() const;
+
+    // the value of a cell without widgets, safe to call from any thread
+    static QVariant getMatrixCellValue(const FeatureMatrix &matrix, const IntensityNormalization &normalization,
+        const DifferentialStatistics &statistics, const FeatureGroups &groups, int row, int column);
 
 signals:
     void setIndexWidget(const QModelIndex &index, QWidget *w);
@@ -39,27 +80,25 @@ signals:
 private:
     void updateRowNumber();
     void updateColumnNumber();
-    void updateFeatureCount();
+    int getFirstGroupColumn() const; // the column count if there are no groups
     void updateFeatureAnnotationRows();
-    void invalidateCache();
-    void cacheValue(int row, int column, const QVariant &val);
-    QVariant getCachedValue(int row, int column) const;
     QVariant dataInternal(const QModelIndex &index, int role);
     QVariant compoundIdColumnData(const QModelIndex &index);
-    static qint64 findFirstQueryRecordIndex(QSqlQuery &query, qint64 startIndex, qint64 endIndex, int fieldNumber, qint64 value);
+    QVariant sparklineData(int row, int column);
 
     qint64 rowNumber;
     qint64 columnNumber;
     FeatureDataSource *dataSource;
+    IntensityNormalization normalization;
+    DifferentialStatistics differentialStatistics;
+    FeatureGroups featureGroups;
+    MassTraceIndex massTraceIndex;
+    bool massTraceIndexBuilt;
 
-    QSqlQuery consensusFeatureFetcher;
-    QSqlQuery intensityFetcher;
     QSqlQuery annotationFetcher;
 
     QMap<FeatureId, QPair<qint64, int> > featureAnnotationRows;
-    QMap<FeatureId, qint64> featureObservationCount;
-    qint64 totalFeatureObservationCount;
-    QVector<QVariant> cachedCells;
+    QVector<QVariant> cachedCompoundIds; // widgets with links are created only once
 
     QSqlError error;
 };
@@ -3,13 +3,104 @@
 namespace ov {
 
 FeatureTableProxyModel::FeatureTableProxyModel(QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : QSortFilterProxyModel(parent), annotationColumn(-1)
 {
 
 }
 
+void FeatureTableProxyModel::setRowOrder(const QVector<int> &sourceRows)
+{
+    rowRanks.fill(0, sourceRows.size());
+    for (int i = 0; i < sourceRows.size(); ++i) {
+        rowRanks[sourceRows[i]] = i;
+    }
+    // the base class sorts without dropping the ranks; it ignores a sort by the current column and order,
+    // e.g. after a previous order or a sort of the first column by the user, so new ranks are applied explicitly
+    const int column = rowRanks.isEmpty() ? -1 : 0;
+    if (column == sortColumn() && Qt::AscendingOrder == sortOrder()) {
+        invalidate();
+    } else {
+        QSortFilterProxyModel::sort(column, Qt::AscendingOrder);
+    }
+}
+
+bool FeatureTableProxyModel::hasRowOrder() const
+{
+    return !rowRanks.isEmpty();
+}
+
+QVector<int> FeatureTableProxyModel::getRowOrder() const
+{
+    QVector<int> sourceRows(rowRanks.size());
+    for (int row = 0; row < rowRanks.size(); ++row) {
+        sourceRows[rowRanks[row]] = row;
+    }
+    return sourceRows;
+}
+
+void FeatureTableProxyModel::setRowFilter(RowFilter filter, const QBitArray &acceptedRows)
+{
+    if (rowFilters[filter].isEmpty() && acceptedRows.isEmpty()) {
+        return;
+    }
+    rowFilters[filter] = acceptedRows;
+    invalidateFilter();
+}
+
+bool FeatureTableProxyModel::hasRowFilter(RowFilter filter) const
+{
+    return !rowFilters[filter].isEmpty();
+}
+
+void FeatureTableProxyModel::setAnnotationMatches(int column, const QBitArray &matchingRows)
+{
+    annotationColumn = column;
+    annotationMatches = matchingRows;
+}
+
+void FeatureTableProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (NULL != this->sourceModel()) {
+        disconnect(this->sourceModel(), &QAbstractItemModel::modelAboutToBeReset, this, &FeatureTableProxyModel::dropSourceRowState);
+    }
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+    if (NULL != sourceModel) {
+        connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &FeatureTableProxyModel::dropSourceRowState);
+    }
+}
+
+void FeatureTableProxyModel::dropSourceRowState()
+{
+    // sets of rows of the previous data must not be tested against new rows, the base class filters them on reset
+    rowRanks.clear();
+    for (int rowFilter = 0; rowFilter < ROW_FILTER_COUNT; ++rowFilter) {
+        rowFilters[rowFilter].clear();
+    }
+    annotationMatches.clear();
+}
+
+void FeatureTableProxyModel::sort(int column, Qt::SortOrder order)
+{
+    rowRanks.clear();
+    QSortFilterProxyModel::sort(column, order);
+}
+
+bool FeatureTableProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if (!rowRanks.isEmpty()) {
+        return rowRanks[left.row()] < rowRanks[right.row()];
+    }
+    return QSortFilterProxyModel::lessThan(left, right);
+}
+
 bool FeatureTableProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
+    for (int rowFilter = 0; rowFilter < ROW_FILTER_COUNT; ++rowFilter) {
+        if (!rowFilters[rowFilter].isEmpty() && !rowFilters[rowFilter].testBit(sourceRow)) {
+            return false;
+        }
+    }
+
     const QString filter = filterRegExp().pattern();
     if (filter.isEmpty()) {
         return true;
@@ -18,6 +109,13 @@ bool FeatureTableProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &
     QAbstractItemModel *originalModel = sourceModel();
     const int columnNum = originalModel->columnCount();
     for (int column = 0; column < columnNum; ++column) {
+        if (column == annotationColumn) {
+            // rows of the previous database may be matched until the filter text is set again
+            if (sourceRow < annotationMatches.size() && annotationMatches.testBit(sourceRow)) {
+                return true;
+            }
+            continue;
+        }
         if (originalModel->data(originalModel->index(sourceRow, column, sourceParent)).toString().contains(filter, Qt::CaseInsensitive)) {
             return true;
         }
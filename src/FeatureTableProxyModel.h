@@ -1,17 +1,53 @@
 #ifndef FEATURE_TABLE_PROXY_MODEL_H
 #define FEATURE_TABLE_PROXY_MODEL_H
 
+#include <QBitArray>
 #include <QSortFilterProxyModel>
+#include <QVector>
 
 namespace ov {
 
 class FeatureTableProxyModel : public QSortFilterProxyModel
 {
 public:
+    // independent sets of rows, a row is displayed if it's in all of them and matches the text filter
+    enum RowFilter {
+        FEATURE_GROUP_FILTER, // main features of groups
+        RANGE_FILTER, // features in a window of consensus m/z and RT
+        EXPRESSION_FILTER, // features matching a filter expression
+        MOST_INTENSE_FILTER, // features most intense in a sample
+        ROW_FILTER_COUNT
+    };
+
     FeatureTableProxyModel(QObject *parent);
 
+    // bit per source row, an empty array accepts all rows
+    void setRowFilter(RowFilter filter, const QBitArray &acceptedRows);
+    bool hasRowFilter(RowFilter filter) const;
+
+    // rows whose annotations match the text filter, the column then isn't read from the source model;
+    // should be set before the filter text
+    void setAnnotationMatches(int column, const QBitArray &matchingRows);
+
+    // rows are kept in the given order until the model is sorted by a column, empty restores the source order
+    void setRowOrder(const QVector<int> &sourceRows);
+    bool hasRowOrder() const;
+    QVector<int> getRowOrder() const; // source rows, empty if there is no order
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+    void setSourceModel(QAbstractItemModel *sourceModel);
+
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
+
+private:
+    void dropSourceRowState();
+
+    QVector<int> rowRanks; // by source row
+    QBitArray rowFilters[ROW_FILTER_COUNT];
+    int annotationColumn;
+    QBitArray annotationMatches;
 };
 
 } // namespace ov
@@ -2,12 +2,18 @@
 #include <QHeaderView>
 #include <QMenu>
 #include <QScrollBar>
+#include <QSet>
+#include <QTimer>
 
 #include "FeatureTableItemDelegate.h"
 #include "FeatureTableVisibilityDialog.h"
 
 #include "FeatureTableWidget.h"
 
+const int NEIGHBOURHOOD_ROW_RADIUS = 3;
+const int NEIGHBOURHOOD_COLUMN_LIMIT = 16;
+const int NEIGHBOURHOOD_UPDATE_DELAY_MS = 150;
+
 namespace ov {
 
 FeatureTableWidget::FeatureTableWidget(QAbstractItemModel *model, int countOfFrozenColumns, QWidget *parent)
@@ -17,6 +23,10 @@ FeatureTableWidget::FeatureTableWidget(QAbstractItemModel *model, int countOfFro
     setModel(model);
     frozenTableView = new QTableView(this);
 
+    neighbourhoodTimer = new QTimer(this);
+    neighbourhoodTimer->setSingleShot(true);
+    neighbourhoodTimer->setInterval(NEIGHBOURHOOD_UPDATE_DELAY_MS);
+
     QSizePolicy sp(QSizePolicy::Expanding, QSizePolicy::Expanding);
     sp.setHorizontalStretch(0);
     sp.setVerticalStretch(0);
@@ -39,6 +49,39 @@ FeatureTableWidget::~FeatureTableWidget()
     delete frozenTableView;
 }
 
+void FeatureTableWidget::setSparklinesVisible(bool visible)
+{
+    // frozen columns show general data of features only
+    static_cast<FeatureTableItemDelegate *>(itemDelegate())->setSparklinesVisible(visible);
+    viewport()->update();
+}
+
+void FeatureTableWidget::clearSortIndicator()
+{
+    foreach (QHeaderView *headerView, QList<QHeaderView *>() << horizontalHeader() << frozenTableView->horizontalHeader()) {
+        const bool signalsWereBlocked = headerView->blockSignals(true);
+        headerView->setSortIndicator(-1, Qt::AscendingOrder);
+        headerView->blockSignals(signalsWereBlocked);
+    }
+    currentSortedColumn = -1;
+}
+
+void FeatureTableWidget::placeColumns(const QVector<int> &columns, int firstVisualIndex)
+{
+    QHeaderView *headerView = horizontalHeader();
+    for (int i = 0; i < columns.size(); ++i) {
+        headerView->moveSection(headerView->visualIndex(columns[i]), firstVisualIndex + i);
+    }
+}
+
+void FeatureTableWidget::resetColumnOrder()
+{
+    QHeaderView *headerView = horizontalHeader();
+    for (int column = 0; column < headerView->count(); ++column) {
+        headerView->moveSection(headerView->visualIndex(column), column);
+    }
+}
+
 void FeatureTableWidget::initActions()
 {
     hideColumnAction = new QAction(tr("Hide this column"), this);
@@ -81,6 +124,7 @@ void FeatureTableWidget::connectGuiSignals()
     headerView->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(headerView, &QHeaderView::customContextMenuRequested, this, &FeatureTableWidget::headerContextMenu);
     connect(headerView, &QHeaderView::sortIndicatorChanged, this, &FeatureTableWidget::headerSortIndicatorChanged);
+    connect(model(), &QAbstractItemModel::columnsInserted, this, &FeatureTableWidget::modelColumnsInserted);
 
     QHeaderView *frozenHeaderView = frozenTableView->horizontalHeader();
     frozenHeaderView->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -90,6 +134,51 @@ void FeatureTableWidget::connectGuiSignals()
 
     connect(selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)), frozenTableView->viewport(), SLOT(update()));
     connect(selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)), viewport(), SLOT(update()));
+
+    connect(selectionModel(), &QItemSelectionModel::currentChanged, this, &FeatureTableWidget::scheduleNeighbourhoodUpdate);
+    connect(verticalScrollBar(), &QAbstractSlider::valueChanged, this, &FeatureTableWidget::scheduleNeighbourhoodUpdate);
+    connect(neighbourhoodTimer, &QTimer::timeout, this, &FeatureTableWidget::updateNeighbourhood);
+}
+
+void FeatureTableWidget::scheduleNeighbourhoodUpdate()
+{
+    neighbourhoodTimer->start();
+}
+
+void FeatureTableWidget::updateNeighbourhood()
+{
+    // Cells of the selected sample columns around the current row are the ones that are likely to be selected next
+    QSet<int> columns;
+    foreach (const QItemSelectionRange &range, selectionModel()->selection()) {
+        for (int column = qMax(range.left(), countOfFrozenColumns); column <= range.right() && columns.size() < NEIGHBOURHOOD_COLUMN_LIMIT; ++column) {
+            columns.insert(column);
+        }
+    }
+    const QModelIndex current = currentIndex();
+    if (columns.isEmpty() && current.isValid() && current.column() >= countOfFrozenColumns) {
+        columns.insert(current.column());
+    }
+    const int rowCount = model()->rowCount();
+    if (columns.isEmpty() || 0 == rowCount) {
+        return;
+    }
+
+    const int firstVisibleRow = qMax(rowAt(0), 0);
+    const int lastVisibleRow = -1 == rowAt(viewport()->height() - 1) ? rowCount - 1 : rowAt(viewport()->height() - 1);
+    int centralRow = current.isValid() ? current.row() : -1;
+    if (centralRow < firstVisibleRow || centralRow > lastVisibleRow) {
+        centralRow = (firstVisibleRow + lastVisibleRow) / 2;
+    }
+
+    QModelIndexList neighbourhood;
+    const int firstRow = qMax(centralRow - NEIGHBOURHOOD_ROW_RADIUS, 0);
+    const int lastRow = qMin(centralRow + NEIGHBOURHOOD_ROW_RADIUS, rowCount - 1);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        foreach (int column, columns) {
+            neighbourhood.append(model()->index(row, column));
+        }
+    }
+    emit neighbourhoodChanged(neighbourhood);
 }
 
 void FeatureTableWidget::frozenColumnResized(int logicalIndex, int oldSize, int newSize)
@@ -198,6 +287,17 @@ void FeatureTableWidget::resetColumnHiddenState()
     }
 }
 
+void FeatureTableWidget::modelColumnsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    for (int column = first; column <= last; ++column) {
+        if (column >= countOfFrozenColumns) {
+            frozenTableView->setColumnHidden(column, true);
+            resizeColumnToContents(column);
+        }
+    }
+}
+
 void FeatureTableWidget::updateSectionWidth(int logicalIndex, int /* oldSize */, int newSize)
 {
     if (logicalIndex < countOfFrozenColumns) {
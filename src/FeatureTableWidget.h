@@ -2,8 +2,10 @@
 #define FEATURETABLEWIDGET_H
 
 #include <QTableView>
+#include <QVector>
 
 class QAction;
+class QTimer;
 
 namespace ov {
 
@@ -17,6 +19,13 @@ public:
     void setColumnHidden(int column, bool hide);
     void resetColumnHiddenState();
     void setIndexWidget(const QModelIndex &index, QWidget *w);
+    void setSparklinesVisible(bool visible);
+    void clearSortIndicator(); // without sorting the model again
+    void placeColumns(const QVector<int> &columns, int firstVisualIndex); // shows columns one after another
+    void resetColumnOrder();
+
+signals:
+    void neighbourhoodChanged(const QModelIndexList &indexes);
 
 protected:
     void resizeEvent(QResizeEvent *event);
@@ -31,6 +40,9 @@ private slots:
     void frozenColumnResized(int logicalIndex, int oldSize, int newSize);
     void hideColumnTriggered();
     void showHideColumnsTriggered();
+    void scheduleNeighbourhoodUpdate();
+    void updateNeighbourhood();
+    void modelColumnsInserted(const QModelIndex &parent, int first, int last);
 
 private:
     void connectGuiSignals();
@@ -41,6 +53,7 @@ private:
     QAction *hideColumnAction;
     QAction *showHideColumnsAction;
     QTableView *frozenTableView;
+    QTimer *neighbourhoodTimer;
     int lastReferredLogicalColumn;
     int countOfFrozenColumns;
     int currentSortedColumn;
@@ -0,0 +1,496 @@
+#include <algorithm>
+#include <limits>
+
+#include "FeatureMatrix.h"
+#include "FeatureMatrixUtils.h"
+#include "IntensityNormalization.h"
+
+#include "FilterExpression.h"
+
+const qreal UNLIMITED = std::numeric_limits<qreal>::infinity();
+
+namespace ov {
+
+namespace {
+
+struct Token
+{
+    enum Type {
+        WORD, // names of values and keywords, case insensitive
+        NUMBER,
+        STRING, // quotes are removed
+        SYMBOL, // operators and brackets
+        END
+    };
+
+    Type type;
+    QString text;
+    qreal number;
+    int position; // starting with 1
+};
+
+struct ValueName
+{
+    const char *name;
+    FilterExpression::Value value;
+};
+
+const ValueName VALUE_NAMES[] = {
+    { "id", FilterExpression::ID_VALUE },
+    { "mz", FilterExpression::MZ_VALUE },
+    { "rt", FilterExpression::RT_VALUE },
+    { "charge", FilterExpression::CHARGE_VALUE },
+    { "nonzero_count", FilterExpression::NONZERO_COUNT_VALUE },
+    { "max_intensity", FilterExpression::MAX_INTENSITY_VALUE },
+    { "intensity", FilterExpression::INTENSITY_VALUE }
+};
+const int VALUE_COUNT = sizeof(VALUE_NAMES) / sizeof(VALUE_NAMES[0]);
+
+bool isWordCharacter(QChar c)
+{
+    return c.isLetterOrNumber() || '_' == c;
+}
+
+}
+
+FilterExpression::Instruction::Instruction()
+    : opcode(RANGE_TEST), value(ID_VALUE), sampleNumber(-1), min(-UNLIMITED), max(UNLIMITED), minIncluded(true),
+    maxIncluded(true)
+{
+
+}
+
+// recursive descent parser of the grammar
+//     expression := conjunction ("or" conjunction)*
+//     conjunction := negation ("and" negation)*
+//     negation := "not" negation | "(" expression ")" | comparison
+//     comparison := value ("between" number "and" number | operator number)
+//     value := name | "intensity" "[" string "]"
+// instructions are emitted in postfix order while operands are parsed
+class FilterExpression::Compiler
+{
+public:
+    Compiler(const QStringList &sampleNames, QVector<Instruction> &program, QString &errorMessage)
+        : sampleNames(sampleNames), program(program), errorMessage(errorMessage), current(0)
+    {
+
+    }
+
+    bool compile(const QString &text)
+    {
+        if (!tokenize(text) || !parseExpression()) {
+            return false;
+        }
+        return Token::END == tokens[current].type || setUnexpectedTokenError();
+    }
+
+private:
+    bool tokenize(const QString &text)
+    {
+        int i = 0;
+        while (i < text.size()) {
+            const QChar c = text[i];
+            Token token;
+            token.position = i + 1;
+            token.number = 0.0;
+            if (c.isSpace()) {
+                ++i;
+                continue;
+            } else if (c.isDigit() || ('.' == c && i + 1 < text.size() && text[i + 1].isDigit())) {
+                int end = i;
+                while (end < text.size() && (text[end].isDigit() || '.' == text[end])) {
+                    ++end;
+                }
+                // exponent, e.g. 1e5 or 2.5E-3
+                if (end < text.size() && ('e' == text[end] || 'E' == text[end])) {
+                    int exponentEnd = end + 1;
+                    if (exponentEnd < text.size() && ('+' == text[exponentEnd] || '-' == text[exponentEnd])) {
+                        ++exponentEnd;
+                    }
+                    if (exponentEnd < text.size() && text[exponentEnd].isDigit()) {
+                        end = exponentEnd;
+                        while (end < text.size() && text[end].isDigit()) {
+                            ++end;
+                        }
+                    }
+                }
+                bool ok = false;
+                token.type = Token::NUMBER;
+                token.text = text.mid(i, end - i);
+                token.number = token.text.toDouble(&ok);
+                if (!ok) {
+                    errorMessage = tr("Invalid number \"%1\" at position %2.").arg(token.text).arg(token.position);
+                    return false;
+                }
+                i = end;
+            } else if (isWordCharacter(c)) {
+                int end = i;
+                while (end < text.size() && isWordCharacter(text[end])) {
+                    ++end;
+                }
+                token.type = Token::WORD;
+                token.text = text.mid(i, end - i);
+                i = end;
+            } else if ('"' == c || '\'' == c) {
+                const int end = text.indexOf(c, i + 1);
+                if (-1 == end) {
+                    errorMessage = tr("Unterminated string at position %1.").arg(token.position);
+                    return false;
+                }
+                token.type = Token::STRING;
+                token.text = text.mid(i + 1, end - i - 1);
+                i = end + 1;
+            } else {
+                static const QStringList symbols = QStringList() << "<=" << ">=" << "!=" << "<>" << "==" << "<" << ">" << "="
+                    << "(" << ")" << "[" << "]" << "-" << "+";
+                token.type = Token::SYMBOL;
+                foreach (const QString &symbol, symbols) {
+                    if (text.midRef(i, symbol.size()) == symbol) {
+                        token.text = symbol;
+                        break;
+                    }
+                }
+                if (token.text.isEmpty()) {
+                    errorMessage = tr("Unexpected character \"%1\" at position %2.").arg(c).arg(token.position);
+                    return false;
+                }
+                i += token.text.size();
+            }
+            tokens.append(token);
+        }
+
+        Token end;
+        end.type = Token::END;
+        end.number = 0.0;
+        end.position = text.size() + 1;
+        tokens.append(end);
+        return true;
+    }
+
+    bool accept(Token::Type type, const QString &text)
+    {
+        if (type == tokens[current].type && 0 == text.compare(tokens[current].text, Qt::CaseInsensitive)) {
+            ++current;
+            return true;
+        }
+        return false;
+    }
+
+    bool expect(Token::Type type, const QString &text)
+    {
+        return accept(type, text) || setUnexpectedTokenError();
+    }
+
+    bool setUnexpectedTokenError()
+    {
+        const Token &token = tokens[current];
+        if (Token::END == token.type) {
+            errorMessage = tr("Unexpected end of the expression.");
+        } else {
+            errorMessage = tr("Unexpected \"%1\" at position %2.").arg(token.text).arg(token.position);
+        }
+        return false;
+    }
+
+    void appendInstruction(Opcode opcode)
+    {
+        Instruction instruction;
+        instruction.opcode = opcode;
+        program.append(instruction);
+    }
+
+    bool parseExpression()
+    {
+        if (!parseConjunction()) {
+            return false;
+        }
+        while (accept(Token::WORD, "or")) {
+            if (!parseConjunction()) {
+                return false;
+            }
+            appendInstruction(OR);
+        }
+        return true;
+    }
+
+    bool parseConjunction()
+    {
+        if (!parseNegation()) {
+            return false;
+        }
+        while (accept(Token::WORD, "and")) {
+            if (!parseNegation()) {
+                return false;
+            }
+            appendInstruction(AND);
+        }
+        return true;
+    }
+
+    bool parseNegation()
+    {
+        if (accept(Token::WORD, "not")) {
+            if (!parseNegation()) {
+                return false;
+            }
+            appendInstruction(NOT);
+            return true;
+        } else if (accept(Token::SYMBOL, "(")) {
+            return parseExpression() && expect(Token::SYMBOL, ")");
+        }
+        return parseComparison();
+    }
+
+    bool parseComparison()
+    {
+        Instruction test;
+        if (!parseValue(test)) {
+            return false;
+        }
+
+        bool negated = false;
+        if (accept(Token::WORD, "between")) {
+            if (!parseNumber(test.min) || !expect(Token::WORD, "and") || !parseNumber(test.max)) {
+                return false;
+            }
+        } else {
+            const Token &token = tokens[current];
+            qreal number = 0.0;
+            static const QStringList operators = QStringList() << "<" << "<=" << ">" << ">=" << "=" << "==" << "!=" << "<>";
+            if (Token::SYMBOL != token.type || !operators.contains(token.text)) {
+                return setUnexpectedTokenError();
+            }
+            const QString op = token.text;
+            ++current;
+            if (!parseNumber(number)) {
+                return false;
+            }
+            if (op.startsWith('<') && "<>" != op) {
+                test.max = number;
+                test.maxIncluded = "<=" == op;
+            } else if (op.startsWith('>')) {
+                test.min = number;
+                test.minIncluded = ">=" == op;
+            } else {
+                test.min = number;
+                test.max = number;
+                negated = "!=" == op || "<>" == op;
+            }
+        }
+
+        program.append(test);
+        if (negated) {
+            appendInstruction(NOT);
+        }
+        return true;
+    }
+
+    bool parseValue(Instruction &test)
+    {
+        const Token &token = tokens[current];
+        if (Token::WORD != token.type) {
+            return setUnexpectedTokenError();
+        }
+        const ValueName *valueName = std::find_if(VALUE_NAMES, VALUE_NAMES + VALUE_COUNT,
+            [&token] (const ValueName &valueName) { return token.text.toLower() == valueName.name; });
+        if (VALUE_NAMES + VALUE_COUNT == valueName) {
+            errorMessage = tr("Unknown value \"%1\" at position %2.").arg(token.text).arg(token.position);
+            return false;
+        }
+        ++current;
+        test.value = valueName->value;
+        if (INTENSITY_VALUE != test.value) {
+            return true;
+        }
+
+        if (!expect(Token::SYMBOL, "[")) {
+            return false;
+        }
+        const Token &sampleToken = tokens[current];
+        if (Token::STRING != sampleToken.type) {
+            return setUnexpectedTokenError();
+        }
+        test.sampleNumber = sampleNames.indexOf(sampleToken.text);
+        if (-1 == test.sampleNumber) {
+            errorMessage = tr("Unknown sample \"%1\" at position %2.").arg(sampleToken.text).arg(sampleToken.position);
+            return false;
+        }
+        ++current;
+        return expect(Token::SYMBOL, "]");
+    }
+
+    bool parseNumber(qreal &number)
+    {
+        const bool negative = accept(Token::SYMBOL, "-");
+        if (!negative) {
+            accept(Token::SYMBOL, "+");
+        }
+        if (Token::NUMBER != tokens[current].type) {
+            return setUnexpectedTokenError();
+        }
+        number = negative ? -tokens[current].number : tokens[current].number;
+        ++current;
+        return true;
+    }
+
+    const QStringList &sampleNames;
+    QVector<Instruction> &program;
+    QString &errorMessage;
+    QVector<Token> tokens;
+    int current;
+};
+
+// runs the program over a block of rows, results are stored byte per row
+class FilterExpression::BlockEvaluator
+{
+public:
+    BlockEvaluator(const QVector<Instruction> &program, const FeatureMatrix &matrix, const IntensityNormalization &normalization,
+        char *acceptedRows)
+        : program(program), matrix(matrix), normalization(normalization), acceptedRows(acceptedRows)
+    {
+
+    }
+
+    void operator ()(int firstRow, int endRow) const
+    {
+        const int blockSize = endRow - firstRow;
+        QVector<double> values(blockSize);
+        QVector<QVector<char> > stack;
+        foreach (const Instruction &instruction, program) {
+            if (RANGE_TEST == instruction.opcode) {
+                loadValues(instruction, firstRow, endRow, values.data());
+                QVector<char> result(blockSize);
+                for (int i = 0; i < blockSize; ++i) {
+                    const double value = values[i];
+                    result[i] = (instruction.minIncluded ? value >= instruction.min : value > instruction.min)
+                        && (instruction.maxIncluded ? value <= instruction.max : value < instruction.max);
+                }
+                stack.append(result);
+            } else if (NOT == instruction.opcode) {
+                for (char &accepted : stack.last()) {
+                    accepted = !accepted;
+                }
+            } else {
+                const QVector<char> right = stack.takeLast();
+                QVector<char> &left = stack.last();
+                for (int i = 0; i < blockSize; ++i) {
+                    left[i] = AND == instruction.opcode ? left[i] && right[i] : left[i] || right[i];
+                }
+            }
+        }
+        Q_ASSERT(1 == stack.size());
+        std::copy(stack.last().constBegin(), stack.last().constEnd(), acceptedRows + firstRow);
+    }
+
+private:
+    void loadValues(const Instruction &instruction, int firstRow, int endRow, double *values) const
+    {
+        for (int row = firstRow; row < endRow; ++row) {
+            double &value = values[row - firstRow];
+            switch (instruction.value) {
+                case ID_VALUE:
+                    value = matrix.getFeatureId(row);
+                    break;
+                case MZ_VALUE:
+                    value = matrix.getConsensusMz(row);
+                    break;
+                case RT_VALUE:
+                    value = matrix.getConsensusRt(row);
+                    break;
+                case CHARGE_VALUE:
+                    value = matrix.getConsensusCharge(row);
+                    break;
+                case INTENSITY_VALUE:
+                    value = matrix.hasIntensity(row, instruction.sampleNumber)
+                        ? normalization.normalize(instruction.sampleNumber, matrix.getIntensity(row, instruction.sampleNumber)) : 0.0;
+                    break;
+                default: {
+                    const int *sampleNumbers = NULL;
+                    const double *intensities = NULL;
+                    const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+                    if (NONZERO_COUNT_VALUE == instruction.value) {
+                        value = count - std::count(intensities, intensities + count, 0.0);
+                    } else {
+                        value = 0.0;
+                        for (int i = 0; i < count; ++i) {
+                            value = qMax(value, normalization.normalize(sampleNumbers[i], intensities[i]));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const QVector<Instruction> &program;
+    const FeatureMatrix &matrix;
+    const IntensityNormalization &normalization;
+    char *acceptedRows;
+};
+
+FilterExpression::FilterExpression()
+{
+
+}
+
+bool FilterExpression::compile(const QString &text, const QStringList &sampleNames, QString &errorMessage)
+{
+    QVector<Instruction> compiledProgram;
+    if (!text.trimmed().isEmpty() && !Compiler(sampleNames, compiledProgram, errorMessage).compile(text)) {
+        return false;
+    }
+    this->text = text.trimmed();
+    program = compiledProgram;
+    return true;
+}
+
+bool FilterExpression::isEmpty() const
+{
+    return program.isEmpty();
+}
+
+QString FilterExpression::getText() const
+{
+    return text;
+}
+
+bool FilterExpression::dependsOnIntensities() const
+{
+    foreach (const Instruction &instruction, program) {
+        if (RANGE_TEST == instruction.opcode && (INTENSITY_VALUE == instruction.value || MAX_INTENSITY_VALUE == instruction.value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QBitArray FilterExpression::evaluate(const FeatureMatrix &matrix, const IntensityNormalization &normalization) const
+{
+    const int rowCount = matrix.getRowCount();
+    if (isEmpty()) {
+        return QBitArray(rowCount, true);
+    }
+
+    // blocks are written to separate bytes, bits are packed afterwards
+    QVector<char> acceptedRows(rowCount, 0);
+    FeatureMatrixUtils::runInBlocks(rowCount, FeatureMatrixUtils::ROWS_PER_TASK,
+        BlockEvaluator(program, matrix, normalization, acceptedRows.data()));
+
+    QBitArray result(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        if (acceptedRows[row]) {
+            result.setBit(row);
+        }
+    }
+    return result;
+}
+
+QString FilterExpression::getSyntaxDescription()
+{
+    return tr("Compare values of features with numbers by <, <=, >, >=, = and != or by \"between ... and ...\", "
+        "join comparisons by \"and\", \"or\", \"not\" and parentheses.\n"
+        "Values: id, mz, rt, charge, nonzero_count (samples where the feature is detected), max_intensity "
+        "and intensity[\"sample name\"].\n"
+        "Example: mz between 300 and 400 and charge = 1 and intensity[\"QC_03\"] > 1e5 and nonzero_count >= 10");
+}
+
+} // namespace ov
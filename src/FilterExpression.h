@@ -0,0 +1,78 @@
+#ifndef FILTER_EXPRESSION_H
+#define FILTER_EXPRESSION_H
+
+#include <QBitArray>
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVector>
+
+namespace ov {
+
+class FeatureMatrix;
+class IntensityNormalization;
+
+// Condition on values of features typed by the user, e.g.
+//     mz between 300 and 400 and charge = 1 and intensity["QC_03"] > 1e5 and nonzero_count >= 10
+// Comparisons of a value with numbers are joined by "and", "or", "not" and parentheses. The text is compiled once
+// into a postfix program of range tests; the program is run over blocks of rows in parallel, every test reads
+// the value of all rows of the block at once, so the table model isn't involved.
+class FilterExpression
+{
+    Q_DECLARE_TR_FUNCTIONS(FilterExpression)
+
+public:
+    enum Value {
+        ID_VALUE,
+        MZ_VALUE, // consensus
+        RT_VALUE,
+        CHARGE_VALUE,
+        NONZERO_COUNT_VALUE, // number of samples where the feature is detected
+        MAX_INTENSITY_VALUE, // over all samples
+        INTENSITY_VALUE // in a sample, 0 if the feature isn't detected there
+    };
+
+    FilterExpression(); // accepts all features
+
+    // @sampleNames: by sample number, samples are referred to as intensity["name"]
+    bool compile(const QString &text, const QStringList &sampleNames, QString &errorMessage);
+
+    bool isEmpty() const;
+    QString getText() const;
+    bool dependsOnIntensities() const; // i.e. on normalization
+
+    // bit per row, intensities are normalized before they're compared
+    QBitArray evaluate(const FeatureMatrix &matrix, const IntensityNormalization &normalization) const;
+
+    static QString getSyntaxDescription();
+
+private:
+    class Compiler;
+    class BlockEvaluator;
+
+    enum Opcode {
+        RANGE_TEST, // pushes whether the value is within the bounds
+        AND,
+        OR,
+        NOT
+    };
+
+    struct Instruction
+    {
+        Instruction();
+
+        Opcode opcode;
+        Value value;
+        int sampleNumber; // of INTENSITY_VALUE
+        qreal min;
+        qreal max;
+        bool minIncluded;
+        bool maxIncluded;
+    };
+
+    QString text;
+    QVector<Instruction> program;
+};
+
+} // namespace ov
+
+#endif // FILTER_EXPRESSION_H
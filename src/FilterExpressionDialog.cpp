@@ -0,0 +1,47 @@
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+#include "FilterExpressionDialog.h"
+
+namespace ov {
+
+FilterExpressionDialog::FilterExpressionDialog(const QStringList &sampleNames, const QString &text, QWidget *parent)
+    : QDialog(parent), sampleNames(sampleNames)
+{
+    setWindowTitle(tr("Filter by Expression"));
+
+    expressionEdit = new QLineEdit(text, this);
+    expressionEdit->setMinimumWidth(500);
+
+    QLabel *syntaxLabel = new QLabel(FilterExpression::getSyntaxDescription(), this);
+    syntaxLabel->setWordWrap(true);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &FilterExpressionDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(expressionEdit);
+    layout->addWidget(syntaxLabel);
+    layout->addWidget(buttonBox);
+}
+
+FilterExpression FilterExpressionDialog::getExpression() const
+{
+    return expression;
+}
+
+void FilterExpressionDialog::accept()
+{
+    QString errorMessage;
+    if (!expression.compile(expressionEdit->text(), sampleNames, errorMessage)) {
+        QMessageBox::warning(this, tr("Warning"), errorMessage);
+    } else {
+        QDialog::accept();
+    }
+}
+
+} // namespace ov
@@ -0,0 +1,34 @@
+#ifndef FILTER_EXPRESSION_DIALOG_H
+#define FILTER_EXPRESSION_DIALOG_H
+
+#include <QDialog>
+
+#include "FilterExpression.h"
+
+class QLineEdit;
+
+namespace ov {
+
+// Lets the user type a filter expression, the dialog can only be accepted if the expression compiles
+class FilterExpressionDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // @sampleNames: by sample number
+    FilterExpressionDialog(const QStringList &sampleNames, const QString &text, QWidget *parent);
+
+    FilterExpression getExpression() const;
+
+public slots:
+    void accept();
+
+private:
+    QStringList sampleNames;
+    QLineEdit *expressionEdit;
+    FilterExpression expression;
+};
+
+} // namespace ov
+
+#endif // FILTER_EXPRESSION_DIALOG_H
@@ -14,9 +14,10 @@
 namespace ov {
 
 GraphDataController::GraphDataController(FeatureDataSource *dataSource)
-    : dataSource(dataSource)
+    : webPlotEnabled(true), dataSource(dataSource)
 {
     Q_ASSERT(NULL != dataSource);
+    connect(dataSource, &FeatureDataSource::ms2SpectraDataReady, this, &GraphDataController::ms2SpectraDataReady);
 }
 
 QVariantMap GraphDataController::ms1graphDescriptionToMap(const Ms1GraphDescriptor &graphDescription) const
@@ -47,8 +48,8 @@ QVariantMap GraphDataController::msngraphDescriptionToMap(const MsnGraphDescript
     return result;
 }
 
-void GraphDataController::addMs2ScanPointToGraph(const QPointF &nextXicPoint, const QList<Ms2ScanInfo> &ms2ScanPoints,
-    const Ms1GraphDescriptor &graphDescription, int &nextMs2Index, bool &moreMs2Points, QVariantList &xicGraph)
+void GraphDataController::addMs2ScanPointToGraph(const QPointF &nextXicPoint, const Ms2ScanInfo *ms2ScanPoints, int ms2ScanCount,
+    const Ms1GraphDescriptor &graphDescription, int &nextMs2Index, bool &moreMs2Points, QVariantList &xicGraph) const
 {
     // Check if ms2 scan happened before @xicPoint, and if it did, add it to the plot
     if (moreMs2Points && ms2ScanPoints[nextMs2Index].scanTime < nextXicPoint.x()) {
@@ -63,7 +64,7 @@ void GraphDataController::addMs2ScanPointToGraph(const QPointF &nextXicPoint, co
 
             xicGraph.append(variantPlotData);
 
-            if (nextMs2Index < ms2ScanPoints.length() - 1) {
+            if (nextMs2Index < ms2ScanCount - 1) {
                 ms2Point = &ms2ScanPoints[++nextMs2Index];
             } else {
                 moreMs2Points = false;
@@ -84,29 +85,59 @@ void GraphDataController::featureSelectionChanged(const QMultiHash<SampleId, Fea
         QMessageBox::critical(QApplication::activeWindow(), tr("Error"), tr("Too many features are selected simultaneously."));
     }
 
+    updateSeries(featureMzs);
+    if (webPlotEnabled) {
+        emit updatePlot(seriesToPlotData());
+    }
+    emit seriesChanged();
+
+    // spectra of plotted MS2 markers are likely to be requested next
+    QList<FragmentationSpectrumId> plottedSpectrumIds;
+    foreach (const GraphSeries &series, xicSeries) {
+        foreach (const Ms2ScanInfo &scan, series.ms2Scans) {
+            plottedSpectrumIds.append(scan.spectrumId);
+        }
+    }
+    dataSource->prefetchMs2Spectra(plottedSpectrumIds);
+}
+
+void GraphDataController::updateSeries(const QMap<FeatureId, qreal> &featureMzs)
+{
+    xicSeries.clear();
+    massSeries.clear();
+
     const QList<FeatureData> &features = dataSource->getMs1Data();
-    const QHash<SampleId, QHash<FeatureId, QList<Ms2ScanInfo> > > ms2ScanData = dataSource->getMs2ScanData();
+    const Ms2ScanTable &ms2ScanTable = dataSource->getMs2ScanTable();
+    const QHash<FeatureId, QStringList> featureAnnotations = dataSource->getFeatureCompoundIds(currentFeatures.values().toSet());
+    foreach (const FeatureData &fd, features) {
+        GraphSeries xic(fd.sampleId, fd.featureId, dataSource->getSampleNameById(fd.sampleId), featureMzs[fd.featureId],
+            featureAnnotations[fd.featureId]);
+        GraphSeries massPeaks = xic;
+
+        xic.setXic(fd, ms2ScanTable);
+        xicSeries.append(xic);
+
+        massPeaks.setMassPeaks(fd);
+        massSeries.append(massPeaks);
+    }
+}
 
+QVariantMap GraphDataController::seriesToPlotData() const
+{
     QVariantMap xicGraphDescriptions;
     QVariantList xicGraph;
-    QVariantList ms1Graph;
-    QVariantMap ms1GraphDescriptions;
-    const QHash<FeatureId, QStringList> featureAnnotations = dataSource->getFeatureCompoundIds(newSelection.values().toSet());
-    foreach (const FeatureData &fd, features) {
+    foreach (const GraphSeries &series, xicSeries) {
         // add XIC graph info
-        XicGraphDescriptor xicGraphDescription(fd.sampleId, fd.featureId, dataSource->getSampleNameById(fd.sampleId), featureMzs[fd.featureId],
-            featureAnnotations[fd.featureId], fd.featureStart, fd.featureEnd);
+        XicGraphDescriptor xicGraphDescription(series.sampleId, series.featureId, series.sampleName, series.consensusMz,
+            series.compoundIds, series.rtStart, series.rtEnd);
         xicGraphDescriptions[xicGraphDescription.graphId] = xicGraphDescriptionToMap(xicGraphDescription);
 
-        const QList<QPointF> xicPoints = fd.getXic();
-        const QList<Ms2ScanInfo> &ms2ScanPoints = ms2ScanData[fd.sampleId][fd.featureId];
-
+        const Ms2ScanInfo *ms2ScanPoints = series.ms2Scans.constData();
+        const int ms2ScanCount = series.ms2Scans.size();
         int nextMs2Index = 0;
-        bool moreMs2Points = !ms2ScanPoints.isEmpty();
-        for (int xicIndex = 0, xicCount = xicPoints.length(); xicIndex < xicCount; ++xicIndex) {
-            const QPointF &xicPoint = xicPoints[xicIndex];
-
-            addMs2ScanPointToGraph(xicPoint, ms2ScanPoints, xicGraphDescription, nextMs2Index, moreMs2Points, xicGraph);
+        bool moreMs2Points = ms2ScanCount > 0;
+        foreach (const QPointF &xicPoint, series.points) {
+            addMs2ScanPointToGraph(xicPoint, ms2ScanPoints, ms2ScanCount, xicGraphDescription, nextMs2Index, moreMs2Points, xicGraph);
 
             QVariantMap variantPlotData;
             variantPlotData[xicGraphDescription.getXField()] = xicPoint.x();
@@ -117,15 +148,19 @@ void GraphDataController::featureSelectionChanged(const QMultiHash<SampleId, Fea
         // ms2 scans after ms1 finished for this feature
         if (moreMs2Points) {
             const QPointF infinityPoint = QPointF(std::numeric_limits<qreal>::max(), 0.0);
-            addMs2ScanPointToGraph(infinityPoint, ms2ScanPoints, xicGraphDescription, nextMs2Index, moreMs2Points, xicGraph);
+            addMs2ScanPointToGraph(infinityPoint, ms2ScanPoints, ms2ScanCount, xicGraphDescription, nextMs2Index, moreMs2Points, xicGraph);
         }
+    }
 
+    QVariantList ms1Graph;
+    QVariantMap ms1GraphDescriptions;
+    foreach (const GraphSeries &series, massSeries) {
         // add mass peak graph info
-        Ms1GraphDescriptor massGraphDescription(fd.sampleId, fd.featureId, dataSource->getSampleNameById(fd.sampleId),
-            featureMzs[fd.featureId], featureAnnotations[fd.featureId]);
+        Ms1GraphDescriptor massGraphDescription(series.sampleId, series.featureId, series.sampleName, series.consensusMz,
+            series.compoundIds);
         ms1GraphDescriptions[massGraphDescription.graphId] = ms1graphDescriptionToMap(massGraphDescription);
 
-        foreach (const QPointF &ms1Point, fd.getMassPeaks()) {
+        foreach (const QPointF &ms1Point, series.points) {
             QVariantMap variantPlotData;
             variantPlotData[massGraphDescription.getXField()] = ms1Point.x();
             variantPlotData[massGraphDescription.getYField()] = ms1Point.y();
@@ -139,22 +174,80 @@ void GraphDataController::featureSelectionChanged(const QMultiHash<SampleId, Fea
     data[getXicGraphDataKey()] = xicGraph;
     data[getMs1GraphDescKey()] = ms1GraphDescriptions;
     data[getMs1GraphDataKey()] = ms1Graph;
-    emit updatePlot(data);
+    return data;
 }
 
-QVariantMap GraphDataController::getMs2Spectra(const QVariantList &spectraIds) const
+const GraphSeriesList & GraphDataController::getXicSeries() const
+{
+    return xicSeries;
+}
+
+const GraphSeriesList & GraphDataController::getMassSeries() const
+{
+    return massSeries;
+}
+
+GraphSeriesList GraphDataController::getSeriesByGraphIds(const GraphId &chartId, const QStringList &graphIds) const
+{
+    const GraphSeriesList &chartSeries = GraphIds::XIC_ID == chartId ? xicSeries : massSeries;
+    QHash<QString, int> seriesNumberByGraphId;
+    for (int i = 0; i < chartSeries.size(); ++i) {
+        const GraphSeries &series = chartSeries[i];
+        const Ms1GraphDescriptor graphDescription(series.sampleId, series.featureId, series.sampleName, series.consensusMz,
+            series.compoundIds);
+        seriesNumberByGraphId[graphDescription.graphId] = i;
+    }
+
+    QList<FragmentationSpectrumId> spectrumIds;
+    foreach (const QString &graphId, graphIds) {
+        bool isSpectrumId = false;
+        const FragmentationSpectrumId spectrumId = graphId.toLongLong(&isSpectrumId);
+        if (!seriesNumberByGraphId.contains(graphId) && isSpectrumId && GraphIds::MASS_PEAK_ID == chartId) {
+            spectrumIds.append(spectrumId);
+        }
+    }
+    const Ms2SpectraById spectra = spectrumIds.isEmpty() ? Ms2SpectraById() : dataSource->getMs2SpectraData(spectrumIds);
+
+    GraphSeriesList result;
+    foreach (const QString &graphId, graphIds) {
+        if (seriesNumberByGraphId.contains(graphId)) {
+            result.append(chartSeries[seriesNumberByGraphId[graphId]]);
+        } else {
+            GraphSeries series;
+            series.points = spectra.value(graphId.toLongLong()).toVector();
+            GraphSeries::sortPoints(series.points);
+            result.append(series);
+        }
+    }
+    return result;
+}
+
+void GraphDataController::setWebPlotEnabled(bool enabled)
+{
+    if (enabled == webPlotEnabled) {
+        return;
+    }
+    webPlotEnabled = enabled;
+    if (webPlotEnabled) {
+        emit updatePlot(seriesToPlotData());
+    }
+}
+
+QList<FragmentationSpectrumId> GraphDataController::toSpectrumIds(const QVariantList &spectraIds)
 {
     QVector<FragmentationSpectrumId> tmpIds(spectraIds.size());
     std::transform(spectraIds.constBegin(), spectraIds.constEnd(), tmpIds.begin(), [] (const QVariant &v) { return v.value<FragmentationSpectrumId>(); });
-    const QList<FragmentationSpectrumId> realIds = tmpIds.toList();
+    return tmpIds.toList();
+}
 
+QVariantMap GraphDataController::ms2SpectraToMap(const Ms2SpectraById &spectra) const
+{
     QVariantList msnGraph;
     QVariantMap msnGraphDescriptions;
-    const QHash<FragmentationSpectrumId, QList<QPointF> > graphPoints = dataSource->getMs2SpectraData(realIds);
-    foreach (const FragmentationSpectrumId &specId, graphPoints.keys()) {
+    foreach (const FragmentationSpectrumId &specId, spectra.keys()) {
         MsnGraphDescriptor graphDescription(specId);
         msnGraphDescriptions[graphDescription.graphId] = msngraphDescriptionToMap(graphDescription);
-        foreach (const QPointF &point, graphPoints[specId]) {
+        foreach (const QPointF &point, spectra[specId]) {
             QVariantMap variantPlotData;
             variantPlotData[graphDescription.getXField()] = point.x();
             variantPlotData[graphDescription.getYField()] = point.y();
@@ -169,6 +262,29 @@ QVariantMap GraphDataController::getMs2Spectra(const QVariantList &spectraIds) c
     return data;
 }
 
+QVariantMap GraphDataController::getMs2Spectra(const QVariantList &spectraIds) const
+{
+    return ms2SpectraToMap(dataSource->getMs2SpectraData(toSpectrumIds(spectraIds)));
+}
+
+int GraphDataController::requestMs2Spectra(const QVariantList &spectraIds) const
+{
+    return requestMs2Spectra(toSpectrumIds(spectraIds));
+}
+
+int GraphDataController::requestMs2Spectra(const QList<FragmentationSpectrumId> &spectrumIds) const
+{
+    return dataSource->requestMs2SpectraData(spectrumIds);
+}
+
+void GraphDataController::ms2SpectraDataReady(int requestId, const Ms2SpectraById &spectra)
+{
+    if (webPlotEnabled) {
+        emit ms2SpectraReady(requestId, ms2SpectraToMap(spectra));
+    }
+    emit ms2SpectraSeriesReady(requestId, spectra);
+}
+
 QString GraphDataController::getXFieldKey() const
 {
     return "x";
@@ -257,12 +373,12 @@ Q_INVOKABLE QString GraphDataController::getMsnGraphDataKey() const
 void GraphDataController::samplesChanged()
 {
     currentFeatures.clear();
-    QVariantMap emptyData;
-    emptyData[getXicGraphDescKey()] = QVariantMap();
-    emptyData[getXicGraphDataKey()] = QVariantList();
-    emptyData[getMs1GraphDescKey()] = QVariantMap();
-    emptyData[getMs1GraphDataKey()] = QVariantList();
-    emit updatePlot(emptyData);
+    xicSeries.clear();
+    massSeries.clear();
+    if (webPlotEnabled) {
+        emit updatePlot(seriesToPlotData());
+    }
+    emit seriesChanged();
 }
 
 } // namespace ov
@@ -3,9 +3,11 @@
 
 #include <QMultiHash>
 #include <QObject>
+#include <QStringList>
 #include <QVariantMap>
 
-#include "Ms2ScanInfo.h"
+#include "FeatureDataLoader.h"
+#include "GraphSeries.h"
 
 namespace ov {
 
@@ -45,6 +47,14 @@ public:
     explicit GraphDataController(FeatureDataSource *dataSource);
 
     Q_INVOKABLE QVariantMap getMs2Spectra(const QVariantList &spectraIds) const;
+    Q_INVOKABLE int requestMs2Spectra(const QVariantList &spectraIds) const; // the result is sent by ms2SpectraReady()
+    int requestMs2Spectra(const QList<FragmentationSpectrumId> &spectrumIds) const; // the result is sent by ms2SpectraSeriesReady()
+
+    const GraphSeriesList & getXicSeries() const;
+    const GraphSeriesList & getMassSeries() const;
+    // series of the web view graphs in the given order, graph ids of the mass chart may also refer to fragmentation spectra.
+    // Graphs which are not available anymore are returned as empty series.
+    GraphSeriesList getSeriesByGraphIds(const GraphId &chartId, const QStringList &graphIds) const;
 
     QString getXFieldKey() const;
     QString getYFieldKey() const;
@@ -71,20 +81,34 @@ public:
 
 signals:
     void updatePlot(const QVariantMap &data);
+    void ms2SpectraReady(int requestId, const QVariantMap &data);
+    void seriesChanged();
+    void ms2SpectraSeriesReady(int requestId, const Ms2SpectraById &spectra);
     void resetActiveFeatures();
 
 public slots:
     void samplesChanged();
     void featureSelectionChanged(const QMultiHash<SampleId, FeatureId> &newSelection, const QMap<FeatureId, qreal> &featureMzs);
+    void setWebPlotEnabled(bool enabled);
+
+private slots:
+    void ms2SpectraDataReady(int requestId, const Ms2SpectraById &spectra);
 
 private:
+    void updateSeries(const QMap<FeatureId, qreal> &featureMzs);
+    QVariantMap seriesToPlotData() const;
+    static QList<FragmentationSpectrumId> toSpectrumIds(const QVariantList &spectraIds);
+    QVariantMap ms2SpectraToMap(const Ms2SpectraById &spectra) const;
     QVariantMap ms1graphDescriptionToMap(const Ms1GraphDescriptor &graphDescription) const;
     QVariantMap xicGraphDescriptionToMap(const XicGraphDescriptor &graphDescription) const;
     QVariantMap msngraphDescriptionToMap(const MsnGraphDescriptor &graphDescription) const;
-    void addMs2ScanPointToGraph(const QPointF &nextXicPoint, const QList<Ms2ScanInfo> &ms2ScanPoints,
-        const Ms1GraphDescriptor &graphDescription, int &nextMs2Index, bool &moreMs2Points, QVariantList &xicGraph);
+    void addMs2ScanPointToGraph(const QPointF &nextXicPoint, const Ms2ScanInfo *ms2ScanPoints, int ms2ScanCount,
+        const Ms1GraphDescriptor &graphDescription, int &nextMs2Index, bool &moreMs2Points, QVariantList &xicGraph) const;
 
     QMultiHash<SampleId, FeatureId> currentFeatures;
+    GraphSeriesList xicSeries;
+    GraphSeriesList massSeries;
+    bool webPlotEnabled; // the data for the web view is converted to variants only if it's shown
 
     FeatureDataSource *dataSource;
 };
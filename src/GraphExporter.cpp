@@ -4,17 +4,25 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QPrinter>
+#include <QSaveFile>
 #include <QScopedPointer>
 #include <QSvgGenerator>
 #include <QWebFrame>
 #include <QWebPage>
 #include <QWebView>
 
-#include "CsvWritingUtils.h"
+#include "ChartRenderer.h"
+#include "GraphDataController.h"
 #include "SaveGraphDialog.h"
+#include "StripImageWriter.h"
 
 #include "GraphExporter.h"
 
+const int MAX_STRIP_BYTES = 16 * 1024 * 1024;
+const int TIFF_COMPRESSION_LEVEL = 6;
+// charts having more points than this per pixel column of the output are drawn decimated instead of being copied from the view
+const int DECIMATION_POINTS_PER_PIXEL = 4;
+
 namespace ov {
 
 const QList<FormatId> GraphExporter::supportedImageFormatIds = QStringList() << ExportFormats::lossyImageFormats
@@ -33,10 +41,21 @@ QVariantList toVariantList(const QList<T> &l)
     return result;
 }
 
+// Renders only the part of the element covered by the paint device, the rest is skipped by WebKit.
+void renderVisiblePart(QPainter &painter, QWebElement &element, const QSize &deviceSize)
+{
+    const QRectF deviceRect(QPointF(0, 0), deviceSize);
+    const QRect clip = painter.worldTransform().inverted().mapRect(deviceRect).toAlignedRect()
+        .intersected(QRect(QPoint(0, 0), element.geometry().size()));
+    if (!clip.isEmpty()) {
+        element.render(&painter, clip);
+    }
+}
+
 }
 
 GraphExporter::GraphExporter(QWebView *graphView)
-    : graphView(graphView)
+    : graphView(graphView), graphDataController(NULL)
 {
 
 }
@@ -77,6 +96,12 @@ void GraphExporter::setGraphView(QWebView *view)
     graphView = view;
 }
 
+void GraphExporter::setGraphDataController(const GraphDataController *controller)
+{
+    Q_ASSERT(NULL != controller);
+    graphDataController = controller;
+}
+
 QWebElement GraphExporter::getGraphWebElement(const GraphId &id) const
 {
     Q_ASSERT(NULL != graphView);
@@ -96,6 +121,14 @@ QWebElement GraphExporter::getLegendWebElement(const GraphId &id) const
 
 void GraphExporter::saveGraphAsImage(const GraphId &id, const FormatId &formatId, const QString &path, int quality, double scale) const
 {
+    if (!path.isEmpty() && ("PNG" == formatId || "TIFF" == formatId)) {
+        QString errorMessage;
+        if (!saveGraphAsTiledImage(id, formatId, path, quality, scale, errorMessage)) {
+            QMessageBox::critical(QApplication::activeWindow(), tr("Error"), errorMessage);
+        }
+        return;
+    }
+
     QWebElement graphElement = getGraphWebElement(id);
     QWebElement legendElement = getLegendWebElement(id);
     const QRect graphGeometry = graphElement.geometry();
@@ -127,7 +160,93 @@ void GraphExporter::saveGraphAsImage(const GraphId &id, const FormatId &formatId
     }
 }
 
-void GraphExporter::saveGraphAsSvg(const GraphId &id, const QString &path, double scale) const
+bool GraphExporter::saveGraphAsTiledImage(const GraphId &id, const FormatId &formatId, const QString &path, int quality,
+    double scale, QString &errorMessage) const
+{
+    QWebElement graphElement = getGraphWebElement(id);
+    QWebElement legendElement = getLegendWebElement(id);
+    const QRect graphGeometry = graphElement.geometry();
+    const QRect legendGeometry = legendElement.geometry();
+
+    const double legendScalingFactor = double(graphGeometry.width()) / legendGeometry.width();
+    const QSize imageSize(graphGeometry.width() * scale, (graphGeometry.height() + legendGeometry.height() * legendScalingFactor) * scale);
+    const int rowsPerStrip = qBound(1, MAX_STRIP_BYTES / (imageSize.width() * 4), imageSize.height());
+
+    errorMessage = tr("Unable to save the file. Perhaps, it is being used by another process.");
+    // the image is written to a temporary file, so a failed export doesn't leave a truncated one at the path
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    // quality is mapped to zlib levels the same way as QImage does it for PNG
+    const bool isPng = "PNG" == formatId;
+    StripImageWriter writer(isPng ? StripImageWriter::PNG_FORMAT : StripImageWriter::TIFF_FORMAT, &file, imageSize, rowsPerStrip,
+        isPng ? (100 - quality) * 9 / 91 : TIFF_COMPRESSION_LEVEL);
+
+    QImage strip(imageSize.width(), rowsPerStrip, QImage::Format_RGB32);
+    for (int top = 0; top < imageSize.height(); top += rowsPerStrip) {
+        strip.fill(Qt::white);
+        QPainter painter(&strip);
+        painter.translate(0, -top);
+        painter.scale(scale, scale);
+        renderVisiblePart(painter, graphElement, strip.size());
+        painter.translate(QPoint(0, graphGeometry.height()));
+        painter.scale(legendScalingFactor, legendScalingFactor);
+        renderVisiblePart(painter, legendElement, strip.size());
+        painter.end();
+
+        if (!writer.writeStrip(strip)) {
+            break;
+        }
+    }
+    if (writer.finish()) {
+        return file.commit();
+    }
+    if (writer.isTooLarge()) {
+        errorMessage = tr("The image exceeds 4 GB, which is the limit of the TIFF format. Save it as PNG or with a smaller scale.");
+    }
+    return false;
+}
+
+bool GraphExporter::setupDecimatedChart(const GraphId &id, const QVariantList &visibleGraphs, const QVariantMap &chartView,
+    int outputWidth, ChartRenderer &renderer) const
+{
+    if (NULL == graphDataController || visibleGraphs.isEmpty()) {
+        return false;
+    }
+
+    QStringList graphIds;
+    QStringList titles;
+    QVector<QColor> colors;
+    foreach (const QVariant &graph, visibleGraphs) {
+        const QVariantMap graphMap = graph.toMap();
+        graphIds.append(graphMap["id"].toString());
+        titles.append(graphMap["title"].toString());
+        const QColor color(graphMap["color"].toString());
+        colors.append(color.isValid() ? color : ChartRenderer::getDefaultColor(colors.size()));
+    }
+    const GraphSeriesList series = graphDataController->getSeriesByGraphIds(id, graphIds);
+
+    int pointCount = 0;
+    foreach (const GraphSeries &s, series) {
+        pointCount += s.points.size();
+    }
+    if (pointCount <= outputWidth * DECIMATION_POINTS_PER_PIXEL) {
+        return false; // small charts are copied from the view as they are
+    }
+
+    renderer.setAxisTitles(GraphIds::XIC_ID == id ? tr("Retention time [s]") : tr("m/z"), tr("Ion count"));
+    renderer.setPlotStyle(chartView["stickPlot"].toBool() ? ChartRenderer::STICK_PLOT : ChartRenderer::AREA_PLOT);
+    renderer.setSeries(series, colors);
+    renderer.setSeriesTitles(titles);
+    if (chartView.contains("xMin") && chartView.contains("xMax")) {
+        renderer.setXRange(chartView["xMin"].toDouble(), chartView["xMax"].toDouble());
+    }
+    return true;
+}
+
+void GraphExporter::saveGraphAsSvg(const GraphId &id, const QString &path, double scale, const QVariantList &visibleGraphs,
+    const QVariantMap &chartView) const
 {
     QWebElement graphElement = getGraphWebElement(id);
     QWebElement legendElement = getLegendWebElement(id);
@@ -137,21 +256,27 @@ void GraphExporter::saveGraphAsSvg(const GraphId &id, const QString &path, doubl
     QSvgGenerator generator;
     generator.setFileName(path);
     const double legendScalingFactor = double(graphGeometry.width()) / legendGeometry.width();
-    generator.setSize(QSize(graphGeometry.width() * scale,
-        (graphGeometry.height() + legendGeometry.height() * legendScalingFactor) * scale));
+    const QSize chartSize(graphGeometry.width(), graphGeometry.height() + legendGeometry.height() * legendScalingFactor);
+    generator.setSize(chartSize * scale);
 
     generator.setTitle(tr("Snapshot by OptimusViewer"));
     generator.setDescription(tr("An image of a plot created by OptimusViewer software, LC-MS data visualization tool."));
 
     QPainter painter(&generator);
     painter.scale(scale, scale);
+    ChartRenderer renderer;
+    if (setupDecimatedChart(id, visibleGraphs, chartView, chartSize.width() * scale, renderer)) {
+        renderer.render(&painter, QRect(QPoint(0, 0), chartSize));
+        return;
+    }
     graphElement.render(&painter);
     painter.translate(QPoint(0, graphGeometry.height()));
     painter.scale(legendScalingFactor, legendScalingFactor);
     legendElement.render(&painter);
 }
 
-void GraphExporter::saveGraphAsPdf(const GraphId &id, const QString &path) const
+void GraphExporter::saveGraphAsPdf(const GraphId &id, const QString &path, const QVariantList &visibleGraphs,
+    const QVariantMap &chartView) const
 {
     QWebElement graphElement = getGraphWebElement(id);
     QWebElement legendElement = getLegendWebElement(id);
@@ -175,19 +300,25 @@ void GraphExporter::saveGraphAsPdf(const GraphId &id, const QString &path) const
     const qreal pageScale = pageWidth * printer.resolution() / graphGeometry.width();
 
     painter.scale(pageScale, pageScale);
+    ChartRenderer renderer;
+    if (setupDecimatedChart(id, visibleGraphs, chartView, graphGeometry.width() * pageScale, renderer)) {
+        renderer.render(&painter, QRect(0, 0, graphGeometry.width(), graphGeometry.height() + legendGeometry.height() * legendScalingFactor));
+        return;
+    }
     graphElement.render(&painter);
     painter.translate(QPoint(0, graphGeometry.height()));
     painter.scale(legendScalingFactor, legendScalingFactor);
     legendElement.render(&painter);
 }
 
-void GraphExporter::saveGraphAsCsv(const GraphId &id, const QString &path, const QVariantList &graphPoints) const
+void GraphExporter::saveGraphAsCsv(const GraphId &id, const QString &path, const QVariantList &visibleGraphs,
+    CsvWritingUtils::GraphTableLayout layout) const
 {
-    if (graphPoints.isEmpty()) {
+    Q_ASSERT(NULL != graphDataController);
+    if (visibleGraphs.isEmpty()) {
         return;
     }
 
-    int numberOfNextValueColumn = 1;
     QString xFieldColumnName;
     if (id == GraphIds::XIC_ID) {
         xFieldColumnName = "RT";
@@ -196,57 +327,23 @@ void GraphExporter::saveGraphAsCsv(const GraphId &id, const QString &path, const
     } else {
         Q_ASSERT(false);
     }
-    QMap<QString, int> columnNumberByName;
-    QVariantList graphPointsSortedByX = graphPoints;
-    std::sort(graphPointsSortedByX.begin(), graphPointsSortedByX.end(),
-        [](const QVariant &first, const QVariant &second) { return first.toMap()["x"].toReal() < second.toMap()["x"].toReal(); });
 
-    foreach (const QVariant &varPoint, graphPointsSortedByX) {
-        const QVariantMap mapPoint = varPoint.toMap();
-        const QString yField = mapPoint["y"].toString();
-
-        if (!columnNumberByName.contains(yField)) {
-            columnNumberByName[yField] = numberOfNextValueColumn++;
-        }
-    }
-
-    QList<QStringList> resultTable = CsvWritingUtils::createEmptyTable(graphPointsSortedByX.length() + 1, numberOfNextValueColumn);
-    resultTable[0][0] = xFieldColumnName;
-    for (int i = 1; i < numberOfNextValueColumn; ++i) {
-        QString columnName = columnNumberByName.key(i);
-        if (columnName.contains(",")) {
-            columnName = QString("\"%1\"").arg(columnName); // escape commas
-        }
-        resultTable[0][i] = columnName;
-    }
-
-    QMap<QString, int> rowNumberByXValue;
-    int currentRow = 0;
-    foreach (const QVariant &varPoint, graphPointsSortedByX) {
-        const QVariantMap mapPoint = varPoint.toMap();
-        const QString yField = mapPoint["y"].toString();
-        const int columnNumber = columnNumberByName[yField];
-
-        const QString xValue = mapPoint["x"].toString();
-
-        int row = -1;
-        if (!rowNumberByXValue.contains(xValue)) {
-            rowNumberByXValue[xValue] = ++currentRow;
-            row = currentRow;
-            resultTable[row][0] = xValue;
-        } else {
-            row = rowNumberByXValue[xValue];
-        }
-        Q_ASSERT(-1 != row);
-        resultTable[row][columnNumber] = mapPoint[yField].toString();
+    QStringList graphIds;
+    QStringList titles;
+    foreach (const QVariant &graph, visibleGraphs) {
+        const QVariantMap graphMap = graph.toMap();
+        graphIds.append(graphMap["id"].toString());
+        titles.append(graphMap["title"].toString());
     }
+    const GraphSeriesList series = graphDataController->getSeriesByGraphIds(id, graphIds);
 
-    if (!CsvWritingUtils::saveTableToFile(resultTable, path)) {
+    if (!CsvWritingUtils::saveGraphSeriesToFile(series, titles, xFieldColumnName, tr("Intensity"), layout, path)) {
         QMessageBox::critical(QApplication::activeWindow(), tr("Error"), tr("Unable to save file: %1").arg(path));
     }
 }
 
-void GraphExporter::exportGraph(const QString &graphId, const FormatId &initialFormatId, const QVariantList &graphPoints)
+void GraphExporter::exportGraph(const QString &graphId, const FormatId &initialFormatId, const QVariantList &visibleGraphs,
+    const QVariantMap &chartView)
 {
     if (initialFormatId == "Clipboard") {
         saveGraphAsImage(graphId, initialFormatId, QString(), 100, 1);
@@ -267,15 +364,15 @@ void GraphExporter::exportGraph(const QString &graphId, const FormatId &initialF
     }
     if (isImageFormat(finalFormatId)) {
         if (finalFormatId == "SVG") {
-            saveGraphAsSvg(graphId, path, saveDialog->getScale());
+            saveGraphAsSvg(graphId, path, saveDialog->getScale(), visibleGraphs, chartView);
         } else if (finalFormatId == "PDF") {
-            saveGraphAsPdf(graphId, path);
+            saveGraphAsPdf(graphId, path, visibleGraphs, chartView);
         } else {
             saveGraphAsImage(graphId, finalFormatId, path, saveDialog->getQuality(), saveDialog->getScale());
         }
     } else if (isDataFormat(initialFormatId)) {
         if (finalFormatId == "CSV") {
-            saveGraphAsCsv(graphId, path, graphPoints);
+            saveGraphAsCsv(graphId, path, visibleGraphs, saveDialog->getGraphTableLayout());
         } else {
             Q_ASSERT(false);
         }
@@ -4,14 +4,19 @@
 #include <QImage>
 #include <QObject>
 #include <QVariantList>
+#include <QVariantMap>
 #include <QWebElement>
 
+#include "CsvWritingUtils.h"
 #include "Globals.h"
 
 class QWebView;
 
 namespace ov {
 
+class ChartRenderer;
+class GraphDataController;
+
 class GraphExporter : public QObject
 {
     Q_OBJECT
@@ -30,19 +35,30 @@ public:
     QVariantList getSupportedImageFormatIds() const;
     QVariantList getSupportedDataFormatIds() const;
 
-    Q_INVOKABLE void exportGraph(const GraphId &graphId, const FormatId &formatId, const QVariantList &graphPoints);
+    // @visibleGraphs: list of {id, title, color} objects describing graphs which are not hidden
+    // @chartView: {stickPlot, xMin, xMax} object describing the plot style and the zoomed range if any
+    Q_INVOKABLE void exportGraph(const GraphId &graphId, const FormatId &formatId, const QVariantList &visibleGraphs,
+        const QVariantMap &chartView);
 
     void setGraphView(QWebView *view);
+    void setGraphDataController(const GraphDataController *controller);
 
 private:
     QWebView *graphView;
+    const GraphDataController *graphDataController;
 
     QWebElement getGraphWebElement(const GraphId &id) const;
     QWebElement getLegendWebElement(const GraphId &id) const;
     void saveGraphAsImage(const GraphId &id, const FormatId &formatId, const QString &path, int quality, double scale) const;
-    void saveGraphAsSvg(const GraphId &id, const QString &path, double scale) const;
-    void saveGraphAsPdf(const GraphId &id, const QString &path) const;
-    void saveGraphAsCsv(const GraphId &id, const QString &path, const QVariantList &graphPoints) const;
+    bool saveGraphAsTiledImage(const GraphId &id, const FormatId &formatId, const QString &path, int quality, double scale,
+        QString &errorMessage) const;
+    void saveGraphAsSvg(const GraphId &id, const QString &path, double scale, const QVariantList &visibleGraphs,
+        const QVariantMap &chartView) const;
+    void saveGraphAsPdf(const GraphId &id, const QString &path, const QVariantList &visibleGraphs, const QVariantMap &chartView) const;
+    bool setupDecimatedChart(const GraphId &id, const QVariantList &visibleGraphs, const QVariantMap &chartView, int outputWidth,
+        ChartRenderer &renderer) const;
+    void saveGraphAsCsv(const GraphId &id, const QString &path, const QVariantList &visibleGraphs,
+        CsvWritingUtils::GraphTableLayout layout) const;
 
     static bool isDataFormat(const QString &id);
     static bool isImageFormat(const QString &id);
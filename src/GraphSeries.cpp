@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include "FeatureData.h"
+#include "Ms2ScanTable.h"
+
+#include "GraphSeries.h"
+
+const int MAX_COMPOUND_ID_LENGTH = 97;
+
+namespace ov {
+
+GraphSeries::GraphSeries()
+    : sampleId(-1), featureId(-1), consensusMz(0.0), rtStart(0.0), rtEnd(-1.0)
+{
+
+}
+
+GraphSeries::GraphSeries(const SampleId &sampleId, const FeatureId &featureId, const QString &sampleName, qreal consensusMz,
+    const QStringList &compoundIds)
+    : sampleId(sampleId), featureId(featureId), sampleName(sampleName), consensusMz(consensusMz), compoundIds(compoundIds),
+    rtStart(0.0), rtEnd(-1.0)
+{
+
+}
+
+bool GraphSeries::hasElutionRange() const
+{
+    return rtStart <= rtEnd;
+}
+
+void GraphSeries::setXic(const FeatureData &feature, const Ms2ScanTable &ms2ScanTable)
+{
+    points = feature.getXic().toVector();
+    rtStart = feature.featureStart;
+    rtEnd = feature.featureEnd;
+
+    int ms2ScanCount = 0;
+    const Ms2ScanInfo *ms2ScanPoints = ms2ScanTable.getScans(feature.sampleId, feature.featureId, ms2ScanCount);
+    ms2Scans.resize(ms2ScanCount);
+    std::copy(ms2ScanPoints, ms2ScanPoints + ms2ScanCount, ms2Scans.begin());
+}
+
+void GraphSeries::setMassPeaks(const FeatureData &feature)
+{
+    points = feature.getMassPeaks().toVector();
+}
+
+// Titles are the same as the ones generated by GraphView.js, lines are separated by "\n"
+
+QString GraphSeries::getFeatureTitle() const
+{
+    QString title = QString("Feature ID: %1").arg(featureId);
+    if (!compoundIds.isEmpty()) {
+        QString compoundId = compoundIds.join("; ");
+        if (compoundId.length() > MAX_COMPOUND_ID_LENGTH) {
+            compoundId = compoundId.left(MAX_COMPOUND_ID_LENGTH) + "...";
+        }
+        title += QString("\nCompound ID: %1").arg(compoundId);
+    }
+    title += QString("\nConsensus m/z: %1\nSample: %2").arg(QString::number(consensusMz, 'f', 4), sampleName);
+    return title;
+}
+
+QString GraphSeries::getSpectrumTitle(const Ms2ScanInfo &scan) const
+{
+    QString title = QString("Precursor m/z: %1").arg(QString::number(scan.precursorMz, 'f', 4));
+    if (!compoundIds.isEmpty()) {
+        title += QString("\nCompound ID: %1").arg(compoundIds.join("; "));
+    }
+    title += QString("\nSample: %1\nScan start time: %2 s").arg(sampleName, QString::number(scan.scanTime, 'f', 2));
+    return title;
+}
+
+void GraphSeries::sortPoints(QVector<QPointF> &points)
+{
+    const auto lessThan = [] (const QPointF &p1, const QPointF &p2) { return p1.x() < p2.x(); };
+    if (!std::is_sorted(points.constBegin(), points.constEnd(), lessThan)) {
+        std::sort(points.begin(), points.end(), lessThan);
+    }
+}
+
+} // namespace ov
@@ -0,0 +1,46 @@
+#ifndef GRAPH_SERIES_H
+#define GRAPH_SERIES_H
+
+#include <QPointF>
+#include <QVector>
+
+#include "Ms2ScanInfo.h"
+
+namespace ov {
+
+struct FeatureData;
+class Ms2ScanTable;
+
+// Plotted points of a single graph together with the data describing it. Points are sorted by x.
+struct GraphSeries {
+    GraphSeries();
+    GraphSeries(const SampleId &sampleId, const FeatureId &featureId, const QString &sampleName, qreal consensusMz,
+        const QStringList &compoundIds);
+
+    bool hasElutionRange() const;
+
+    void setXic(const FeatureData &feature, const Ms2ScanTable &ms2ScanTable); // also sets elution range and MS2 scans
+    void setMassPeaks(const FeatureData &feature);
+
+    QString getFeatureTitle() const;
+    QString getSpectrumTitle(const Ms2ScanInfo &scan) const;
+
+    static void sortPoints(QVector<QPointF> &points);
+
+    SampleId sampleId;
+    FeatureId featureId;
+    QString sampleName;
+    qreal consensusMz;
+    QStringList compoundIds;
+
+    QVector<QPointF> points;
+    qreal rtStart;
+    qreal rtEnd;
+    QVector<Ms2ScanInfo> ms2Scans; // sorted by scan time
+};
+
+typedef QList<GraphSeries> GraphSeriesList;
+
+} // namespace ov
+
+#endif // GRAPH_SERIES_H
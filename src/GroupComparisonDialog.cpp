@@ -0,0 +1,84 @@
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QMessageBox>
+
+#include "GroupComparisonDialog.h"
+
+namespace ov {
+
+GroupComparisonDialog::GroupComparisonDialog(const QStringList &sampleTypes, QWidget *parent)
+    : QDialog(parent), sampleTypes(sampleTypes)
+{
+    setWindowTitle(tr("Compare Sample Groups"));
+
+    QStringList types = sampleTypes;
+    types.removeDuplicates();
+    types.removeAll(QString());
+    types.sort();
+
+    firstGroupComboBox = new QComboBox(this);
+    secondGroupComboBox = new QComboBox(this);
+    foreach (const QString &type, types) {
+        const int count = sampleTypes.count(type);
+        firstGroupComboBox->addItem(tr("%1 (%2 samples)").arg(type).arg(count), type);
+        secondGroupComboBox->addItem(tr("%1 (%2 samples)").arg(type).arg(count), type);
+    }
+    secondGroupComboBox->addItem(tr("All other samples"));
+    secondGroupComboBox->setCurrentIndex(qMin(1, types.size()));
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &GroupComparisonDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QFormLayout *layout = new QFormLayout(this);
+    layout->addRow(tr("Reference group:"), firstGroupComboBox);
+    layout->addRow(tr("Compared group:"), secondGroupComboBox);
+    layout->addRow(buttonBox);
+}
+
+QVector<int> GroupComparisonDialog::getGroup(const QComboBox *comboBox, const QComboBox *otherComboBox) const
+{
+    const QVariant type = comboBox->currentData();
+    const QString otherType = otherComboBox->currentData().toString();
+    QVector<int> sampleNumbers;
+    for (int i = 0; i < sampleTypes.size(); ++i) {
+        if (type.isValid() ? sampleTypes[i] == type.toString() : sampleTypes[i] != otherType) {
+            sampleNumbers.append(i);
+        }
+    }
+    return sampleNumbers;
+}
+
+QVector<int> GroupComparisonDialog::getFirstGroup() const
+{
+    return getGroup(firstGroupComboBox, secondGroupComboBox);
+}
+
+QVector<int> GroupComparisonDialog::getSecondGroup() const
+{
+    return getGroup(secondGroupComboBox, firstGroupComboBox);
+}
+
+QString GroupComparisonDialog::getFirstGroupName() const
+{
+    return firstGroupComboBox->currentData().toString();
+}
+
+QString GroupComparisonDialog::getSecondGroupName() const
+{
+    return secondGroupComboBox->currentData().isValid() ? secondGroupComboBox->currentData().toString() : tr("others");
+}
+
+void GroupComparisonDialog::accept()
+{
+    if (firstGroupComboBox->currentData() == secondGroupComboBox->currentData()) {
+        QMessageBox::warning(this, tr("Warning"), tr("Please, select two different groups."));
+    } else if (getFirstGroup().isEmpty() || getSecondGroup().isEmpty()) {
+        QMessageBox::warning(this, tr("Warning"), tr("Both groups should contain samples."));
+    } else {
+        QDialog::accept();
+    }
+}
+
+} // namespace ov
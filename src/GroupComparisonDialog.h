@@ -0,0 +1,38 @@
+#ifndef GROUP_COMPARISON_DIALOG_H
+#define GROUP_COMPARISON_DIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+class QComboBox;
+
+namespace ov {
+
+// Lets the user choose two groups of samples by their types, the second one may be all other samples
+class GroupComparisonDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // @sampleTypes: by sample number
+    GroupComparisonDialog(const QStringList &sampleTypes, QWidget *parent);
+
+    QVector<int> getFirstGroup() const; // sample numbers
+    QVector<int> getSecondGroup() const;
+    QString getFirstGroupName() const;
+    QString getSecondGroupName() const;
+
+public slots:
+    void accept();
+
+private:
+    QVector<int> getGroup(const QComboBox *comboBox, const QComboBox *otherComboBox) const;
+
+    QStringList sampleTypes;
+    QComboBox *firstGroupComboBox;
+    QComboBox *secondGroupComboBox;
+};
+
+} // namespace ov
+
+#endif // GROUP_COMPARISON_DIALOG_H
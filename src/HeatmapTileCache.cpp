@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cmath>
+
+#include <QColor>
+#include <QtConcurrent>
+
+#include "HeatmapTileCache.h"
+
+const int TILE_CACHE_SIZE = 256 * 1024; // kilobytes
+const QRgb BACKGROUND_COLOR = qRgb(255, 255, 255);
+
+namespace ov {
+
+namespace {
+
+// perceptually uniform from dark blue to yellow, like viridis
+QVector<QRgb> createPalette()
+{
+    const QColor stops[] = { QColor(68, 1, 84), QColor(59, 82, 139), QColor(33, 145, 140), QColor(94, 201, 98), QColor(253, 231, 37) };
+    const int stopCount = sizeof(stops) / sizeof(stops[0]);
+    QVector<QRgb> palette(256);
+    for (int i = 0; i < palette.size(); ++i) {
+        const qreal position = qreal(i) / (palette.size() - 1) * (stopCount - 1);
+        const int stop = qMin(int(position), stopCount - 2);
+        const qreal t = position - stop;
+        palette[i] = qRgb(stops[stop].red() + t * (stops[stop + 1].red() - stops[stop].red()),
+            stops[stop].green() + t * (stops[stop + 1].green() - stops[stop].green()),
+            stops[stop].blue() + t * (stops[stop + 1].blue() - stops[stop].blue()));
+    }
+    return palette;
+}
+
+int getLevelCount(int size)
+{
+    int level = 0;
+    while ((HeatmapTileCache::TILE_SIZE << level) < size) {
+        ++level;
+    }
+    return level;
+}
+
+}
+
+HeatmapTileKey::HeatmapTileKey()
+    : rowLevel(0), columnLevel(0), tileRow(0), tileColumn(0)
+{
+
+}
+
+HeatmapTileKey::HeatmapTileKey(int rowLevel, int columnLevel, int tileRow, int tileColumn)
+    : rowLevel(rowLevel), columnLevel(columnLevel), tileRow(tileRow), tileColumn(tileColumn)
+{
+
+}
+
+bool HeatmapTileKey::operator ==(const HeatmapTileKey &other) const
+{
+    return rowLevel == other.rowLevel && columnLevel == other.columnLevel && tileRow == other.tileRow && tileColumn == other.tileColumn;
+}
+
+uint qHash(const HeatmapTileKey &key, uint seed)
+{
+    return ::qHash((quint64(key.rowLevel) << 56) ^ (quint64(key.columnLevel) << 48) ^ (quint64(key.tileRow) << 20) ^ key.tileColumn, seed);
+}
+
+HeatmapTileCache::TileComputer::TileComputer(const QSharedPointer<const Data> &data)
+    : data(data)
+{
+
+}
+
+QImage HeatmapTileCache::TileComputer::operator ()(const HeatmapTileKey &key) const
+{
+    const int rowBlock = 1 << key.rowLevel;
+    const int columnBlock = 1 << key.columnLevel;
+    const int firstRow = key.tileRow * TILE_SIZE * rowBlock;
+    const int endRow = qMin(data->rows.size(), firstRow + TILE_SIZE * rowBlock);
+    const int firstColumn = key.tileColumn * TILE_SIZE * columnBlock;
+    const int endColumn = qMin(data->matrix.getSampleCount(), firstColumn + TILE_SIZE * columnBlock);
+    if (firstRow >= endRow || firstColumn >= endColumn) {
+        return QImage();
+    }
+
+    const int width = (endColumn - firstColumn + columnBlock - 1) >> key.columnLevel;
+    const int height = (endRow - firstRow + rowBlock - 1) >> key.rowLevel;
+    QVector<double> values(width * height, 0.0);
+    const bool isMax = MAX_AGGREGATION == data->aggregation;
+    for (int position = firstRow; position < endRow; ++position) {
+        const int *sampleNumbers = NULL;
+        const double *intensities = NULL;
+        const int count = data->matrix.getRowIntensities(data->rows[position], sampleNumbers, intensities);
+        double *line = values.data() + ((position - firstRow) >> key.rowLevel) * width;
+        for (int i = std::lower_bound(sampleNumbers, sampleNumbers + count, firstColumn) - sampleNumbers;
+            i < count && sampleNumbers[i] < endColumn; ++i)
+        {
+            double &value = line[(sampleNumbers[i] - firstColumn) >> key.columnLevel];
+            value = isMax ? qMax(value, intensities[i]) : value + intensities[i];
+        }
+    }
+
+    const qreal logRange = qMax(data->maxLogIntensity - data->minLogIntensity, 1e-9);
+    const int maxColorIndex = data->palette.size() - 1;
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        QRgb *pixels = reinterpret_cast<QRgb *>(image.scanLine(y));
+        const int blockRows = qMin(rowBlock, endRow - firstRow - y * rowBlock);
+        for (int x = 0; x < width; ++x) {
+            double value = values[y * width + x];
+            if (!isMax) {
+                value /= blockRows * qMin(columnBlock, endColumn - firstColumn - x * columnBlock); // edge blocks are smaller
+            }
+            if (value <= 0.0) {
+                pixels[x] = BACKGROUND_COLOR;
+            } else {
+                const qreal t = (std::log10(value) - data->minLogIntensity) / logRange;
+                pixels[x] = data->palette[qBound(0, qRound(t * maxColorIndex), maxColorIndex)];
+            }
+        }
+    }
+    return image;
+}
+
+HeatmapTileCache::HeatmapTileCache(QObject *parent)
+    : QObject(parent), tiles(TILE_CACHE_SIZE)
+{
+    resetData(FeatureMatrix(), QVector<int>(), MAX_AGGREGATION, 0.0, 0.0);
+
+    connect(&batchWatcher, &QFutureWatcher<QImage>::resultReadyAt, this, &HeatmapTileCache::batchResultReady);
+    connect(&batchWatcher, &QFutureWatcher<QImage>::finished, this, &HeatmapTileCache::batchFinished);
+}
+
+HeatmapTileCache::~HeatmapTileCache()
+{
+    batchWatcher.cancel();
+    batchWatcher.waitForFinished();
+}
+
+void HeatmapTileCache::setMatrix(const FeatureMatrix &matrix, const QVector<int> &rows)
+{
+    // the color scale is the same for all levels, so that zooming doesn't change colors
+    double minIntensity = 0.0;
+    double maxIntensity = 0.0;
+    for (int row = 0; row < matrix.getRowCount(); ++row) {
+        const int *sampleNumbers = NULL;
+        const double *intensities = NULL;
+        const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+        for (int i = 0; i < count; ++i) {
+            if (intensities[i] > 0.0) {
+                minIntensity = 0.0 == minIntensity ? intensities[i] : qMin(minIntensity, intensities[i]);
+                maxIntensity = qMax(maxIntensity, intensities[i]);
+            }
+        }
+    }
+    resetData(matrix, rows, data->aggregation, minIntensity > 0.0 ? std::log10(minIntensity) : 0.0,
+        maxIntensity > 0.0 ? std::log10(maxIntensity) : 0.0);
+}
+
+void HeatmapTileCache::setRows(const QVector<int> &rows)
+{
+    resetData(data->matrix, rows, data->aggregation, data->minLogIntensity, data->maxLogIntensity);
+}
+
+void HeatmapTileCache::setAggregation(Aggregation aggregation)
+{
+    if (aggregation != data->aggregation) {
+        resetData(data->matrix, data->rows, aggregation, data->minLogIntensity, data->maxLogIntensity);
+    }
+}
+
+HeatmapTileCache::Aggregation HeatmapTileCache::getAggregation() const
+{
+    return data->aggregation;
+}
+
+void HeatmapTileCache::resetData(const FeatureMatrix &matrix, const QVector<int> &rows, Aggregation aggregation,
+    qreal minLogIntensity, qreal maxLogIntensity)
+{
+    Data *newData = new Data;
+    newData->matrix = matrix;
+    newData->rows = rows;
+    newData->aggregation = aggregation;
+    newData->minLogIntensity = minLogIntensity;
+    newData->maxLogIntensity = maxLogIntensity;
+    newData->palette = createPalette();
+
+    data = QSharedPointer<const Data>(newData);
+    tiles.clear();
+    requestedKeys.clear();
+    batchWatcher.cancel(); // results of the running batch are dropped as they belong to the old data
+}
+
+int HeatmapTileCache::getRowCount() const
+{
+    return data->rows.size();
+}
+
+int HeatmapTileCache::getColumnCount() const
+{
+    return data->matrix.getSampleCount();
+}
+
+int HeatmapTileCache::getMaxRowLevel() const
+{
+    return getLevelCount(getRowCount());
+}
+
+int HeatmapTileCache::getMaxColumnLevel() const
+{
+    return getLevelCount(getColumnCount());
+}
+
+const QImage * HeatmapTileCache::getTile(const HeatmapTileKey &key) const
+{
+    return tiles.object(key);
+}
+
+void HeatmapTileCache::requestTiles(const QList<HeatmapTileKey> &keys)
+{
+    requestedKeys.clear();
+    foreach (const HeatmapTileKey &key, keys) {
+        if (!tiles.contains(key) && !(batchData == data && batchKeys.contains(key))) {
+            requestedKeys.append(key);
+        }
+    }
+    if (!batchWatcher.isRunning()) {
+        startBatch();
+    }
+}
+
+void HeatmapTileCache::startBatch()
+{
+    batchKeys = requestedKeys;
+    batchData = data;
+    requestedKeys.clear();
+    if (!batchKeys.isEmpty()) {
+        batchWatcher.setFuture(QtConcurrent::mapped(batchKeys, TileComputer(batchData)));
+    }
+}
+
+void HeatmapTileCache::batchResultReady(int index)
+{
+    if (batchData != data) {
+        return;
+    }
+    const QImage tile = batchWatcher.resultAt(index);
+    tiles.insert(batchKeys[index], new QImage(tile), qMax(1, tile.byteCount() / 1024));
+    emit tileReady();
+}
+
+void HeatmapTileCache::batchFinished()
+{
+    batchKeys.clear();
+    batchData.clear();
+    startBatch();
+}
+
+} // namespace ov
@@ -0,0 +1,111 @@
+#ifndef HEATMAP_TILE_CACHE_H
+#define HEATMAP_TILE_CACHE_H
+
+#include <QCache>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "FeatureMatrix.h"
+
+namespace ov {
+
+// Tile of the heatmap pyramid. At row level r and column level c every pixel of the tile aggregates a block of
+// 2^r displayed rows and 2^c samples. Levels are independent for rows and columns because feature matrices are
+// usually much taller than wide.
+struct HeatmapTileKey
+{
+    HeatmapTileKey();
+    HeatmapTileKey(int rowLevel, int columnLevel, int tileRow, int tileColumn);
+
+    bool operator ==(const HeatmapTileKey &other) const;
+
+    int rowLevel;
+    int columnLevel;
+    int tileRow;
+    int tileColumn;
+};
+
+uint qHash(const HeatmapTileKey &key, uint seed = 0);
+
+// Computes heatmap tiles of the intensity matrix in the thread pool and keeps the most recently used ones.
+// Tiles are computed straight from the sparse rows, so finer levels cost nothing until they're looked at.
+class HeatmapTileCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Aggregation {
+        MAX_AGGREGATION,
+        MEAN_AGGREGATION // undetected features count as zeros
+    };
+
+    static const int TILE_SIZE = 256; // pixels
+
+    explicit HeatmapTileCache(QObject *parent = NULL);
+    ~HeatmapTileCache();
+
+    // @rows: matrix rows in the order they're displayed
+    void setMatrix(const FeatureMatrix &matrix, const QVector<int> &rows);
+    void setRows(const QVector<int> &rows);
+    void setAggregation(Aggregation aggregation);
+    Aggregation getAggregation() const;
+
+    int getRowCount() const;
+    int getColumnCount() const;
+    int getMaxRowLevel() const;
+    int getMaxColumnLevel() const;
+
+    // returns NULL if the tile isn't computed yet
+    const QImage * getTile(const HeatmapTileKey &key) const;
+    // replaces tiles requested earlier which haven't been started yet
+    void requestTiles(const QList<HeatmapTileKey> &keys);
+
+signals:
+    void tileReady();
+
+private slots:
+    void batchResultReady(int index);
+    void batchFinished();
+
+private:
+    struct Data
+    {
+        FeatureMatrix matrix;
+        QVector<int> rows;
+        Aggregation aggregation;
+        qreal minLogIntensity;
+        qreal maxLogIntensity;
+        QVector<QRgb> palette;
+    };
+
+    class TileComputer
+    {
+    public:
+        typedef QImage result_type;
+
+        explicit TileComputer(const QSharedPointer<const Data> &data);
+        QImage operator ()(const HeatmapTileKey &key) const;
+
+    private:
+        QSharedPointer<const Data> data;
+    };
+
+    void resetData(const FeatureMatrix &matrix, const QVector<int> &rows, Aggregation aggregation, qreal minLogIntensity,
+        qreal maxLogIntensity);
+    void startBatch();
+
+    QSharedPointer<const Data> data;
+    QCache<HeatmapTileKey, QImage> tiles;
+
+    QList<HeatmapTileKey> requestedKeys;
+    QList<HeatmapTileKey> batchKeys;
+    QSharedPointer<const Data> batchData;
+    QFutureWatcher<QImage> batchWatcher;
+};
+
+} // namespace ov
+
+#endif // HEATMAP_TILE_CACHE_H
@@ -0,0 +1,261 @@
+#include <cmath>
+
+#include <QActionGroup>
+#include <QApplication>
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+
+#include "HeatmapView.h"
+
+const qreal WHEEL_ZOOM_FACTOR = 1.25;
+const qreal MAX_PIXELS_PER_CELL = 24.0;
+
+namespace ov {
+
+HeatmapView::HeatmapView(QWidget *parent)
+    : QWidget(parent), pixelsPerRow(1.0), pixelsPerColumn(1.0), fitted(true), dragging(false)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(100, 100);
+    connect(&tileCache, &HeatmapTileCache::tileReady, this, static_cast<void (QWidget::*)()>(&QWidget::update));
+}
+
+void HeatmapView::setMatrix(const FeatureMatrix &matrix, const QVector<int> &rows)
+{
+    tileCache.setMatrix(matrix, rows);
+    fitToView();
+}
+
+void HeatmapView::setRows(const QVector<int> &rows)
+{
+    const bool rowCountChanged = rows.size() != tileCache.getRowCount();
+    tileCache.setRows(rows);
+    if (fitted || rowCountChanged) {
+        fitToView();
+    } else {
+        update();
+    }
+}
+
+void HeatmapView::fitToView()
+{
+    pixelsPerColumn = qreal(width()) / qMax(1, tileCache.getColumnCount());
+    pixelsPerRow = qreal(height()) / qMax(1, tileCache.getRowCount());
+    origin = QPointF();
+    fitted = true;
+    update();
+}
+
+int HeatmapView::getLevel(qreal pixelsPerCell, int maxLevel)
+{
+    // the coarsest level having at least one tile pixel per screen pixel
+    return pixelsPerCell >= 1.0 ? 0 : qBound(0, int(std::floor(std::log2(1.0 / pixelsPerCell))), maxLevel);
+}
+
+QRectF HeatmapView::getTileRect(const HeatmapTileKey &key) const
+{
+    const int tileRows = HeatmapTileCache::TILE_SIZE << key.rowLevel;
+    const int tileColumns = HeatmapTileCache::TILE_SIZE << key.columnLevel;
+    const int firstRow = key.tileRow * tileRows;
+    const int firstColumn = key.tileColumn * tileColumns;
+    const int endRow = qMin(tileCache.getRowCount(), firstRow + tileRows);
+    const int endColumn = qMin(tileCache.getColumnCount(), firstColumn + tileColumns);
+    return QRectF(origin.x() + firstColumn * pixelsPerColumn, origin.y() + firstRow * pixelsPerRow,
+        (endColumn - firstColumn) * pixelsPerColumn, (endRow - firstRow) * pixelsPerRow);
+}
+
+QPointF HeatmapView::cellAt(const QPointF &pos) const
+{
+    return QPointF((pos.x() - origin.x()) / pixelsPerColumn, (pos.y() - origin.y()) / pixelsPerRow);
+}
+
+bool HeatmapView::drawTile(QPainter &painter, const HeatmapTileKey &key)
+{
+    const QImage *tile = tileCache.getTile(key);
+    if (NULL == tile) {
+        return false;
+    }
+    if (!tile->isNull()) {
+        painter.drawImage(getTileRect(key), *tile);
+    }
+    return true;
+}
+
+void HeatmapView::drawCoarserTile(QPainter &painter, const HeatmapTileKey &key)
+{
+    // while the tile is being computed, a part of a coarser one already in the cache is shown instead
+    const int maxRowLevel = tileCache.getMaxRowLevel();
+    const int maxColumnLevel = tileCache.getMaxColumnLevel();
+    for (int step = 1; key.rowLevel + step <= maxRowLevel || key.columnLevel + step <= maxColumnLevel; ++step) {
+        const int rowLevel = qMin(key.rowLevel + step, maxRowLevel);
+        const int columnLevel = qMin(key.columnLevel + step, maxColumnLevel);
+        const HeatmapTileKey coarserKey(rowLevel, columnLevel, key.tileRow >> (rowLevel - key.rowLevel),
+            key.tileColumn >> (columnLevel - key.columnLevel));
+        const QImage *tile = tileCache.getTile(coarserKey);
+        if (NULL != tile) {
+            painter.save();
+            painter.setClipRect(getTileRect(key));
+            painter.drawImage(getTileRect(coarserKey), *tile);
+            painter.restore();
+            return;
+        }
+    }
+}
+
+void HeatmapView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Window));
+
+    const int rowCount = tileCache.getRowCount();
+    const int columnCount = tileCache.getColumnCount();
+    if (0 == rowCount || 0 == columnCount) {
+        return;
+    }
+    const QRectF matrixRect(origin, QSizeF(columnCount * pixelsPerColumn, rowCount * pixelsPerRow));
+    painter.fillRect(matrixRect, Qt::white);
+
+    const int rowLevel = getLevel(pixelsPerRow, tileCache.getMaxRowLevel());
+    const int columnLevel = getLevel(pixelsPerColumn, tileCache.getMaxColumnLevel());
+    const int tileRows = HeatmapTileCache::TILE_SIZE << rowLevel;
+    const int tileColumns = HeatmapTileCache::TILE_SIZE << columnLevel;
+    const QPointF topLeft = cellAt(QPointF(0, 0));
+    const QPointF bottomRight = cellAt(QPointF(width(), height()));
+    const int firstTileRow = qMax(0, int(topLeft.y())) / tileRows;
+    const int lastTileRow = qBound(0, int(bottomRight.y()), rowCount - 1) / tileRows;
+    const int firstTileColumn = qMax(0, int(topLeft.x())) / tileColumns;
+    const int lastTileColumn = qBound(0, int(bottomRight.x()), columnCount - 1) / tileColumns;
+
+    QList<HeatmapTileKey> missingTiles;
+    for (int tileRow = firstTileRow; tileRow <= lastTileRow; ++tileRow) {
+        for (int tileColumn = firstTileColumn; tileColumn <= lastTileColumn; ++tileColumn) {
+            const HeatmapTileKey key(rowLevel, columnLevel, tileRow, tileColumn);
+            if (!drawTile(painter, key)) {
+                drawCoarserTile(painter, key);
+                missingTiles.append(key);
+            }
+        }
+    }
+    tileCache.requestTiles(missingTiles); // tiles which went out of sight are no longer needed
+
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(matrixRect.adjusted(0, 0, -1, -1));
+}
+
+void HeatmapView::clampView()
+{
+    const qreal matrixWidth = tileCache.getColumnCount() * pixelsPerColumn;
+    const qreal matrixHeight = tileCache.getRowCount() * pixelsPerRow;
+    origin.setX(matrixWidth <= width() ? 0.0 : qBound(width() - matrixWidth, origin.x(), 0.0));
+    origin.setY(matrixHeight <= height() ? 0.0 : qBound(height() - matrixHeight, origin.y(), 0.0));
+}
+
+void HeatmapView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    if (fitted) {
+        fitToView();
+    } else {
+        clampView();
+    }
+}
+
+void HeatmapView::mousePressEvent(QMouseEvent *event)
+{
+    if (Qt::LeftButton != event->button()) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    pressPos = event->pos();
+    pressOrigin = origin;
+    dragging = false;
+}
+
+void HeatmapView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton)) {
+        return;
+    }
+    if (!dragging && (event->pos() - pressPos).manhattanLength() >= QApplication::startDragDistance()) {
+        dragging = true;
+        setCursor(Qt::ClosedHandCursor);
+    }
+    if (dragging) {
+        origin = pressOrigin + (event->pos() - pressPos);
+        clampView();
+        update();
+    }
+}
+
+void HeatmapView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (Qt::LeftButton != event->button()) {
+        return;
+    }
+    if (dragging) {
+        dragging = false;
+        unsetCursor();
+        return;
+    }
+    const QPointF cell = cellAt(event->pos());
+    if (cell.x() >= 0 && cell.y() >= 0 && cell.x() < tileCache.getColumnCount() && cell.y() < tileCache.getRowCount()) {
+        emit blockClicked(int(cell.y()), int(cell.x()));
+    }
+}
+
+void HeatmapView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event);
+    fitToView();
+}
+
+void HeatmapView::wheelEvent(QWheelEvent *event)
+{
+    if (0 == event->angleDelta().y() || 0 == tileCache.getRowCount()) {
+        event->ignore();
+        return;
+    }
+    const qreal factor = event->angleDelta().y() > 0 ? WHEEL_ZOOM_FACTOR : 1.0 / WHEEL_ZOOM_FACTOR;
+    const QPointF cell = cellAt(event->pos());
+
+    // zooming out stops when the matrix fits into the view
+    pixelsPerRow = qBound(qMin(MAX_PIXELS_PER_CELL, qreal(height()) / tileCache.getRowCount()), pixelsPerRow * factor, MAX_PIXELS_PER_CELL);
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        pixelsPerColumn = qBound(qMin(MAX_PIXELS_PER_CELL, qreal(width()) / tileCache.getColumnCount()), pixelsPerColumn * factor,
+            MAX_PIXELS_PER_CELL);
+    }
+    origin = QPointF(event->pos()) - QPointF(cell.x() * pixelsPerColumn, cell.y() * pixelsPerRow);
+    fitted = false;
+    clampView();
+    update();
+}
+
+void HeatmapView::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QActionGroup aggregationGroup(&menu);
+    QAction *maxAction = menu.addAction(tr("Maximum of a block"));
+    QAction *meanAction = menu.addAction(tr("Mean of a block"));
+    foreach (QAction *action, QList<QAction *>() << maxAction << meanAction) {
+        action->setCheckable(true);
+        aggregationGroup.addAction(action);
+    }
+    (HeatmapTileCache::MAX_AGGREGATION == tileCache.getAggregation() ? maxAction : meanAction)->setChecked(true);
+    menu.addSeparator();
+    menu.addAction(tr("Fit to view"), this, SLOT(fitToView()));
+
+    const QAction *chosenAction = menu.exec(event->globalPos());
+    if (maxAction == chosenAction) {
+        tileCache.setAggregation(HeatmapTileCache::MAX_AGGREGATION);
+        update();
+    } else if (meanAction == chosenAction) {
+        tileCache.setAggregation(HeatmapTileCache::MEAN_AGGREGATION);
+        update();
+    }
+}
+
+} // namespace ov
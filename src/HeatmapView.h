@@ -0,0 +1,64 @@
+#ifndef HEATMAP_VIEW_H
+#define HEATMAP_VIEW_H
+
+#include <QPointF>
+#include <QWidget>
+
+#include "HeatmapTileCache.h"
+
+namespace ov {
+
+// Overview of the whole feature table as a heatmap of log intensities: displayed rows go down, samples go right.
+// The wheel zooms (only rows with Ctrl), dragging pans, double click fits the matrix into the view
+// and a click on a block reports the table cell it starts with.
+class HeatmapView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HeatmapView(QWidget *parent = NULL);
+
+    // @rows: matrix rows in the order they're displayed
+    void setMatrix(const FeatureMatrix &matrix, const QVector<int> &rows);
+    void setRows(const QVector<int> &rows);
+
+signals:
+    void blockClicked(int displayedRow, int sampleNumber);
+
+public slots:
+    void fitToView();
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void mouseReleaseEvent(QMouseEvent *event);
+    void mouseDoubleClickEvent(QMouseEvent *event);
+    void wheelEvent(QWheelEvent *event);
+    void contextMenuEvent(QContextMenuEvent *event);
+
+private:
+    bool drawTile(QPainter &painter, const HeatmapTileKey &key);
+    void drawCoarserTile(QPainter &painter, const HeatmapTileKey &key);
+    QRectF getTileRect(const HeatmapTileKey &key) const;
+    QPointF cellAt(const QPointF &pos) const;
+    void clampView();
+    static int getLevel(qreal pixelsPerCell, int maxLevel);
+
+    HeatmapTileCache tileCache;
+
+    // view: cell (row, column) is drawn at origin + (column * pixelsPerColumn, row * pixelsPerRow)
+    qreal pixelsPerRow;
+    qreal pixelsPerColumn;
+    QPointF origin;
+    bool fitted; // the view follows the size of the widget until the user zooms
+
+    QPoint pressPos;
+    QPointF pressOrigin;
+    bool dragging;
+};
+
+} // namespace ov
+
+#endif // HEATMAP_VIEW_H
@@ -0,0 +1,474 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include <QPair>
+
+#include "FeatureMatrix.h"
+#include "FeatureMatrixUtils.h"
+#include "IntensityNormalization.h"
+
+#include "HierarchicalClustering.h"
+
+const int ITEMS_PER_TASK = 1024;
+const int LEAVES_PER_TASK = 16; // rows of the distance matrix get shorter, so tasks are small
+const int PROJECTION_DIMENSION = 16;
+const int KMEANS_ITERATIONS = 4;
+const unsigned RANDOM_SEED = 20161019; // the same data is always ordered in the same way
+
+namespace ov {
+
+namespace {
+
+// Sparse profiles in compressed rows: entries of item i are at [offsets[i], offsets[i + 1]).
+// Compared profiles are scales[i] * (x - means[i]) over all dimensions, x being 0 where there is no entry.
+struct Profiles
+{
+    int dimension;
+    QVector<int> offsets;
+    QVector<int> indices;
+    QVector<double> values;
+    QVector<double> means;
+    QVector<double> scales;
+};
+
+Profiles getFeatureProfiles(const FeatureMatrix &matrix, const IntensityNormalization &normalization)
+{
+    const int rowCount = matrix.getRowCount();
+    Profiles profiles;
+    profiles.dimension = matrix.getSampleCount();
+    profiles.offsets.resize(rowCount + 1);
+    for (int row = 0; row < rowCount; ++row) {
+        profiles.offsets[row] = matrix.getRowOffset(row);
+    }
+    profiles.offsets[rowCount] = matrix.getIntensityCount();
+    profiles.indices.resize(matrix.getIntensityCount());
+    profiles.values.resize(matrix.getIntensityCount());
+    FeatureMatrixUtils::runInBlocks(rowCount, ITEMS_PER_TASK, [&matrix, &normalization, &profiles] (int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            const int offset = profiles.offsets[row];
+            for (int i = 0; i < count; ++i) {
+                profiles.indices[offset + i] = sampleNumbers[i];
+                profiles.values[offset + i] = FeatureMatrixUtils::getLogIntensity(normalization, sampleNumbers[i],
+                    intensities[i]);
+            }
+        }
+    });
+    return profiles;
+}
+
+// samples over the features whose log intensities vary the most, features with a few large values don't dominate
+Profiles getSampleProfiles(const FeatureMatrix &matrix, const IntensityNormalization &normalization)
+{
+    const int rowCount = matrix.getRowCount();
+    const int sampleCount = matrix.getSampleCount();
+    QVector<double> variances(rowCount);
+    FeatureMatrixUtils::runInBlocks(rowCount, ITEMS_PER_TASK, [&matrix, &normalization, &variances, sampleCount]
+        (int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            double sum = 0.0;
+            double sumOfSquares = 0.0;
+            for (int i = 0; i < count; ++i) {
+                const double value = FeatureMatrixUtils::getLogIntensity(normalization, sampleNumbers[i], intensities[i]);
+                sum += value;
+                sumOfSquares += value * value;
+            }
+            const double mean = sum / sampleCount;
+            variances[row] = sumOfSquares / sampleCount - mean * mean;
+        }
+    });
+    QVector<int> rows(rowCount);
+    std::iota(rows.begin(), rows.end(), 0);
+    const int keptCount = qMin(int(HierarchicalClustering::MAX_SAMPLE_FEATURE_COUNT), rowCount);
+    std::nth_element(rows.begin(), rows.begin() + keptCount, rows.end(),
+        [&variances] (int i, int j) { return variances[i] > variances[j]; });
+    rows.resize(keptCount);
+    std::sort(rows.begin(), rows.end());
+
+    // the kept part of the matrix is transposed by counting entries of every sample first
+    Profiles profiles;
+    profiles.dimension = keptCount;
+    profiles.offsets.fill(0, sampleCount + 1);
+    for (int i = 0; i < keptCount; ++i) {
+        const int *sampleNumbers = NULL;
+        const double *intensities = NULL;
+        const int count = matrix.getRowIntensities(rows[i], sampleNumbers, intensities);
+        for (int j = 0; j < count; ++j) {
+            ++profiles.offsets[sampleNumbers[j] + 1];
+        }
+    }
+    std::partial_sum(profiles.offsets.begin(), profiles.offsets.end(), profiles.offsets.begin());
+    profiles.indices.resize(profiles.offsets[sampleCount]);
+    profiles.values.resize(profiles.offsets[sampleCount]);
+    QVector<int> positions = profiles.offsets;
+    for (int i = 0; i < keptCount; ++i) {
+        const int *sampleNumbers = NULL;
+        const double *intensities = NULL;
+        const int count = matrix.getRowIntensities(rows[i], sampleNumbers, intensities);
+        for (int j = 0; j < count; ++j) {
+            const int position = positions[sampleNumbers[j]]++;
+            profiles.indices[position] = i;
+            profiles.values[position] = FeatureMatrixUtils::getLogIntensity(normalization, sampleNumbers[j], intensities[j]);
+        }
+    }
+    return profiles;
+}
+
+// the correlation distance is half the squared Euclidean distance of centered profiles of unit length
+void initStandardization(Profiles &profiles, HierarchicalClustering::Distance distance)
+{
+    const int itemCount = profiles.offsets.size() - 1;
+    profiles.means.fill(0.0, itemCount);
+    profiles.scales.fill(1.0, itemCount);
+    if (HierarchicalClustering::EUCLIDEAN_DISTANCE == distance) {
+        return;
+    }
+    FeatureMatrixUtils::runInBlocks(itemCount, ITEMS_PER_TASK, [&profiles] (int begin, int end) {
+        for (int item = begin; item < end; ++item) {
+            double sum = 0.0;
+            double sumOfSquares = 0.0;
+            for (int i = profiles.offsets[item]; i < profiles.offsets[item + 1]; ++i) {
+                sum += profiles.values[i];
+                sumOfSquares += profiles.values[i] * profiles.values[i];
+            }
+            const double mean = sum / profiles.dimension;
+            const double centeredSumOfSquares = sumOfSquares - sum * mean;
+            profiles.means[item] = mean;
+            profiles.scales[item] = centeredSumOfSquares > 1e-12 * qMax(1.0, sumOfSquares)
+                ? 1.0 / std::sqrt(centeredSumOfSquares) : 0.0;
+        }
+    });
+}
+
+// PROJECTION_DIMENSION coordinates per item, random projections roughly keep distances between profiles
+QVector<double> projectProfiles(const Profiles &profiles)
+{
+    std::mt19937 generator(RANDOM_SEED);
+    std::normal_distribution<double> distribution;
+    QVector<double> directions(profiles.dimension * PROJECTION_DIMENSION);
+    QVector<double> directionSums(PROJECTION_DIMENSION, 0.0);
+    for (int i = 0; i < directions.size(); ++i) {
+        directions[i] = distribution(generator);
+        directionSums[i % PROJECTION_DIMENSION] += directions[i];
+    }
+
+    const int itemCount = profiles.offsets.size() - 1;
+    QVector<double> projections(itemCount * PROJECTION_DIMENSION, 0.0);
+    FeatureMatrixUtils::runInBlocks(itemCount, ITEMS_PER_TASK, [&profiles, &directions, &directionSums, &projections]
+        (int begin, int end) {
+        for (int item = begin; item < end; ++item) {
+            double *projection = projections.data() + item * PROJECTION_DIMENSION;
+            for (int i = profiles.offsets[item]; i < profiles.offsets[item + 1]; ++i) {
+                const double *direction = directions.constData() + profiles.indices[i] * PROJECTION_DIMENSION;
+                for (int j = 0; j < PROJECTION_DIMENSION; ++j) {
+                    projection[j] += profiles.values[i] * direction[j];
+                }
+            }
+            for (int j = 0; j < PROJECTION_DIMENSION; ++j) {
+                projection[j] = profiles.scales[item] * (projection[j] - profiles.means[item] * directionSums[j]);
+            }
+        }
+    });
+    return projections;
+}
+
+// k-means of projected items starting from random items; returns the count of non-empty bins, which are
+// numbered without gaps, or 0 if canceled
+int assignBins(const QVector<double> &projections, int maxBinCount, QVector<int> &bins,
+    const HierarchicalClustering::ProgressCallback &progress, int firstPercent, int lastPercent)
+{
+    const int itemCount = projections.size() / PROJECTION_DIMENSION;
+    QVector<int> seeds(itemCount);
+    std::iota(seeds.begin(), seeds.end(), 0);
+    std::shuffle(seeds.begin(), seeds.end(), std::mt19937(RANDOM_SEED));
+    QVector<double> centroids(maxBinCount * PROJECTION_DIMENSION);
+    for (int bin = 0; bin < maxBinCount; ++bin) {
+        std::copy(projections.constBegin() + seeds[bin] * PROJECTION_DIMENSION,
+            projections.constBegin() + (seeds[bin] + 1) * PROJECTION_DIMENSION, centroids.begin() + bin * PROJECTION_DIMENSION);
+    }
+
+    bins.resize(itemCount);
+    for (int iteration = 0; iteration < KMEANS_ITERATIONS; ++iteration) {
+        FeatureMatrixUtils::runInBlocks(itemCount, ITEMS_PER_TASK, [&projections, &centroids, &bins, maxBinCount]
+            (int begin, int end) {
+            for (int item = begin; item < end; ++item) {
+                const double *projection = projections.constData() + item * PROJECTION_DIMENSION;
+                double nearestDistance = std::numeric_limits<double>::max();
+                for (int bin = 0; bin < maxBinCount; ++bin) {
+                    const double *centroid = centroids.constData() + bin * PROJECTION_DIMENSION;
+                    double distance = 0.0;
+                    for (int j = 0; j < PROJECTION_DIMENSION; ++j) {
+                        distance += (projection[j] - centroid[j]) * (projection[j] - centroid[j]);
+                    }
+                    if (distance < nearestDistance) {
+                        nearestDistance = distance;
+                        bins[item] = bin;
+                    }
+                }
+            }
+        });
+
+        // empty bins keep their centroids
+        QVector<double> sums(maxBinCount * PROJECTION_DIMENSION, 0.0);
+        QVector<int> sizes(maxBinCount, 0);
+        for (int item = 0; item < itemCount; ++item) {
+            ++sizes[bins[item]];
+            for (int j = 0; j < PROJECTION_DIMENSION; ++j) {
+                sums[bins[item] * PROJECTION_DIMENSION + j] += projections[item * PROJECTION_DIMENSION + j];
+            }
+        }
+        for (int bin = 0; bin < maxBinCount; ++bin) {
+            for (int j = 0; sizes[bin] > 0 && j < PROJECTION_DIMENSION; ++j) {
+                centroids[bin * PROJECTION_DIMENSION + j] = sums[bin * PROJECTION_DIMENSION + j] / sizes[bin];
+            }
+        }
+        if (!progress(firstPercent + (lastPercent - firstPercent) * (iteration + 1) / KMEANS_ITERATIONS)) {
+            return 0;
+        }
+    }
+
+    QVector<int> binNumbers(maxBinCount, -1);
+    int binCount = 0;
+    for (int item = 0; item < itemCount; ++item) {
+        if (-1 == binNumbers[bins[item]]) {
+            binNumbers[bins[item]] = binCount++;
+        }
+        bins[item] = binNumbers[bins[item]];
+    }
+    return binCount;
+}
+
+// dense mean profiles of bins, binCount x dimension
+QVector<double> getBinProfiles(const Profiles &profiles, const QVector<int> &bins, int binCount, QVector<double> &binSizes)
+{
+    const int dimension = profiles.dimension;
+    QVector<double> binProfiles(binCount * dimension, 0.0);
+    QVector<double> baseValues(binCount, 0.0); // added to every dimension
+    binSizes.fill(0.0, binCount);
+    for (int item = 0; item < bins.size(); ++item) {
+        const int bin = bins[item];
+        binSizes[bin] += 1.0;
+        baseValues[bin] -= profiles.scales[item] * profiles.means[item];
+        double *binProfile = binProfiles.data() + bin * dimension;
+        for (int i = profiles.offsets[item]; i < profiles.offsets[item + 1]; ++i) {
+            binProfile[profiles.indices[i]] += profiles.scales[item] * profiles.values[i];
+        }
+    }
+    for (int bin = 0; bin < binCount; ++bin) {
+        for (int i = 0; i < dimension; ++i) {
+            binProfiles[bin * dimension + i] = (binProfiles[bin * dimension + i] + baseValues[bin]) / binSizes[bin];
+        }
+    }
+    return binProfiles;
+}
+
+// position of the pair (i, j) in the upper triangle of a symmetric matrix stored row by row
+int getPairIndex(int i, int j, int count)
+{
+    if (i > j) {
+        std::swap(i, j);
+    }
+    return i * count - i * (i + 1) / 2 + j - i - 1;
+}
+
+QVector<double> getLeafDistances(const QVector<double> &leafProfiles, const QVector<double> &leafSizes, int dimension,
+    HierarchicalClustering::Distance distance, HierarchicalClustering::Linkage linkage)
+{
+    const int leafCount = leafSizes.size();
+    QVector<double> distances(leafCount * (leafCount - 1) / 2);
+    FeatureMatrixUtils::runInBlocks(leafCount, LEAVES_PER_TASK, [&] (int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const double *first = leafProfiles.constData() + i * dimension;
+            for (int j = i + 1; j < leafCount; ++j) {
+                const double *second = leafProfiles.constData() + j * dimension;
+                double sumOfSquares = 0.0;
+                for (int k = 0; k < dimension; ++k) {
+                    sumOfSquares += (first[k] - second[k]) * (first[k] - second[k]);
+                }
+                double &pairDistance = distances[getPairIndex(i, j, leafCount)];
+                if (HierarchicalClustering::WARD_LINKAGE == linkage) {
+                    pairDistance = leafSizes[i] * leafSizes[j] / (leafSizes[i] + leafSizes[j]) * sumOfSquares;
+                } else if (HierarchicalClustering::CORRELATION_DISTANCE == distance) {
+                    pairDistance = sumOfSquares / 2.0;
+                } else {
+                    pairDistance = std::sqrt(sumOfSquares);
+                }
+            }
+        }
+    });
+    return distances;
+}
+
+// Lance-Williams update of the distance from cluster C to the union of A and B
+double getMergedDistance(HierarchicalClustering::Linkage linkage, double distanceAC, double distanceBC, double distanceAB,
+    double sizeA, double sizeB, double sizeC)
+{
+    switch (linkage) {
+        case HierarchicalClustering::COMPLETE_LINKAGE:
+            return qMax(distanceAC, distanceBC);
+        case HierarchicalClustering::SINGLE_LINKAGE:
+            return qMin(distanceAC, distanceBC);
+        case HierarchicalClustering::WARD_LINKAGE:
+            return ((sizeA + sizeC) * distanceAC + (sizeB + sizeC) * distanceBC - sizeC * distanceAB) / (sizeA + sizeB + sizeC);
+        default:
+            return (sizeA * distanceAC + sizeB * distanceBC) / (sizeA + sizeB);
+    }
+}
+
+// Nearest-neighbour chain: follows nearest neighbours until two clusters are nearest to each other and merges them.
+// Valid for linkages whose merged clusters are never closer to others than their parts, all supported ones are such.
+// Returns leaves in the order of the dendrogram.
+QVector<int> linkLeaves(QVector<double> &distances, QVector<double> sizes, HierarchicalClustering::Linkage linkage)
+{
+    const int leafCount = sizes.size();
+    QVector<int> nodes(leafCount); // node i < leafCount is a leaf, node leafCount + m is created by merge m
+    std::iota(nodes.begin(), nodes.end(), 0);
+    QVector<bool> active(leafCount, true);
+    QVector<QPair<int, int> > merges;
+    QVector<int> chain;
+    for (int merge = 0; merge < leafCount - 1; ++merge) {
+        if (chain.isEmpty()) {
+            chain.append(int(std::find(active.constBegin(), active.constEnd(), true) - active.constBegin()));
+        }
+        int first = -1;
+        int second = -1;
+        while (true) {
+            first = chain.last();
+            const int previous = chain.size() >= 2 ? chain[chain.size() - 2] : -1;
+            // the previous cluster wins ties, otherwise the chain could cycle
+            second = previous;
+            double nearestDistance = -1 != previous ? distances[getPairIndex(first, previous, leafCount)]
+                : std::numeric_limits<double>::max();
+            for (int cluster = 0; cluster < leafCount; ++cluster) {
+                if (active[cluster] && cluster != first && distances[getPairIndex(first, cluster, leafCount)] < nearestDistance) {
+                    nearestDistance = distances[getPairIndex(first, cluster, leafCount)];
+                    second = cluster;
+                }
+            }
+            if (second == previous) {
+                break;
+            }
+            chain.append(second);
+        }
+        chain.resize(chain.size() - 2);
+
+        // the union takes the place of the first cluster
+        const double firstSecondDistance = distances[getPairIndex(first, second, leafCount)];
+        for (int cluster = 0; cluster < leafCount; ++cluster) {
+            if (active[cluster] && cluster != first && cluster != second) {
+                double &distance = distances[getPairIndex(first, cluster, leafCount)];
+                distance = getMergedDistance(linkage, distance, distances[getPairIndex(second, cluster, leafCount)],
+                    firstSecondDistance, sizes[first], sizes[second], sizes[cluster]);
+            }
+        }
+        merges.append(qMakePair(nodes[first], nodes[second]));
+        nodes[first] = leafCount + merge;
+        sizes[first] += sizes[second];
+        active[second] = false;
+    }
+
+    QVector<int> leaves;
+    QVector<int> stack;
+    stack.append(2 * leafCount - 2);
+    while (!stack.isEmpty()) {
+        const int node = stack.last();
+        stack.removeLast();
+        if (node < leafCount) {
+            leaves.append(node);
+        } else {
+            stack.append(merges[node - leafCount].second);
+            stack.append(merges[node - leafCount].first);
+        }
+    }
+    return leaves;
+}
+
+// items of bins in the order of bins, every bin is sorted along the direction from the preceding bin to the next one
+QVector<int> orderBinnedItems(const QVector<double> &projections, const QVector<int> &bins, const QVector<int> &binOrder)
+{
+    const int binCount = binOrder.size();
+    QVector<QVector<int> > binItems(binCount);
+    QVector<double> centroids(binCount * PROJECTION_DIMENSION, 0.0);
+    for (int item = 0; item < bins.size(); ++item) {
+        binItems[bins[item]].append(item);
+        for (int j = 0; j < PROJECTION_DIMENSION; ++j) {
+            centroids[bins[item] * PROJECTION_DIMENSION + j] += projections[item * PROJECTION_DIMENSION + j];
+        }
+    }
+
+    QVector<int> items;
+    items.reserve(bins.size());
+    for (int i = 0; i < binCount; ++i) {
+        const int previousBin = binOrder[qMax(i - 1, 0)];
+        const int nextBin = binOrder[qMin(i + 1, binCount - 1)];
+        QVector<double> direction(PROJECTION_DIMENSION);
+        for (int j = 0; j < PROJECTION_DIMENSION; ++j) {
+            direction[j] = centroids[nextBin * PROJECTION_DIMENSION + j] / binItems[nextBin].size()
+                - centroids[previousBin * PROJECTION_DIMENSION + j] / binItems[previousBin].size();
+        }
+        QVector<int> &bin = binItems[binOrder[i]];
+        QVector<double> positions(bin.size());
+        for (int k = 0; k < bin.size(); ++k) {
+            positions[k] = std::inner_product(direction.constBegin(), direction.constEnd(),
+                projections.constBegin() + bin[k] * PROJECTION_DIMENSION, 0.0);
+        }
+        QVector<int> order(bin.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&positions] (int k, int l) { return positions[k] < positions[l]; });
+        foreach (int k, order) {
+            items.append(bin[k]);
+        }
+    }
+    return items;
+}
+
+}
+
+QVector<int> HierarchicalClustering::computeOrder(const FeatureMatrix &matrix, const IntensityNormalization &normalization,
+    Target target, Distance distance, Linkage linkage, const ProgressCallback &progress)
+{
+    Profiles profiles = FEATURE_CLUSTERING == target ? getFeatureProfiles(matrix, normalization)
+        : getSampleProfiles(matrix, normalization);
+    const int itemCount = profiles.offsets.size() - 1;
+    initStandardization(profiles, distance);
+    if (!progress(10)) {
+        return QVector<int>();
+    } else if (itemCount < 2 || 0 == profiles.dimension) {
+        QVector<int> items(itemCount);
+        std::iota(items.begin(), items.end(), 0);
+        return items;
+    }
+
+    QVector<int> bins(itemCount);
+    std::iota(bins.begin(), bins.end(), 0);
+    int binCount = itemCount;
+    QVector<double> projections;
+    if (itemCount > MAX_LEAF_COUNT) {
+        projections = projectProfiles(profiles);
+        binCount = assignBins(projections, MAX_LEAF_COUNT, bins, progress, 10, 70);
+        if (0 == binCount) {
+            return QVector<int>();
+        }
+    }
+
+    QVector<double> binSizes;
+    const QVector<double> binProfiles = getBinProfiles(profiles, bins, binCount, binSizes);
+    QVector<double> distances = getLeafDistances(binProfiles, binSizes, profiles.dimension, distance, linkage);
+    if (!progress(85)) {
+        return QVector<int>();
+    }
+    const QVector<int> binOrder = 1 == binCount ? QVector<int>(1, 0) : linkLeaves(distances, binSizes, linkage);
+    const QVector<int> items = projections.isEmpty() ? binOrder : orderBinnedItems(projections, bins, binOrder);
+    progress(100);
+    return items;
+}
+
+} // namespace ov
@@ -0,0 +1,54 @@
+#ifndef HIERARCHICAL_CLUSTERING_H
+#define HIERARCHICAL_CLUSTERING_H
+
+#include <functional>
+
+#include <QVector>
+
+namespace ov {
+
+class FeatureMatrix;
+class IntensityNormalization;
+
+// Orders features or samples by agglomerative clustering of their log2(1 + intensity) profiles,
+// undetected features being 0. Samples are compared by the most variable features only.
+// Clusters are merged by the nearest-neighbour chain algorithm, which needs no sorted list of pairs.
+// Up to MAX_LEAF_COUNT items are clustered exactly; more items are first gathered into as many bins
+// by k-means in a random projection, bins are clustered and items are ordered inside their bins.
+class HierarchicalClustering
+{
+public:
+    enum Target {
+        FEATURE_CLUSTERING, // matrix rows
+        SAMPLE_CLUSTERING
+    };
+
+    enum Distance {
+        EUCLIDEAN_DISTANCE,
+        CORRELATION_DISTANCE // 1 - Pearson correlation
+    };
+
+    enum Linkage {
+        AVERAGE_LINKAGE,
+        COMPLETE_LINKAGE,
+        SINGLE_LINKAGE,
+        WARD_LINKAGE // minimal increase of the sum of squares, of standardized profiles for the correlation distance
+    };
+
+    enum {
+        MAX_LEAF_COUNT = 1000,
+        MAX_SAMPLE_FEATURE_COUNT = 2000
+    };
+
+    // receives the share of done work in percents, returns false to cancel
+    typedef std::function<bool (int)> ProgressCallback;
+
+    // matrix rows or sample numbers in the order of leaves of the dendrogram, empty if canceled.
+    // Slow for large matrices, meant to be run on a worker thread; items are processed in parallel.
+    static QVector<int> computeOrder(const FeatureMatrix &matrix, const IntensityNormalization &normalization,
+        Target target, Distance distance, Linkage linkage, const ProgressCallback &progress);
+};
+
+} // namespace ov
+
+#endif // HIERARCHICAL_CLUSTERING_H
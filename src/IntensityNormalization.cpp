@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <numeric>
+
+#include <QtConcurrent>
+
+#include "FeatureMatrix.h"
+
+#include "IntensityNormalization.h"
+
+const int REFERENCE_QUANTILE_COUNT = 1001;
+
+namespace ov {
+
+namespace {
+
+// linear interpolation of the quantile function of ascending values, @q is in [0, 1]
+qreal interpolateQuantile(const double *values, int count, qreal q)
+{
+    Q_ASSERT(count > 0);
+    const qreal position = q * (count - 1);
+    const int lower = qMin(int(position), count - 1);
+    const int upper = qMin(lower + 1, count - 1);
+    return values[lower] + (position - lower) * (values[upper] - values[lower]);
+}
+
+// inverse of the above, tied values get the quantile of the middle of their ranks
+qreal findQuantile(const double *values, int count, qreal value)
+{
+    Q_ASSERT(count > 1);
+    const int firstRank = std::lower_bound(values, values + count, value) - values;
+    const int lastRank = std::upper_bound(values, values + count, value) - values - 1;
+    return qBound(0.0, (firstRank + lastRank) / 2.0 / (count - 1), 1.0);
+}
+
+class ColumnSorter
+{
+public:
+    ColumnSorter(const int *columnOffsets, double *intensities)
+        : columnOffsets(columnOffsets), intensities(intensities)
+    {
+
+    }
+
+    void operator ()(int sampleNumber) const
+    {
+        std::sort(intensities + columnOffsets[sampleNumber], intensities + columnOffsets[sampleNumber + 1]);
+    }
+
+private:
+    const int *columnOffsets;
+    double *intensities;
+};
+
+}
+
+IntensityNormalization::IntensityNormalization()
+    : mode(NO_NORMALIZATION), standardRow(-1)
+{
+
+}
+
+IntensityNormalization IntensityNormalization::create(const FeatureMatrix &matrix, Mode mode, int standardRow)
+{
+    IntensityNormalization normalization;
+    normalization.mode = mode;
+
+    const int sampleCount = matrix.getSampleCount();
+    QVector<double> sampleValues(sampleCount, 0.0);
+    switch (mode) {
+        case NO_NORMALIZATION:
+            break;
+        case TIC_NORMALIZATION:
+            for (int i = 0; i < sampleCount; ++i) {
+                sampleValues[i] = matrix.getSampleStatistics(i).totalIntensity;
+            }
+            normalization.initScaleFactors(sampleValues);
+            break;
+        case MEDIAN_NORMALIZATION:
+            for (int i = 0; i < sampleCount; ++i) {
+                sampleValues[i] = matrix.getSampleStatistics(i).medianIntensity;
+            }
+            normalization.initScaleFactors(sampleValues);
+            break;
+        case QUANTILE_NORMALIZATION:
+            normalization.initQuantiles(matrix);
+            break;
+        case INTERNAL_STANDARD_NORMALIZATION: {
+            Q_ASSERT(0 <= standardRow && standardRow < matrix.getRowCount());
+            normalization.standardRow = standardRow;
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(standardRow, sampleNumbers, intensities);
+            for (int i = 0; i < count; ++i) {
+                sampleValues[sampleNumbers[i]] = intensities[i];
+            }
+            normalization.initScaleFactors(sampleValues);
+            break;
+        }
+    }
+    return normalization;
+}
+
+void IntensityNormalization::initScaleFactors(const QVector<double> &sampleValues)
+{
+    double sum = 0.0;
+    int count = 0;
+    foreach (double value, sampleValues) {
+        if (value > 0.0) {
+            sum += value;
+            ++count;
+        }
+    }
+    // samples without a reference value (e.g. the internal standard isn't detected) are left as they are
+    const double target = count > 0 ? sum / count : 0.0;
+    scaleFactors.resize(sampleValues.size());
+    for (int i = 0; i < sampleValues.size(); ++i) {
+        scaleFactors[i] = sampleValues[i] > 0.0 ? target / sampleValues[i] : 1.0;
+    }
+}
+
+void IntensityNormalization::initQuantiles(const FeatureMatrix &matrix)
+{
+    const int sampleCount = matrix.getSampleCount();
+    matrix.getColumns(columnOffsets, sortedIntensities);
+    QVector<int> sampleNumberRange(sampleCount);
+    std::iota(sampleNumberRange.begin(), sampleNumberRange.end(), 0);
+    QtConcurrent::blockingMap(sampleNumberRange, ColumnSorter(columnOffsets.constData(), sortedIntensities.data()));
+
+    // samples have different numbers of detected features, so their quantile functions are averaged on a common grid
+    referenceQuantiles.fill(0.0, REFERENCE_QUANTILE_COUNT);
+    int nonEmptySampleCount = 0;
+    for (int s = 0; s < sampleCount; ++s) {
+        const int count = columnOffsets[s + 1] - columnOffsets[s];
+        if (0 == count) {
+            continue;
+        }
+        const double *values = sortedIntensities.constData() + columnOffsets[s];
+        for (int k = 0; k < REFERENCE_QUANTILE_COUNT; ++k) {
+            referenceQuantiles[k] += interpolateQuantile(values, count, qreal(k) / (REFERENCE_QUANTILE_COUNT - 1));
+        }
+        ++nonEmptySampleCount;
+    }
+    for (int k = 0; k < REFERENCE_QUANTILE_COUNT && nonEmptySampleCount > 0; ++k) {
+        referenceQuantiles[k] /= nonEmptySampleCount;
+    }
+}
+
+IntensityNormalization::Mode IntensityNormalization::getMode() const
+{
+    return mode;
+}
+
+int IntensityNormalization::getStandardRow() const
+{
+    return standardRow;
+}
+
+qreal IntensityNormalization::getQuantileValue(int sampleNumber, qreal intensity) const
+{
+    if (intensity <= 0.0) {
+        return 0.0; // undetected features stay undetected
+    }
+    const double *values = sortedIntensities.constData() + columnOffsets[sampleNumber];
+    const int count = columnOffsets[sampleNumber + 1] - columnOffsets[sampleNumber];
+    if (0 == count) {
+        return intensity;
+    }
+    // a single detection has no ranks within its sample, so it takes the rank its intensity has in the reference
+    const qreal q = count > 1 ? findQuantile(values, count, intensity)
+        : findQuantile(referenceQuantiles.constData(), REFERENCE_QUANTILE_COUNT, intensity);
+    return interpolateQuantile(referenceQuantiles.constData(), REFERENCE_QUANTILE_COUNT, q);
+}
+
+qreal IntensityNormalization::normalize(int sampleNumber, qreal intensity) const
+{
+    switch (mode) {
+        case NO_NORMALIZATION:
+            return intensity;
+        case QUANTILE_NORMALIZATION:
+            return getQuantileValue(sampleNumber, intensity);
+        default:
+            return intensity * scaleFactors[sampleNumber];
+    }
+}
+
+} // namespace ov
@@ -0,0 +1,50 @@
+#ifndef INTENSITY_NORMALIZATION_H
+#define INTENSITY_NORMALIZATION_H
+
+#include <QVector>
+
+namespace ov {
+
+class FeatureMatrix;
+
+// Makes intensities of different samples comparable. Normalized values aren't stored, they're derived from
+// the raw ones on request, so switching modes costs only the per-sample factors (or sorted samples
+// for quantile normalization). Copies are cheap and may be used from other threads.
+class IntensityNormalization
+{
+public:
+    enum Mode {
+        NO_NORMALIZATION,
+        TIC_NORMALIZATION, // total intensities of all samples are scaled to their mean
+        MEDIAN_NORMALIZATION, // same for median intensities
+        QUANTILE_NORMALIZATION, // every sample gets the mean distribution of detected intensities
+        INTERNAL_STANDARD_NORMALIZATION // intensities of a chosen feature are scaled to their mean
+    };
+
+    IntensityNormalization(); // leaves intensities as they are
+
+    // @standardRow: matrix row of the internal standard, used only by INTERNAL_STANDARD_NORMALIZATION
+    static IntensityNormalization create(const FeatureMatrix &matrix, Mode mode, int standardRow = -1);
+
+    Mode getMode() const;
+    int getStandardRow() const; // -1 unless the mode is INTERNAL_STANDARD_NORMALIZATION
+    qreal normalize(int sampleNumber, qreal intensity) const;
+
+private:
+    void initScaleFactors(const QVector<double> &sampleValues);
+    void initQuantiles(const FeatureMatrix &matrix);
+    qreal getQuantileValue(int sampleNumber, qreal intensity) const;
+
+    Mode mode;
+    int standardRow;
+    QVector<double> scaleFactors; // by sample number
+
+    // detected intensities of sample s sorted ascending are at [columnOffsets[s], columnOffsets[s + 1])
+    QVector<int> columnOffsets;
+    QVector<double> sortedIntensities;
+    QVector<double> referenceQuantiles; // evenly spaced quantiles of the mean distribution
+};
+
+} // namespace ov
+
+#endif // INTENSITY_NORMALIZATION_H
@@ -0,0 +1,297 @@
+#include <algorithm>
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QThread>
+#include <QVariant>
+
+#include "MassTraceIndex.h"
+
+const quint32 HILBERT_GRID_SIZE = 1 << 16;
+const char * const TRACE_COLUMNS[] = { "sample_id", "feature_id", "mz_min", "mz_max", "rt_start", "rt_end" };
+
+namespace ov {
+
+const int MassTraceIndex::NODE_SIZE = 16;
+
+TraceBounds::TraceBounds()
+    : mzMin(0.0), mzMax(0.0), rtStart(0.0), rtEnd(0.0)
+{
+
+}
+
+TraceBounds::TraceBounds(qreal mzMin, qreal mzMax, qreal rtStart, qreal rtEnd)
+    : mzMin(mzMin), mzMax(mzMax), rtStart(rtStart), rtEnd(rtEnd)
+{
+
+}
+
+bool TraceBounds::intersects(const TraceBounds &other) const
+{
+    return mzMin <= other.mzMax && other.mzMin <= mzMax && rtStart <= other.rtEnd && other.rtStart <= rtEnd;
+}
+
+void TraceBounds::unite(const TraceBounds &other)
+{
+    mzMin = qMin(mzMin, other.mzMin);
+    mzMax = qMax(mzMax, other.mzMax);
+    rtStart = qMin(rtStart, other.rtStart);
+    rtEnd = qMax(rtEnd, other.rtEnd);
+}
+
+namespace {
+
+// distance of the cell (x, y) from the start of the Hilbert curve filling the grid
+quint32 getHilbertIndex(quint32 x, quint32 y)
+{
+    quint32 index = 0;
+    for (quint32 s = HILBERT_GRID_SIZE / 2; s > 0; s /= 2) {
+        const quint32 rx = (x & s) > 0 ? 1 : 0;
+        const quint32 ry = (y & s) > 0 ? 1 : 0;
+        index += s * s * ((3 * rx) ^ ry);
+        if (0 == ry) {
+            if (1 == rx) {
+                x = HILBERT_GRID_SIZE - 1 - x;
+                y = HILBERT_GRID_SIZE - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+quint32 toGridCoordinate(qreal value, qreal min, qreal scale)
+{
+    return quint32(qBound(0.0, (value - min) * scale, qreal(HILBERT_GRID_SIZE - 1)));
+}
+
+}
+
+MassTraceIndex::MassTraceIndex()
+{
+
+}
+
+void MassTraceIndex::clear()
+{
+    matrix = FeatureMatrix();
+    trees.clear();
+    intensityBounds.clear();
+    intensityHasBounds.clear();
+}
+
+bool MassTraceIndex::isEmpty() const
+{
+    return trees.isEmpty();
+}
+
+bool MassTraceIndex::isStoredInDatabase()
+{
+    // bounds were added to the table later, older databases have traces that can't be indexed
+    const QSqlRecord record = QSqlDatabase::database().record("FeatureMassTrace");
+    for (int i = 0; i < int(sizeof(TRACE_COLUMNS) / sizeof(TRACE_COLUMNS[0])); ++i) {
+        if (!record.contains(TRACE_COLUMNS[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MassTraceIndex MassTraceIndex::build(const DataSourceId &dataSourceId, const FeatureMatrix &matrix,
+    const QVector<SampleId> &sampleIds, const FeatureMatrixUtils::ProgressCallback &progress)
+{
+    // a connection may be used only by the thread that has created it
+    const QString connectionName = QString("ov_trace_index_%1").arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    MassTraceIndex index;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(dataSourceId);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        index.matrix = matrix;
+        if (!db.open() || !index.readTraces(db, sampleIds, progress)) {
+            index.clear();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return index;
+}
+
+bool MassTraceIndex::readTraces(QSqlDatabase &db, const QVector<SampleId> &sampleIds,
+    const FeatureMatrixUtils::ProgressCallback &progress)
+{
+    // bounds are queried separately from traces, so that databases without them can still be opened
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT sample_id, feature_id, mz_min, mz_max, rt_start, rt_end FROM FeatureMassTrace ORDER BY sample_id")) {
+        return false;
+    }
+
+    QHash<SampleId, int> sampleNumberById;
+    for (int i = 0; i < sampleIds.size(); ++i) {
+        sampleNumberById[sampleIds[i]] = i;
+    }
+    trees.resize(sampleIds.size());
+    intensityBounds.resize(matrix.getIntensityCount());
+    intensityHasBounds.resize(matrix.getIntensityCount());
+
+    QVector<QPair<TraceBounds, int> > sampleTraces;
+    int lastSampleNumber = -1;
+    int readSampleCount = 0;
+    bool hasTraces = false;
+    while (query.next()) {
+        const int sampleNumber = sampleNumberById.value(query.value(0).value<SampleId>(), -1);
+        if (sampleNumber != lastSampleNumber) {
+            if (!sampleTraces.isEmpty()) {
+                buildTree(sampleTraces, trees[lastSampleNumber]);
+                sampleTraces.clear();
+            }
+            // traces come sorted by samples, so the progress is counted by them
+            if (!progress(qMin(100, 100 * readSampleCount++ / sampleIds.size()))) {
+                return false;
+            }
+        }
+        lastSampleNumber = sampleNumber;
+        const int row = matrix.findRow(query.value(1).value<FeatureId>());
+        const int intensityIndex = -1 != sampleNumber && -1 != row ? matrix.findIntensity(row, sampleNumber) : -1;
+        if (-1 == intensityIndex) {
+            continue; // the feature isn't detected in the sample
+        }
+
+        const TraceBounds bounds(query.value(2).toReal(), query.value(3).toReal(), query.value(4).toReal(), query.value(5).toReal());
+        sampleTraces.append(qMakePair(bounds, row));
+        if (intensityHasBounds.testBit(intensityIndex)) {
+            intensityBounds[intensityIndex].unite(bounds);
+        } else {
+            intensityBounds[intensityIndex] = bounds;
+            intensityHasBounds.setBit(intensityIndex);
+        }
+        hasTraces = true;
+    }
+    if (!sampleTraces.isEmpty()) {
+        buildTree(sampleTraces, trees[lastSampleNumber]);
+    }
+    return hasTraces && progress(100);
+}
+
+void MassTraceIndex::buildTree(QVector<QPair<TraceBounds, int> > &traces, SampleTree &tree)
+{
+    Q_ASSERT(!traces.isEmpty());
+    const int traceCount = traces.size();
+
+    // leaves are ordered by the Hilbert index of their centers, so that close boxes share parents
+    TraceBounds extent = traces.first().first;
+    for (int i = 1; i < traceCount; ++i) {
+        extent.unite(traces[i].first);
+    }
+    const qreal mzScale = extent.mzMax > extent.mzMin ? (HILBERT_GRID_SIZE - 1) / (extent.mzMax - extent.mzMin) : 0.0;
+    const qreal rtScale = extent.rtEnd > extent.rtStart ? (HILBERT_GRID_SIZE - 1) / (extent.rtEnd - extent.rtStart) : 0.0;
+    QVector<QPair<quint32, int> > order(traceCount);
+    for (int i = 0; i < traceCount; ++i) {
+        const TraceBounds &bounds = traces[i].first;
+        const quint32 x = toGridCoordinate((bounds.mzMin + bounds.mzMax) / 2, extent.mzMin, mzScale);
+        const quint32 y = toGridCoordinate((bounds.rtStart + bounds.rtEnd) / 2, extent.rtStart, rtScale);
+        order[i] = qMakePair(getHilbertIndex(x, y), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    tree.leafBounds.resize(traceCount);
+    tree.leafRows.resize(traceCount);
+    for (int i = 0; i < traceCount; ++i) {
+        tree.leafBounds[i] = traces[order[i].second].first;
+        tree.leafRows[i] = traces[order[i].second].second;
+    }
+
+    int levelBegin = 0;
+    int levelEnd = traceCount;
+    bool leafChildren = true;
+    do {
+        const int parentLevelBegin = tree.nodes.size();
+        for (int firstChild = levelBegin; firstChild < levelEnd; firstChild += NODE_SIZE) {
+            Node node;
+            node.firstChild = firstChild;
+            node.childEnd = qMin(firstChild + NODE_SIZE, levelEnd);
+            node.leafChildren = leafChildren;
+            node.bounds = leafChildren ? tree.leafBounds[firstChild] : tree.nodes[firstChild].bounds;
+            for (int child = firstChild + 1; child < node.childEnd; ++child) {
+                node.bounds.unite(leafChildren ? tree.leafBounds[child] : tree.nodes[child].bounds);
+            }
+            tree.nodes.append(node);
+        }
+        levelBegin = parentLevelBegin;
+        levelEnd = tree.nodes.size();
+        leafChildren = false;
+    } while (levelEnd - levelBegin > 1);
+
+    tree.leafBounds.squeeze();
+    tree.leafRows.squeeze();
+    tree.nodes.squeeze();
+}
+
+bool MassTraceIndex::getFeatureBounds(int row, int sampleNumber, TraceBounds &bounds) const
+{
+    const int intensityIndex = !isEmpty() ? matrix.findIntensity(row, sampleNumber) : -1;
+    if (-1 == intensityIndex || !intensityHasBounds.testBit(intensityIndex)) {
+        return false;
+    }
+    bounds = intensityBounds[intensityIndex];
+    return true;
+}
+
+bool MassTraceIndex::getConsensusBounds(int row, TraceBounds &bounds) const
+{
+    if (isEmpty()) {
+        return false;
+    }
+    // averaged on request, the row has at most one intensity per sample
+    TraceBounds sum;
+    int sampleCount = 0;
+    for (int i = matrix.getRowOffset(row); i < matrix.getRowOffset(row + 1); ++i) {
+        if (intensityHasBounds.testBit(i)) {
+            sum.mzMin += intensityBounds[i].mzMin;
+            sum.mzMax += intensityBounds[i].mzMax;
+            sum.rtStart += intensityBounds[i].rtStart;
+            sum.rtEnd += intensityBounds[i].rtEnd;
+            ++sampleCount;
+        }
+    }
+    if (0 == sampleCount) {
+        return false;
+    }
+    bounds = TraceBounds(sum.mzMin / sampleCount, sum.mzMax / sampleCount, sum.rtStart / sampleCount, sum.rtEnd / sampleCount);
+    return true;
+}
+
+QVector<int> MassTraceIndex::findRows(int sampleNumber, const TraceBounds &window) const
+{
+    QVector<int> result;
+    if (sampleNumber < 0 || sampleNumber >= trees.size() || trees[sampleNumber].nodes.isEmpty()) {
+        return result;
+    }
+    const SampleTree &tree = trees[sampleNumber];
+
+    QVector<int> nodesToVisit;
+    nodesToVisit.append(tree.nodes.size() - 1);
+    while (!nodesToVisit.isEmpty()) {
+        const Node &node = tree.nodes[nodesToVisit.last()];
+        nodesToVisit.removeLast();
+        if (!node.bounds.intersects(window)) {
+            continue;
+        }
+        for (int child = node.firstChild; child < node.childEnd; ++child) {
+            if (!node.leafChildren) {
+                nodesToVisit.append(child);
+            } else if (tree.leafBounds[child].intersects(window)) {
+                result.append(tree.leafRows[child]);
+            }
+        }
+    }
+
+    // traces of a feature, e.g. its isotopes, may all be found
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+} // namespace ov
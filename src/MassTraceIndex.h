@@ -0,0 +1,86 @@
+#ifndef MASS_TRACE_INDEX_H
+#define MASS_TRACE_INDEX_H
+
+#include <QBitArray>
+#include <QPair>
+#include <QVector>
+
+#include "FeatureMatrix.h"
+#include "FeatureMatrixUtils.h"
+#include "Globals.h"
+
+class QSqlDatabase;
+
+namespace ov {
+
+// m/z and retention time bounds of a mass trace or of a query window, bounds are inclusive
+struct TraceBounds
+{
+    TraceBounds();
+    TraceBounds(qreal mzMin, qreal mzMax, qreal rtStart, qreal rtEnd);
+
+    bool intersects(const TraceBounds &other) const;
+    void unite(const TraceBounds &other);
+
+    qreal mzMin;
+    qreal mzMax;
+    qreal rtStart;
+    qreal rtEnd;
+};
+
+// Bounding boxes of mass traces of all features kept in a static R-tree per sample, so that features eluting
+// together with a given one, or lying in an m/z and RT window, are found without reading the traces.
+// Boxes are sorted along a Hilbert curve and packed into nodes of NODE_SIZE children level by level.
+// Bounds of a feature in a sample are stored along the intensities of the feature matrix, in the same order.
+// The index keeps a shallow copy of the matrix, so copies of it are cheap and may be read from other threads.
+class MassTraceIndex
+{
+public:
+    MassTraceIndex();
+
+    // slow on large databases, meant to be run on a worker thread, so traces are read through a connection of its own;
+    // @sampleIds: by sample numbers of the matrix, traces of other samples and of unknown features are skipped;
+    // @progress is called after every sample, a canceled build returns an empty index
+    static MassTraceIndex build(const DataSourceId &dataSourceId, const FeatureMatrix &matrix,
+        const QVector<SampleId> &sampleIds, const FeatureMatrixUtils::ProgressCallback &progress);
+    void clear();
+    bool isEmpty() const; // also if the database doesn't store bounds of mass traces
+    static bool isStoredInDatabase(); // whether the trace table has bounds, without building the index
+
+    // union of bounds of all traces of the feature, false if it has no traces in the sample
+    bool getFeatureBounds(int row, int sampleNumber, TraceBounds &bounds) const;
+    // bounds of the feature averaged over samples where it has traces, false if there are none
+    bool getConsensusBounds(int row, TraceBounds &bounds) const;
+    // rows of features having a trace in the sample that intersects the window, sorted
+    QVector<int> findRows(int sampleNumber, const TraceBounds &window) const;
+
+    static const int NODE_SIZE;
+
+private:
+    struct Node
+    {
+        TraceBounds bounds;
+        int firstChild;
+        int childEnd;
+        bool leafChildren;
+    };
+
+    struct SampleTree
+    {
+        QVector<TraceBounds> leafBounds;
+        QVector<int> leafRows;
+        QVector<Node> nodes; // level by level starting from parents of leaves, the root is the last one
+    };
+
+    bool readTraces(QSqlDatabase &db, const QVector<SampleId> &sampleIds, const FeatureMatrixUtils::ProgressCallback &progress);
+    static void buildTree(QVector<QPair<TraceBounds, int> > &traces, SampleTree &tree);
+
+    FeatureMatrix matrix;
+    QVector<SampleTree> trees; // by sample number, empty ones for samples without traces
+    QVector<TraceBounds> intensityBounds; // indexed as intensities of the matrix
+    QBitArray intensityHasBounds;
+};
+
+} // namespace ov
+
+#endif // MASS_TRACE_INDEX_H
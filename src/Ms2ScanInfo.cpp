@@ -2,6 +2,12 @@
 
 namespace ov {
 
+Ms2ScanInfo::Ms2ScanInfo()
+    : scanTime(-1), precursorMz(-1), precursorIntensity(-1), spectrumId(-1)
+{
+
+}
+
 Ms2ScanInfo::Ms2ScanInfo(qreal scanTime, qreal precursorMz, qreal precursorIntensity, const FragmentationSpectrumId &spectrumId)
     : scanTime(scanTime), precursorMz(precursorMz), precursorIntensity(precursorIntensity), spectrumId(spectrumId)
 {
@@ -6,6 +6,7 @@
 namespace ov {
 
 struct Ms2ScanInfo {
+    Ms2ScanInfo();
     Ms2ScanInfo(qreal scanTime, qreal precursorMz, qreal precursorIntensity, const FragmentationSpectrumId &spectrumId);
 
     qreal scanTime;
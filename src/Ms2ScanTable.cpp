@@ -0,0 +1,55 @@
+#include <QSqlQuery>
+#include <QVariant>
+
+#include "Ms2ScanTable.h"
+
+namespace ov {
+
+Ms2ScanTable::Ms2ScanTable()
+{
+
+}
+
+void Ms2ScanTable::clear()
+{
+    scans.clear();
+    scanRanges.clear();
+}
+
+void Ms2ScanTable::build()
+{
+    clear();
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    const bool ok = query.exec("SELECT FMT.sample_id, FMT.feature_id, FS.scan_time, FS.precursor_mz, FS.precursor_intensity, FS.id "
+        "FROM FeatureMassTrace AS FMT, MassTraceFragmentationSpectrum AS MSFS, FragmentationSpectrum AS FS "
+        "WHERE FMT.id = MSFS.mt_id AND MSFS.spectrum_id = FS.id ORDER BY FMT.sample_id, FMT.feature_id, FS.scan_time");
+    Q_ASSERT(ok);
+
+    ScanKey lastKey(-1, -1);
+    while (query.next()) {
+        const ScanKey key(query.value(0).value<SampleId>(), query.value(1).value<FeatureId>());
+        if (key != lastKey) {
+            scanRanges[key] = QPair<int, int>(scans.size(), 0);
+            lastKey = key;
+        }
+        scanRanges[key].second++;
+        scans.append(Ms2ScanInfo(query.value(2).toReal(), query.value(3).toReal(),
+            query.value(4).toReal(), query.value(5).value<FragmentationSpectrumId>()));
+    }
+    scans.squeeze();
+}
+
+const Ms2ScanInfo * Ms2ScanTable::getScans(const SampleId &sampleId, const FeatureId &featureId, int &count) const
+{
+    const QHash<ScanKey, QPair<int, int> >::const_iterator range = scanRanges.constFind(ScanKey(sampleId, featureId));
+    if (range == scanRanges.constEnd()) {
+        count = 0;
+        return NULL;
+    }
+    count = range->second;
+    return scans.constData() + range->first;
+}
+
+} // namespace ov
@@ -0,0 +1,33 @@
+#ifndef MS2_SCAN_TABLE_H
+#define MS2_SCAN_TABLE_H
+
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+#include "Ms2ScanInfo.h"
+
+namespace ov {
+
+// Stores MS2 scans of all features in one contiguous array sorted by (sample, feature, scan time)
+// so that scans of a feature can be read as a slice without querying the database.
+class Ms2ScanTable
+{
+public:
+    Ms2ScanTable();
+
+    void build();
+    void clear();
+
+    const Ms2ScanInfo * getScans(const SampleId &sampleId, const FeatureId &featureId, int &count) const;
+
+private:
+    typedef QPair<SampleId, FeatureId> ScanKey;
+
+    QVector<Ms2ScanInfo> scans;
+    QHash<ScanKey, QPair<int, int> > scanRanges; // value: (index of first scan, count of scans)
+};
+
+} // namespace ov
+
+#endif // MS2_SCAN_TABLE_H
@@ -0,0 +1,226 @@
+#include <limits>
+
+#include <QAction>
+#include <QActionGroup>
+#include <QHBoxLayout>
+#include <QMenu>
+#include <QSplitter>
+
+#include "ChartWidget.h"
+#include "GraphDataController.h"
+
+#include "NativeGraphView.h"
+
+const int FIRST_SCAN_COLOR_INDEX = 10; // offset to reduce chance of color collision between XICs and fragmentation spectra
+const qreal XIC_PEAK_ZOOM_OFFSET = 7.5;
+
+namespace ov {
+
+NativeGraphView::NativeGraphView(GraphDataController *graphDataController, QWidget *parent)
+    : QWidget(parent), graphDataController(graphDataController), xicChart(new ChartWidget), massChart(new ChartWidget),
+    lastUsedColorIndex(FIRST_SCAN_COLOR_INDEX), pendingSpectraRequestId(-1)
+{
+    Q_ASSERT(NULL != graphDataController);
+
+    xicChart->getRenderer().setTitle(tr("Extracted Ion Chromatogram of Selected Features"));
+    xicChart->getRenderer().setAxisTitles(tr("Retention time [s]"), tr("Ion count"));
+    massChart->getRenderer().setAxisTitles(tr("m/z"), tr("Ion count"));
+    massChart->getRenderer().setPlotStyle(ChartRenderer::STICK_PLOT);
+
+    QSplitter *splitter = new QSplitter(Qt::Horizontal);
+    splitter->addWidget(xicChart);
+    splitter->addWidget(massChart);
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(splitter);
+
+    connect(graphDataController, &GraphDataController::seriesChanged, this, &NativeGraphView::seriesChanged);
+    connect(graphDataController, &GraphDataController::ms2SpectraSeriesReady, this, &NativeGraphView::ms2SpectraSeriesReady);
+    connect(xicChart, &ChartWidget::seriesVisibilityChanged, this, &NativeGraphView::xicSeriesVisibilityChanged);
+    connect(xicChart, &ChartWidget::scanClicked, this, &NativeGraphView::xicScanClicked);
+    connect(xicChart, &ChartWidget::backgroundClicked, this, &NativeGraphView::deselectScans);
+    connect(xicChart, &ChartWidget::contextMenuRequested, this, &NativeGraphView::xicContextMenuRequested);
+
+    seriesChanged();
+}
+
+void NativeGraphView::seriesChanged()
+{
+    const GraphSeriesList &xicSeries = graphDataController->getXicSeries();
+    QVector<QColor> colors(xicSeries.size());
+    for (int i = 0; i < colors.size(); ++i) {
+        colors[i] = ChartRenderer::getDefaultColor(i);
+    }
+    xicChart->getRenderer().setSeries(xicSeries, colors);
+
+    selectedScans.clear();
+    lastUsedColorIndex = FIRST_SCAN_COLOR_INDEX;
+    pendingSpectraRequestId = -1;
+
+    zoomXicToFeatures();
+    showMassPeaks();
+    xicChart->update();
+}
+
+void NativeGraphView::zoomXicToFeatures()
+{
+    qreal minRt = std::numeric_limits<qreal>::max();
+    qreal maxRt = -std::numeric_limits<qreal>::max();
+    foreach (const GraphSeries &series, graphDataController->getXicSeries()) {
+        if (series.hasElutionRange()) {
+            minRt = qMin(minRt, series.rtStart);
+            maxRt = qMax(maxRt, series.rtEnd);
+        }
+    }
+    if (minRt <= maxRt) {
+        xicChart->getRenderer().setXRange(qMax(minRt - XIC_PEAK_ZOOM_OFFSET, 0.0), maxRt + XIC_PEAK_ZOOM_OFFSET);
+    }
+}
+
+void NativeGraphView::showMassPeaks()
+{
+    // mass peak graphs have the same order and colors as XICs
+    ChartRenderer &xicRenderer = xicChart->getRenderer();
+    ChartRenderer &massRenderer = massChart->getRenderer();
+    const GraphSeriesList &massSeries = graphDataController->getMassSeries();
+    QVector<QColor> colors(massSeries.size());
+    for (int i = 0; i < colors.size(); ++i) {
+        colors[i] = ChartRenderer::getDefaultColor(i);
+    }
+    massRenderer.setSeries(massSeries, colors);
+    massRenderer.setTitle(tr("Mass Peaks of Selected Features"));
+    massRenderer.setLegendVisible(false);
+    for (int i = 0; i < massSeries.size() && i < xicRenderer.getSeries().size(); ++i) {
+        massRenderer.setSeriesVisible(i, xicRenderer.isSeriesVisible(i));
+    }
+    massChart->update();
+}
+
+void NativeGraphView::xicSeriesVisibilityChanged(int seriesIndex, bool visible)
+{
+    if (selectedScans.isEmpty() && seriesIndex < massChart->getRenderer().getSeries().size()) {
+        massChart->getRenderer().setSeriesVisible(seriesIndex, visible);
+        massChart->update();
+    }
+}
+
+void NativeGraphView::xicScanClicked(int seriesIndex, const Ms2ScanInfo &scan, bool addToSelection)
+{
+    if (!addToSelection) {
+        selectedScans.clear();
+        lastUsedColorIndex = FIRST_SCAN_COLOR_INDEX;
+    } else {
+        for (int i = 0; i < selectedScans.size(); ++i) {
+            if (selectedScans[i].scan.spectrumId == scan.spectrumId) {
+                selectedScans.removeAt(i);
+                if (selectedScans.isEmpty()) {
+                    deselectScans();
+                } else {
+                    updateScanSelection();
+                }
+                return;
+            }
+        }
+    }
+
+    SelectedScan selectedScan;
+    selectedScan.seriesIndex = seriesIndex;
+    selectedScan.scan = scan;
+    // color of selected ms2 scan point is the same as color of ms2 spectrum graph
+    selectedScan.color = ChartRenderer::getDefaultColor(++lastUsedColorIndex);
+    selectedScans.append(selectedScan);
+    updateScanSelection();
+}
+
+void NativeGraphView::updateScanSelection()
+{
+    QHash<FragmentationSpectrumId, QColor> scanColors;
+    QList<FragmentationSpectrumId> spectrumIds;
+    foreach (const SelectedScan &selectedScan, selectedScans) {
+        scanColors[selectedScan.scan.spectrumId] = selectedScan.color;
+        spectrumIds.append(selectedScan.scan.spectrumId);
+    }
+    ChartRenderer &xicRenderer = xicChart->getRenderer();
+    xicRenderer.setHighlightedScans(scanColors);
+    xicRenderer.setSeriesDimmed(true);
+    xicChart->update();
+
+    // spectra are read in background, only a response to the latest request is displayed
+    pendingSpectraRequestId = graphDataController->requestMs2Spectra(spectrumIds);
+}
+
+void NativeGraphView::deselectScans()
+{
+    if (selectedScans.isEmpty()) {
+        return;
+    }
+    selectedScans.clear();
+    lastUsedColorIndex = FIRST_SCAN_COLOR_INDEX;
+    pendingSpectraRequestId = -1;
+
+    ChartRenderer &xicRenderer = xicChart->getRenderer();
+    xicRenderer.setHighlightedScans(QHash<FragmentationSpectrumId, QColor>());
+    xicRenderer.setSeriesDimmed(false);
+    xicChart->update();
+
+    showMassPeaks();
+}
+
+void NativeGraphView::ms2SpectraSeriesReady(int requestId, const Ms2SpectraById &spectra)
+{
+    if (requestId != pendingSpectraRequestId || selectedScans.isEmpty()) {
+        return;
+    }
+    pendingSpectraRequestId = -1;
+
+    const GraphSeriesList &xicSeries = xicChart->getRenderer().getSeries();
+    GraphSeriesList spectrumSeries;
+    QVector<QColor> colors;
+    QStringList titles;
+    foreach (const SelectedScan &selectedScan, selectedScans) {
+        if (!spectra.contains(selectedScan.scan.spectrumId)) {
+            continue;
+        }
+        const GraphSeries &xic = xicSeries[selectedScan.seriesIndex];
+        GraphSeries series(xic.sampleId, xic.featureId, xic.sampleName, xic.consensusMz, xic.compoundIds);
+        series.points = spectra[selectedScan.scan.spectrumId].toVector();
+        GraphSeries::sortPoints(series.points);
+        titles.append(series.getSpectrumTitle(selectedScan.scan));
+        spectrumSeries.append(series);
+        colors.append(selectedScan.color);
+    }
+
+    ChartRenderer &massRenderer = massChart->getRenderer();
+    massRenderer.setSeries(spectrumSeries, colors);
+    massRenderer.setSeriesTitles(titles);
+    massRenderer.setTitle(tr("Fragmentation Spectra of Selected Scans"));
+    massRenderer.setLegendVisible(true);
+    massChart->update();
+}
+
+void NativeGraphView::xicContextMenuRequested(QMenu *menu)
+{
+    QMenu *modeMenu = menu->addMenu(tr("Visualization mode"));
+    QActionGroup *modeGroup = new QActionGroup(modeMenu);
+    QAction *fillingAction = modeMenu->addAction(tr("Filling"));
+    QAction *peaksAction = modeMenu->addAction(tr("Peaks"));
+    fillingAction->setCheckable(true);
+    peaksAction->setCheckable(true);
+    modeGroup->addAction(fillingAction);
+    modeGroup->addAction(peaksAction);
+
+    ChartRenderer &xicRenderer = xicChart->getRenderer();
+    fillingAction->setChecked(ChartRenderer::AREA_PLOT == xicRenderer.getPlotStyle());
+    peaksAction->setChecked(ChartRenderer::STICK_PLOT == xicRenderer.getPlotStyle());
+
+    connect(fillingAction, &QAction::triggered, [this] () {
+        xicChart->getRenderer().setPlotStyle(ChartRenderer::AREA_PLOT);
+        xicChart->update();
+    });
+    connect(peaksAction, &QAction::triggered, [this] () {
+        xicChart->getRenderer().setPlotStyle(ChartRenderer::STICK_PLOT);
+        xicChart->update();
+    });
+}
+
+} // namespace ov
@@ -0,0 +1,56 @@
+#ifndef NATIVE_GRAPH_VIEW_H
+#define NATIVE_GRAPH_VIEW_H
+
+#include <QColor>
+#include <QWidget>
+
+#include "FeatureDataLoader.h"
+#include "Ms2ScanInfo.h"
+
+class QMenu;
+
+namespace ov {
+
+class ChartWidget;
+class GraphDataController;
+
+// Alternative to the web graph view drawing XICs, mass peaks and fragmentation spectra natively.
+// It doesn't depend on OpenGL and stays responsive with hundreds of graphs.
+class NativeGraphView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    NativeGraphView(GraphDataController *graphDataController, QWidget *parent = NULL);
+
+private slots:
+    void seriesChanged();
+    void xicSeriesVisibilityChanged(int seriesIndex, bool visible);
+    void xicScanClicked(int seriesIndex, const Ms2ScanInfo &scan, bool addToSelection);
+    void xicContextMenuRequested(QMenu *menu);
+    void ms2SpectraSeriesReady(int requestId, const Ms2SpectraById &spectra);
+    void deselectScans();
+
+private:
+    struct SelectedScan {
+        int seriesIndex;
+        Ms2ScanInfo scan;
+        QColor color;
+    };
+
+    void showMassPeaks();
+    void zoomXicToFeatures();
+    void updateScanSelection();
+
+    GraphDataController *graphDataController;
+    ChartWidget *xicChart;
+    ChartWidget *massChart;
+
+    QList<SelectedScan> selectedScans;
+    int lastUsedColorIndex;
+    int pendingSpectraRequestId;
+};
+
+} // namespace ov
+
+#endif // NATIVE_GRAPH_VIEW_H
@@ -0,0 +1,57 @@
+#include <limits>
+
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+
+#include "NeighbourFeaturesDialog.h"
+
+const double DEFAULT_MZ_TOLERANCE_PPM = 10.0;
+
+namespace ov {
+
+NeighbourFeaturesDialog::NeighbourFeaturesDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Add Neighbouring Features to Plot"));
+
+    mzLimitCheckBox = new QCheckBox(tr("Only features within the m/z range of the feature"), this);
+
+    mzToleranceSpinBox = new QDoubleSpinBox(this);
+    mzToleranceSpinBox->setRange(0.0, 1000.0);
+    mzToleranceSpinBox->setDecimals(1);
+    mzToleranceSpinBox->setSuffix(tr(" ppm"));
+    mzToleranceSpinBox->setValue(DEFAULT_MZ_TOLERANCE_PPM);
+    mzToleranceSpinBox->setEnabled(false);
+    connect(mzLimitCheckBox, &QCheckBox::toggled, mzToleranceSpinBox, &QWidget::setEnabled);
+
+    rtToleranceSpinBox = new QDoubleSpinBox(this);
+    rtToleranceSpinBox->setRange(0.0, 3600.0);
+    rtToleranceSpinBox->setDecimals(1);
+    rtToleranceSpinBox->setSuffix(tr(" s"));
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QFormLayout *layout = new QFormLayout(this);
+    layout->addRow(mzLimitCheckBox);
+    layout->addRow(tr("m/z tolerance:"), mzToleranceSpinBox);
+    layout->addRow(tr("Widen the elution period by:"), rtToleranceSpinBox);
+    layout->addRow(buttonBox);
+}
+
+TraceBounds NeighbourFeaturesDialog::getWindow(const TraceBounds &featureBounds) const
+{
+    TraceBounds window(-std::numeric_limits<qreal>::max(), std::numeric_limits<qreal>::max(),
+        featureBounds.rtStart - rtToleranceSpinBox->value(), featureBounds.rtEnd + rtToleranceSpinBox->value());
+    if (mzLimitCheckBox->isChecked()) {
+        const qreal relativeTolerance = mzToleranceSpinBox->value() * 1e-6;
+        window.mzMin = featureBounds.mzMin * (1.0 - relativeTolerance);
+        window.mzMax = featureBounds.mzMax * (1.0 + relativeTolerance);
+    }
+    return window;
+}
+
+} // namespace ov
@@ -0,0 +1,32 @@
+#ifndef NEIGHBOUR_FEATURES_DIALOG_H
+#define NEIGHBOUR_FEATURES_DIALOG_H
+
+#include <QDialog>
+
+#include "MassTraceIndex.h"
+
+class QCheckBox;
+class QDoubleSpinBox;
+
+namespace ov {
+
+// Lets the user choose the window around mass traces of a feature where neighbouring features are searched
+class NeighbourFeaturesDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit NeighbourFeaturesDialog(QWidget *parent);
+
+    // without the m/z limit the window contains all features co-eluting with the given one
+    TraceBounds getWindow(const TraceBounds &featureBounds) const;
+
+private:
+    QCheckBox *mzLimitCheckBox;
+    QDoubleSpinBox *mzToleranceSpinBox;
+    QDoubleSpinBox *rtToleranceSpinBox;
+};
+
+} // namespace ov
+
+#endif // NEIGHBOUR_FEATURES_DIALOG_H
@@ -9,6 +9,8 @@ ProgressIndicator::ProgressIndicator(QWidget *parent)
 {
     ui->setupUi(this);
     hide();
+
+    connect(ui->cancelButton, &QPushButton::clicked, this, &ProgressIndicator::reject);
 }
 
 void ProgressIndicator::started()
@@ -27,4 +29,11 @@ void ProgressIndicator::finished()
     hide();
 }
 
+void ProgressIndicator::reject()
+{
+    // closing the dialog by Escape or the title bar button cancels the operation as well
+    emit canceled();
+    QDialog::reject();
+}
+
 } // namespace ov
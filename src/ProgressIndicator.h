@@ -17,10 +17,14 @@ class ProgressIndicator : public QDialog
 public:
     ProgressIndicator(QWidget *parent = NULL);
 
+signals:
+    void canceled();
+
 public slots:
     void started();
     void progress(int percents);
     void finished();
+    void reject();
 
 private:
     Ui::ProgressIndicatorUi *ui;
@@ -0,0 +1,92 @@
+#include <limits>
+
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+
+#include "RangeFilterDialog.h"
+
+const double DEFAULT_MZ_TOLERANCE_PPM = 5.0;
+const double MAX_RT = 36000.0;
+
+namespace ov {
+
+RangeFilterDialog::RangeFilterDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Filter by m/z and RT"));
+
+    mzLimitCheckBox = new QCheckBox(tr("Only features with consensus m/z within the tolerance"), this);
+    mzLimitCheckBox->setChecked(true);
+
+    mzSpinBox = new QDoubleSpinBox(this);
+    mzSpinBox->setRange(0.0, 100000.0);
+    mzSpinBox->setDecimals(4);
+
+    mzToleranceSpinBox = new QDoubleSpinBox(this);
+    mzToleranceSpinBox->setRange(0.0, 100000.0);
+    mzToleranceSpinBox->setDecimals(1);
+    mzToleranceSpinBox->setSuffix(tr(" ppm"));
+    mzToleranceSpinBox->setValue(DEFAULT_MZ_TOLERANCE_PPM);
+    connect(mzLimitCheckBox, &QCheckBox::toggled, mzSpinBox, &QWidget::setEnabled);
+    connect(mzLimitCheckBox, &QCheckBox::toggled, mzToleranceSpinBox, &QWidget::setEnabled);
+
+    rtLimitCheckBox = new QCheckBox(tr("Only features with consensus RT in the range"), this);
+
+    rtMinSpinBox = new QDoubleSpinBox(this);
+    rtMinSpinBox->setRange(0.0, MAX_RT);
+    rtMinSpinBox->setDecimals(1);
+    rtMinSpinBox->setSuffix(tr(" s"));
+    rtMinSpinBox->setEnabled(false);
+
+    rtMaxSpinBox = new QDoubleSpinBox(this);
+    rtMaxSpinBox->setRange(0.0, MAX_RT);
+    rtMaxSpinBox->setDecimals(1);
+    rtMaxSpinBox->setSuffix(tr(" s"));
+    rtMaxSpinBox->setValue(MAX_RT);
+    rtMaxSpinBox->setEnabled(false);
+    connect(rtLimitCheckBox, &QCheckBox::toggled, rtMinSpinBox, &QWidget::setEnabled);
+    connect(rtLimitCheckBox, &QCheckBox::toggled, rtMaxSpinBox, &QWidget::setEnabled);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QFormLayout *layout = new QFormLayout(this);
+    layout->addRow(mzLimitCheckBox);
+    layout->addRow(tr("m/z:"), mzSpinBox);
+    layout->addRow(tr("m/z tolerance:"), mzToleranceSpinBox);
+    layout->addRow(rtLimitCheckBox);
+    layout->addRow(tr("RT from:"), rtMinSpinBox);
+    layout->addRow(tr("RT to:"), rtMaxSpinBox);
+    layout->addRow(buttonBox);
+}
+
+qreal RangeFilterDialog::getMzMin() const
+{
+    if (!mzLimitCheckBox->isChecked()) {
+        return -std::numeric_limits<qreal>::max();
+    }
+    return mzSpinBox->value() * (1.0 - mzToleranceSpinBox->value() * 1e-6);
+}
+
+qreal RangeFilterDialog::getMzMax() const
+{
+    if (!mzLimitCheckBox->isChecked()) {
+        return std::numeric_limits<qreal>::max();
+    }
+    return mzSpinBox->value() * (1.0 + mzToleranceSpinBox->value() * 1e-6);
+}
+
+qreal RangeFilterDialog::getRtMin() const
+{
+    return rtLimitCheckBox->isChecked() ? rtMinSpinBox->value() : -std::numeric_limits<qreal>::max();
+}
+
+qreal RangeFilterDialog::getRtMax() const
+{
+    return rtLimitCheckBox->isChecked() ? rtMaxSpinBox->value() : std::numeric_limits<qreal>::max();
+}
+
+} // namespace ov
@@ -0,0 +1,36 @@
+#ifndef RANGE_FILTER_DIALOG_H
+#define RANGE_FILTER_DIALOG_H
+
+#include <QDialog>
+
+class QCheckBox;
+class QDoubleSpinBox;
+
+namespace ov {
+
+// Lets the user choose the window of consensus m/z and RT where features are displayed
+class RangeFilterDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit RangeFilterDialog(QWidget *parent);
+
+    // bounds are inclusive, unlimited ones are the lowest and the highest values
+    qreal getMzMin() const;
+    qreal getMzMax() const;
+    qreal getRtMin() const;
+    qreal getRtMax() const;
+
+private:
+    QCheckBox *mzLimitCheckBox;
+    QDoubleSpinBox *mzSpinBox;
+    QDoubleSpinBox *mzToleranceSpinBox;
+    QCheckBox *rtLimitCheckBox;
+    QDoubleSpinBox *rtMinSpinBox;
+    QDoubleSpinBox *rtMaxSpinBox;
+};
+
+} // namespace ov
+
+#endif // RANGE_FILTER_DIALOG_H
@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "FeatureMatrix.h"
+#include "FeatureMatrixUtils.h"
+#include "IntensityNormalization.h"
+
+#include "SamplePca.h"
+
+const int OVERSAMPLING = 10; // extra random vectors make the leading components accurate
+const int POWER_ITERATIONS = 4; // separate components with close variances
+const int MAX_JACOBI_SWEEPS = 50;
+const int TRANSFORM_PROGRESS = 20; // percents of the progress taken by the transform of intensities, the rest by iterations
+const unsigned RANDOM_SEED = 20160901; // the same data always gets the same components
+
+namespace ov {
+
+namespace {
+
+// Matrix A of samples by features, stored as the transposed sparse feature matrix plus per-feature
+// means and weights: A[s][f] = (x[f][s] - means[f]) * weights[f]. Dense matrices are row-major.
+struct CenteredMatrix
+{
+    CenteredMatrix(const FeatureMatrix &matrix)
+        : matrix(matrix)
+    {
+
+    }
+
+    const FeatureMatrix &matrix;
+    QVector<double> values; // log intensities, parallel to intensities of the matrix
+    QVector<double> means;
+    QVector<double> weights; // 1 or 1 / standard deviation, 0 for constant features
+};
+
+class RowTransformer
+{
+public:
+    RowTransformer(CenteredMatrix &centered, const IntensityNormalization &normalization, bool unitVariance)
+        : centered(centered), normalization(normalization), unitVariance(unitVariance)
+    {
+
+    }
+
+    void operator ()(int beginRow, int endRow) const
+    {
+        const FeatureMatrix &matrix = centered.matrix;
+        const int sampleCount = matrix.getSampleCount();
+        for (int row = beginRow; row < endRow; ++row) {
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            double *rowValues = centered.values.data() + matrix.getRowOffset(row);
+            double sum = 0.0;
+            double sumOfSquares = 0.0;
+            for (int i = 0; i < count; ++i) {
+                rowValues[i] = FeatureMatrixUtils::getLogIntensity(normalization, sampleNumbers[i], intensities[i]);
+                sum += rowValues[i];
+                sumOfSquares += rowValues[i] * rowValues[i];
+            }
+            const double mean = sum / sampleCount;
+            const double variance = qMax(0.0, (sumOfSquares - sum * mean) / (sampleCount - 1));
+            centered.means[row] = mean;
+            if (variance <= 1e-12 * qMax(1.0, sumOfSquares / sampleCount)) {
+                centered.weights[row] = 0.0; // constant features carry no information about samples
+            } else {
+                centered.weights[row] = unitVariance ? 1.0 / std::sqrt(variance) : 1.0;
+            }
+        }
+    }
+
+private:
+    CenteredMatrix &centered;
+    const IntensityNormalization &normalization;
+    bool unitVariance;
+};
+
+// A * V for a block of features: sample rows of the product followed by the centering term, summed over blocks
+class ProductPart
+{
+public:
+    ProductPart(const CenteredMatrix &centered, const QVector<double> &v, int columnCount)
+        : centered(centered), v(v), columnCount(columnCount)
+    {
+
+    }
+
+    QVector<double> operator ()(int beginRow, int endRow) const
+    {
+        const FeatureMatrix &matrix = centered.matrix;
+        QVector<double> part((matrix.getSampleCount() + 1) * columnCount, 0.0);
+        double *centering = part.data() + matrix.getSampleCount() * columnCount;
+        for (int row = beginRow; row < endRow; ++row) {
+            const double weight = centered.weights[row];
+            if (0.0 == weight) {
+                continue;
+            }
+            const double *vRow = v.constData() + row * columnCount;
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            const double *rowValues = centered.values.constData() + matrix.getRowOffset(row);
+            for (int i = 0; i < count; ++i) {
+                double *partRow = part.data() + sampleNumbers[i] * columnCount;
+                const double value = rowValues[i] * weight;
+                for (int j = 0; j < columnCount; ++j) {
+                    partRow[j] += value * vRow[j];
+                }
+            }
+            const double meanValue = centered.means[row] * weight;
+            for (int j = 0; j < columnCount; ++j) {
+                centering[j] += meanValue * vRow[j];
+            }
+        }
+        return part;
+    }
+
+private:
+    const CenteredMatrix &centered;
+    const QVector<double> &v;
+    int columnCount;
+};
+
+// rows of A^T * Y for a block of features, blocks write distinct rows
+class TransposedProduct
+{
+public:
+    TransposedProduct(const CenteredMatrix &centered, const QVector<double> &y, const QVector<double> &columnSums,
+        int columnCount, double *result)
+        : centered(centered), y(y), columnSums(columnSums), columnCount(columnCount), result(result)
+    {
+
+    }
+
+    void operator ()(int beginRow, int endRow) const
+    {
+        const FeatureMatrix &matrix = centered.matrix;
+        for (int row = beginRow; row < endRow; ++row) {
+            double *resultRow = result + row * columnCount;
+            const double weight = centered.weights[row];
+            if (0.0 == weight) {
+                std::fill(resultRow, resultRow + columnCount, 0.0);
+                continue;
+            }
+            for (int j = 0; j < columnCount; ++j) {
+                resultRow[j] = -centered.means[row] * columnSums[j];
+            }
+            const int *sampleNumbers = NULL;
+            const double *intensities = NULL;
+            const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+            const double *rowValues = centered.values.constData() + matrix.getRowOffset(row);
+            for (int i = 0; i < count; ++i) {
+                const double *yRow = y.constData() + sampleNumbers[i] * columnCount;
+                for (int j = 0; j < columnCount; ++j) {
+                    resultRow[j] += rowValues[i] * yRow[j];
+                }
+            }
+            for (int j = 0; j < columnCount; ++j) {
+                resultRow[j] *= weight;
+            }
+        }
+    }
+
+private:
+    const CenteredMatrix &centered;
+    const QVector<double> &y;
+    const QVector<double> &columnSums;
+    int columnCount;
+    double *result;
+};
+
+// samples x columnCount
+QVector<double> multiply(const CenteredMatrix &centered, const QVector<double> &v, int columnCount)
+{
+    const int sampleCount = centered.matrix.getSampleCount();
+    const QVector<QVector<double> > parts = FeatureMatrixUtils::mapBlocks<QVector<double> >(centered.matrix.getRowCount(),
+        FeatureMatrixUtils::ROWS_PER_TASK, ProductPart(centered, v, columnCount));
+    QVector<double> product((sampleCount + 1) * columnCount, 0.0);
+    foreach (const QVector<double> &part, parts) {
+        for (int i = 0; i < part.size(); ++i) {
+            product[i] += part[i];
+        }
+    }
+    // every sample, detected or not, gets the centering term
+    for (int s = 0; s < sampleCount; ++s) {
+        for (int j = 0; j < columnCount; ++j) {
+            product[s * columnCount + j] -= product[sampleCount * columnCount + j];
+        }
+    }
+    product.resize(sampleCount * columnCount);
+    return product;
+}
+
+// features x columnCount
+QVector<double> multiplyTransposed(const CenteredMatrix &centered, const QVector<double> &y, int columnCount)
+{
+    QVector<double> columnSums(columnCount, 0.0);
+    for (int i = 0; i < y.size(); ++i) {
+        columnSums[i % columnCount] += y[i];
+    }
+    QVector<double> product(centered.matrix.getRowCount() * columnCount);
+    FeatureMatrixUtils::runInBlocks(centered.matrix.getRowCount(), FeatureMatrixUtils::ROWS_PER_TASK,
+        TransposedProduct(centered, y, columnSums, columnCount, product.data()));
+    return product;
+}
+
+// modified Gram-Schmidt applied twice, columns that turn out dependent become zero
+void orthonormalizeColumns(QVector<double> &m, int columnCount)
+{
+    const int rowCount = m.size() / columnCount;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int j = 0; j < columnCount; ++j) {
+            for (int k = 0; k < j; ++k) {
+                double product = 0.0;
+                for (int i = 0; i < rowCount; ++i) {
+                    product += m[i * columnCount + j] * m[i * columnCount + k];
+                }
+                for (int i = 0; i < rowCount; ++i) {
+                    m[i * columnCount + j] -= product * m[i * columnCount + k];
+                }
+            }
+            double norm = 0.0;
+            for (int i = 0; i < rowCount; ++i) {
+                norm += m[i * columnCount + j] * m[i * columnCount + j];
+            }
+            norm = std::sqrt(norm);
+            const double factor = norm > 1e-12 ? 1.0 / norm : 0.0;
+            for (int i = 0; i < rowCount; ++i) {
+                m[i * columnCount + j] *= factor;
+            }
+        }
+    }
+}
+
+// cyclic Jacobi rotations of a small symmetric matrix, eigenvectors are the columns of @vectors
+void findEigenvectors(QVector<double> a, int size, QVector<double> &values, QVector<double> &vectors)
+{
+    vectors.fill(0.0, size * size);
+    for (int i = 0; i < size; ++i) {
+        vectors[i * size + i] = 1.0;
+    }
+    for (int sweep = 0; sweep < MAX_JACOBI_SWEEPS; ++sweep) {
+        double offDiagonal = 0.0;
+        double diagonal = 0.0;
+        for (int p = 0; p < size; ++p) {
+            diagonal += a[p * size + p] * a[p * size + p];
+            for (int q = p + 1; q < size; ++q) {
+                offDiagonal += a[p * size + q] * a[p * size + q];
+            }
+        }
+        if (offDiagonal <= 1e-30 * diagonal) {
+            break;
+        }
+        for (int p = 0; p < size; ++p) {
+            for (int q = p + 1; q < size; ++q) {
+                const double apq = a[p * size + q];
+                if (0.0 == apq) {
+                    continue;
+                }
+                const double theta = (a[q * size + q] - a[p * size + p]) / (2.0 * apq);
+                const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+                for (int k = 0; k < size; ++k) {
+                    const double akp = a[k * size + p];
+                    const double akq = a[k * size + q];
+                    a[k * size + p] = c * akp - s * akq;
+                    a[k * size + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < size; ++k) {
+                    const double apk = a[p * size + k];
+                    const double aqk = a[q * size + k];
+                    a[p * size + k] = c * apk - s * aqk;
+                    a[q * size + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < size; ++k) {
+                    const double vkp = vectors[k * size + p];
+                    const double vkq = vectors[k * size + q];
+                    vectors[k * size + p] = c * vkp - s * vkq;
+                    vectors[k * size + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    values.resize(size);
+    for (int i = 0; i < size; ++i) {
+        values[i] = a[i * size + i];
+    }
+}
+
+}
+
+SamplePca::SamplePca()
+    : unitVariance(false), componentCount(0)
+{
+
+}
+
+SamplePca SamplePca::compute(const FeatureMatrix &matrix, const IntensityNormalization &normalization, bool unitVariance,
+    const FeatureMatrixUtils::ProgressCallback &progress)
+{
+    SamplePca pca;
+    pca.unitVariance = unitVariance;
+    const int sampleCount = matrix.getSampleCount();
+    const int rowCount = matrix.getRowCount();
+    if (sampleCount < 2 || 0 == rowCount) {
+        return pca;
+    }
+
+    CenteredMatrix centered(matrix);
+    centered.values.resize(matrix.getIntensityCount());
+    centered.means.resize(rowCount);
+    centered.weights.resize(rowCount);
+    if (!FeatureMatrixUtils::runInBlocks(rowCount, FeatureMatrixUtils::ROWS_PER_TASK,
+        RowTransformer(centered, normalization, unitVariance), [&progress] (int percents) {
+            return progress(percents * TRANSFORM_PROGRESS / 100);
+        }))
+    {
+        return pca;
+    }
+
+    double totalVariance = 0.0;
+    for (int row = 0; row < rowCount; ++row) {
+        const int *sampleNumbers = NULL;
+        const double *intensities = NULL;
+        const int count = matrix.getRowIntensities(row, sampleNumbers, intensities);
+        const double *rowValues = centered.values.constData() + matrix.getRowOffset(row);
+        double sumOfSquares = 0.0;
+        for (int i = 0; i < count; ++i) {
+            sumOfSquares += rowValues[i] * rowValues[i];
+        }
+        const double weight = centered.weights[row];
+        totalVariance += weight * weight * (sumOfSquares - sampleCount * centered.means[row] * centered.means[row]);
+    }
+    if (totalVariance <= 0.0) {
+        return pca;
+    }
+
+    // the range of A is captured by a few random combinations of features, refined by power iterations
+    const int columnCount = qMin(COMPONENT_COUNT + OVERSAMPLING, qMin(sampleCount, rowCount));
+    std::mt19937 generator(RANDOM_SEED);
+    std::normal_distribution<double> distribution;
+    QVector<double> v(rowCount * columnCount);
+    for (int i = 0; i < v.size(); ++i) {
+        v[i] = distribution(generator);
+    }
+    QVector<double> y = multiply(centered, v, columnCount);
+    orthonormalizeColumns(y, columnCount);
+    for (int iteration = 0; iteration < POWER_ITERATIONS; ++iteration) {
+        if (!progress(TRANSFORM_PROGRESS + (100 - TRANSFORM_PROGRESS) * iteration / POWER_ITERATIONS)) {
+            return pca;
+        }
+        v = multiplyTransposed(centered, y, columnCount);
+        orthonormalizeColumns(v, columnCount);
+        y = multiply(centered, v, columnCount);
+        orthonormalizeColumns(y, columnCount);
+    }
+
+    if (!progress(100)) {
+        return pca;
+    }
+
+    // A ~ Y * B with B = Y^T * A, components of A follow from the eigenvectors of the small B * B^T
+    const QVector<double> bTransposed = multiplyTransposed(centered, y, columnCount);
+    QVector<double> gram(columnCount * columnCount, 0.0);
+    for (int row = 0; row < rowCount; ++row) {
+        const double *bRow = bTransposed.constData() + row * columnCount;
+        for (int i = 0; i < columnCount; ++i) {
+            for (int j = i; j < columnCount; ++j) {
+                gram[i * columnCount + j] += bRow[i] * bRow[j];
+            }
+        }
+    }
+    for (int i = 0; i < columnCount; ++i) {
+        for (int j = 0; j < i; ++j) {
+            gram[i * columnCount + j] = gram[j * columnCount + i];
+        }
+    }
+    QVector<double> eigenvalues;
+    QVector<double> eigenvectors;
+    findEigenvectors(gram, columnCount, eigenvalues, eigenvectors);
+    QVector<int> order(columnCount);
+    for (int i = 0; i < columnCount; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&eigenvalues] (int i, int j) { return eigenvalues[i] > eigenvalues[j]; });
+
+    pca.componentCount = qMin(int(COMPONENT_COUNT), columnCount);
+    pca.scores.fill(0.0, sampleCount * pca.componentCount);
+    for (int component = 0; component < pca.componentCount; ++component) {
+        const int index = order[component];
+        const double singularValue = std::sqrt(qMax(0.0, eigenvalues[index]));
+        pca.explainedVariances.append(qMax(0.0, eigenvalues[index]) / totalVariance);
+        double largestScore = 0.0;
+        for (int s = 0; s < sampleCount; ++s) {
+            double score = 0.0;
+            for (int j = 0; j < columnCount; ++j) {
+                score += y[s * columnCount + j] * eigenvectors[j * columnCount + index];
+            }
+            score *= singularValue;
+            pca.scores[s * pca.componentCount + component] = score;
+            if (std::fabs(score) > std::fabs(largestScore)) {
+                largestScore = score;
+            }
+        }
+        // the sign of a component is arbitrary, fixing it keeps plots stable between runs
+        if (largestScore < 0.0) {
+            for (int s = 0; s < sampleCount; ++s) {
+                pca.scores[s * pca.componentCount + component] *= -1.0;
+            }
+        }
+    }
+    return pca;
+}
+
+bool SamplePca::isEmpty() const
+{
+    return 0 == componentCount;
+}
+
+bool SamplePca::isUnitVariance() const
+{
+    return unitVariance;
+}
+
+int SamplePca::getSampleCount() const
+{
+    return 0 == componentCount ? 0 : scores.size() / componentCount;
+}
+
+int SamplePca::getComponentCount() const
+{
+    return componentCount;
+}
+
+qreal SamplePca::getScore(int sampleNumber, int component) const
+{
+    return scores[sampleNumber * componentCount + component];
+}
+
+qreal SamplePca::getExplainedVariance(int component) const
+{
+    return explainedVariances[component];
+}
+
+} // namespace ov
@@ -0,0 +1,45 @@
+#ifndef SAMPLE_PCA_H
+#define SAMPLE_PCA_H
+
+#include <QVector>
+
+#include "FeatureMatrixUtils.h"
+
+namespace ov {
+
+class FeatureMatrix;
+class IntensityNormalization;
+
+// Principal components of samples described by log2(1 + intensity) of all features, undetected features being 0.
+// Features are centered and optionally scaled to unit variance. Components are found by randomized subspace
+// iteration, so neither the covariance of features nor a dense copy of the matrix is ever built, only products
+// of the sparse matrix with a few vectors. Results are implicitly shared, so copies are cheap.
+class SamplePca
+{
+public:
+    enum { COMPONENT_COUNT = 3 };
+
+    SamplePca(); // no components
+
+    // slow, meant to be run on a worker thread; features are processed in parallel;
+    // @progress is called between iterations, a canceled computation returns no components
+    static SamplePca compute(const FeatureMatrix &matrix, const IntensityNormalization &normalization, bool unitVariance,
+        const FeatureMatrixUtils::ProgressCallback &progress);
+
+    bool isEmpty() const;
+    bool isUnitVariance() const;
+    int getSampleCount() const;
+    int getComponentCount() const; // at most COMPONENT_COUNT, fewer if the matrix is too small
+    qreal getScore(int sampleNumber, int component) const;
+    qreal getExplainedVariance(int component) const; // fraction of the total variance
+
+private:
+    bool unitVariance;
+    int componentCount;
+    QVector<double> scores; // componentCount values per sample
+    QVector<double> explainedVariances;
+};
+
+} // namespace ov
+
+#endif // SAMPLE_PCA_H
@@ -0,0 +1,248 @@
+#include <QContextMenuEvent>
+#include <QHelpEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <QtConcurrent>
+
+#include "SamplePcaView.h"
+
+const int PLOT_MARGIN = 40;
+const qreal POINT_RADIUS = 4.0;
+const qreal CLICK_RADIUS = 6.0;
+
+namespace ov {
+
+SamplePcaView::SamplePcaView(QWidget *parent)
+    : QWidget(parent), unitVariance(false), xComponent(0), yComponent(1)
+{
+    setMinimumSize(300, 250);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setWindowTitle(tr("PCA of Samples"));
+    connect(&watcher, &QFutureWatcher<SamplePca>::finished, this, &SamplePcaView::computationFinished);
+}
+
+SamplePcaView::~SamplePcaView()
+{
+    if (cancelRequested) {
+        cancelRequested->store(1);
+    }
+}
+
+void SamplePcaView::setData(const FeatureMatrix &matrix, const IntensityNormalization &normalization,
+    const QStringList &sampleNames, const QStringList &sampleTypes)
+{
+    Q_ASSERT(sampleNames.size() == matrix.getSampleCount() && sampleTypes.size() == matrix.getSampleCount());
+    this->matrix = matrix;
+    this->normalization = normalization;
+    this->sampleNames = sampleNames;
+    this->sampleTypes = sampleTypes;
+    types = sampleTypes;
+    types.removeDuplicates();
+    types.sort();
+    startComputation();
+}
+
+void SamplePcaView::startComputation()
+{
+    // a computation still running is superseded, it stops at its next iteration and the watcher drops its result
+    if (cancelRequested) {
+        cancelRequested->store(1);
+    }
+    const QSharedPointer<QAtomicInt> canceled(new QAtomicInt(0));
+    cancelRequested = canceled;
+    pca = SamplePca();
+    watcher.setFuture(QtConcurrent::run(&SamplePca::compute, matrix, normalization, unitVariance,
+        FeatureMatrixUtils::ProgressCallback([canceled] (int) { return 0 == canceled->load(); })));
+    update();
+}
+
+void SamplePcaView::computationFinished()
+{
+    pca = watcher.result();
+    if (yComponent >= pca.getComponentCount()) {
+        xComponent = 0;
+        yComponent = 1;
+    }
+    update();
+}
+
+QRect SamplePcaView::getPlotRect() const
+{
+    return rect().adjusted(PLOT_MARGIN, PLOT_MARGIN / 2, -PLOT_MARGIN / 2, -PLOT_MARGIN);
+}
+
+QPointF SamplePcaView::toWidget(qreal x, qreal y) const
+{
+    const QRect plotRect = getPlotRect();
+    return QPointF(plotRect.left() + (x - dataRect.left()) / dataRect.width() * plotRect.width(),
+        plotRect.bottom() - (y - dataRect.top()) / dataRect.height() * plotRect.height());
+}
+
+int SamplePcaView::findSample(const QPoint &pos) const
+{
+    if (pca.getComponentCount() < 2) {
+        return -1;
+    }
+    int nearestSample = -1;
+    qreal nearestDistance = CLICK_RADIUS * CLICK_RADIUS;
+    for (int sampleNumber = 0; sampleNumber < pca.getSampleCount(); ++sampleNumber) {
+        const QPointF offset = toWidget(pca.getScore(sampleNumber, xComponent), pca.getScore(sampleNumber, yComponent)) - pos;
+        const qreal distance = QPointF::dotProduct(offset, offset);
+        if (distance <= nearestDistance) {
+            nearestDistance = distance;
+            nearestSample = sampleNumber;
+        }
+    }
+    return nearestSample;
+}
+
+QColor SamplePcaView::getTypeColor(const QString &type) const
+{
+    static const QColor colors[] = {
+        QColor(31, 119, 180), QColor(255, 127, 14), QColor(44, 160, 44), QColor(214, 39, 40), QColor(148, 103, 189),
+        QColor(140, 86, 75), QColor(227, 119, 194), QColor(127, 127, 127), QColor(188, 189, 34), QColor(23, 190, 207)
+    };
+    if (type.isEmpty()) {
+        return palette().color(QPalette::Mid);
+    }
+    return colors[types.indexOf(type) % (sizeof(colors) / sizeof(colors[0]))];
+}
+
+void SamplePcaView::drawLegend(QPainter &painter)
+{
+    const QRect plotRect = getPlotRect();
+    const QFontMetrics metrics = painter.fontMetrics();
+    int y = plotRect.top() + 4;
+    foreach (const QString &type, types) {
+        const QString label = type.isEmpty() ? tr("No type") : type;
+        const int x = plotRect.right() - 4 - metrics.width(label);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(getTypeColor(type));
+        painter.drawEllipse(QPointF(x - POINT_RADIUS - 4, y + metrics.height() / 2.0), POINT_RADIUS, POINT_RADIUS);
+        painter.setPen(palette().color(QPalette::WindowText));
+        painter.drawText(QPointF(x, y + metrics.ascent()), label);
+        y += metrics.height();
+    }
+}
+
+void SamplePcaView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    painter.setPen(palette().color(QPalette::WindowText));
+    if (watcher.isRunning()) {
+        painter.drawText(rect(), Qt::AlignCenter, tr("Computing principal components..."));
+        return;
+    } else if (pca.getComponentCount() < 2) {
+        painter.drawText(rect(), Qt::AlignCenter, tr("Not enough samples or features with varying intensities."));
+        return;
+    }
+
+    // the extent is symmetric around the origin, so that the centered data is seen around it
+    qreal maxAbsX = 0.0;
+    qreal maxAbsY = 0.0;
+    for (int sampleNumber = 0; sampleNumber < pca.getSampleCount(); ++sampleNumber) {
+        maxAbsX = qMax(maxAbsX, qAbs(pca.getScore(sampleNumber, xComponent)));
+        maxAbsY = qMax(maxAbsY, qAbs(pca.getScore(sampleNumber, yComponent)));
+    }
+    maxAbsX = qMax(maxAbsX * 1.1, 1e-9);
+    maxAbsY = qMax(maxAbsY * 1.1, 1e-9);
+    dataRect = QRectF(-maxAbsX, -maxAbsY, 2.0 * maxAbsX, 2.0 * maxAbsY);
+
+    const QRect plotRect = getPlotRect();
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(plotRect);
+    painter.setPen(QPen(palette().color(QPalette::Mid), 1, Qt::DashLine));
+    painter.drawLine(toWidget(0.0, dataRect.top()), toWidget(0.0, dataRect.bottom()));
+    painter.drawLine(toWidget(dataRect.left(), 0.0), toWidget(dataRect.right(), 0.0));
+
+    painter.setPen(palette().color(QPalette::WindowText));
+    const QFontMetrics metrics = painter.fontMetrics();
+    const QString xLabel = tr("PC%1 (%2% of variance)").arg(xComponent + 1)
+        .arg(100.0 * pca.getExplainedVariance(xComponent), 0, 'f', 1);
+    const QString yLabel = tr("PC%1 (%2% of variance)").arg(yComponent + 1)
+        .arg(100.0 * pca.getExplainedVariance(yComponent), 0, 'f', 1);
+    painter.drawText(QRect(plotRect.left(), height() - metrics.height() - 8, plotRect.width(), metrics.height()),
+        Qt::AlignCenter, xLabel);
+    painter.save();
+    painter.translate(PLOT_MARGIN / 2, plotRect.center().y());
+    painter.rotate(-90);
+    painter.drawText(QRect(-plotRect.height() / 2, -metrics.height() / 2, plotRect.height(), metrics.height()),
+        Qt::AlignCenter, yLabel);
+    painter.restore();
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    for (int sampleNumber = 0; sampleNumber < pca.getSampleCount(); ++sampleNumber) {
+        QColor color = getTypeColor(sampleTypes[sampleNumber]);
+        color.setAlpha(200);
+        painter.setBrush(color);
+        painter.drawEllipse(toWidget(pca.getScore(sampleNumber, xComponent), pca.getScore(sampleNumber, yComponent)),
+            POINT_RADIUS, POINT_RADIUS);
+    }
+    if (types != QStringList(QString())) { // types aren't set in the database
+        drawLegend(painter);
+    }
+}
+
+bool SamplePcaView::event(QEvent *event)
+{
+    if (QEvent::ToolTip == event->type()) {
+        const QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        const int sampleNumber = findSample(helpEvent->pos());
+        if (-1 != sampleNumber) {
+            QToolTip::showText(helpEvent->globalPos(), sampleNames[sampleNumber], this);
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void SamplePcaView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (Qt::LeftButton != event->button()) {
+        return;
+    }
+    const int sampleNumber = findSample(event->pos());
+    if (-1 != sampleNumber) {
+        emit sampleClicked(sampleNumber);
+    }
+}
+
+void SamplePcaView::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QList<QPair<int, int> > componentPairs;
+    componentPairs << qMakePair(0, 1) << qMakePair(0, 2) << qMakePair(1, 2);
+    QList<QAction *> pairActions;
+    for (int i = 0; i < componentPairs.size(); ++i) {
+        QAction *action = menu.addAction(tr("PC%1 vs. PC%2").arg(componentPairs[i].first + 1).arg(componentPairs[i].second + 1));
+        action->setCheckable(true);
+        action->setChecked(componentPairs[i].first == xComponent && componentPairs[i].second == yComponent);
+        action->setEnabled(componentPairs[i].second < pca.getComponentCount());
+        pairActions.append(action);
+    }
+    menu.addSeparator();
+    QAction *scalingAction = menu.addAction(tr("Scale features to unit variance"));
+    scalingAction->setCheckable(true);
+    scalingAction->setChecked(unitVariance);
+
+    QAction *chosenAction = menu.exec(event->globalPos());
+    if (scalingAction == chosenAction) {
+        unitVariance = !unitVariance;
+        startComputation();
+    } else if (pairActions.contains(chosenAction)) {
+        const QPair<int, int> &componentPair = componentPairs[pairActions.indexOf(chosenAction)];
+        xComponent = componentPair.first;
+        yComponent = componentPair.second;
+        update();
+    }
+}
+
+} // namespace ov
@@ -0,0 +1,66 @@
+#ifndef SAMPLE_PCA_VIEW_H
+#define SAMPLE_PCA_VIEW_H
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QWidget>
+
+#include "FeatureMatrix.h"
+#include "IntensityNormalization.h"
+#include "SamplePca.h"
+
+namespace ov {
+
+// Scores plot of principal components of samples, colored by sample type. Components are computed
+// on a worker thread whenever the data or the scaling changes. A click on a point reports its sample number.
+class SamplePcaView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SamplePcaView(QWidget *parent = NULL);
+    ~SamplePcaView();
+
+    void setData(const FeatureMatrix &matrix, const IntensityNormalization &normalization, const QStringList &sampleNames,
+        const QStringList &sampleTypes);
+
+signals:
+    void sampleClicked(int sampleNumber);
+
+protected:
+    bool event(QEvent *event);
+    void paintEvent(QPaintEvent *event);
+    void mouseReleaseEvent(QMouseEvent *event);
+    void contextMenuEvent(QContextMenuEvent *event);
+
+private slots:
+    void computationFinished();
+
+private:
+    void startComputation();
+    QRect getPlotRect() const;
+    QPointF toWidget(qreal x, qreal y) const;
+    int findSample(const QPoint &pos) const; // -1 if no point is near
+    QColor getTypeColor(const QString &type) const;
+    void drawLegend(QPainter &painter);
+
+    FeatureMatrix matrix;
+    IntensityNormalization normalization;
+    QStringList sampleNames;
+    QStringList sampleTypes;
+    QStringList types; // distinct, sorted
+    bool unitVariance;
+    QFutureWatcher<SamplePca> watcher;
+    QSharedPointer<QAtomicInt> cancelRequested; // of the latest computation, it may outlive the view
+
+    SamplePca pca;
+    int xComponent;
+    int yComponent;
+    QRectF dataRect;
+};
+
+} // namespace ov
+
+#endif // SAMPLE_PCA_VIEW_H
@@ -0,0 +1,61 @@
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QStandardItemModel>
+#include <QTableView>
+#include <QVBoxLayout>
+
+#include "FeatureMatrix.h"
+
+#include "SampleStatisticsDialog.h"
+
+namespace ov {
+
+namespace {
+
+QStandardItem * createNumberItem(const QVariant &value)
+{
+    // numbers are kept as numbers, so that the model sorts them by value
+    QStandardItem *item = new QStandardItem;
+    item->setData(value, Qt::DisplayRole);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+}
+
+SampleStatisticsDialog::SampleStatisticsDialog(const FeatureMatrix &matrix, const QStringList &sampleNames, QWidget *parent)
+    : QDialog(parent)
+{
+    Q_ASSERT(sampleNames.size() == matrix.getSampleCount());
+    setWindowTitle(tr("Sample Statistics"));
+
+    QStandardItemModel *model = new QStandardItemModel(0, 5, this);
+    model->setHorizontalHeaderLabels(QStringList() << tr("Sample") << tr("Detected features") << tr("Total intensity")
+        << tr("Median intensity") << tr("Max intensity"));
+    for (int sampleNumber = 0; sampleNumber < matrix.getSampleCount(); ++sampleNumber) {
+        const SampleStatistics &statistics = matrix.getSampleStatistics(sampleNumber);
+        model->appendRow(QList<QStandardItem *>() << new QStandardItem(sampleNames[sampleNumber])
+            << createNumberItem(statistics.featureCount) << createNumberItem(statistics.totalIntensity)
+            << createNumberItem(statistics.medianIntensity) << createNumberItem(statistics.maxIntensity));
+    }
+
+    QTableView *tableView = new QTableView(this);
+    tableView->setModel(model);
+    tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tableView->setSortingEnabled(true);
+    tableView->sortByColumn(0, Qt::AscendingOrder);
+    tableView->verticalHeader()->hide();
+    tableView->horizontalHeader()->setStretchLastSection(true);
+    tableView->resizeColumnsToContents();
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(tableView);
+    layout->addWidget(buttonBox);
+    resize(640, 480);
+}
+
+} // namespace ov
@@ -0,0 +1,21 @@
+#ifndef SAMPLE_STATISTICS_DIALOG_H
+#define SAMPLE_STATISTICS_DIALOG_H
+
+#include <QDialog>
+
+namespace ov {
+
+class FeatureMatrix;
+
+// Sortable table of per-sample statistics of the feature matrix, one row per sample
+class SampleStatisticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    SampleStatisticsDialog(const FeatureMatrix &matrix, const QStringList &sampleNames, QWidget *parent);
+};
+
+} // namespace ov
+
+#endif // SAMPLE_STATISTICS_DIALOG_H
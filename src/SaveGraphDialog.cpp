@@ -1,3 +1,4 @@
+#include <QComboBox>
 #include <QLabel>
 #include <QGridLayout>
 #include <QSlider>
@@ -8,7 +9,8 @@
 namespace ov {
 
 SaveGraphDialog::SaveGraphDialog(QWidget *parent, const FormatId &selectedFormat)
-    : QFileDialog(parent, tr("Save File")), selectedScale(1), selectedQuality(100)
+    : QFileDialog(parent, tr("Save File")), selectedScale(1), selectedQuality(100),
+    selectedGraphTableLayout(CsvWritingUtils::WIDE_GRAPH_TABLE)
 {
     initFilters();
     setOption(QFileDialog::DontUseNativeDialog);
@@ -61,7 +63,7 @@ void SaveGraphDialog::setupUi()
     QDoubleSpinBox *scaleSetter = new QDoubleSpinBox();
     scaleSetter->setSingleStep(0.1);
     scaleSetter->setMinimum(1);
-    scaleSetter->setMaximum(10);
+    scaleSetter->setMaximum(50); // PNG and TIFF images are rendered in strips, so poster sizes are fine
     scaleSetter->setValue(1);
 
     connect(scaleSetter, SIGNAL(valueChanged(double)), SLOT(scaleChanged(double)));
@@ -96,6 +98,21 @@ void SaveGraphDialog::setupUi()
     l->addWidget(qualitySpinBox, currentRow, 2);
     qualityControllers.append(qualitySpinBox);
 
+    ++currentRow;
+
+    QLabel *layoutLabel = new QLabel(tr("Layout:"));
+    l->addWidget(layoutLabel, currentRow, 0);
+    layoutControllers.append(layoutLabel);
+
+    QComboBox *layoutSelector = new QComboBox();
+    layoutSelector->addItem(tr("Column per graph"), CsvWritingUtils::WIDE_GRAPH_TABLE);
+    layoutSelector->addItem(tr("Row per point"), CsvWritingUtils::LONG_GRAPH_TABLE);
+
+    connect(layoutSelector, SIGNAL(currentIndexChanged(int)), SLOT(graphTableLayoutChanged(int)));
+
+    l->addWidget(layoutSelector, currentRow, 1);
+    layoutControllers.append(layoutSelector);
+
     connect(this, &QFileDialog::filterSelected, this, &SaveGraphDialog::filterSelected);
 }
 
@@ -114,6 +131,11 @@ QString SaveGraphDialog::getSelectedFormat() const
     return formatByFilter[selectedNameFilter()];
 }
 
+CsvWritingUtils::GraphTableLayout SaveGraphDialog::getGraphTableLayout() const
+{
+    return selectedGraphTableLayout;
+}
+
 void SaveGraphDialog::qualityChanged(int value)
 {
     selectedQuality = value;
@@ -124,6 +146,11 @@ void SaveGraphDialog::scaleChanged(double value)
     selectedScale = value;
 }
 
+void SaveGraphDialog::graphTableLayoutChanged(int index)
+{
+    selectedGraphTableLayout = 0 == index ? CsvWritingUtils::WIDE_GRAPH_TABLE : CsvWritingUtils::LONG_GRAPH_TABLE;
+}
+
 namespace {
 
 void setWidgetsVisibility(const QList<QWidget *> &widgets, bool visibility)
@@ -139,17 +166,21 @@ void SaveGraphDialog::filterSelected(const QString &filter)
     if (ExportFormats::lossyImageFormats.contains(selectedFormat)) {
         setWidgetsVisibility(scaleControllers, true);
         setWidgetsVisibility(qualityControllers, true);
+        setWidgetsVisibility(layoutControllers, false);
     } else if (ExportFormats::resizableVectorImageFormats.contains(selectedFormat)
         || ExportFormats::losslessImageFormats.contains(selectedFormat))
     {
         setWidgetsVisibility(scaleControllers, true);
         setWidgetsVisibility(qualityControllers, false);
+        setWidgetsVisibility(layoutControllers, false);
     } else if (ExportFormats::fixedSizeVectorImageFormats.contains(selectedFormat)) {
         setWidgetsVisibility(scaleControllers, false);
         setWidgetsVisibility(qualityControllers, false);
+        setWidgetsVisibility(layoutControllers, false);
     } else if (ExportFormats::dataFormats.contains(selectedFormat)) {
         setWidgetsVisibility(scaleControllers, false);
         setWidgetsVisibility(qualityControllers, false);
+        setWidgetsVisibility(layoutControllers, true);
     } else {
         Q_ASSERT(false);
     }
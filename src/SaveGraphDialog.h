@@ -4,6 +4,7 @@
 #include <QMap>
 #include <QFileDialog>
 
+#include "CsvWritingUtils.h"
 #include "Globals.h"
 
 namespace ov {
@@ -18,11 +19,13 @@ public:
     double getScale() const;
     int getQuality() const;
     QString getSelectedFormat() const;
+    CsvWritingUtils::GraphTableLayout getGraphTableLayout() const;
 
 private slots:
     void filterSelected(const QString &filter);
     void qualityChanged(int value);
     void scaleChanged(double value);
+    void graphTableLayoutChanged(int index);
 
 private:
     void setupUi();
@@ -30,10 +33,12 @@ private:
 
     double selectedScale;
     int selectedQuality;
+    CsvWritingUtils::GraphTableLayout selectedGraphTableLayout;
     QMap<QString, QString> formatByFilter;
 
     QList<QWidget *> qualityControllers;
     QList<QWidget *> scaleControllers;
+    QList<QWidget *> layoutControllers;
 };
 
 } // namespace ov
@@ -0,0 +1,169 @@
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "SparklineCache.h"
+
+const int SPARKLINE_CACHE_SIZE = 200000; // profiles, each takes about a hundred bytes
+const quint32 SIDECAR_MAGIC = 0x4f565350; // "OVSP"
+const quint32 SIDECAR_VERSION = 1;
+
+namespace ov {
+
+SparklineCache::SparklineCache()
+    : sparklines(SPARKLINE_CACHE_SIZE), modified(false), loader(NULL)
+{
+    requestTimer.setSingleShot(true);
+    requestTimer.setInterval(0); // requests of a single paint event go to the loader together
+    connect(&requestTimer, &QTimer::timeout, this, &SparklineCache::sendRequests);
+
+    // profiles are only a hint, so they're loaded with the lowest priority not to slow down anything else
+    loader = new FeatureDataLoader;
+    loader->moveToThread(&loaderThread);
+    connect(&loaderThread, &QThread::finished, loader, &QObject::deleteLater);
+
+    connect(this, &SparklineCache::loaderDataSourceChanged, loader, &FeatureDataLoader::setDataSource);
+    connect(this, &SparklineCache::loadRequested, loader, &FeatureDataLoader::loadSparklines);
+    connect(loader, &FeatureDataLoader::sparklinesLoaded, this, &SparklineCache::sparklinesLoaded);
+
+    loaderThread.start(QThread::LowestPriority);
+}
+
+SparklineCache::~SparklineCache()
+{
+    saveSidecar();
+    loaderThread.quit();
+    loaderThread.wait();
+}
+
+void SparklineCache::setDataSource(const DataSourceId &dataSourceId)
+{
+    saveSidecar();
+
+    this->dataSourceId = dataSourceId;
+    sparklines.clear();
+    requestedKeys.clear();
+    pendingRequests.clear();
+    modified = false;
+    loadSidecar();
+
+    emit loaderDataSourceChanged(dataSourceId);
+}
+
+bool SparklineCache::getSparkline(const SampleId &sampleId, const FeatureId &featureId, QByteArray &sparkline)
+{
+    const SampleFeatureKey key(sampleId, featureId);
+    const QByteArray *cachedSparkline = sparklines.object(key);
+    if (NULL != cachedSparkline) {
+        sparkline = *cachedSparkline;
+        return true;
+    }
+    if (!dataSourceId.isEmpty() && !requestedKeys.contains(key)) {
+        requestedKeys.insert(key);
+        pendingRequests.insert(sampleId, featureId);
+        requestTimer.start();
+    }
+    return false;
+}
+
+void SparklineCache::sendRequests()
+{
+    if (!pendingRequests.isEmpty()) {
+        emit loadRequested(pendingRequests);
+        pendingRequests.clear();
+    }
+}
+
+void SparklineCache::sparklinesLoaded(const DataSourceId &dataSourceId, const SparklinesByFeature &loadedSparklines)
+{
+    if (dataSourceId != this->dataSourceId) {
+        return; // the data source was changed while the request was processed
+    }
+    SparklinesByFeature::const_iterator it = loadedSparklines.constBegin();
+    for (; it != loadedSparklines.constEnd(); ++it) {
+        sparklines.insert(it.key(), new QByteArray(it.value()));
+        requestedKeys.remove(it.key()); // evicted profiles can be requested again
+    }
+    modified = true;
+    emit sparklinesReady();
+}
+
+QPair<qint64, qint64> SparklineCache::getDataSourceStamp() const
+{
+    const QFileInfo dataSourceInfo(dataSourceId);
+    return QPair<qint64, qint64>(dataSourceInfo.size(), dataSourceInfo.lastModified().toMSecsSinceEpoch());
+}
+
+QString SparklineCache::getSidecarPath() const
+{
+    const QFileInfo dataSourceInfo(dataSourceId);
+    if (QFileInfo(dataSourceInfo.absolutePath()).isWritable()) {
+        return dataSourceInfo.absoluteFilePath() + ".sparklines";
+    }
+    // databases in read-only locations get their sidecars in the user's cache
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    const QByteArray pathHash = QCryptographicHash::hash(dataSourceInfo.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    return QDir(cacheDir).filePath(QString::fromLatin1(pathHash.toHex()) + ".sparklines");
+}
+
+bool SparklineCache::loadSidecar()
+{
+    QFile file(getSidecarPath());
+    if (dataSourceId.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_5);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 pointCount = 0;
+    QPair<qint64, qint64> stamp;
+    qint32 count = 0;
+    in >> magic >> version >> pointCount >> stamp.first >> stamp.second >> count;
+    // the sidecar is stale if the database has been rewritten since the profiles were computed
+    if (QDataStream::Ok != in.status() || SIDECAR_MAGIC != magic || SIDECAR_VERSION != version
+        || FeatureDataLoader::SPARKLINE_POINT_COUNT != pointCount || getDataSourceStamp() != stamp)
+    {
+        return false;
+    }
+
+    for (qint32 i = 0; i < count && QDataStream::Ok == in.status(); ++i) {
+        SampleFeatureKey key;
+        QByteArray *sparkline = new QByteArray;
+        in >> key.first >> key.second >> *sparkline;
+        sparklines.insert(key, sparkline);
+    }
+    return QDataStream::Ok == in.status();
+}
+
+bool SparklineCache::saveSidecar() const
+{
+    if (!modified || dataSourceId.isEmpty()) {
+        return true;
+    }
+    const QString sidecarPath = getSidecarPath();
+    QDir().mkpath(QFileInfo(sidecarPath).absolutePath());
+    QSaveFile file(sidecarPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_5);
+
+    const QList<SampleFeatureKey> keys = sparklines.keys();
+    const QPair<qint64, qint64> stamp = getDataSourceStamp();
+    out << SIDECAR_MAGIC << SIDECAR_VERSION << qint32(FeatureDataLoader::SPARKLINE_POINT_COUNT) << stamp.first << stamp.second
+        << qint32(keys.size());
+    foreach (const SampleFeatureKey &key, keys) {
+        out << key.first << key.second << *sparklines.object(key);
+    }
+    return QDataStream::Ok == out.status() && file.commit();
+}
+
+} // namespace ov
@@ -0,0 +1,61 @@
+#ifndef SPARKLINE_CACHE_H
+#define SPARKLINE_CACHE_H
+
+#include <QCache>
+#include <QObject>
+#include <QSet>
+#include <QThread>
+#include <QTimer>
+
+#include "FeatureDataLoader.h"
+
+namespace ov {
+
+// Downsampled XICs of (sample, feature) pairs for drawing elution profiles in table cells. Profiles are computed
+// from mass traces by a loader in a low priority thread of its own and kept in a bounded cache, which is saved
+// to a sidecar file next to the database, so that they're available immediately when the database is opened again.
+class SparklineCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    SparklineCache();
+    ~SparklineCache();
+
+    // saves profiles of the previous data source and loads the ones saved for the new data source if any
+    void setDataSource(const DataSourceId &dataSourceId);
+
+    // never blocks: if the profile isn't cached yet, it's scheduled for loading and false is returned
+    bool getSparkline(const SampleId &sampleId, const FeatureId &featureId, QByteArray &sparkline);
+
+signals:
+    void sparklinesReady();
+
+    void loaderDataSourceChanged(const DataSourceId &dataSourceId);
+    void loadRequested(const SampleFeatureIds &featuresBySample);
+
+private slots:
+    void sendRequests();
+    void sparklinesLoaded(const DataSourceId &dataSourceId, const SparklinesByFeature &loadedSparklines);
+
+private:
+    bool loadSidecar();
+    bool saveSidecar() const;
+    QString getSidecarPath() const;
+    QPair<qint64, qint64> getDataSourceStamp() const; // (size, modification time) of the database file
+
+    DataSourceId dataSourceId;
+    QCache<SampleFeatureKey, QByteArray> sparklines;
+    bool modified; // since the sidecar was loaded
+
+    QSet<SampleFeatureKey> requestedKeys; // sent to the loader or waiting in pendingRequests
+    SampleFeatureIds pendingRequests;
+    QTimer requestTimer;
+
+    QThread loaderThread;
+    FeatureDataLoader *loader;
+};
+
+} // namespace ov
+
+#endif // SPARKLINE_CACHE_H
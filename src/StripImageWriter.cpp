@@ -0,0 +1,280 @@
+#include <QIODevice>
+#include <QImage>
+
+#include "StripImageWriter.h"
+
+const int COMPRESSED_CHUNK_SIZE = 1 << 18; // bytes, also the size of PNG IDAT chunks
+const int BYTES_PER_PIXEL = 3;
+const uchar PNG_SUB_FILTER = 1;
+const quint16 TIFF_SHORT = 3;
+const quint16 TIFF_LONG = 4;
+const quint16 TIFF_DEFLATE_COMPRESSION = 8;
+const quint16 TIFF_RGB_PHOTOMETRIC = 2;
+const quint64 TIFF_MAX_OFFSET = 0xFFFFFFFF;
+
+namespace ov {
+
+namespace {
+
+void appendBigEndian32(QByteArray &data, quint32 value)
+{
+    data.append(char(value >> 24));
+    data.append(char(value >> 16));
+    data.append(char(value >> 8));
+    data.append(char(value));
+}
+
+void appendLittleEndian16(QByteArray &data, quint16 value)
+{
+    data.append(char(value));
+    data.append(char(value >> 8));
+}
+
+void appendLittleEndian32(QByteArray &data, quint32 value)
+{
+    appendLittleEndian16(data, quint16(value));
+    appendLittleEndian16(data, quint16(value >> 16));
+}
+
+void appendTiffEntry(QByteArray &directory, quint16 tag, quint16 type, quint32 count, quint32 value)
+{
+    appendLittleEndian16(directory, tag);
+    appendLittleEndian16(directory, type);
+    appendLittleEndian32(directory, count);
+    if (TIFF_SHORT == type && 1 == count) {
+        appendLittleEndian16(directory, quint16(value)); // values are left-aligned in the 4-byte field
+        appendLittleEndian16(directory, 0);
+    } else {
+        appendLittleEndian32(directory, value);
+    }
+}
+
+}
+
+StripImageWriter::StripImageWriter(Format format, QIODevice *device, const QSize &size, int rowsPerStrip, int compressionLevel)
+    : format(format), device(device), size(size), rowsPerStrip(rowsPerStrip), compressionLevel(qBound(0, compressionLevel, 9)),
+    writtenRows(0), error(false), tooLarge(false), streamInitialized(false)
+{
+    Q_ASSERT(NULL != device && !size.isEmpty() && rowsPerStrip > 0);
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    error = !writeHeader();
+}
+
+StripImageWriter::~StripImageWriter()
+{
+    if (streamInitialized) {
+        deflateEnd(&stream);
+    }
+}
+
+bool StripImageWriter::writeHeader()
+{
+    QByteArray header;
+    if (PNG_FORMAT == format) {
+        if (Z_OK != deflateInit(&stream, compressionLevel)) {
+            return false;
+        }
+        streamInitialized = true;
+        compressed.resize(COMPRESSED_CHUNK_SIZE);
+        stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+        stream.avail_out = COMPRESSED_CHUNK_SIZE;
+
+        header.append("\x89PNG\r\n\x1a\n", 8);
+        if (device->write(header) != header.size()) {
+            return false;
+        }
+        QByteArray imageHeader;
+        appendBigEndian32(imageHeader, size.width());
+        appendBigEndian32(imageHeader, size.height());
+        imageHeader.append(char(8)); // bit depth
+        imageHeader.append(char(2)); // truecolor
+        imageHeader.append(char(0)); // deflate
+        imageHeader.append(char(0)); // adaptive filtering
+        imageHeader.append(char(0)); // no interlace
+        return writePngChunk("IHDR", imageHeader);
+    } else {
+        if (device->isSequential()) {
+            return false;
+        }
+        header.append("II", 2);
+        appendLittleEndian16(header, 42);
+        appendLittleEndian32(header, 0); // directory offset, written when all strips are known
+        return device->write(header) == header.size();
+    }
+}
+
+void StripImageWriter::convertRows(const QImage &strip, int rowPrefixSize, QByteArray &rows) const
+{
+    const QImage rgbStrip = QImage::Format_RGB32 == strip.format() || QImage::Format_ARGB32 == strip.format()
+        || QImage::Format_ARGB32_Premultiplied == strip.format() ? strip : strip.convertToFormat(QImage::Format_RGB32);
+    const int width = size.width();
+    const int rowSize = rowPrefixSize + width * BYTES_PER_PIXEL;
+    rows.resize(rowSize * rgbStrip.height());
+    uchar *output = reinterpret_cast<uchar *>(rows.data());
+    for (int y = 0; y < rgbStrip.height(); ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(rgbStrip.constScanLine(y));
+        uchar *row = output + y * rowSize;
+        for (int i = 0; i < rowPrefixSize; ++i) {
+            *row++ = 0;
+        }
+        for (int x = 0; x < width; ++x) {
+            *row++ = qRed(line[x]);
+            *row++ = qGreen(line[x]);
+            *row++ = qBlue(line[x]);
+        }
+    }
+}
+
+bool StripImageWriter::writeStrip(const QImage &strip)
+{
+    if (error) {
+        return false;
+    }
+    Q_ASSERT(strip.width() == size.width());
+    Q_ASSERT(strip.height() == rowsPerStrip || writtenRows + strip.height() == size.height());
+    const int rowCount = qMin(strip.height(), size.height() - writtenRows);
+    if (rowCount <= 0) {
+        return true;
+    }
+    const QImage rows = rowCount == strip.height() ? strip : strip.copy(0, 0, size.width(), rowCount);
+
+    QByteArray data;
+    if (PNG_FORMAT == format) {
+        convertRows(rows, 1, data);
+        // "Sub" filter: every byte is replaced with its difference from the same channel of the previous pixel
+        const int rowSize = 1 + size.width() * BYTES_PER_PIXEL;
+        uchar *output = reinterpret_cast<uchar *>(data.data());
+        for (int y = 0; y < rowCount; ++y) {
+            uchar *row = output + y * rowSize;
+            for (int i = rowSize - 1; i > BYTES_PER_PIXEL; --i) {
+                row[i] = uchar(row[i] - row[i - BYTES_PER_PIXEL]);
+            }
+            row[0] = PNG_SUB_FILTER;
+        }
+        error = !deflateRows(data, Z_NO_FLUSH);
+    } else {
+        convertRows(rows, 0, data);
+        uLongf compressedSize = compressBound(data.size());
+        compressed.resize(compressedSize);
+        error = Z_OK != compress2(reinterpret_cast<Bytef *>(compressed.data()), &compressedSize,
+            reinterpret_cast<const Bytef *>(data.constData()), data.size(), compressionLevel);
+        if (!error && quint64(device->pos()) + compressedSize > TIFF_MAX_OFFSET) {
+            error = tooLarge = true;
+        }
+        if (!error) {
+            stripOffsets.append(device->pos());
+            stripByteCounts.append(compressedSize);
+            error = device->write(compressed.constData(), compressedSize) != qint64(compressedSize);
+        }
+    }
+    writtenRows += rowCount;
+    return !error;
+}
+
+bool StripImageWriter::writePngChunk(const char *type, const QByteArray &data)
+{
+    QByteArray chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian32(chunk, data.size());
+    chunk.append(type, 4);
+    chunk.append(data);
+    const uLong crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(chunk.constData() + 4), data.size() + 4);
+    appendBigEndian32(chunk, crc);
+    return device->write(chunk) == chunk.size();
+}
+
+bool StripImageWriter::deflateRows(const QByteArray &rows, int flush)
+{
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(rows.constData()));
+    stream.avail_in = rows.size();
+    int result = Z_OK;
+    do {
+        result = deflate(&stream, flush);
+        if (Z_STREAM_ERROR == result) {
+            return false;
+        }
+        const bool streamEnded = Z_STREAM_END == result;
+        if (0 == stream.avail_out || (streamEnded && stream.avail_out < uInt(COMPRESSED_CHUNK_SIZE))) {
+            if (!writePngChunk("IDAT", compressed.left(COMPRESSED_CHUNK_SIZE - stream.avail_out))) {
+                return false;
+            }
+            stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+            stream.avail_out = COMPRESSED_CHUNK_SIZE;
+        }
+    } while (stream.avail_in > 0 || (Z_FINISH == flush && Z_STREAM_END != result));
+    return true;
+}
+
+bool StripImageWriter::writeTiffDirectory()
+{
+    if (device->pos() % 2 != 0 && device->write("\0", 1) != 1) {
+        return false; // the directory must begin on a word boundary
+    }
+    const quint16 entryCount = 10;
+    const int stripCount = stripOffsets.size();
+    const quint64 directorySize = 2 + entryCount * 12 + 4 + BYTES_PER_PIXEL * 2 + (stripCount > 1 ? stripCount * 8 : 0);
+    if (quint64(device->pos()) + directorySize > TIFF_MAX_OFFSET) {
+        tooLarge = true;
+        return false;
+    }
+    const quint32 directoryOffset = device->pos();
+    const quint32 dataOffset = directoryOffset + 2 + entryCount * 12 + 4;
+    const quint32 bitsPerSampleOffset = dataOffset;
+    const quint32 stripOffsetsOffset = bitsPerSampleOffset + BYTES_PER_PIXEL * 2;
+    const quint32 stripByteCountsOffset = stripOffsetsOffset + stripCount * 4;
+
+    QByteArray directory;
+    appendLittleEndian16(directory, entryCount);
+    appendTiffEntry(directory, 256, TIFF_LONG, 1, size.width());
+    appendTiffEntry(directory, 257, TIFF_LONG, 1, size.height());
+    appendTiffEntry(directory, 258, TIFF_SHORT, BYTES_PER_PIXEL, bitsPerSampleOffset);
+    appendTiffEntry(directory, 259, TIFF_SHORT, 1, TIFF_DEFLATE_COMPRESSION);
+    appendTiffEntry(directory, 262, TIFF_SHORT, 1, TIFF_RGB_PHOTOMETRIC);
+    appendTiffEntry(directory, 273, TIFF_LONG, stripCount, 1 == stripCount ? stripOffsets.first() : stripOffsetsOffset);
+    appendTiffEntry(directory, 277, TIFF_SHORT, 1, BYTES_PER_PIXEL);
+    appendTiffEntry(directory, 278, TIFF_LONG, 1, rowsPerStrip);
+    appendTiffEntry(directory, 279, TIFF_LONG, stripCount, 1 == stripCount ? stripByteCounts.first() : stripByteCountsOffset);
+    appendTiffEntry(directory, 284, TIFF_SHORT, 1, 1); // RGB values are interleaved
+    appendLittleEndian32(directory, 0); // no more directories
+
+    for (int i = 0; i < BYTES_PER_PIXEL; ++i) {
+        appendLittleEndian16(directory, 8);
+    }
+    if (stripCount > 1) {
+        foreach (quint32 offset, stripOffsets) {
+            appendLittleEndian32(directory, offset);
+        }
+        foreach (quint32 byteCount, stripByteCounts) {
+            appendLittleEndian32(directory, byteCount);
+        }
+    }
+    if (device->write(directory) != directory.size()) {
+        return false;
+    }
+
+    QByteArray headerOffset;
+    appendLittleEndian32(headerOffset, directoryOffset);
+    return device->seek(4) && device->write(headerOffset) == headerOffset.size();
+}
+
+bool StripImageWriter::isTooLarge() const
+{
+    return tooLarge;
+}
+
+bool StripImageWriter::finish()
+{
+    if (error || writtenRows != size.height()) {
+        return false;
+    }
+    if (PNG_FORMAT == format) {
+        error = !deflateRows(QByteArray(), Z_FINISH) || !writePngChunk("IEND", QByteArray());
+    } else {
+        error = !writeTiffDirectory();
+    }
+    return !error;
+}
+
+} // namespace ov
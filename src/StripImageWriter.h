@@ -0,0 +1,63 @@
+#ifndef STRIP_IMAGE_WRITER_H
+#define STRIP_IMAGE_WRITER_H
+
+#include <QByteArray>
+#include <QSize>
+#include <QVector>
+
+#include <zlib.h>
+
+class QImage;
+class QIODevice;
+
+namespace ov {
+
+// Encodes an RGB image given as a sequence of horizontal strips, so that the whole image never has to be in memory.
+// PNG is written as a single deflate stream split into IDAT chunks. TIFF is written with deflate compressed strips
+// followed by the directory, so the device must be seekable to patch the directory offset in the header.
+class StripImageWriter
+{
+public:
+    enum Format {
+        PNG_FORMAT,
+        TIFF_FORMAT
+    };
+
+    // @compressionLevel: zlib level from 0 to 9
+    StripImageWriter(Format format, QIODevice *device, const QSize &size, int rowsPerStrip, int compressionLevel);
+    ~StripImageWriter();
+
+    // strips go from top to bottom, each of them but the last one has exactly rowsPerStrip rows
+    bool writeStrip(const QImage &strip);
+    bool finish();
+
+    // TIFF offsets are 32-bit, so the file can't grow over 4 GB
+    bool isTooLarge() const;
+
+private:
+    bool writeHeader();
+    bool writePngChunk(const char *type, const QByteArray &data);
+    bool deflateRows(const QByteArray &rows, int flush);
+    bool writeTiffDirectory();
+    void convertRows(const QImage &strip, int rowPrefixSize, QByteArray &rows) const;
+
+    const Format format;
+    QIODevice *device;
+    const QSize size;
+    const int rowsPerStrip;
+    const int compressionLevel;
+    int writtenRows;
+    bool error;
+    bool tooLarge;
+
+    z_stream stream;
+    bool streamInitialized;
+    QByteArray compressed;
+
+    QVector<quint32> stripOffsets; // TIFF only
+    QVector<quint32> stripByteCounts;
+};
+
+} // namespace ov
+
+#endif // STRIP_IMAGE_WRITER_H
@@ -0,0 +1,210 @@
+#include <cmath>
+
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+
+#include "VolcanoPlotView.h"
+
+const int PLOT_MARGIN = 40;
+const qreal CLICK_RADIUS = 6.0;
+const qreal SIGNIFICANCE_LEVEL = 0.05; // of q-values
+const qreal MIN_ABS_LOG2_FOLD_CHANGE = 1.0;
+const int TICK_TARGET_COUNT = 6;
+
+namespace ov {
+
+namespace {
+
+qreal getTickStep(qreal range)
+{
+    const qreal rawStep = range / TICK_TARGET_COUNT;
+    const qreal magnitude = std::pow(10.0, std::floor(std::log10(rawStep)));
+    const qreal normalized = rawStep / magnitude;
+    return magnitude * (normalized < 1.5 ? 1.0 : normalized < 3.5 ? 2.0 : normalized < 7.5 ? 5.0 : 10.0);
+}
+
+}
+
+VolcanoPlotView::VolcanoPlotView(QWidget *parent)
+    : QWidget(parent), mannWhitney(false)
+{
+    setMinimumSize(300, 250);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void VolcanoPlotView::setStatistics(const DifferentialStatistics &statistics)
+{
+    this->statistics = statistics;
+    setWindowTitle(tr("Volcano Plot: %1 vs. %2").arg(statistics.getSecondGroupName(), statistics.getFirstGroupName()));
+    updatePoints();
+}
+
+void VolcanoPlotView::updatePoints()
+{
+    points.clear();
+    pointRows.clear();
+    significant.clear();
+    const DifferentialStatistics::Column pValueColumn = mannWhitney
+        ? DifferentialStatistics::MANN_WHITNEY_P_VALUE_COLUMN : DifferentialStatistics::T_TEST_P_VALUE_COLUMN;
+    const DifferentialStatistics::Column qValueColumn = mannWhitney
+        ? DifferentialStatistics::MANN_WHITNEY_Q_VALUE_COLUMN : DifferentialStatistics::T_TEST_Q_VALUE_COLUMN;
+
+    qreal maxAbsFoldChange = MIN_ABS_LOG2_FOLD_CHANGE;
+    qreal maxLogPValue = 1.0;
+    for (int row = 0; row < statistics.getRowCount(); ++row) {
+        const qreal foldChange = statistics.getValue(row, DifferentialStatistics::LOG2_FOLD_CHANGE_COLUMN);
+        const qreal pValue = statistics.getValue(row, pValueColumn);
+        if (std::isnan(foldChange) || std::isnan(pValue)) {
+            continue;
+        }
+        const qreal logPValue = -std::log10(qMax(pValue, 1e-300));
+        points.append(QPointF(foldChange, logPValue));
+        pointRows.append(row);
+        significant.append(statistics.getValue(row, qValueColumn) < SIGNIFICANCE_LEVEL
+            && std::fabs(foldChange) >= MIN_ABS_LOG2_FOLD_CHANGE);
+        maxAbsFoldChange = qMax(maxAbsFoldChange, std::fabs(foldChange));
+        maxLogPValue = qMax(maxLogPValue, logPValue);
+    }
+    // symmetric, so that the direction of changes is seen at once
+    dataRect = QRectF(-maxAbsFoldChange * 1.05, 0.0, 2.1 * maxAbsFoldChange, maxLogPValue * 1.05);
+    renderPoints();
+}
+
+QRect VolcanoPlotView::getPlotRect() const
+{
+    return rect().adjusted(PLOT_MARGIN, PLOT_MARGIN / 2, -PLOT_MARGIN / 2, -PLOT_MARGIN);
+}
+
+QPointF VolcanoPlotView::toWidget(const QPointF &point) const
+{
+    const QRect plotRect = getPlotRect();
+    return QPointF(plotRect.left() + (point.x() - dataRect.left()) / dataRect.width() * plotRect.width(),
+        plotRect.bottom() - (point.y() - dataRect.top()) / dataRect.height() * plotRect.height());
+}
+
+void VolcanoPlotView::renderPoints()
+{
+    pointsPixmap = QPixmap(size());
+    pointsPixmap.fill(Qt::transparent);
+    if (points.isEmpty() || getPlotRect().isEmpty()) {
+        update();
+        return;
+    }
+    QPainter painter(&pointsPixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    const QColor regularColor(128, 128, 128, 90);
+    const QColor upColor(214, 39, 40, 200);
+    const QColor downColor(31, 119, 180, 200);
+    // highlighted points go last to stay on top
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < points.size(); ++i) {
+            if (significant[i] != (1 == pass)) {
+                continue;
+            }
+            painter.setBrush(!significant[i] ? regularColor : points[i].x() > 0 ? upColor : downColor);
+            painter.drawEllipse(toWidget(points[i]), 2.0, 2.0);
+        }
+    }
+    update();
+}
+
+void VolcanoPlotView::drawAxes(QPainter &painter)
+{
+    const QRect plotRect = getPlotRect();
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(plotRect);
+
+    // thresholds of highlighted features
+    QPen thresholdPen(palette().color(QPalette::Mid), 1, Qt::DashLine);
+    painter.setPen(thresholdPen);
+    foreach (qreal x, QList<qreal>() << -MIN_ABS_LOG2_FOLD_CHANGE << MIN_ABS_LOG2_FOLD_CHANGE) {
+        const qreal widgetX = toWidget(QPointF(x, 0.0)).x();
+        painter.drawLine(QPointF(widgetX, plotRect.top()), QPointF(widgetX, plotRect.bottom()));
+    }
+
+    painter.setPen(palette().color(QPalette::WindowText));
+    const QFontMetrics metrics = painter.fontMetrics();
+    const qreal xStep = getTickStep(dataRect.width());
+    for (qreal x = std::ceil(dataRect.left() / xStep) * xStep; x <= dataRect.right(); x += xStep) {
+        const QPointF tick = toWidget(QPointF(x, dataRect.top()));
+        painter.drawLine(tick, tick + QPointF(0, 4));
+        const QString label = QString::number(std::fabs(x) < xStep / 2 ? 0.0 : x);
+        painter.drawText(QPointF(tick.x() - metrics.width(label) / 2.0, tick.y() + 4 + metrics.ascent()), label);
+    }
+    const qreal yStep = getTickStep(dataRect.height());
+    for (qreal y = 0.0; y <= dataRect.bottom(); y += yStep) {
+        const QPointF tick = toWidget(QPointF(dataRect.left(), y));
+        painter.drawLine(tick, tick - QPointF(4, 0));
+        const QString label = QString::number(y);
+        painter.drawText(QPointF(tick.x() - 6 - metrics.width(label), tick.y() + metrics.ascent() / 2.0), label);
+    }
+
+    painter.drawText(QRect(plotRect.left(), height() - metrics.height(), plotRect.width(), metrics.height()), Qt::AlignCenter,
+        tr("log2 fold change"));
+    painter.save();
+    painter.translate(metrics.height(), plotRect.center().y());
+    painter.rotate(-90);
+    painter.drawText(QRect(-plotRect.height() / 2, -metrics.height(), plotRect.height(), metrics.height()), Qt::AlignCenter,
+        mannWhitney ? tr("-log10 Mann-Whitney p-value") : tr("-log10 t-test p-value"));
+    painter.restore();
+}
+
+void VolcanoPlotView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    if (statistics.isEmpty()) {
+        return;
+    }
+    drawAxes(painter);
+    painter.drawPixmap(0, 0, pointsPixmap);
+}
+
+void VolcanoPlotView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    renderPoints();
+}
+
+void VolcanoPlotView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (Qt::LeftButton != event->button()) {
+        return;
+    }
+    int nearestPoint = -1;
+    qreal nearestDistance = CLICK_RADIUS * CLICK_RADIUS;
+    for (int i = 0; i < points.size(); ++i) {
+        const QPointF offset = toWidget(points[i]) - event->pos();
+        const qreal distance = QPointF::dotProduct(offset, offset);
+        if (distance <= nearestDistance) {
+            nearestDistance = distance;
+            nearestPoint = i;
+        }
+    }
+    if (-1 != nearestPoint) {
+        emit featureClicked(pointRows[nearestPoint]);
+    }
+}
+
+void VolcanoPlotView::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *tTestAction = menu.addAction(tr("t-test p-values"));
+    QAction *mannWhitneyAction = menu.addAction(tr("Mann-Whitney p-values"));
+    tTestAction->setCheckable(true);
+    tTestAction->setChecked(!mannWhitney);
+    mannWhitneyAction->setCheckable(true);
+    mannWhitneyAction->setChecked(mannWhitney);
+
+    const QAction *chosenAction = menu.exec(event->globalPos());
+    if (NULL != chosenAction && (mannWhitneyAction == chosenAction) != mannWhitney) {
+        mannWhitney = mannWhitneyAction == chosenAction;
+        updatePoints();
+    }
+}
+
+} // namespace ov
@@ -0,0 +1,51 @@
+#ifndef VOLCANO_PLOT_VIEW_H
+#define VOLCANO_PLOT_VIEW_H
+
+#include <QPixmap>
+#include <QVector>
+#include <QWidget>
+
+#include "DifferentialStatistics.h"
+
+namespace ov {
+
+// Scatter of log2 fold changes against -log10 p-values of all features. Features with q-value below 0.05
+// and at least twofold change are highlighted. A click on a point reports the matrix row of its feature.
+class VolcanoPlotView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit VolcanoPlotView(QWidget *parent = NULL);
+
+    void setStatistics(const DifferentialStatistics &statistics);
+
+signals:
+    void featureClicked(int row);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void mouseReleaseEvent(QMouseEvent *event);
+    void contextMenuEvent(QContextMenuEvent *event);
+
+private:
+    void updatePoints();
+    void renderPoints();
+    QRect getPlotRect() const;
+    QPointF toWidget(const QPointF &point) const;
+    void drawAxes(QPainter &painter);
+
+    DifferentialStatistics statistics;
+    bool mannWhitney; // p-values of the Mann-Whitney test instead of the t-test
+
+    QVector<QPointF> points; // (log2 fold change, -log10 p-value)
+    QVector<int> pointRows;
+    QVector<bool> significant;
+    QRectF dataRect;
+    QPixmap pointsPixmap; // points are drawn once per data or size change
+};
+
+} // namespace ov
+
+#endif // VOLCANO_PLOT_VIEW_H
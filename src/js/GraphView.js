@@ -16,6 +16,7 @@ var xicPeakZoomOffset = 7.5;
 
 var actualPlotData = {};
 var xicPlotFilling = true;
+var chartXRanges = {}; // chart id -> [min, max] of the zoomed x axis
 
 var graphColors = {
     _colorGenerationSize: 10,
@@ -41,34 +42,33 @@ function cloneObject(obj) {
     return copy;
 }
 
-function getCoordinates(chartId) {
+function getVisibleGraphs(chartId) {
+    // the plotted data is exported from the series kept by the application, only graph ids and titles are passed there
     var chart = chartsById[chartId];
-    var graphDescriptorsKey = chartId === graphExporter.xicChartId ? dataController.xicGraphDescKey :
-        xicGraphSelectionState._selectionActive ? dataController.msnGraphDescKey : dataController.ms1GraphDescKey;
-    var graphDescriptors = actualPlotData[graphDescriptorsKey];
-
-    var resultPoints = [];
-    for (var i = 0; i < chart.dataProvider.length; ++i) {
-        var originalPoint = chart.dataProvider[i];
-        var currentGraph = chart.getGraphById(originalPoint[dataController.graphIdKey]);
-        var resultPoint = {};
-        if (auxPointFlag in originalPoint || currentGraph.hidden) {
-            continue;
+    var result = [];
+    for (var i = 0; i < chart.graphs.length; ++i) {
+        var graph = chart.graphs[i];
+        if (!graph.hidden) {
+            result.push({'id': graph['id'], 'title': graph[graphTitleKey].replace('<br>', '; '), 'color': graph[graphColorKey]});
         }
+    }
+    return result;
+}
 
-        var graphId = originalPoint[dataController.graphIdKey];
-
-        var xKey = graphDescriptors[graphId][dataController.xFieldKey];
-        resultPoint['x'] = originalPoint[xKey];
-
-        var yKey = graphDescriptors[graphId][dataController.yFieldKey];
-        var graphName = currentGraph[graphTitleKey].replace('<br>', '; ');
-        resultPoint['y'] = graphName;
-        resultPoint[graphName] = originalPoint[yKey];
-
-        resultPoints.push(resultPoint);
+function getChartView(chartId) {
+    var view = {'stickPlot': chartId !== graphExporter.xicChartId || !xicPlotFilling};
+    if (chartId in chartXRanges) {
+        view['xMin'] = chartXRanges[chartId][0];
+        view['xMax'] = chartXRanges[chartId][1];
     }
-    return resultPoints;
+    return view;
+}
+
+function trackXRange(chartId) {
+    delete chartXRanges[chartId];
+    chartsById[chartId].valueAxes[0].addListener('axisZoomed', function (event) {
+        chartXRanges[chartId] = [event.startValue, event.endValue];
+    });
 }
 
 function generateFormatListMenu(chartId, formats) {
@@ -104,7 +104,7 @@ function generateFormatListMenu(chartId, formats) {
                 chart.chartScrollbar.enabled = false;
                 chartsToValidate.forEach(function(chart) { chart.validateData(); });
 
-                graphExporter.exportGraph(chartId, menuItem.label, getCoordinates(chartId));
+                graphExporter.exportGraph(chartId, menuItem.label, getVisibleGraphs(chartId), getChartView(chartId));
 
                 legend.fontSize = legendFontSize;
                 legend.markerSize = legendMarkerSize;
@@ -138,7 +138,7 @@ function generatePlotExportDescriptor(graphId, switchRenderingMode) {
                 'click': function (event, menuItem) {
                     if (!xicPlotFilling) {
                         updateXicChartData(actualPlotData[dataController.xicGraphDescKey],
-                            actualPlotData[dataController.xicGraphDataKey].slice(0), true);
+                            actualPlotData[dataController.xicGraphDataKey], true);
                         xicPlotFilling = true;
                     }
                 }
@@ -147,7 +147,7 @@ function generatePlotExportDescriptor(graphId, switchRenderingMode) {
                 'click': function (event, menuItem) {
                     if (xicPlotFilling) {
                         updateXicChartData(actualPlotData[dataController.xicGraphDescKey],
-                            actualPlotData[dataController.xicGraphDataKey].slice(0), false);
+                            actualPlotData[dataController.xicGraphDataKey], false);
                         xicPlotFilling = false;
                     }
                 }
@@ -268,13 +268,17 @@ function generateMs2GraphTitle(graphDescriptor) {
     return title;
 }
 
+// Returns graphs and chart data provider, which consists of the input points and auxiliary ground points
 function getGraphs(graphDescriptors, points, graphProtoGenerator, horizontalOffset, stickPlot, pointAttributeSetter, graphTitleGenarator) {
-    var graphs = [];
+    var result = {'graphs': [], 'dataProvider': []};
 
     if (!graphDescriptors || !points) {
-        return graphs;
+        return result;
     }
 
+    // auxiliary points are appended to a new array, since inserting them into the input one takes quadratic time
+    var graphs = result.graphs;
+    var dataProvider = result.dataProvider;
     var lastGraphId = null;
     for (var i = 0; i < points.length; ++i) {
         var curPoint = points[i];
@@ -286,18 +290,24 @@ function getGraphs(graphDescriptors, points, graphProtoGenerator, horizontalOffs
 
         if (isAuxPoint(curPoint)) {
             if (stickPlot && dataController.precursorMzKey in curPoint) {
-                points.splice(i++, 0, createAuxGroundPoint(curPoint, yField, xField, 0));
-                points.splice(++i, 0, createAuxGroundPoint(curPoint, yField, xField, 0));
+                dataProvider.push(createAuxGroundPoint(curPoint, yField, xField, 0));
+                dataProvider.push(curPoint);
+                dataProvider.push(createAuxGroundPoint(curPoint, yField, xField, 0));
+            } else {
+                dataProvider.push(curPoint);
             }
             continue;
         }
 
+        var isLastPoint = i === points.length - 1;
+        var nextPoint = isLastPoint ? null : points[i + 1];
+
         // add auxilary ground points at ends of current graph
         var addAuxBefore = stickPlot || curGraphId !== lastGraphId;
-        var addAuxAfter = stickPlot || i === points.length - 1 || points[i + 1][dataController.graphIdKey] !== curGraphId;
+        var addAuxAfter = stickPlot || isLastPoint || nextPoint[dataController.graphIdKey] !== curGraphId;
 
         var addOffsetBefore = horizontalOffset > 0 && curGraphId !== lastGraphId;
-        var addOffsetAfter = horizontalOffset > 0 && i === points.length - 1;
+        var addOffsetAfter = horizontalOffset > 0 && isLastPoint;
 
         if (curGraphId !== lastGraphId) {
             var currentGraph = graphProtoGenerator();
@@ -311,20 +321,22 @@ function getGraphs(graphDescriptors, points, graphProtoGenerator, horizontalOffs
         }
 
         if (addOffsetBefore) {
-            points.splice(i++, 0, createAuxGroundPoint(curPoint, yField, xField, -horizontalOffset));
+            dataProvider.push(createAuxGroundPoint(curPoint, yField, xField, -horizontalOffset));
         }
-        if (addAuxBefore && (i === 0 || !(isAuxPoint(points[i - 1]) && points[i - 1][xField] === curPoint[xField]))) { // check if auxilary point is already there
-            points.splice(i++, 0, createAuxGroundPoint(curPoint, yField, xField, 0));
+        var prevPoint = dataProvider.length > 0 ? dataProvider[dataProvider.length - 1] : null;
+        if (addAuxBefore && (null === prevPoint || !(isAuxPoint(prevPoint) && prevPoint[xField] === curPoint[xField]))) { // check if auxilary point is already there
+            dataProvider.push(createAuxGroundPoint(curPoint, yField, xField, 0));
         }
-        if (addAuxAfter && (i === points.length - 1 || !(isAuxPoint(points[i + 1]) && points[i + 1][xField] === curPoint[xField]))) { // check if auxilary point is already there
-            points.splice(++i, 0, createAuxGroundPoint(curPoint, yField, xField, 0));
+        dataProvider.push(curPoint);
+        if (addAuxAfter && (isLastPoint || !(isAuxPoint(nextPoint) && nextPoint[xField] === curPoint[xField]))) { // check if auxilary point is already there
+            dataProvider.push(createAuxGroundPoint(curPoint, yField, xField, 0));
         }
         if (addOffsetAfter) {
-            points.splice(++i, 0, createAuxGroundPoint(curPoint, yField, xField, horizontalOffset));
+            dataProvider.push(createAuxGroundPoint(curPoint, yField, xField, horizontalOffset));
         }
         pointAttributeSetter(curPoint);
     }
-    return graphs;
+    return result;
 }
 
 var xicGraphSelectionState = {
@@ -333,6 +345,7 @@ var xicGraphSelectionState = {
     _alphasByGraph: [],
     _selectionActive: false,
     _lastUsedColorIndex: 10, // offset to reduce chance of color collision between XICs and fragmentation spectra
+    _pendingSpectraRequestId: null,
 
     reset: function() {
         this._selectedItems = [];
@@ -340,6 +353,7 @@ var xicGraphSelectionState = {
         this._alphasByGraph = [];
         this._lastUsedColorIndex = 10;
         this._selectionActive = false;
+        this._pendingSpectraRequestId = null;
     },
 
     deselect: function(event) {
@@ -360,6 +374,7 @@ var xicGraphSelectionState = {
             this._selectedCharts = [];
             this._selectionActive = false;
             this._lastUsedColorIndex = 10;
+            this._pendingSpectraRequestId = null;
 
             delete actualPlotData[dataController.msnGraphDescKey];
             delete actualPlotData[dataController.msnGraphDataKey];
@@ -431,7 +446,16 @@ var xicGraphSelectionState = {
         var spectraIds = this._selectedItems.map(function(item) {
             return item.item.dataContext[dataController.spectrumIdKey];
         });
-        var graphData = dataController.getMs2Spectra(spectraIds);
+        // spectra are read in background, only a response to the latest request is displayed
+        this._pendingSpectraRequestId = dataController.requestMs2Spectra(spectraIds);
+    },
+
+    ms2SpectraReceived: function(requestId, graphData) {
+        if (requestId !== this._pendingSpectraRequestId || !this._selectionActive) {
+            return;
+        }
+        this._pendingSpectraRequestId = null;
+
         var graphDescriptors = graphData[dataController.msnGraphDescKey];
         for (var graphId in graphDescriptors) {
             var xicPoint = null;
@@ -690,7 +714,8 @@ function updateMassChartData(graphDescriptors, points, fragmentationSpectra) {
     }
 
     chartsById[graphExporter.massPeakChartId] = createMassPeakChart('mass_peak_container',
-        points, massGraphs, fragmentationSpectra);
+        massGraphs.dataProvider, massGraphs.graphs, fragmentationSpectra);
+    trackXRange(graphExporter.massPeakChartId);
 }
 
 function updateXicChartData(graphDescriptors, points, plotFilling) {
@@ -702,9 +727,10 @@ function updateXicChartData(graphDescriptors, points, plotFilling) {
     if (null !== xicChart) {
         xicChart.clear();
     }
-    var xicGuides = createXicGuides(xicGraphs, graphDescriptors);
-    chartsById[graphExporter.xicChartId] = createXicChart('xic_container', points,
-        xicGraphs, xicGuides);
+    var xicGuides = createXicGuides(xicGraphs.graphs, graphDescriptors);
+    chartsById[graphExporter.xicChartId] = createXicChart('xic_container', xicGraphs.dataProvider,
+        xicGraphs.graphs, xicGuides);
+    trackXRange(graphExporter.xicChartId);
 
     var minRt = Number.POSITIVE_INFINITY;
     var maxRt = Number.NEGATIVE_INFINITY;
@@ -722,8 +748,11 @@ function updateXicChartData(graphDescriptors, points, plotFilling) {
 
 function updateChartData(data) {
     actualPlotData = data;
-    updateXicChartData(data[dataController.xicGraphDescKey], data[dataController.xicGraphDataKey].slice(0), xicPlotFilling);
+    updateXicChartData(data[dataController.xicGraphDescKey], data[dataController.xicGraphDataKey], xicPlotFilling);
     updateMassChartData(data[dataController.ms1GraphDescKey], data[dataController.ms1GraphDataKey], false);
 }
 
 dataController.updatePlot.connect(this, updateChartData);
+dataController.ms2SpectraReady.connect(this, function(requestId, graphData) {
+    xicGraphSelectionState.ms2SpectraReceived(requestId, graphData);
+});
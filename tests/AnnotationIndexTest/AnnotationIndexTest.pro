@@ -0,0 +1,18 @@
+# Search of compound IDs and web links of annotations, run by "make check"
+QT += concurrent sql testlib
+QT -= gui
+TEMPLATE = app
+TARGET = AnnotationIndexTest
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+SRC_DIR = ../../src
+INCLUDEPATH += $$SRC_DIR
+
+HEADERS += $$SRC_DIR/AnnotationIndex.h \
+           $$SRC_DIR/FeatureMatrix.h \
+           $$SRC_DIR/Globals.h
+
+SOURCES += $$SRC_DIR/AnnotationIndex.cpp \
+           $$SRC_DIR/FeatureMatrix.cpp \
+           tst_AnnotationIndex.cpp
@@ -0,0 +1,179 @@
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "AnnotationIndex.h"
+#include "FeatureMatrix.h"
+
+using namespace ov;
+
+const int FIXTURE_FEATURE_COUNT = 6;
+const int FIXTURE_SAMPLE_COUNT = 2;
+
+// Indexes annotations of a small database and checks prefix and substring searches against rows known in advance.
+// Features 1-6 are in rows 0-5: feature 1 is annotated twice by HMDB0000122 and feature 5 once, HMDB0000122 and
+// C00031 have web links, features 2, 3 and 4 have one annotation each and feature 6 has none.
+class AnnotationIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void findRows_data();
+    void findRows();
+    void findTerms_data();
+    void findTerms();
+    void emptyIndex();
+
+private:
+    bool exec(QSqlQuery &query);
+
+    QTemporaryDir directory;
+    FeatureMatrix matrix;
+    AnnotationIndex index;
+};
+
+bool AnnotationIndexTest::exec(QSqlQuery &query)
+{
+    if (!query.exec()) {
+        qWarning("%s", qPrintable(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+void AnnotationIndexTest::initTestCase()
+{
+    QVERIFY(directory.isValid());
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(directory.path() + "/fixture.db");
+    QVERIFY(db.open());
+
+    const QStringList statements = QStringList()
+        << "CREATE TABLE Feature (id INTEGER PRIMARY KEY, consensus_mz REAL, consensus_rt REAL, consensus_charge INTEGER)"
+        << "CREATE TABLE SampleFeature (sample_id INTEGER, feature_id INTEGER, intensity REAL)"
+        << "CREATE TABLE Annotation (id INTEGER PRIMARY KEY, compound_id TEXT)"
+        << "CREATE TABLE FeatureAnnotation (feature_id INTEGER, annotation_id INTEGER)"
+        << "CREATE TABLE CompoundWebLink (id INTEGER PRIMARY KEY, web_link TEXT)"
+        << "CREATE TABLE AnnotationWebLink (annotation_id INTEGER, link_id INTEGER)"
+        << "INSERT INTO Annotation (id, compound_id) VALUES (1, 'HMDB0000122'), (2, 'HMDB0000123'), (3, 'HMDB0001122'), "
+           "(4, 'C00031')"
+        << "INSERT INTO CompoundWebLink (id, web_link) VALUES (1, 'https://hmdb.ca/metabolites/HMDB0000122'), "
+           "(2, 'https://www.kegg.jp/entry/C00031')"
+        << "INSERT INTO AnnotationWebLink (annotation_id, link_id) VALUES (1, 1), (4, 2)"
+        << "INSERT INTO FeatureAnnotation (feature_id, annotation_id) VALUES (1, 1), (1, 1), (2, 2), (3, 3), (4, 4), (5, 1)";
+    foreach (const QString &statement, statements) {
+        QSqlQuery query(statement);
+        QVERIFY2(query.isActive(), qPrintable(query.lastError().text()));
+    }
+
+    QSqlQuery featureQuery;
+    QVERIFY(featureQuery.prepare("INSERT INTO Feature (id, consensus_mz, consensus_rt, consensus_charge) VALUES (?, ?, ?, 1)"));
+    for (int featureId = 1; featureId <= FIXTURE_FEATURE_COUNT; ++featureId) {
+        featureQuery.addBindValue(featureId);
+        featureQuery.addBindValue(100.0 * featureId);
+        featureQuery.addBindValue(10.0 * featureId);
+        QVERIFY(exec(featureQuery));
+    }
+
+    QVector<SampleId> sampleIds;
+    for (int i = 1; i <= FIXTURE_SAMPLE_COUNT; ++i) {
+        sampleIds.append(i);
+    }
+    matrix.build(sampleIds);
+    QCOMPARE(matrix.getRowCount(), FIXTURE_FEATURE_COUNT);
+    index.build(matrix);
+    QVERIFY(!index.isEmpty());
+}
+
+void AnnotationIndexTest::cleanupTestCase()
+{
+    index.clear();
+    matrix.clear();
+    QSqlDatabase::database().close();
+    QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+}
+
+void AnnotationIndexTest::findRows_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<QVector<int> >("rows");
+
+    typedef QVector<int> Rows;
+    const int prefix = AnnotationIndex::PREFIX_MATCH;
+    const int substring = AnnotationIndex::SUBSTRING_MATCH;
+
+    QTest::newRow("prefix, compound IDs") << "HMDB" << prefix << (Rows() << 0 << 1 << 2 << 4);
+    QTest::newRow("prefix, case insensitive") << "hMdB000012" << prefix << (Rows() << 0 << 1 << 4);
+    QTest::newRow("prefix, whole term") << "HMDB0000122" << prefix << (Rows() << 0 << 4);
+    QTest::newRow("prefix, longer than terms") << "HMDB00001220" << prefix << Rows();
+    QTest::newRow("prefix, web link") << "https://hmdb" << prefix << (Rows() << 0 << 4);
+    QTest::newRow("prefix, compound IDs and links") << "h" << prefix << (Rows() << 0 << 1 << 2 << 3 << 4);
+    QTest::newRow("prefix, two characters") << "c0" << prefix << (Rows() << 3);
+    QTest::newRow("prefix, substring isn't matched") << "0000122" << prefix << Rows();
+    QTest::newRow("prefix, empty") << "" << prefix << Rows();
+
+    QTest::newRow("substring, compound ID and link") << "0000122" << substring << (Rows() << 0 << 4);
+    QTest::newRow("substring, case insensitive") << "c00031" << substring << (Rows() << 3);
+    QTest::newRow("substring, at term start") << "HMDB000112" << substring << (Rows() << 2);
+    QTest::newRow("substring, at term end") << "1122" << substring << (Rows() << 2);
+    QTest::newRow("substring, several terms") << "122" << substring << (Rows() << 0 << 2 << 4);
+    QTest::newRow("substring, links only") << "kegg.jp" << substring << (Rows() << 3);
+    QTest::newRow("substring, unknown trigram") << "xyz" << substring << Rows();
+    // every trigram of the text is in HMDB0000122, but the text itself isn't
+    QTest::newRow("substring, known trigrams only") << "b0000000122" << substring << Rows();
+    QTest::newRow("substring, two characters") << "12" << substring << (Rows() << 0 << 1 << 2 << 4);
+    QTest::newRow("substring, two characters, case insensitive") << "Jp" << substring << (Rows() << 3);
+    QTest::newRow("substring, one character") << "3" << substring << (Rows() << 1 << 3);
+    QTest::newRow("substring, one unknown character") << "q" << substring << Rows();
+    QTest::newRow("substring, empty") << "" << substring << Rows();
+}
+
+void AnnotationIndexTest::findRows()
+{
+    QFETCH(QString, text);
+    QFETCH(int, mode);
+    QFETCH(QVector<int>, rows);
+
+    QCOMPARE(index.findRows(text, static_cast<AnnotationIndex::MatchMode>(mode)), rows);
+}
+
+void AnnotationIndexTest::findTerms_data()
+{
+    QTest::addColumn<QString>("prefix");
+    QTest::addColumn<int>("maxCount");
+    QTest::addColumn<QStringList>("terms");
+
+    QTest::newRow("original case") << "hmdb" << 10 << (QStringList() << "HMDB0000122" << "HMDB0000123" << "HMDB0001122");
+    QTest::newRow("limited") << "HMDB" << 2 << (QStringList() << "HMDB0000122" << "HMDB0000123");
+    QTest::newRow("links") << "https://" << 10
+        << (QStringList() << "https://hmdb.ca/metabolites/HMDB0000122" << "https://www.kegg.jp/entry/C00031");
+    QTest::newRow("unknown") << "KEGG" << 10 << QStringList();
+    QTest::newRow("empty") << "" << 10 << QStringList();
+}
+
+void AnnotationIndexTest::findTerms()
+{
+    QFETCH(QString, prefix);
+    QFETCH(int, maxCount);
+    QFETCH(QStringList, terms);
+
+    QCOMPARE(index.findTerms(prefix, maxCount), terms);
+}
+
+void AnnotationIndexTest::emptyIndex()
+{
+    AnnotationIndex emptyIndex;
+    QVERIFY(emptyIndex.isEmpty());
+    QVERIFY(emptyIndex.findRows("HMDB", AnnotationIndex::PREFIX_MATCH).isEmpty());
+    QVERIFY(emptyIndex.findRows("HMDB", AnnotationIndex::SUBSTRING_MATCH).isEmpty());
+    QVERIFY(emptyIndex.findRows("HM", AnnotationIndex::SUBSTRING_MATCH).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(AnnotationIndexTest)
+
+#include "tst_AnnotationIndex.moc"
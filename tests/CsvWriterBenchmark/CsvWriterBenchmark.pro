@@ -0,0 +1,15 @@
+# Export speed of CsvWriter compared with the QTextStream writer it replaced, run by "make check"
+QT += testlib
+QT -= gui
+TEMPLATE = app
+TARGET = CsvWriterBenchmark
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+SRC_DIR = ../../src
+INCLUDEPATH += $$SRC_DIR
+
+HEADERS += $$SRC_DIR/CsvWriter.h
+
+SOURCES += $$SRC_DIR/CsvWriter.cpp \
+           tst_CsvWriterBenchmark.cpp
@@ -0,0 +1,136 @@
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QtTest>
+
+#include "CsvWriter.h"
+
+using namespace ov;
+
+const int BLOCK_ROW_COUNT = 10000;
+const int SAMPLE_COUNT = 40;
+const qint64 DEFAULT_OUTPUT_SIZE = 1024; // MB, OV_CSV_BENCHMARK_MB overrides it
+
+// Writes the same feature table, repeated until the file has the requested size, with both writers.
+// Cells are variants as the feature table exporter gets them from the model.
+class CsvWriterBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void textStreamWriter();
+    void csvWriter();
+
+private:
+    static void writeTextStreamRow(QTextStream &output, const QStringList &row);
+    void report(const char *writerName, const QFile &file, qint64 elapsedMs) const;
+
+    QStringList header;
+    QVector<QVariantList> rows;
+    qint64 outputSize;
+};
+
+void CsvWriterBenchmark::initTestCase()
+{
+    const qint64 megabytes = qgetenv("OV_CSV_BENCHMARK_MB").toLongLong();
+    outputSize = (megabytes > 0 ? megabytes : DEFAULT_OUTPUT_SIZE) * 1024 * 1024;
+
+    header << "Feature ID" << "m/z" << "RT" << "Charge" << "Compound IDs";
+    for (int s = 0; s < SAMPLE_COUNT; ++s) {
+        header << QString("Sample %1").arg(s);
+    }
+    qsrand(1);
+    for (int i = 0; i < BLOCK_ROW_COUNT; ++i) {
+        QVariantList row;
+        row << qint64(i + 1) << 100.0 + qrand() / double(RAND_MAX) * 900.0 << qrand() / double(RAND_MAX) * 1200.0 << qrand() % 3
+            << (0 == i % 4 ? QString("HMDB%1; HMDB%2").arg(qrand() % 100000).arg(qrand() % 100000) : QString());
+        for (int s = 0; s < SAMPLE_COUNT; ++s) {
+            row << (0 == qrand() % 3 ? 0.0 : qrand() / double(RAND_MAX) * 1e7);
+        }
+        rows.append(row);
+    }
+}
+
+void CsvWriterBenchmark::writeTextStreamRow(QTextStream &output, const QStringList &row)
+{
+    // the writer used before CsvWriter
+    for (int i = 0; i < row.size(); ++i) {
+        if (0 != i) {
+            output << ',';
+        }
+        if (row[i].contains(',')) {
+            output << '"' << row[i] << '"';
+        } else {
+            output << row[i];
+        }
+    }
+}
+
+void CsvWriterBenchmark::report(const char *writerName, const QFile &file, qint64 elapsedMs) const
+{
+    const double megabytes = file.size() / (1024.0 * 1024.0);
+    qDebug("%s: %.0f MB in %lld ms, %.1f MB/s", writerName, megabytes, elapsedMs, megabytes * 1000.0 / qMax<qint64>(1, elapsedMs));
+}
+
+void CsvWriterBenchmark::textStreamWriter()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QElapsedTimer timer;
+    timer.start();
+
+    QTextStream output(&file);
+    output.setCodec("UTF-8");
+    writeTextStreamRow(output, header);
+    QStringList cells;
+    while (file.pos() < outputSize) {
+        foreach (const QVariantList &row, rows) {
+            cells.clear();
+            foreach (const QVariant &value, row) {
+                cells.append(value.toString());
+            }
+            output << '\n';
+            writeTextStreamRow(output, cells);
+        }
+        output.flush();
+    }
+    QCOMPARE(file.error(), QFile::NoError);
+    report("QTextStream", file, timer.elapsed());
+}
+
+void CsvWriterBenchmark::csvWriter()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QElapsedTimer timer;
+    timer.start();
+
+    CsvWriter writer(&file);
+    writer.writeRow(header);
+    while (file.pos() < outputSize) {
+        foreach (const QVariantList &row, rows) {
+            // typed as in FeatureTableExporter
+            foreach (const QVariant &value, row) {
+                switch (value.type()) {
+                    case QVariant::Double:
+                        writer.writeField(value.toDouble());
+                        break;
+                    case QVariant::Int:
+                    case QVariant::LongLong:
+                        writer.writeField(value.toLongLong());
+                        break;
+                    default:
+                        writer.writeField(value.toString());
+                }
+            }
+            writer.endRow();
+        }
+        QVERIFY(writer.flush());
+    }
+    report("CsvWriter", file, timer.elapsed());
+}
+
+QTEST_GUILESS_MAIN(CsvWriterBenchmark)
+
+#include "tst_CsvWriterBenchmark.moc"
@@ -0,0 +1,22 @@
+# Group comparison against reference values of R, run by "make check"
+QT += concurrent sql testlib
+QT -= gui
+TEMPLATE = app
+TARGET = DifferentialStatisticsTest
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+SRC_DIR = ../../src
+INCLUDEPATH += $$SRC_DIR
+
+HEADERS += $$SRC_DIR/DifferentialStatistics.h \
+           $$SRC_DIR/FeatureMatrix.h \
+           $$SRC_DIR/FeatureMatrixUtils.h \
+           $$SRC_DIR/Globals.h \
+           $$SRC_DIR/IntensityNormalization.h
+
+SOURCES += $$SRC_DIR/DifferentialStatistics.cpp \
+           $$SRC_DIR/FeatureMatrix.cpp \
+           $$SRC_DIR/FeatureMatrixUtils.cpp \
+           $$SRC_DIR/IntensityNormalization.cpp \
+           tst_DifferentialStatistics.cpp
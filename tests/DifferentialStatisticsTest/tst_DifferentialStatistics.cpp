@@ -0,0 +1,276 @@
+#include <cmath>
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "DifferentialStatistics.h"
+#include "FeatureMatrix.h"
+#include "IntensityNormalization.h"
+
+using namespace ov;
+
+// extra hours of sleep of ten patients with two drugs, the sleep dataset of R
+const double SLEEP_FIRST_GROUP[] = { 0.7, -1.6, -0.2, -1.2, -0.1, 3.4, 3.7, 0.8, 0.0, 2.0 };
+const double SLEEP_SECOND_GROUP[] = { 1.9, 0.8, 1.1, 0.1, -0.1, 4.4, 5.5, 1.6, 4.6, 3.4 };
+const int GROUP_SIZE = 10;
+const int SAMPLE_COUNT = 2 * GROUP_SIZE + 1; // the last sample isn't compared
+const int UNCOMPARED_SAMPLE = SAMPLE_COUNT - 1;
+
+// differences of printed reference values are within half a unit of their last digit
+const double R_TOLERANCE = 5e-6;
+const double EXACT_TOLERANCE = 1e-9;
+
+enum FixtureRow {
+    SLEEP_ROW, // log2 intensities are the sleep data, ties included
+    SMALL_SHIFT_ROW, // two samples per group with equal variances, so the t distribution has 2 degrees of freedom
+    SINGLE_SECOND_ROW, // one detected sample in the second group, too few for the t-test
+    LARGE_SHIFT_ROW,
+    FIRST_GROUP_ONLY_ROW, // nothing to compare
+    FIXTURE_ROW_COUNT
+};
+
+// Compares groups of a small database with values of t.test() and wilcox.test(exact = FALSE) of R and p.adjust("BH").
+// Values that R doesn't print are computed by hand from the closed forms noted next to them.
+class DifferentialStatisticsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void referenceValues_data();
+    void referenceValues();
+    void notApplicable_data();
+    void notApplicable();
+    void groups();
+    void canceled();
+
+private:
+    bool exec(QSqlQuery &query);
+    bool insertIntensities(int featureId, const QVector<QPair<int, double> > &intensities);
+    DifferentialStatistics compare(const FeatureMatrixUtils::ProgressCallback &progress) const;
+
+    QTemporaryDir directory;
+    FeatureMatrix matrix;
+    QVector<SampleId> sampleIds;
+    QVector<int> firstGroup;
+    QVector<int> secondGroup;
+};
+
+bool DifferentialStatisticsTest::exec(QSqlQuery &query)
+{
+    if (!query.exec()) {
+        qWarning("%s", qPrintable(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+// @intensities: sample numbers and intensities of the feature
+bool DifferentialStatisticsTest::insertIntensities(int featureId, const QVector<QPair<int, double> > &intensities)
+{
+    QSqlQuery featureQuery;
+    featureQuery.prepare("INSERT INTO Feature (id, consensus_mz, consensus_rt, consensus_charge) VALUES (?, ?, ?, 1)");
+    featureQuery.addBindValue(featureId);
+    featureQuery.addBindValue(100.0 + featureId);
+    featureQuery.addBindValue(10.0 * featureId);
+    if (!exec(featureQuery)) {
+        return false;
+    }
+
+    QSqlQuery intensityQuery;
+    intensityQuery.prepare("INSERT INTO SampleFeature (sample_id, feature_id, intensity) VALUES (?, ?, ?)");
+    for (int i = 0; i < intensities.size(); ++i) {
+        intensityQuery.addBindValue(sampleIds[intensities[i].first]);
+        intensityQuery.addBindValue(featureId);
+        intensityQuery.addBindValue(intensities[i].second);
+        if (!exec(intensityQuery)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DifferentialStatisticsTest::initTestCase()
+{
+    QVERIFY(directory.isValid());
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(directory.path() + "/fixture.db");
+    QVERIFY(db.open());
+
+    const QStringList schema = QStringList()
+        << "CREATE TABLE Feature (id INTEGER PRIMARY KEY, consensus_mz REAL, consensus_rt REAL, consensus_charge INTEGER)"
+        << "CREATE TABLE SampleFeature (sample_id INTEGER, feature_id INTEGER, intensity REAL)"
+        << "CREATE TABLE Annotation (id INTEGER PRIMARY KEY, compound_id TEXT)"
+        << "CREATE TABLE FeatureAnnotation (feature_id INTEGER, annotation_id INTEGER)";
+    foreach (const QString &statement, schema) {
+        QSqlQuery query(statement);
+        QVERIFY(query.isActive());
+    }
+
+    for (int sampleNumber = 0; sampleNumber < SAMPLE_COUNT; ++sampleNumber) {
+        sampleIds.append(sampleNumber + 1);
+        if (sampleNumber < GROUP_SIZE) {
+            firstGroup.append(sampleNumber);
+        } else if (sampleNumber < 2 * GROUP_SIZE) {
+            secondGroup.append(sampleNumber);
+        }
+    }
+
+    // the t-test compares log2 intensities, so the sleep data are exponents; the uncompared sample would change all values
+    typedef QVector<QPair<int, double> > Intensities;
+    Intensities sleepIntensities;
+    for (int i = 0; i < GROUP_SIZE; ++i) {
+        sleepIntensities.append(qMakePair(firstGroup[i], std::exp2(SLEEP_FIRST_GROUP[i])));
+        sleepIntensities.append(qMakePair(secondGroup[i], std::exp2(SLEEP_SECOND_GROUP[i])));
+    }
+    sleepIntensities.append(qMakePair(UNCOMPARED_SAMPLE, 1e9));
+
+    QVERIFY(db.transaction());
+    QVERIFY(insertIntensities(SLEEP_ROW + 1, sleepIntensities));
+    QVERIFY(insertIntensities(SMALL_SHIFT_ROW + 1, Intensities() << qMakePair(0, 1.0) << qMakePair(1, 4.0)
+        << qMakePair(GROUP_SIZE, 2.0) << qMakePair(GROUP_SIZE + 1, 8.0)));
+    QVERIFY(insertIntensities(SINGLE_SECOND_ROW + 1, Intensities() << qMakePair(0, 1.0) << qMakePair(1, 2.0)
+        << qMakePair(2, 3.0) << qMakePair(GROUP_SIZE, 10.0)));
+    QVERIFY(insertIntensities(LARGE_SHIFT_ROW + 1, Intensities() << qMakePair(0, 1.0) << qMakePair(1, 4.0)
+        << qMakePair(GROUP_SIZE, 16.0) << qMakePair(GROUP_SIZE + 1, 64.0) << qMakePair(UNCOMPARED_SAMPLE, 5.0)));
+    QVERIFY(insertIntensities(FIRST_GROUP_ONLY_ROW + 1, Intensities() << qMakePair(0, 1.0) << qMakePair(1, 4.0)
+        << qMakePair(2, 7.0)));
+    QVERIFY(db.commit());
+
+    matrix.build(sampleIds);
+    QCOMPARE(matrix.getRowCount(), int(FIXTURE_ROW_COUNT));
+}
+
+void DifferentialStatisticsTest::cleanupTestCase()
+{
+    matrix.clear();
+    QSqlDatabase::database().close();
+    QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+}
+
+DifferentialStatistics DifferentialStatisticsTest::compare(const FeatureMatrixUtils::ProgressCallback &progress) const
+{
+    return DifferentialStatistics::compute(matrix, IntensityNormalization(), firstGroup, secondGroup, "first", "second",
+        progress);
+}
+
+void DifferentialStatisticsTest::referenceValues_data()
+{
+    QTest::addColumn<int>("row");
+    QTest::addColumn<int>("column");
+    QTest::addColumn<double>("value");
+    QTest::addColumn<double>("tolerance");
+
+    // t.test(extra ~ group, data = sleep): t = -1.8608, df = 17.776, p-value = 0.07939
+    QTest::newRow("sleep, t-test p") << int(SLEEP_ROW) << int(DifferentialStatistics::T_TEST_P_VALUE_COLUMN) << 0.07939
+        << R_TOLERANCE;
+    // wilcox.test(extra ~ group, data = sleep, exact = FALSE): W = 25.5, p-value = 0.06933
+    QTest::newRow("sleep, Mann-Whitney p") << int(SLEEP_ROW) << int(DifferentialStatistics::MANN_WHITNEY_P_VALUE_COLUMN)
+        << 0.06933 << R_TOLERANCE;
+    // log2(mean(2^extra[11:20]) / mean(2^extra[1:10]))
+    QTest::newRow("sleep, fold change") << int(SLEEP_ROW) << int(DifferentialStatistics::LOG2_FOLD_CHANGE_COLUMN)
+        << 1.7227479994517296 << EXACT_TOLERANCE;
+
+    // log2 intensities 0, 2 vs. 1, 3: t = 1 / sqrt(2) with 2 degrees of freedom, p = 1 - t / sqrt(2 + t^2)
+    QTest::newRow("small shift, t-test p") << int(SMALL_SHIFT_ROW) << int(DifferentialStatistics::T_TEST_P_VALUE_COLUMN)
+        << 1.0 - std::sqrt(0.2) << EXACT_TOLERANCE;
+    // U = 1, mean 2, variance 2 * 2 * 5 / 12 = 5 / 3, p = erfc((|U - mean| - 0.5) / sd / sqrt(2))
+    QTest::newRow("small shift, Mann-Whitney p") << int(SMALL_SHIFT_ROW)
+        << int(DifferentialStatistics::MANN_WHITNEY_P_VALUE_COLUMN) << std::erfc(0.5 / std::sqrt(5.0 / 3.0) / std::sqrt(2.0))
+        << EXACT_TOLERANCE;
+    QTest::newRow("small shift, fold change") << int(SMALL_SHIFT_ROW) << int(DifferentialStatistics::LOG2_FOLD_CHANGE_COLUMN)
+        << 1.0 << EXACT_TOLERANCE;
+
+    // U = 0, mean 1.5, variance 3 * 1 * 5 / 12
+    QTest::newRow("single second, Mann-Whitney p") << int(SINGLE_SECOND_ROW)
+        << int(DifferentialStatistics::MANN_WHITNEY_P_VALUE_COLUMN) << std::erfc(1.0 / std::sqrt(1.25) / std::sqrt(2.0))
+        << EXACT_TOLERANCE;
+    QTest::newRow("single second, fold change") << int(SINGLE_SECOND_ROW)
+        << int(DifferentialStatistics::LOG2_FOLD_CHANGE_COLUMN) << std::log2(5.0) << EXACT_TOLERANCE;
+
+    // log2 intensities 0, 2 vs. 4, 6: t = 4 / sqrt(2) with 2 degrees of freedom
+    QTest::newRow("large shift, t-test p") << int(LARGE_SHIFT_ROW) << int(DifferentialStatistics::T_TEST_P_VALUE_COLUMN)
+        << 1.0 - std::sqrt(0.8) << EXACT_TOLERANCE;
+    // U = 0, mean 2, variance 2 * 2 * 5 / 12 = 5 / 3
+    QTest::newRow("large shift, Mann-Whitney p") << int(LARGE_SHIFT_ROW)
+        << int(DifferentialStatistics::MANN_WHITNEY_P_VALUE_COLUMN) << std::erfc(1.5 / std::sqrt(5.0 / 3.0) / std::sqrt(2.0))
+        << EXACT_TOLERANCE;
+    QTest::newRow("large shift, fold change") << int(LARGE_SHIFT_ROW) << int(DifferentialStatistics::LOG2_FOLD_CHANGE_COLUMN)
+        << 4.0 << EXACT_TOLERANCE;
+
+    // p.adjust(c(0.07939414, 0.55278640, 0.10557281), "BH"), the row without a t-test isn't counted
+    QTest::newRow("sleep, t-test q") << int(SLEEP_ROW) << int(DifferentialStatistics::T_TEST_Q_VALUE_COLUMN) << 0.15835921
+        << R_TOLERANCE;
+    QTest::newRow("small shift, t-test q") << int(SMALL_SHIFT_ROW) << int(DifferentialStatistics::T_TEST_Q_VALUE_COLUMN)
+        << 0.55278640 << R_TOLERANCE;
+    QTest::newRow("large shift, t-test q") << int(LARGE_SHIFT_ROW) << int(DifferentialStatistics::T_TEST_Q_VALUE_COLUMN)
+        << 0.15835921 << R_TOLERANCE;
+
+    // p.adjust(c(0.06932758, 0.69853536, 0.37109337, 0.24527812), "BH")
+    QTest::newRow("sleep, Mann-Whitney q") << int(SLEEP_ROW) << int(DifferentialStatistics::MANN_WHITNEY_Q_VALUE_COLUMN)
+        << 0.27731030 << R_TOLERANCE;
+    QTest::newRow("small shift, Mann-Whitney q") << int(SMALL_SHIFT_ROW)
+        << int(DifferentialStatistics::MANN_WHITNEY_Q_VALUE_COLUMN) << 0.69853536 << R_TOLERANCE;
+    QTest::newRow("single second, Mann-Whitney q") << int(SINGLE_SECOND_ROW)
+        << int(DifferentialStatistics::MANN_WHITNEY_Q_VALUE_COLUMN) << 0.49479116 << R_TOLERANCE;
+    QTest::newRow("large shift, Mann-Whitney q") << int(LARGE_SHIFT_ROW)
+        << int(DifferentialStatistics::MANN_WHITNEY_Q_VALUE_COLUMN) << 0.49055623 << R_TOLERANCE;
+}
+
+void DifferentialStatisticsTest::referenceValues()
+{
+    QFETCH(int, row);
+    QFETCH(int, column);
+    QFETCH(double, value);
+    QFETCH(double, tolerance);
+
+    const DifferentialStatistics statistics = compare(FeatureMatrixUtils::ProgressCallback([] (int) { return true; }));
+    const qreal actualValue = statistics.getValue(row, static_cast<DifferentialStatistics::Column>(column));
+    QVERIFY2(qAbs(actualValue - value) <= tolerance, qPrintable(QString("%1 instead of %2").arg(actualValue, 0, 'g', 12)
+        .arg(value, 0, 'g', 12)));
+}
+
+void DifferentialStatisticsTest::notApplicable_data()
+{
+    QTest::addColumn<int>("row");
+    QTest::addColumn<int>("column");
+
+    QTest::newRow("single second, t-test p") << int(SINGLE_SECOND_ROW) << int(DifferentialStatistics::T_TEST_P_VALUE_COLUMN);
+    QTest::newRow("single second, t-test q") << int(SINGLE_SECOND_ROW) << int(DifferentialStatistics::T_TEST_Q_VALUE_COLUMN);
+    for (int column = 0; column < DifferentialStatistics::COLUMN_COUNT; ++column) {
+        QTest::newRow(qPrintable(QString("first group only, column %1").arg(column))) << int(FIRST_GROUP_ONLY_ROW) << column;
+    }
+}
+
+void DifferentialStatisticsTest::notApplicable()
+{
+    QFETCH(int, row);
+    QFETCH(int, column);
+
+    const DifferentialStatistics statistics = compare(FeatureMatrixUtils::ProgressCallback([] (int) { return true; }));
+    QVERIFY(std::isnan(statistics.getValue(row, static_cast<DifferentialStatistics::Column>(column))));
+}
+
+void DifferentialStatisticsTest::groups()
+{
+    const DifferentialStatistics statistics = compare(FeatureMatrixUtils::ProgressCallback([] (int) { return true; }));
+    QVERIFY(!statistics.isEmpty());
+    QCOMPARE(statistics.getRowCount(), int(FIXTURE_ROW_COUNT));
+    QCOMPARE(statistics.getFirstGroup(), firstGroup);
+    QCOMPARE(statistics.getSecondGroup(), secondGroup);
+    QCOMPARE(statistics.getFirstGroupName(), QString("first"));
+    QCOMPARE(statistics.getSecondGroupName(), QString("second"));
+}
+
+void DifferentialStatisticsTest::canceled()
+{
+    QVERIFY(compare(FeatureMatrixUtils::ProgressCallback([] (int) { return false; })).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(DifferentialStatisticsTest)
+
+#include "tst_DifferentialStatistics.moc"
@@ -0,0 +1,22 @@
+# Load-time cost of the feature matrix and the correlation search on a large generated database, run by "make check"
+QT += concurrent sql testlib
+QT -= gui
+TEMPLATE = app
+TARGET = FeatureMatrixBenchmark
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+SRC_DIR = ../../src
+INCLUDEPATH += $$SRC_DIR
+
+HEADERS += $$SRC_DIR/FeatureCorrelationSearch.h \
+           $$SRC_DIR/FeatureMatrix.h \
+           $$SRC_DIR/FeatureMatrixUtils.h \
+           $$SRC_DIR/Globals.h \
+           $$SRC_DIR/IntensityNormalization.h
+
+SOURCES += $$SRC_DIR/FeatureCorrelationSearch.cpp \
+           $$SRC_DIR/FeatureMatrix.cpp \
+           $$SRC_DIR/FeatureMatrixUtils.cpp \
+           $$SRC_DIR/IntensityNormalization.cpp \
+           tst_FeatureMatrixBenchmark.cpp
@@ -0,0 +1,173 @@
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "FeatureCorrelationSearch.h"
+#include "FeatureMatrix.h"
+
+using namespace ov;
+
+// defaults of the generated database, OV_MATRIX_BENCHMARK_FEATURES, _SAMPLES and _DENSITY (in percents) override them
+const int DEFAULT_FEATURE_COUNT = 100000;
+const int DEFAULT_SAMPLE_COUNT = 1000;
+const int DEFAULT_DENSITY = 10;
+const int CORRELATED_FEATURE_COUNT = 100;
+const int SEARCH_COUNT = 10; // rows searched for after the profiles are prepared
+
+// Times parts of opening a database and the correlation search on a sparse matrix of random intensities.
+// The database is generated once and then read from the disk cache, so the timings are about the matrix
+// rather than the drive.
+class FeatureMatrixBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void build();
+    void findCorrelated_data();
+    void findCorrelated();
+
+private:
+    static int getSetting(const char *name, int defaultValue);
+
+    QTemporaryDir directory;
+    QVector<SampleId> sampleIds;
+    FeatureMatrix matrix;
+};
+
+int FeatureMatrixBenchmark::getSetting(const char *name, int defaultValue)
+{
+    const int value = qgetenv(name).toInt();
+    return value > 0 ? value : defaultValue;
+}
+
+void FeatureMatrixBenchmark::initTestCase()
+{
+    const int featureCount = getSetting("OV_MATRIX_BENCHMARK_FEATURES", DEFAULT_FEATURE_COUNT);
+    const int sampleCount = getSetting("OV_MATRIX_BENCHMARK_SAMPLES", DEFAULT_SAMPLE_COUNT);
+    const int density = qMin(100, getSetting("OV_MATRIX_BENCHMARK_DENSITY", DEFAULT_DENSITY));
+
+    QVERIFY(directory.isValid());
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(directory.path() + "/benchmark.db");
+    QVERIFY(db.open());
+    const QStringList schema = QStringList()
+        << "PRAGMA journal_mode = OFF"
+        << "PRAGMA synchronous = OFF"
+        << "CREATE TABLE Feature (id INTEGER PRIMARY KEY, consensus_mz REAL, consensus_rt REAL, consensus_charge INTEGER)"
+        << "CREATE TABLE SampleFeature (sample_id INTEGER, feature_id INTEGER, intensity REAL)"
+        << "CREATE TABLE Annotation (id INTEGER PRIMARY KEY, compound_id TEXT)"
+        << "CREATE TABLE FeatureAnnotation (feature_id INTEGER, annotation_id INTEGER)";
+    foreach (const QString &statement, schema) {
+        QSqlQuery query;
+        QVERIFY2(query.exec(statement), qPrintable(query.lastError().text()));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(db.transaction());
+    QSqlQuery featureQuery;
+    QVERIFY(featureQuery.prepare("INSERT INTO Feature (id, consensus_mz, consensus_rt, consensus_charge) VALUES (?, ?, ?, ?)"));
+    QSqlQuery intensityQuery;
+    QVERIFY(intensityQuery.prepare("INSERT INTO SampleFeature (sample_id, feature_id, intensity) VALUES (?, ?, ?)"));
+    for (int s = 0; s < sampleCount; ++s) {
+        sampleIds.append(s + 1);
+    }
+    qsrand(1);
+    qint64 intensityCount = 0;
+    for (int featureId = 1; featureId <= featureCount; ++featureId) {
+        featureQuery.addBindValue(featureId);
+        featureQuery.addBindValue(100.0 + qrand() / double(RAND_MAX) * 900.0);
+        featureQuery.addBindValue(qrand() / double(RAND_MAX) * 1200.0);
+        featureQuery.addBindValue(1 + qrand() % 3);
+        QVERIFY(featureQuery.exec());
+        foreach (SampleId sampleId, sampleIds) {
+            if (qrand() % 100 >= density) {
+                continue;
+            }
+            intensityQuery.addBindValue(sampleId);
+            intensityQuery.addBindValue(featureId);
+            intensityQuery.addBindValue(qrand() / double(RAND_MAX) * 1e7);
+            QVERIFY(intensityQuery.exec());
+            ++intensityCount;
+        }
+    }
+    QVERIFY(db.commit());
+    QSqlQuery indexQuery;
+    QVERIFY(indexQuery.exec("CREATE INDEX SampleFeatureOrder ON SampleFeature (feature_id, sample_id)"));
+    qDebug("%d features x %d samples, %lld intensities generated in %lld ms", featureCount, sampleCount, intensityCount,
+        timer.elapsed());
+}
+
+void FeatureMatrixBenchmark::cleanupTestCase()
+{
+    matrix.clear();
+    QSqlDatabase::database().close();
+    QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+}
+
+void FeatureMatrixBenchmark::build()
+{
+    // the first build warms the disk cache up
+    matrix.build(sampleIds);
+
+    QElapsedTimer timer;
+    timer.start();
+    matrix.build(sampleIds);
+    const qint64 buildTime = timer.elapsed();
+    QCOMPARE(matrix.getSampleCount(), sampleIds.size());
+
+    // the statistics are the transpose and a parallel reduction of the columns, the transpose is timed alone
+    timer.restart();
+    QVector<int> columnOffsets;
+    QVector<double> columnIntensities;
+    matrix.getColumns(columnOffsets, columnIntensities);
+    const qint64 transposeTime = timer.elapsed();
+    QCOMPARE(columnIntensities.size(), matrix.getIntensityCount());
+
+    qDebug("FeatureMatrix::build with sample statistics: %lld ms, transpose into columns alone: %lld ms", buildTime,
+        transposeTime);
+}
+
+void FeatureMatrixBenchmark::findCorrelated_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("Pearson") << int(FeatureCorrelationSearch::PEARSON_CORRELATION);
+    QTest::newRow("Spearman") << int(FeatureCorrelationSearch::SPEARMAN_CORRELATION);
+}
+
+void FeatureMatrixBenchmark::findCorrelated()
+{
+    QFETCH(int, method);
+    if (0 == matrix.getRowCount()) {
+        matrix.build(sampleIds);
+    }
+    FeatureCorrelationSearch search;
+    search.setMatrix(matrix, IntensityNormalization());
+
+    // profiles are standardized on the first search
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(search.findCorrelated(0, FeatureCorrelationSearch::Method(method), CORRELATED_FEATURE_COUNT).size()
+        <= CORRELATED_FEATURE_COUNT);
+    const qint64 firstSearchTime = timer.elapsed();
+
+    timer.restart();
+    const int rowStep = qMax(1, matrix.getRowCount() / SEARCH_COUNT);
+    for (int i = 1; i <= SEARCH_COUNT; ++i) {
+        search.findCorrelated(qMin(i * rowStep, matrix.getRowCount() - 1), FeatureCorrelationSearch::Method(method),
+            CORRELATED_FEATURE_COUNT);
+    }
+    const qint64 searchTime = timer.elapsed() / SEARCH_COUNT;
+
+    qDebug("top %d of %d features: %lld ms for the first search with profiles, %lld ms for each next one",
+        CORRELATED_FEATURE_COUNT, matrix.getRowCount(), firstSearchTime, searchTime);
+}
+
+QTEST_GUILESS_MAIN(FeatureMatrixBenchmark)
+
+#include "tst_FeatureMatrixBenchmark.moc"
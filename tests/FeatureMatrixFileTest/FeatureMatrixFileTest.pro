@@ -0,0 +1,19 @@
+# Round trip of the binary feature matrix format, run by "make check"
+QT += concurrent sql testlib
+QT -= gui
+TEMPLATE = app
+TARGET = FeatureMatrixFileTest
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+SRC_DIR = ../../src
+INCLUDEPATH += $$SRC_DIR
+
+HEADERS += $$SRC_DIR/FeatureMatrix.h \
+           $$SRC_DIR/FeatureMatrixFileReader.h \
+           $$SRC_DIR/FeatureMatrixFileWriter.h \
+           $$SRC_DIR/Globals.h
+
+SOURCES += $$SRC_DIR/FeatureMatrix.cpp \
+           $$SRC_DIR/FeatureMatrixFileWriter.cpp \
+           tst_FeatureMatrixFile.cpp
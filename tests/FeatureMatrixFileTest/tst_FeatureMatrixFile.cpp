@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <cstring>
+
+#include <QBuffer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QtTest>
+
+#include "FeatureMatrix.h"
+#include "FeatureMatrixFileReader.h"
+#include "FeatureMatrixFileWriter.h"
+
+using namespace ov;
+
+const int FIXTURE_FEATURE_COUNT = 50;
+const int FIXTURE_SAMPLE_COUNT = 4;
+const SampleId UNKNOWN_SAMPLE_ID = 99; // has intensities, but isn't passed to the matrix
+
+// Exports a matrix built from a small database and checks the mapped file against the database itself.
+class FeatureMatrixFileTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void roundTrip();
+    void unterminatedString();
+    void corruptedHeader_data();
+    void corruptedHeader();
+    void sampleNumberOutOfRange();
+
+private:
+    bool exec(QSqlQuery &query);
+    QByteArray exportMatrix(const QVector<int> &rows);
+    QByteArray exportMatrix();
+    static QVector<quint64> align(const QByteArray &contents);
+
+    QTemporaryDir directory;
+    FeatureMatrix matrix;
+    QVector<SampleId> sampleIds;
+    QStringList sampleNames;
+};
+
+bool FeatureMatrixFileTest::exec(QSqlQuery &query)
+{
+    if (!query.exec()) {
+        qWarning("%s", qPrintable(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+void FeatureMatrixFileTest::initTestCase()
+{
+    QVERIFY(directory.isValid());
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(directory.path() + "/fixture.db");
+    QVERIFY(db.open());
+
+    const QStringList schema = QStringList()
+        << "CREATE TABLE Sample (id INTEGER PRIMARY KEY, name TEXT)"
+        << "CREATE TABLE Feature (id INTEGER PRIMARY KEY, consensus_mz REAL, consensus_rt REAL, consensus_charge INTEGER)"
+        << "CREATE TABLE SampleFeature (sample_id INTEGER, feature_id INTEGER, intensity REAL)"
+        << "CREATE TABLE Annotation (id INTEGER PRIMARY KEY, compound_id TEXT)"
+        << "CREATE TABLE FeatureAnnotation (feature_id INTEGER, annotation_id INTEGER)";
+    foreach (const QString &statement, schema) {
+        QSqlQuery query(statement);
+        QVERIFY(query.isActive());
+    }
+
+    QVERIFY(db.transaction());
+    QSqlQuery sampleQuery;
+    QVERIFY(sampleQuery.prepare("INSERT INTO Sample (id, name) VALUES (?, ?)"));
+    for (int i = 1; i <= FIXTURE_SAMPLE_COUNT; ++i) {
+        sampleIds.append(10 * i);
+        sampleNames.append(QString("QC_%1").arg(i, 2, 10, QChar('0')));
+        sampleQuery.addBindValue(sampleIds.last());
+        sampleQuery.addBindValue(sampleNames.last());
+        QVERIFY(exec(sampleQuery));
+    }
+
+    QSqlQuery annotationQuery;
+    QVERIFY(annotationQuery.prepare("INSERT INTO Annotation (id, compound_id) VALUES (?, ?)"));
+    for (int i = 0; i < 5; ++i) {
+        annotationQuery.addBindValue(i + 1);
+        annotationQuery.addBindValue(QString("HMDB%1").arg(i, 7, 10, QChar('0')));
+        QVERIFY(exec(annotationQuery));
+    }
+
+    // some features have no intensities, no annotations or several annotations sharing compound IDs with others
+    QSqlQuery featureQuery;
+    QVERIFY(featureQuery.prepare("INSERT INTO Feature (id, consensus_mz, consensus_rt, consensus_charge) VALUES (?, ?, ?, ?)"));
+    QSqlQuery intensityQuery;
+    QVERIFY(intensityQuery.prepare("INSERT INTO SampleFeature (sample_id, feature_id, intensity) VALUES (?, ?, ?)"));
+    QSqlQuery featureAnnotationQuery;
+    QVERIFY(featureAnnotationQuery.prepare("INSERT INTO FeatureAnnotation (feature_id, annotation_id) VALUES (?, ?)"));
+    for (int featureId = 1; featureId <= FIXTURE_FEATURE_COUNT; ++featureId) {
+        featureQuery.addBindValue(featureId);
+        featureQuery.addBindValue(100.0 + featureId * 1.53);
+        featureQuery.addBindValue(featureId * 7.1);
+        featureQuery.addBindValue(featureId % 3);
+        QVERIFY(exec(featureQuery));
+
+        QList<SampleId> intensitySampleIds = QList<SampleId>::fromVector(sampleIds) << UNKNOWN_SAMPLE_ID;
+        foreach (SampleId sampleId, intensitySampleIds) {
+            if (0 == (featureId * sampleId / 10) % 3 || 0 == featureId % 7) {
+                continue;
+            }
+            intensityQuery.addBindValue(sampleId);
+            intensityQuery.addBindValue(featureId);
+            intensityQuery.addBindValue(1e4 * featureId + sampleId);
+            QVERIFY(exec(intensityQuery));
+        }
+
+        if (0 != featureId % 6) {
+            featureAnnotationQuery.addBindValue(featureId);
+            featureAnnotationQuery.addBindValue(featureId % 5 + 1);
+            QVERIFY(exec(featureAnnotationQuery));
+        }
+        if (0 == featureId % 4) {
+            featureAnnotationQuery.addBindValue(featureId);
+            featureAnnotationQuery.addBindValue((featureId + 1) % 5 + 1);
+            QVERIFY(exec(featureAnnotationQuery));
+        }
+    }
+    QVERIFY(db.commit());
+
+    matrix.build(sampleIds);
+}
+
+void FeatureMatrixFileTest::cleanupTestCase()
+{
+    matrix.clear();
+    QSqlDatabase::database().close();
+    QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+}
+
+QByteArray FeatureMatrixFileTest::exportMatrix(const QVector<int> &rows)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    FeatureMatrixFileWriter writer(&buffer);
+    const bool ok = writer.write(matrix, rows, sampleIds, sampleNames, [](int) { return true; });
+    return ok ? buffer.data() : QByteArray();
+}
+
+QByteArray FeatureMatrixFileTest::exportMatrix()
+{
+    QVector<int> rows;
+    for (int row = 0; row < matrix.getRowCount(); ++row) {
+        rows.append(row);
+    }
+    return exportMatrix(rows);
+}
+
+QVector<quint64> FeatureMatrixFileTest::align(const QByteArray &contents)
+{
+    QVector<quint64> alignedContents((contents.size() + 7) / 8);
+    std::copy(contents.constBegin(), contents.constEnd(), reinterpret_cast<char *>(alignedContents.data()));
+    return alignedContents;
+}
+
+void FeatureMatrixFileTest::roundTrip()
+{
+    // rows are exported in the reverse order, as if the table was sorted
+    QVector<int> rows;
+    for (int row = matrix.getRowCount() - 1; row >= 0; --row) {
+        rows.append(row);
+    }
+    const QByteArray contents = exportMatrix(rows);
+    QVERIFY(!contents.isEmpty());
+
+    QTemporaryFile file(directory.path() + "/XXXXXX.ovm");
+    QVERIFY(file.open());
+    QCOMPARE(file.write(contents), qint64(contents.size()));
+    file.close();
+
+    FeatureMatrixFileReader reader;
+    QVERIFY2(reader.open(QFile::encodeName(file.fileName()).toStdString()), reader.getError().c_str());
+
+    QSqlQuery countQuery("SELECT COUNT(*) FROM Feature");
+    QVERIFY(countQuery.next());
+    QCOMPARE(quint64(reader.getRowCount()), quint64(countQuery.value(0).toULongLong()));
+    QCOMPARE(quint64(reader.getSampleCount()), quint64(FIXTURE_SAMPLE_COUNT));
+
+    QSqlQuery sampleQuery;
+    QVERIFY(sampleQuery.prepare("SELECT name FROM Sample WHERE id = ?"));
+    for (uint32_t sampleNumber = 0; sampleNumber < reader.getSampleCount(); ++sampleNumber) {
+        QCOMPARE(qint64(reader.getSampleIds()[sampleNumber]), qint64(sampleIds[sampleNumber]));
+        sampleQuery.addBindValue(qint64(reader.getSampleIds()[sampleNumber]));
+        QVERIFY(exec(sampleQuery) && sampleQuery.next());
+        QCOMPARE(QString::fromUtf8(reader.getSampleName(sampleNumber)), sampleQuery.value(0).toString());
+    }
+
+    QSqlQuery featureQuery;
+    QVERIFY(featureQuery.prepare("SELECT consensus_mz, consensus_rt, consensus_charge FROM Feature WHERE id = ?"));
+    QSqlQuery intensityQuery;
+    QVERIFY(intensityQuery.prepare("SELECT sample_id, intensity FROM SampleFeature WHERE feature_id = ? AND sample_id <> ? "
+        "ORDER BY sample_id"));
+    QSqlQuery compoundQuery;
+    QVERIFY(compoundQuery.prepare("SELECT A.compound_id FROM FeatureAnnotation AS FA, Annotation AS A "
+        "WHERE FA.annotation_id = A.id AND FA.feature_id = ?"));
+
+    uint64_t intensityCount = 0;
+    for (uint64_t i = 0; i < reader.getRowCount(); ++i) {
+        const qint64 featureId = reader.getFeatureIds()[i];
+        QCOMPARE(featureId, qint64(matrix.getFeatureId(rows[i])));
+
+        featureQuery.addBindValue(featureId);
+        QVERIFY(exec(featureQuery) && featureQuery.next());
+        QCOMPARE(reader.getConsensusMzs()[i], featureQuery.value(0).toDouble());
+        QCOMPARE(reader.getConsensusRts()[i], featureQuery.value(1).toDouble());
+        QCOMPARE(reader.getConsensusCharges()[i], qint32(featureQuery.value(2).toInt()));
+
+        const uint32_t *sampleNumbers = NULL;
+        const double *intensities = NULL;
+        const uint64_t count = reader.getRowIntensities(i, sampleNumbers, intensities);
+        intensityQuery.addBindValue(featureId);
+        intensityQuery.addBindValue(UNKNOWN_SAMPLE_ID);
+        QVERIFY(exec(intensityQuery));
+        uint64_t j = 0;
+        for (; intensityQuery.next(); ++j) {
+            QVERIFY(j < count);
+            QCOMPARE(qint64(reader.getSampleIds()[sampleNumbers[j]]), qint64(intensityQuery.value(0).toLongLong()));
+            QCOMPARE(intensities[j], intensityQuery.value(1).toDouble());
+            QCOMPARE(reader.getIntensity(i, sampleNumbers[j]), intensities[j]);
+        }
+        QCOMPARE(j, count);
+        intensityCount += count;
+
+        compoundQuery.addBindValue(featureId);
+        QVERIFY(exec(compoundQuery));
+        QStringList expectedCompoundIds;
+        while (compoundQuery.next()) {
+            expectedCompoundIds.append(compoundQuery.value(0).toString());
+        }
+        const QString compoundIds = QString::fromUtf8(reader.getCompoundIds(i));
+        QStringList actualCompoundIds = compoundIds.isEmpty() ? QStringList() : compoundIds.split("; ");
+        std::sort(expectedCompoundIds.begin(), expectedCompoundIds.end());
+        std::sort(actualCompoundIds.begin(), actualCompoundIds.end());
+        QCOMPARE(actualCompoundIds, expectedCompoundIds);
+    }
+    QCOMPARE(reader.getIntensityCount(), intensityCount);
+}
+
+void FeatureMatrixFileTest::unterminatedString()
+{
+    const QByteArray contents = exportMatrix();
+    QVERIFY(!contents.isEmpty());
+
+    // the string data section ends the file, so the last byte is the terminator of the last string
+    QVector<quint64> alignedContents = align(contents);
+    FeatureMatrixFileReader reader;
+    QVERIFY2(reader.open(alignedContents.constData(), contents.size()), reader.getError().c_str());
+
+    reinterpret_cast<char *>(alignedContents.data())[contents.size() - 1] = 'X';
+    QVERIFY(!reader.open(alignedContents.constData(), contents.size()));
+    QVERIFY(!reader.isOpen());
+}
+
+void FeatureMatrixFileTest::corruptedHeader_data()
+{
+    // counts are the 64-bit words after the magic and the version, sizes computed from these wrap around
+    QTest::addColumn<int>("word");
+    QTest::addColumn<quint64>("count");
+    QTest::newRow("row count wrapping row offsets") << 2 << (Q_UINT64_C(1) << 61);
+    QTest::newRow("largest row count") << 2 << ~Q_UINT64_C(0);
+    QTest::newRow("sample count") << 3 << (Q_UINT64_C(1) << 61);
+    QTest::newRow("intensity count wrapping sample numbers") << 4 << (Q_UINT64_C(1) << 62);
+    QTest::newRow("string count") << 5 << (Q_UINT64_C(1) << 61);
+}
+
+void FeatureMatrixFileTest::corruptedHeader()
+{
+    QFETCH(int, word);
+    QFETCH(quint64, count);
+    const QByteArray contents = exportMatrix();
+    QVERIFY(!contents.isEmpty());
+
+    QVector<quint64> alignedContents = align(contents);
+    alignedContents[word] = count;
+    FeatureMatrixFileReader reader;
+    QVERIFY(!reader.open(alignedContents.constData(), contents.size()));
+    QVERIFY(!reader.isOpen());
+}
+
+void FeatureMatrixFileTest::sampleNumberOutOfRange()
+{
+    const QByteArray contents = exportMatrix();
+    QVERIFY(!contents.isEmpty());
+
+    QVector<quint64> alignedContents = align(contents);
+    FeatureMatrixFileReader reader;
+    QVERIFY2(reader.open(alignedContents.constData(), contents.size()), reader.getError().c_str());
+    QVERIFY(reader.getIntensityCount() > 0);
+
+    // the section table follows the 48-byte header, an entry is an offset and a size
+    const int entryWord = 6 + 2 * FeatureMatrixFileFormat::SAMPLE_NUMBERS;
+    char *sampleNumbers = reinterpret_cast<char *>(alignedContents.data()) + alignedContents[entryWord];
+    const quint32 sampleCount = quint32(reader.getSampleCount());
+    std::memcpy(sampleNumbers + 4 * (reader.getIntensityCount() - 1), &sampleCount, sizeof(sampleCount));
+    QVERIFY(!reader.open(alignedContents.constData(), contents.size()));
+    QVERIFY(!reader.isOpen());
+}
+
+QTEST_GUILESS_MAIN(FeatureMatrixFileTest)
+
+#include "tst_FeatureMatrixFile.moc"
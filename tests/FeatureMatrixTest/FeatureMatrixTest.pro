@@ -0,0 +1,16 @@
+# Lookups in the in-memory feature matrix, run by "make check"
+QT += concurrent sql testlib
+QT -= gui
+TEMPLATE = app
+TARGET = FeatureMatrixTest
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+SRC_DIR = ../../src
+INCLUDEPATH += $$SRC_DIR
+
+HEADERS += $$SRC_DIR/FeatureMatrix.h \
+           $$SRC_DIR/Globals.h
+
+SOURCES += $$SRC_DIR/FeatureMatrix.cpp \
+           tst_FeatureMatrix.cpp
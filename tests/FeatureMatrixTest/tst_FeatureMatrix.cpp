@@ -0,0 +1,183 @@
+#include <limits>
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "FeatureMatrix.h"
+
+using namespace ov;
+
+// consensus values of features 1, 2, ...; features share m/z or RT values to check ties at bounds
+const double FIXTURE_MZS[] = { 100.0, 150.0, 150.0, 200.0, 250.0, 300.0, 300.0, 400.0 };
+const double FIXTURE_RTS[] = { 60.0, 30.0, 120.0, 90.0, 60.0, 180.0, 30.0, 240.0 };
+const int FIXTURE_FEATURE_COUNT = sizeof(FIXTURE_MZS) / sizeof(FIXTURE_MZS[0]);
+const int FIXTURE_SAMPLE_COUNT = 3;
+// sample numbers, feature ids and intensities; features 1 and 3 and features 2 and 7 are equally intense in sample 0,
+// feature 6 isn't detected in it and nothing is detected in sample 2
+const struct {
+    int sampleNumber;
+    int featureId;
+    double intensity;
+} FIXTURE_INTENSITIES[] = {
+    { 0, 1, 500.0 }, { 0, 2, 300.0 }, { 0, 3, 500.0 }, { 0, 4, 100.0 }, { 0, 5, 900.0 }, { 0, 7, 300.0 }, { 0, 8, 50.0 },
+    { 1, 2, 10.0 }, { 1, 6, 20.0 }
+};
+const qreal NO_BOUND = std::numeric_limits<qreal>::max(); // what the range dialog passes for a bound left out
+
+// Builds a matrix from a small database and checks lookups of rows against values known in advance.
+class FeatureMatrixTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void findRows_data();
+    void findRows();
+    void findRowsInEmptyMatrix();
+    void findMostIntenseRows_data();
+    void findMostIntenseRows();
+
+private:
+    bool exec(QSqlQuery &query);
+
+    QTemporaryDir directory;
+    FeatureMatrix matrix;
+};
+
+bool FeatureMatrixTest::exec(QSqlQuery &query)
+{
+    if (!query.exec()) {
+        qWarning("%s", qPrintable(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+void FeatureMatrixTest::initTestCase()
+{
+    QVERIFY(directory.isValid());
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(directory.path() + "/fixture.db");
+    QVERIFY(db.open());
+
+    const QStringList schema = QStringList()
+        << "CREATE TABLE Feature (id INTEGER PRIMARY KEY, consensus_mz REAL, consensus_rt REAL, consensus_charge INTEGER)"
+        << "CREATE TABLE SampleFeature (sample_id INTEGER, feature_id INTEGER, intensity REAL)"
+        << "CREATE TABLE Annotation (id INTEGER PRIMARY KEY, compound_id TEXT)"
+        << "CREATE TABLE FeatureAnnotation (feature_id INTEGER, annotation_id INTEGER)";
+    foreach (const QString &statement, schema) {
+        QSqlQuery query(statement);
+        QVERIFY(query.isActive());
+    }
+
+    QVERIFY(db.transaction());
+    QSqlQuery featureQuery;
+    QVERIFY(featureQuery.prepare("INSERT INTO Feature (id, consensus_mz, consensus_rt, consensus_charge) VALUES (?, ?, ?, 1)"));
+    for (int i = 0; i < FIXTURE_FEATURE_COUNT; ++i) {
+        featureQuery.addBindValue(i + 1);
+        featureQuery.addBindValue(FIXTURE_MZS[i]);
+        featureQuery.addBindValue(FIXTURE_RTS[i]);
+        QVERIFY(exec(featureQuery));
+    }
+
+    QVector<SampleId> sampleIds;
+    for (int i = 1; i <= FIXTURE_SAMPLE_COUNT; ++i) {
+        sampleIds.append(i);
+    }
+    QSqlQuery intensityQuery;
+    QVERIFY(intensityQuery.prepare("INSERT INTO SampleFeature (sample_id, feature_id, intensity) VALUES (?, ?, ?)"));
+    for (size_t i = 0; i < sizeof(FIXTURE_INTENSITIES) / sizeof(FIXTURE_INTENSITIES[0]); ++i) {
+        intensityQuery.addBindValue(sampleIds[FIXTURE_INTENSITIES[i].sampleNumber]);
+        intensityQuery.addBindValue(FIXTURE_INTENSITIES[i].featureId);
+        intensityQuery.addBindValue(FIXTURE_INTENSITIES[i].intensity);
+        QVERIFY(exec(intensityQuery));
+    }
+    QVERIFY(db.commit());
+
+    matrix.build(sampleIds);
+    QCOMPARE(matrix.getRowCount(), FIXTURE_FEATURE_COUNT);
+}
+
+void FeatureMatrixTest::cleanupTestCase()
+{
+    matrix.clear();
+    QSqlDatabase::database().close();
+    QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+}
+
+void FeatureMatrixTest::findRows_data()
+{
+    QTest::addColumn<qreal>("mzMin");
+    QTest::addColumn<qreal>("mzMax");
+    QTest::addColumn<qreal>("rtMin");
+    QTest::addColumn<qreal>("rtMax");
+    QTest::addColumn<QVector<int> >("rows");
+
+    typedef QVector<int> Rows;
+    QTest::newRow("window") << 150.0 << 300.0 << 30.0 << 90.0 << (Rows() << 1 << 3 << 4 << 6);
+    QTest::newRow("inclusive m/z bounds") << 150.0 << 150.0 << 30.0 << 120.0 << (Rows() << 1 << 2);
+    QTest::newRow("inclusive RT bounds") << 100.0 << 400.0 << 60.0 << 60.0 << (Rows() << 0 << 4);
+    QTest::newRow("single point") << 300.0 << 300.0 << 30.0 << 30.0 << (Rows() << 6);
+    QTest::newRow("bounds next to values") << 150.5 << 299.5 << -NO_BOUND << NO_BOUND << (Rows() << 3 << 4);
+    QTest::newRow("no bounds") << -NO_BOUND << NO_BOUND << -NO_BOUND << NO_BOUND
+        << (Rows() << 0 << 1 << 2 << 3 << 4 << 5 << 6 << 7);
+    QTest::newRow("m/z bound only") << 400.0 << NO_BOUND << -NO_BOUND << NO_BOUND << (Rows() << 7);
+    QTest::newRow("RT bound only") << -NO_BOUND << NO_BOUND << 30.0 << 30.0 << (Rows() << 1 << 6);
+    QTest::newRow("empty, between m/z values") << 160.0 << 190.0 << -NO_BOUND << NO_BOUND << Rows();
+    QTest::newRow("empty, below all m/z values") << 0.0 << 50.0 << -NO_BOUND << NO_BOUND << Rows();
+    QTest::newRow("empty, above all RT values") << -NO_BOUND << NO_BOUND << 300.0 << 400.0 << Rows();
+    QTest::newRow("empty, inverted m/z range") << 300.0 << 150.0 << -NO_BOUND << NO_BOUND << Rows();
+    QTest::newRow("empty, inverted RT range") << -NO_BOUND << NO_BOUND << 90.0 << 30.0 << Rows();
+    QTest::newRow("empty, disjoint m/z and RT matches") << 100.0 << 150.0 << 180.0 << 240.0 << Rows();
+}
+
+void FeatureMatrixTest::findRows()
+{
+    QFETCH(qreal, mzMin);
+    QFETCH(qreal, mzMax);
+    QFETCH(qreal, rtMin);
+    QFETCH(qreal, rtMax);
+    QFETCH(QVector<int>, rows);
+
+    QCOMPARE(matrix.findRows(mzMin, mzMax, rtMin, rtMax), rows);
+}
+
+void FeatureMatrixTest::findRowsInEmptyMatrix()
+{
+    QVERIFY(FeatureMatrix().findRows(-NO_BOUND, NO_BOUND, -NO_BOUND, NO_BOUND).isEmpty());
+}
+
+void FeatureMatrixTest::findMostIntenseRows_data()
+{
+    QTest::addColumn<int>("sampleNumber");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QVector<int> >("rows");
+
+    typedef QVector<int> Rows;
+    QTest::newRow("most intense") << 0 << 1 << (Rows() << 4);
+    QTest::newRow("equal intensities by row") << 0 << 3 << (Rows() << 4 << 0 << 2);
+    QTest::newRow("equal intensities cut") << 0 << 4 << (Rows() << 4 << 0 << 2 << 1);
+    QTest::newRow("all detected") << 0 << 7 << (Rows() << 4 << 0 << 2 << 1 << 6 << 3 << 7);
+    QTest::newRow("more than detected") << 0 << 100 << (Rows() << 4 << 0 << 2 << 1 << 6 << 3 << 7);
+    QTest::newRow("other sample") << 1 << 100 << (Rows() << 5 << 1);
+    QTest::newRow("nothing detected") << 2 << 100 << Rows();
+    QTest::newRow("zero count") << 0 << 0 << Rows();
+    QTest::newRow("negative count") << 0 << -1 << Rows();
+}
+
+void FeatureMatrixTest::findMostIntenseRows()
+{
+    QFETCH(int, sampleNumber);
+    QFETCH(int, count);
+    QFETCH(QVector<int>, rows);
+
+    QCOMPARE(matrix.findMostIntenseRows(sampleNumber, count), rows);
+}
+
+QTEST_GUILESS_MAIN(FeatureMatrixTest)
+
+#include "tst_FeatureMatrix.moc"
@@ -0,0 +1,22 @@
+# Parsing and evaluation of filter expressions, run by "make check"
+QT += concurrent sql testlib
+QT -= gui
+TEMPLATE = app
+TARGET = FilterExpressionTest
+CONFIG += console testcase c++11
+CONFIG -= app_bundle
+
+SRC_DIR = ../../src
+INCLUDEPATH += $$SRC_DIR
+
+HEADERS += $$SRC_DIR/FeatureMatrix.h \
+           $$SRC_DIR/FeatureMatrixUtils.h \
+           $$SRC_DIR/FilterExpression.h \
+           $$SRC_DIR/Globals.h \
+           $$SRC_DIR/IntensityNormalization.h
+
+SOURCES += $$SRC_DIR/FeatureMatrix.cpp \
+           $$SRC_DIR/FeatureMatrixUtils.cpp \
+           $$SRC_DIR/FilterExpression.cpp \
+           $$SRC_DIR/IntensityNormalization.cpp \
+           tst_FilterExpression.cpp
@@ -0,0 +1,247 @@
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "FeatureMatrix.h"
+#include "FilterExpression.h"
+#include "IntensityNormalization.h"
+
+using namespace ov;
+
+struct FixtureFeature
+{
+    FeatureId id;
+    qreal mz;
+    qreal rt;
+    int charge;
+    qreal intensities[3]; // by sample number, 0 if the feature isn't detected
+};
+
+const FixtureFeature FIXTURE_FEATURES[] = {
+    { 1, 150.5, 30.0, 1, { 1e5, 2e5, 0.0 } },
+    { 2, 300.0, 60.0, 1, { 5e4, 0.0, 3e5 } },
+    { 3, 350.2, 90.0, 2, { 0.0, 1e6, 1e6 } },
+    { 4, 400.0, 120.0, 0, { 2e3, 2e3, 2e3 } },
+    { 5, 450.1, 150.0, 1, { 0.0, 0.0, 0.0 } },
+    { 6, 500.0, 180.0, 3, { 1.5e6, 0.0, 0.0 } }
+};
+const int FIXTURE_FEATURE_COUNT = sizeof(FIXTURE_FEATURES) / sizeof(FIXTURE_FEATURES[0]);
+
+// Compiles expressions against sample names of a small database and evaluates them on its feature matrix.
+class FilterExpressionTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void evaluate_data();
+    void evaluate();
+    void syntaxError_data();
+    void syntaxError();
+    void emptyExpression();
+    void failedCompileKeepsExpression();
+    void dependsOnIntensities();
+
+private:
+    bool exec(QSqlQuery &query);
+    QVector<FeatureId> getAcceptedIds(const FilterExpression &expression) const;
+
+    QTemporaryDir directory;
+    FeatureMatrix matrix;
+    QStringList sampleNames;
+};
+
+bool FilterExpressionTest::exec(QSqlQuery &query)
+{
+    if (!query.exec()) {
+        qWarning("%s", qPrintable(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+void FilterExpressionTest::initTestCase()
+{
+    QVERIFY(directory.isValid());
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(directory.path() + "/fixture.db");
+    QVERIFY(db.open());
+
+    const QStringList schema = QStringList()
+        << "CREATE TABLE Feature (id INTEGER PRIMARY KEY, consensus_mz REAL, consensus_rt REAL, consensus_charge INTEGER)"
+        << "CREATE TABLE SampleFeature (sample_id INTEGER, feature_id INTEGER, intensity REAL)"
+        << "CREATE TABLE Annotation (id INTEGER PRIMARY KEY, compound_id TEXT)"
+        << "CREATE TABLE FeatureAnnotation (feature_id INTEGER, annotation_id INTEGER)";
+    foreach (const QString &statement, schema) {
+        QSqlQuery query(statement);
+        QVERIFY(query.isActive());
+    }
+
+    const QVector<SampleId> sampleIds = QVector<SampleId>() << 10 << 20 << 30;
+    sampleNames << "QC_01" << "QC_02" << "Blank";
+
+    QVERIFY(db.transaction());
+    QSqlQuery featureQuery;
+    QVERIFY(featureQuery.prepare("INSERT INTO Feature (id, consensus_mz, consensus_rt, consensus_charge) VALUES (?, ?, ?, ?)"));
+    QSqlQuery intensityQuery;
+    QVERIFY(intensityQuery.prepare("INSERT INTO SampleFeature (sample_id, feature_id, intensity) VALUES (?, ?, ?)"));
+    for (int i = 0; i < FIXTURE_FEATURE_COUNT; ++i) {
+        const FixtureFeature &feature = FIXTURE_FEATURES[i];
+        featureQuery.addBindValue(feature.id);
+        featureQuery.addBindValue(feature.mz);
+        featureQuery.addBindValue(feature.rt);
+        featureQuery.addBindValue(feature.charge);
+        QVERIFY(exec(featureQuery));
+        for (int sampleNumber = 0; sampleNumber < sampleIds.size(); ++sampleNumber) {
+            if (0.0 == feature.intensities[sampleNumber]) {
+                continue;
+            }
+            intensityQuery.addBindValue(sampleIds[sampleNumber]);
+            intensityQuery.addBindValue(feature.id);
+            intensityQuery.addBindValue(feature.intensities[sampleNumber]);
+            QVERIFY(exec(intensityQuery));
+        }
+    }
+    QVERIFY(db.commit());
+
+    matrix.build(sampleIds);
+    QCOMPARE(matrix.getRowCount(), FIXTURE_FEATURE_COUNT);
+}
+
+void FilterExpressionTest::cleanupTestCase()
+{
+    matrix.clear();
+    QSqlDatabase::database().close();
+    QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+}
+
+QVector<FeatureId> FilterExpressionTest::getAcceptedIds(const FilterExpression &expression) const
+{
+    const QBitArray acceptedRows = expression.evaluate(matrix, IntensityNormalization());
+    Q_ASSERT(acceptedRows.size() == matrix.getRowCount());
+    QVector<FeatureId> ids;
+    for (int row = 0; row < acceptedRows.size(); ++row) {
+        if (acceptedRows.testBit(row)) {
+            ids.append(matrix.getFeatureId(row));
+        }
+    }
+    return ids;
+}
+
+void FilterExpressionTest::evaluate_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QVector<FeatureId> >("ids");
+
+    typedef QVector<FeatureId> Ids;
+    QTest::newRow("equal") << "charge = 1" << (Ids() << 1 << 2 << 5);
+    QTest::newRow("double equal") << "charge == 2" << (Ids() << 3);
+    QTest::newRow("not equal") << "charge != 1" << (Ids() << 3 << 4 << 6);
+    QTest::newRow("not equal, <>") << "charge <> 1" << (Ids() << 3 << 4 << 6);
+    QTest::newRow("less") << "rt < 90" << (Ids() << 1 << 2);
+    QTest::newRow("less or equal") << "rt <= 90" << (Ids() << 1 << 2 << 3);
+    QTest::newRow("greater") << "id > 4" << (Ids() << 5 << 6);
+    QTest::newRow("greater or equal") << "id >= 4" << (Ids() << 4 << 5 << 6);
+    QTest::newRow("between, inclusive bounds") << "mz between 300 and 400" << (Ids() << 2 << 3 << 4);
+    QTest::newRow("between, empty range") << "mz between 400 and 300" << Ids();
+    QTest::newRow("and binds tighter than or") << "charge = 1 or charge = 2 and mz > 400" << (Ids() << 1 << 2 << 5);
+    QTest::newRow("parentheses") << "(charge = 1 or charge = 2) and mz > 400" << (Ids() << 5);
+    QTest::newRow("not binds tighter than and") << "not mz < 300 and charge = 1" << (Ids() << 2 << 5);
+    QTest::newRow("not of parentheses") << "not (mz < 300 and charge = 1)" << (Ids() << 2 << 3 << 4 << 5 << 6);
+    QTest::newRow("double negation") << "not not charge = 0" << (Ids() << 4);
+    QTest::newRow("exponent") << "intensity[\"QC_01\"] >= 1e5" << (Ids() << 1 << 6);
+    QTest::newRow("exponent with sign") << "max_intensity > 2.5E+5" << (Ids() << 2 << 3 << 6);
+    QTest::newRow("fractional exponent mantissa") << "mz < 3.5e2" << (Ids() << 1 << 2);
+    QTest::newRow("negative exponent") << "rt >= 1.2e-1 and rt <= 6e1" << (Ids() << 1 << 2);
+    QTest::newRow("negative number") << "rt > -1e3" << (Ids() << 1 << 2 << 3 << 4 << 5 << 6);
+    QTest::newRow("fractional bound") << "mz between 300 and 350.2" << (Ids() << 2 << 3);
+    QTest::newRow("leading point") << "mz < .5e3" << (Ids() << 1 << 2 << 3 << 4 << 5);
+    QTest::newRow("undetected intensity is 0") << "intensity['Blank'] = 0" << (Ids() << 1 << 5 << 6);
+    QTest::newRow("nonzero count") << "nonzero_count >= 2" << (Ids() << 1 << 2 << 3 << 4);
+    QTest::newRow("max intensity of undetected feature") << "max_intensity = 0" << (Ids() << 5);
+    QTest::newRow("case insensitive") << "MZ Between 300 AND 400 Or NOT Charge >= 1" << (Ids() << 2 << 3 << 4);
+    QTest::newRow("no spaces") << "(rt<60)or(id>=6)" << (Ids() << 1 << 6);
+}
+
+void FilterExpressionTest::evaluate()
+{
+    QFETCH(QString, text);
+    QFETCH(QVector<FeatureId>, ids);
+
+    FilterExpression expression;
+    QString errorMessage;
+    QVERIFY2(expression.compile(text, sampleNames, errorMessage), qPrintable(errorMessage));
+    QVERIFY(!expression.isEmpty());
+    QCOMPARE(getAcceptedIds(expression), ids);
+}
+
+void FilterExpressionTest::syntaxError_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("errorMessage");
+
+    // positions start with 1
+    QTest::newRow("missing number") << "mz >" << "Unexpected end of the expression.";
+    QTest::newRow("missing operand of and") << "mz > 1 and" << "Unexpected end of the expression.";
+    QTest::newRow("unclosed parenthesis") << "(mz > 1" << "Unexpected end of the expression.";
+    QTest::newRow("extra parenthesis") << "mz > 1)" << "Unexpected \")\" at position 7.";
+    QTest::newRow("or instead of and in between") << "mz between 1 or 2" << "Unexpected \"or\" at position 14.";
+    QTest::newRow("missing operator") << "mz 1" << "Unexpected \"1\" at position 4.";
+    QTest::newRow("missing conjunction") << "mz > 1 charge = 1" << "Unexpected \"charge\" at position 8.";
+    QTest::newRow("unknown value") << "foo > 1" << "Unknown value \"foo\" at position 1.";
+    QTest::newRow("unknown sample") << "intensity[\"X\"] > 1" << "Unknown sample \"X\" at position 11.";
+    QTest::newRow("unquoted sample") << "intensity[QC_01] > 1" << "Unexpected \"QC_01\" at position 11.";
+    QTest::newRow("unterminated string") << "intensity[\"QC_01] > 1" << "Unterminated string at position 11.";
+    QTest::newRow("invalid number") << "mz > 1.2.3" << "Invalid number \"1.2.3\" at position 6.";
+    QTest::newRow("unexpected character") << "mz # 1" << "Unexpected character \"#\" at position 4.";
+    QTest::newRow("value instead of number") << "mz > rt" << "Unexpected \"rt\" at position 6.";
+}
+
+void FilterExpressionTest::syntaxError()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, errorMessage);
+
+    FilterExpression expression;
+    QString actualErrorMessage;
+    QVERIFY(!expression.compile(text, sampleNames, actualErrorMessage));
+    QCOMPARE(actualErrorMessage, errorMessage);
+}
+
+void FilterExpressionTest::emptyExpression()
+{
+    FilterExpression expression;
+    QString errorMessage;
+    QVERIFY(expression.compile("  ", sampleNames, errorMessage));
+    QVERIFY(expression.isEmpty());
+    QCOMPARE(expression.evaluate(matrix, IntensityNormalization()), QBitArray(FIXTURE_FEATURE_COUNT, true));
+}
+
+void FilterExpressionTest::failedCompileKeepsExpression()
+{
+    FilterExpression expression;
+    QString errorMessage;
+    QVERIFY(expression.compile(" charge = 2 ", sampleNames, errorMessage));
+    QVERIFY(!expression.compile("charge = ", sampleNames, errorMessage));
+    QCOMPARE(expression.getText(), QString("charge = 2"));
+    QCOMPARE(getAcceptedIds(expression), QVector<FeatureId>() << 3);
+}
+
+void FilterExpressionTest::dependsOnIntensities()
+{
+    FilterExpression expression;
+    QString errorMessage;
+    QVERIFY(expression.compile("mz > 1 and not charge = 2", sampleNames, errorMessage));
+    QVERIFY(!expression.dependsOnIntensities());
+    QVERIFY(expression.compile("mz > 1 or max_intensity > 1", sampleNames, errorMessage));
+    QVERIFY(expression.dependsOnIntensities());
+    QVERIFY(expression.compile("intensity['QC_02'] > 1", sampleNames, errorMessage));
+    QVERIFY(expression.dependsOnIntensities());
+}
+
+QTEST_GUILESS_MAIN(FilterExpressionTest)
+
+#include "tst_FilterExpression.moc"